@@ -0,0 +1,282 @@
+/**
+ * Cache of the preprocessed 3DS models and textures
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       asset_cache.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "asset_cache.h"
+#include "../os.h"
+
+//--------------------------------------------------------------------------
+//                           T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Beginning of a cache file (followed by the data)
+ */
+struct AssetCacheHeader
+{
+  char          sMagic[8];           // "RARSCOOK"
+  int           iVersion;            // ASSET_CACHE_VERSION
+  unsigned int  iParam;
+  int           iSourceSize;
+  unsigned int  iSourceHash;
+  int           iDataSize;           // size of the data after the header
+};
+
+static const char g_sCacheMagic[8] = { 'R','A','R','S','C','O','O','K' };
+
+//--------------------------------------------------------------------------
+//                          Class AssetCache
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * @param sSource       (in) name of the source file (3ds, tga, bmp)
+ * @param sKind         (in) extension of the cache file ("mdl", "tex")
+ * @param iParam        (in) loading parameters (a different value cooks again)
+ */
+AssetCache::AssetCache( const char * sSource, const char * sKind, unsigned int iParam )
+{
+  m_iParam = iParam;
+  m_aData = NULL;
+  m_iSize = 0;
+  m_iPos = 0;
+  m_pOut = NULL;
+  m_bOk = false;
+
+  // cache/3ds_indy2_car_body.3ds.mdl
+  sprintf( m_sFileName, "%s/", ASSET_CACHE_DIR );
+  char * dest = m_sFileName+strlen(m_sFileName);
+  const char * src = sSource;
+  while( *src=='.' || *src=='/' || *src=='\\' )
+  {
+    src++;
+  }
+  for( ; *src!=0 && dest<m_sFileName+240; src++ )
+  {
+    *dest++ = ( *src=='/' || *src=='\\' || *src==':' ) ? '_' : *src;
+  }
+  sprintf( dest, ".%s", sKind );
+
+  HashSource( sSource );
+}
+
+/**
+ * Destructor
+ */
+AssetCache::~AssetCache()
+{
+  if( m_pOut!=NULL )
+  {
+    m_bOk = false;
+    Close();
+  }
+  if( m_aData!=NULL )
+  {
+    delete [] m_aData;
+  }
+}
+
+/**
+ * Hash of the source file (read in one block)
+ */
+void AssetCache::HashSource( const char * sSource )
+{
+  m_iSourceSize = -1;
+  m_iSourceHash = 0;
+
+  FILE * in = fopen( sSource, "rb" );
+  if( in==NULL )
+  {
+    return;
+  }
+  fseek( in, 0, SEEK_END );
+  long size = ftell( in );
+  fseek( in, 0, SEEK_SET );
+
+  char * buf = new char[size+1];
+  if( (long)fread( buf, 1, size, in )==size )
+  {
+    m_iSourceSize = size;
+    m_iSourceHash = Hash( buf, size );
+  }
+  delete [] buf;
+  fclose( in );
+}
+
+/**
+ * Read the cache file
+ *
+ * @return true if it exists and matches the source and the parameters
+ */
+bool AssetCache::Load()
+{
+  AssetCacheHeader header;
+
+  m_bOk = false;
+  if( m_iSourceSize<0 )
+  {
+    return false;
+  }
+  FILE * in = fopen( m_sFileName, "rb" );
+  if( in==NULL )
+  {
+    return false;
+  }
+
+  if( fread( &header, sizeof(header), 1, in )==1
+   && memcmp( header.sMagic, g_sCacheMagic, sizeof(g_sCacheMagic) )==0
+   && header.iVersion==ASSET_CACHE_VERSION
+   && header.iParam==m_iParam
+   && header.iSourceSize==m_iSourceSize
+   && header.iSourceHash==m_iSourceHash
+   && header.iDataSize>=0 )
+  {
+    m_aData = new char[header.iDataSize+1];
+    m_iSize = header.iDataSize;
+    m_iPos = 0;
+    m_bOk = (long)fread( m_aData, 1, m_iSize, in )==m_iSize;
+  }
+  fclose( in );
+  return m_bOk;
+}
+
+/**
+ * Copy the next bytes of the cache file. After the end of the file,
+ * p is zeroed and IsOk() returns false.
+ *
+ * @param p             (out) destination
+ * @param size          (in) number of bytes
+ */
+void AssetCache::Read( void * p, long size )
+{
+  if( !m_bOk || size<0 || m_iPos+size>m_iSize )
+  {
+    m_bOk = false;
+    if( size>0 )
+    {
+      memset( p, 0, size );
+    }
+    return;
+  }
+  memcpy( p, m_aData+m_iPos, size );
+  m_iPos += size;
+}
+
+/**
+ * Start writing the cache file (in a temporary file, see Close)
+ *
+ * @return false if the source is unknown or the cache can not be written
+ */
+bool AssetCache::Create()
+{
+  char sTmpName[280];
+  AssetCacheHeader header;
+
+  if( m_iSourceSize<0 )
+  {
+    return false;
+  }
+  sprintf( sTmpName, "%s.tmp", m_sFileName );
+  m_pOut = fopen( sTmpName, "wb" );
+  if( m_pOut==NULL )
+  {
+    os.CreateDirectory( ASSET_CACHE_DIR );
+    m_pOut = fopen( sTmpName, "wb" );
+    if( m_pOut==NULL )
+    {
+      return false;
+    }
+  }
+
+  // The size of the data is written by Close
+  memset( &header, 0, sizeof(header) );
+  memcpy( header.sMagic, g_sCacheMagic, sizeof(g_sCacheMagic) );
+  header.iVersion = ASSET_CACHE_VERSION;
+  header.iParam = m_iParam;
+  header.iSourceSize = m_iSourceSize;
+  header.iSourceHash = m_iSourceHash;
+  m_bOk = fwrite( &header, sizeof(header), 1, m_pOut )==1;
+  m_iSize = 0;
+  return true;
+}
+
+/**
+ * Append bytes to the cache file
+ */
+void AssetCache::Write( const void * p, long size )
+{
+  if( m_pOut==NULL || !m_bOk || size<=0 )
+  {
+    return;
+  }
+  m_bOk = (long)fwrite( p, 1, size, m_pOut )==size;
+  m_iSize += size;
+}
+
+/**
+ * End the writing: the temporary file replaces the old cache file,
+ * or is removed after an error.
+ */
+void AssetCache::Close()
+{
+  char sTmpName[280];
+  int iDataSize = (int)m_iSize;
+
+  if( m_pOut==NULL )
+  {
+    return;
+  }
+  if( m_bOk )
+  {
+    fseek( m_pOut, (long)offsetof( AssetCacheHeader, iDataSize ), SEEK_SET );
+    m_bOk = fwrite( &iDataSize, sizeof(iDataSize), 1, m_pOut )==1;
+  }
+  if( fclose( m_pOut )!=0 )
+  {
+    m_bOk = false;
+  }
+  m_pOut = NULL;
+
+  sprintf( sTmpName, "%s.tmp", m_sFileName );
+  if( m_bOk )
+  {
+    remove( m_sFileName );
+    m_bOk = rename( sTmpName, m_sFileName )==0;
+  }
+  if( !m_bOk )
+  {
+    remove( sTmpName );
+  }
+}
+
+/**
+ * FNV-1a hash of a block of memory
+ *
+ * @param p             (in) data
+ * @param size          (in) number of bytes
+ * @param h             (in) previous hash to combine several blocks
+ */
+unsigned int AssetCache::Hash( const void * p, long size, unsigned int h )
+{
+  const unsigned char * c = (const unsigned char *)p;
+  for( long i=0; i<size; i++ )
+  {
+    h = (h^c[i])*16777619u;
+  }
+  return h;
+}
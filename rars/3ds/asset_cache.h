@@ -0,0 +1,85 @@
+/**
+ * Cache of the preprocessed 3DS models and textures
+ *
+ * The first time a model or a texture is read, the result of the loading
+ * (vertices, normals, faces sorted by material, bounds, decoded image and
+ * its mipmaps) is written in one flat binary file of the directory
+ * "cache". The next runs read this file in one block and copy the arrays:
+ * no 3DS chunk, no normal and no image decoding.
+ *
+ * The cache file is keyed by the size and a hash of the source file and
+ * by the loading parameters (scale, ...): a changed source is cooked
+ * again. If the directory can not be written (read-only installation),
+ * the models are simply read from the source each time.
+ *
+ * Usage (reading):
+ *   AssetCache cache( "3ds/indy2/car_body.3ds", "mdl", param );
+ *   if( cache.Load() )
+ *   {
+ *     cache.Read( &numObjects, sizeof(int) );
+ *     ...
+ *     if( cache.IsOk() ) -> done
+ *   }
+ * Usage (writing, after loading the source):
+ *   if( cache.Create() )
+ *   {
+ *     cache.Write( &numObjects, sizeof(int) );
+ *     ...
+ *     cache.Close();
+ *   }
+ */
+
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define ASSET_CACHE_DIR      "cache"
+#define ASSET_CACHE_VERSION  1       // change it when the format changes
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * One cache file (for one source file)
+ */
+class AssetCache
+{
+  private:
+    char           m_sFileName[256];   // name of the cache file
+    unsigned int   m_iParam;           // loading parameters
+    unsigned int   m_iSourceHash;      // hash of the source file
+    long           m_iSourceSize;      // size of the source file (-1: not found)
+    char         * m_aData;            // content of the cache file (Load)
+    long           m_iSize;
+    long           m_iPos;
+    FILE         * m_pOut;             // cache file being written (Create)
+    bool           m_bOk;
+
+    void HashSource( const char * sSource );
+
+  public:
+    AssetCache( const char * sSource, const char * sKind, unsigned int iParam );
+    ~AssetCache();
+
+    bool Load();
+    void Read( void * p, long size );
+    bool IsOk() { return m_bOk; }
+
+    bool Create();
+    void Write( const void * p, long size );
+    void Close();
+
+    static unsigned int Hash( const void * p, long size, unsigned int h = 2166136261u );
+};
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * Background loading of the 3DS models and of their textures
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       asset_loader.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef WIN32
+  #include <unistd.h>             // sysconf()
+#endif
+#include "asset_loader.h"
+#include "model_3ds.h"
+#include "../misc.h"
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+AssetLoader asset_loader;
+
+//--------------------------------------------------------------------------
+//                          Class AssetLoader
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+AssetLoader::AssetLoader()
+{
+  m_iFirstQueued = 0;
+  m_iNumQueued = 0;
+  m_iNumDecoded = 0;
+  m_iNumBusy = 0;
+  m_iNumThread = 0;
+  m_bStarted = false;
+  m_bStop = false;
+#ifndef WIN32
+  pthread_mutex_init( &m_oMutex, NULL );
+  pthread_cond_init( &m_oJob, NULL );
+  pthread_cond_init( &m_oDone, NULL );
+#endif
+}
+
+/**
+ * Destructor
+ *
+ * The threads are only asked to stop: at the exit of the program one of
+ * them may be the caller (exitOnError while reading a model).
+ */
+AssetLoader::~AssetLoader()
+{
+  Lock();
+  m_bStop = true;
+#ifndef WIN32
+  pthread_cond_broadcast( &m_oJob );
+#endif
+  Unlock();
+}
+
+/**
+ * Start the loading threads (first model queued)
+ *
+ * One CPU is left to the race. If no thread can be created, the models
+ * are read when they are queued.
+ */
+void AssetLoader::Start()
+{
+  m_bStarted = true;
+#ifndef WIN32
+  long nb_cpu = sysconf( _SC_NPROCESSORS_ONLN );
+  int nb_thread = (int)nb_cpu-1;
+  if( nb_thread<1 ) nb_thread = 1;
+  if( nb_thread>MAX_ASSET_THREADS ) nb_thread = MAX_ASSET_THREADS;
+
+  for( m_iNumThread=0; m_iNumThread<nb_thread; m_iNumThread++ )
+  {
+    if( pthread_create(&m_aThread[m_iNumThread], NULL, WorkerThread, this)!=0 )
+    {
+      break;
+    }
+    pthread_detach( m_aThread[m_iNumThread] );
+  }
+#endif
+}
+
+#ifndef WIN32
+/**
+ * Loading thread: read the queued models one after the other
+ */
+void * AssetLoader::WorkerThread( void * arg )
+{
+  AssetLoader * loader = (AssetLoader *)arg;
+
+  loader->Lock();
+  for( ;; )
+  {
+    while( loader->m_iNumQueued==0 && !loader->m_bStop )
+    {
+      pthread_cond_wait( &loader->m_oJob, &loader->m_oMutex );
+    }
+    if( loader->m_bStop )
+    {
+      break;
+    }
+    Model_3DS * model = loader->m_aQueue[loader->m_iFirstQueued];
+    loader->m_iFirstQueued = (loader->m_iFirstQueued+1)%MAX_ASSET_JOBS;
+    loader->m_iNumQueued--;
+    loader->m_iNumBusy++;
+    loader->Unlock();
+
+    model->Decode();
+
+    loader->Lock();
+    loader->m_iNumBusy--;
+    loader->m_aDecoded[loader->m_iNumDecoded++] = model;
+    pthread_cond_broadcast( &loader->m_oDone );
+  }
+  loader->Unlock();
+  return NULL;
+}
+#endif
+
+/**
+ * Add a model to read (OpenGL thread). The model is not drawn until
+ * Upload finds it decoded.
+ *
+ * @param model         (in) model with its name, scale and options set
+ */
+void AssetLoader::Queue( Model_3DS * model )
+{
+  model->m_iState = MODEL_LOADING;
+  if( !m_bStarted )
+  {
+    Start();
+  }
+
+  if( m_iNumThread==0 )
+  {
+    // No thread: read it and upload it now (this is the OpenGL thread)
+    model->Decode();
+    model->Upload();
+    return;
+  }
+
+  Lock();
+  if( m_iNumQueued+m_iNumBusy+m_iNumDecoded>=MAX_ASSET_JOBS )
+  {
+    exitOnError( "AssetLoader::Queue: too many models to load (max %d)", MAX_ASSET_JOBS );
+  }
+  m_aQueue[(m_iFirstQueued+m_iNumQueued)%MAX_ASSET_JOBS] = model;
+  m_iNumQueued++;
+#ifndef WIN32
+  pthread_cond_signal( &m_oJob );
+#endif
+  Unlock();
+}
+
+/**
+ * Send the decoded models to OpenGL (OpenGL thread, once per frame)
+ *
+ * @return the number of models still loading
+ */
+int AssetLoader::Upload()
+{
+  Model_3DS * aModel[MAX_ASSET_JOBS];
+  int i, num, left;
+
+  Lock();
+  num = m_iNumDecoded;
+  for( i=0; i<num; i++ )
+  {
+    aModel[i] = m_aDecoded[i];
+  }
+  m_iNumDecoded = 0;
+  left = m_iNumQueued+m_iNumBusy;
+  Unlock();
+
+  for( i=0; i<num; i++ )
+  {
+    aModel[i]->Upload();
+  }
+  return left;
+}
+
+/**
+ * Forget the models not started, wait for the ones being read
+ * (before the models or the textures are deleted)
+ */
+void AssetLoader::Reset()
+{
+  Lock();
+  m_iNumQueued = 0;
+  while( m_iNumBusy>0 )
+  {
+    Wait();
+  }
+  Unlock();
+  Upload();
+}
+
+/**
+ * True if some models are not ready yet
+ */
+bool AssetLoader::IsBusy()
+{
+  Lock();
+  bool busy = m_iNumQueued+m_iNumBusy+m_iNumDecoded>0;
+  Unlock();
+  return busy;
+}
+
+void AssetLoader::Lock()
+{
+#ifndef WIN32
+  pthread_mutex_lock( &m_oMutex );
+#endif
+}
+
+void AssetLoader::Unlock()
+{
+#ifndef WIN32
+  pthread_mutex_unlock( &m_oMutex );
+#endif
+}
+
+/**
+ * Wait (locked) until a model or a texture is decoded
+ */
+void AssetLoader::Wait()
+{
+#ifndef WIN32
+  pthread_cond_wait( &m_oDone, &m_oMutex );
+#endif
+}
+
+/**
+ * Wake up the threads in Wait (locked)
+ */
+void AssetLoader::Signal()
+{
+#ifndef WIN32
+  pthread_cond_broadcast( &m_oDone );
+#endif
+}
@@ -0,0 +1,89 @@
+/**
+ * Background loading of the 3DS models and of their textures
+ *
+ * The models are read in loading threads: 3DS chunks, normals and
+ * decoding of the textures (TGA and BMP) are done in memory. The OpenGL
+ * thread only sends the result to OpenGL (Upload, once per frame): the
+ * race does not stop while the 3D view is loading. A model that is not
+ * ready is not drawn (Model_3DS::IsReady); the 3D view draws the default
+ * car instead.
+ *
+ * Usage:
+ *   Model_3DS * m = model_loader.QueueModel( "3ds/indy2/car_body.3ds", 0.1f, 90, true );
+ *   ...
+ *   asset_loader.Upload();              // each frame, in the OpenGL thread
+ *   if( m->IsReady() ) m->Draw();
+ *
+ * Without threads (WIN32 build), the models are read when queued and
+ * uploaded at the next frame.
+ */
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#ifndef WIN32
+  #include <pthread.h>
+#endif
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_ASSET_THREADS 4     // loading threads
+#define MAX_ASSET_JOBS    512   // models waiting or decoded
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+class Model_3DS;
+
+/**
+ * Queue of the models to load
+ */
+class AssetLoader
+{
+  private:
+    Model_3DS * m_aQueue[MAX_ASSET_JOBS];    // models to read (FIFO)
+    int         m_iFirstQueued;
+    int         m_iNumQueued;
+    Model_3DS * m_aDecoded[MAX_ASSET_JOBS];  // models read, to upload
+    int         m_iNumDecoded;
+    int         m_iNumBusy;                  // models being read
+    int         m_iNumThread;
+    bool        m_bStarted;
+    bool        m_bStop;
+
+#ifndef WIN32
+    pthread_t       m_aThread[MAX_ASSET_THREADS];
+    pthread_mutex_t m_oMutex;
+    pthread_cond_t  m_oJob;                  // a model is queued
+    pthread_cond_t  m_oDone;                 // a model or a texture is decoded
+
+    static void * WorkerThread( void * arg );
+#endif
+    void   Start();
+
+  public:
+    AssetLoader();
+    ~AssetLoader();
+
+    void   Queue( Model_3DS * model );
+    int    Upload();
+    void   Reset();
+    bool   IsBusy();
+
+    // Lock shared by the loading threads (queue, list of textures)
+    void   Lock();
+    void   Unlock();
+    void   Wait();
+    void   Signal();
+};
+
+extern AssetLoader asset_loader;
+
+#endif
@@ -35,6 +35,8 @@
 #include <stdlib.h>
 #include "../misc.h"
 #include "gl_texture.h"
+#include "asset_loader.h"
+#include "asset_cache.h"
 
 //--------------------------------------------------------------------------
 //                           T Y P E S
@@ -58,7 +60,7 @@ typedef struct
   GLubyte Header[12];                 // TGA File Header
 } TGAHeader;
 
-typedef struct
+struct TGA
 {
   GLubyte   header[6];                 // First 6 Useful Bytes From The Header
   GLuint    bytesPerPixel;             // Holds Number Of Bytes Per Pixel Used In The TGA File
@@ -68,7 +70,7 @@ typedef struct
   GLuint    Height;                    //Height of Image
   GLuint    Width;                     //Width ofImage
   GLuint    Bpp;                       // Bits Per Pixel
-} TGA;
+};
 
 // Format BMP
 struct BitmapArrayHeader
@@ -113,10 +115,6 @@ struct BMPInfoHeaderOld
 //                           G L O B A L S
 //--------------------------------------------------------------------------
 
-BMPInfoHeader bmpInfo;           
-BMPFileHeader bmpHeader;           
-TGAHeader tgaheader;                   // TGA header
-TGA tga;                               // TGA image data
 GLubyte uTGAcompare[12] = {0,0,2, 0,0,0,0,0,0,0,0,0}; // Uncompressed TGA Header
 GLubyte cTGAcompare[12] = {0,0,10,0,0,0,0,0,0,0,0,0}; // Compressed TGA Header
 
@@ -135,6 +133,8 @@ GLTexture * g_TextureEnvMap;
 GLTexture::GLTexture()
 {
   m_ImageData = NULL;
+  m_iNumLevel = 0;
+  m_iState = TEXTURE_DECODING;
 }
 
 /**
@@ -150,12 +150,13 @@ GLTexture::~GLTexture()
 }
 
 /**
- * Load a texture
+ * Decode a texture in memory (no OpenGL call: it may run in a loading
+ * thread, see Upload)
  *
  * @param name    : name of the bitmap file (tga or bmp)
  * @param bMipMap : render the texture with MipMap
  */
-int GLTexture::Load( const char * sPath, const char * sName, bool bMipmap)
+int GLTexture::Decode( const char * sPath, const char * sName, bool bMipmap)
 {
   char sFullName[256];
   strcpy( m_sTextureName, sName );
@@ -182,6 +183,14 @@ int GLTexture::Load( const char * sPath, const char * sName, bool bMipmap)
     bMipmap = false;
   }
 
+  // Already decoded in a previous run ?
+  AssetCache cache( sFullName, "tex", bMipmap ? 1 : 0 );
+  if( cache.Load() && ReadCache( cache ) )
+  {
+    fclose( file );
+    return 0;
+  }
+
   // check the file extension to see what type of texture
   if( strstr(sName,".tga") || strstr(sName,".TGA") ) 
     error = LoadTGA( file );
@@ -196,10 +205,13 @@ int GLTexture::Load( const char * sPath, const char * sName, bool bMipmap)
   }
   FindAlphaChannel();
   m_bMipmap = bMipmap;
-  BindTexture();
-
-  g_aLoadedTexture[g_iNbLoadedTexture++] = this;
+  BuildMipmaps();
 
+  if( cache.Create() )
+  {
+    WriteCache( cache );
+    cache.Close();
+  }
   return 0;
 }
 
@@ -226,8 +238,36 @@ void GLTexture::BindTexture()
   }
   glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
 
-  // Generate the mipmaps
-  gluBuild2DMipmaps(GL_TEXTURE_2D, type, width, height, type, GL_UNSIGNED_BYTE, m_ImageData);
+  // Send the images prepared by BuildMipmaps, skip the ones too big
+  GLint max_size;
+  glGetIntegerv( GL_MAX_TEXTURE_SIZE, &max_size );
+  glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+  int comp = (type==GL_RGBA) ? 4 : 3;
+  int w = width, h = height, level = 0;
+  GLubyte * image = m_ImageData;
+  for( int i=0; i<m_iNumLevel; i++ )
+  {
+    if( (w<=max_size && h<=max_size) || i==m_iNumLevel-1 )
+    {
+      glTexImage2D( GL_TEXTURE_2D, level++, type, w, h, 0, type, GL_UNSIGNED_BYTE, image );
+    }
+    image += w*h*comp;
+    w = w>1 ? w/2 : 1;
+    h = h>1 ? h/2 : 1;
+  }
+}
+
+/**
+ * Send a decoded texture to OpenGL (once, in the OpenGL thread)
+ */
+void GLTexture::Upload()
+{
+  if( m_iState==TEXTURE_DECODED )
+  {
+    BindTexture();
+    m_iState = TEXTURE_BOUND;
+  }
 }
 
 void GLTexture::Use()
@@ -270,6 +310,9 @@ void GLTexture::BuildColorTexture(unsigned char r, unsigned char g, unsigned cha
  */
 int GLTexture::LoadTGA( FILE * file )
 {
+  TGAHeader tgaheader;                           // TGA header
+  TGA tga;                                       // TGA image data
+
   // Read TGA signature
   if( fread(&tgaheader, sizeof(TGAHeader), 1, file)==0 )
   {
@@ -316,11 +359,11 @@ int GLTexture::LoadTGA( FILE * file )
   // See if signature matches the predefined header of compressed or uncompresed 
   if(memcmp(uTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)
   {
-    return LoadUncompressedTGA( file );
+    return LoadUncompressedTGA( file, tga );
   }
   else if(memcmp(cTGAcompare, &tgaheader, sizeof(tgaheader)) == 0)
   {
-    return LoadCompressedTGA( file );
+    return LoadCompressedTGA( file, tga );
   }
   else
   {
@@ -332,7 +375,7 @@ int GLTexture::LoadTGA( FILE * file )
 /**
  * Load an uncompressed TGA (note, much of this code is based on NeHe's )
  */
-int GLTexture::LoadUncompressedTGA( FILE * file )
+int GLTexture::LoadUncompressedTGA( FILE * file, TGA &tga )
 {
   if(fread(m_ImageData, 1, tga.imageSize, file) != tga.imageSize)  // Attempt to read image data
   {
@@ -354,7 +397,7 @@ int GLTexture::LoadUncompressedTGA( FILE * file )
 /**
  * Load COMPRESSED TGAs
  */
-int GLTexture::LoadCompressedTGA( FILE * file )
+int GLTexture::LoadCompressedTGA( FILE * file, TGA &tga )
 {
   GLuint pixelcount = tga.Height * tga.Width;    // Nuber of pixels in the image
   GLuint currentpixel = 0;                       // Current pixel being read
@@ -454,7 +497,7 @@ int GLTexture::LoadCompressedTGA( FILE * file )
 /**
  * Read a BMP file header
  */
-int GLTexture::ReadBMPHeaders( FILE * file, int &info_size )
+int GLTexture::ReadBMPHeaders( FILE * file, int &info_size, BMPFileHeader &bmpHeader, BMPInfoHeader &bmpInfo )
 {
    fread(&bmpHeader, 1, sizeof(BMPFileHeader), file);
    fread(&info_size, 1, sizeof(int), file);
@@ -493,6 +536,8 @@ int GLTexture::ReadBMPHeaders( FILE * file, int &info_size )
  */
 int GLTexture::LoadBMP( FILE * file )
 {
+   BMPFileHeader bmpHeader;
+   BMPInfoHeader bmpInfo;
    char file_type[2];
    fread(&file_type, 1, 2, file);
 
@@ -517,7 +562,7 @@ int GLTexture::LoadBMP( FILE * file )
          if (file_type[0] == 'B' && file_type[1] == 'M')
          {
             int info_size;
-            if( !ReadBMPHeaders(file, info_size) )
+            if( !ReadBMPHeaders(file, info_size, bmpHeader, bmpInfo) )
             {
                ++count;
                if (bmpInfo.image_size >= best_res)
@@ -546,7 +591,7 @@ int GLTexture::LoadBMP( FILE * file )
 
    int info_size;
 
-   if( ReadBMPHeaders(file, info_size) )
+   if( ReadBMPHeaders(file, info_size, bmpHeader, bmpInfo) )
    {
       fclose(file);
       return ERR_INVALID_FORMAT;
@@ -956,27 +1001,216 @@ void GLTexture::CheckWidth()
 }
 
 /**
- * Find a texture in the list of the already loaded textures
+ * Resize an image with the average of the source pixels (box filter)
  */
-GLTexture * GLTexture::GetLoadedTexture( const char * sPath, const char * sName, bool bMipmap )
+static void ScaleImage( const GLubyte * src, int sw, int sh, GLubyte * dest, int dw, int dh, int comp )
 {
-  for( int i=0; i<g_iNbLoadedTexture; i++ )
+  for( int y=0; y<dh; y++ )
+  {
+    int y0 = y*sh/dh;
+    int y1 = (y+1)*sh/dh;
+    if( y1<=y0 ) y1 = y0+1;
+    for( int x=0; x<dw; x++ )
+    {
+      int x0 = x*sw/dw;
+      int x1 = (x+1)*sw/dw;
+      if( x1<=x0 ) x1 = x0+1;
+      int n = (x1-x0)*(y1-y0);
+      for( int c=0; c<comp; c++ )
+      {
+        int sum = 0;
+        for( int sy=y0; sy<y1; sy++ )
+        {
+          for( int sx=x0; sx<x1; sx++ )
+          {
+            sum += src[(sy*sw+sx)*comp+c];
+          }
+        }
+        *dest++ = (GLubyte)((sum+n/2)/n);
+      }
+    }
+  }
+}
+
+/**
+ * Scale the image to a power of 2 and add the reduced images after it
+ * (what gluBuild2DMipmaps did in BindTexture, now done with the decoding
+ * and kept in the cache)
+ */
+void GLTexture::BuildMipmaps()
+{
+  int comp = (type==GL_RGBA) ? 4 : 3;
+  int w = 1, h = 1;
+  while( w*2<=width )  w *= 2;
+  while( h*2<=height ) h *= 2;
+
+  // Number of levels: down to 1x1
+  m_iNumLevel = 1;
+  if( m_bMipmap )
+  {
+    for( int lw=w, lh=h; lw>1 || lh>1; m_iNumLevel++ )
+    {
+      lw = lw>1 ? lw/2 : 1;
+      lh = lh>1 ? lh/2 : 1;
+    }
+  }
+
+  int old_width = width, old_height = height;
+  width = w;
+  height = h;
+  GLubyte * image = new GLubyte[ImageSize()];
+  ScaleImage( m_ImageData, old_width, old_height, image, w, h, comp );
+
+  GLubyte * src = image;
+  for( int i=1; i<m_iNumLevel; i++ )
+  {
+    int nw = w>1 ? w/2 : 1;
+    int nh = h>1 ? h/2 : 1;
+    GLubyte * dest = src + w*h*comp;
+    ScaleImage( src, w, h, dest, nw, nh, comp );
+    src = dest;
+    w = nw;
+    h = nh;
+  }
+  delete m_ImageData;
+  m_ImageData = image;
+}
+
+/**
+ * Size of m_ImageData with all the levels
+ */
+int GLTexture::ImageSize()
+{
+  int comp = (type==GL_RGBA) ? 4 : 3;
+  int size = 0;
+  int w = width, h = height;
+  for( int i=0; i<m_iNumLevel; i++ )
+  {
+    size += w*h*comp;
+    w = w>1 ? w/2 : 1;
+    h = h>1 ? h/2 : 1;
+  }
+  return size;
+}
+
+/**
+ * Read a decoded texture from the cache
+ *
+ * @return false if the cache file is not complete
+ */
+bool GLTexture::ReadCache( AssetCache &cache )
+{
+  int data[6];
+  cache.Read( data, sizeof(data) );
+  width       = data[0];
+  height      = data[1];
+  bpp         = data[2];
+  type        = (GLuint)data[3];
+  m_bMipmap   = data[4]!=0;
+  m_iNumLevel = data[5];
+  if( !cache.IsOk() || width<=0 || height<=0 || m_iNumLevel<=0 || m_iNumLevel>32 )
+  {
+    m_iNumLevel = 0;
+    return false;
+  }
+
+  int size = ImageSize();
+  m_ImageData = new GLubyte[size];
+  cache.Read( m_ImageData, size );
+  if( !cache.IsOk() )
+  {
+    delete m_ImageData;
+    m_ImageData = NULL;
+    m_iNumLevel = 0;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Write the decoded texture and its mipmaps in the cache
+ */
+void GLTexture::WriteCache( AssetCache &cache )
+{
+  int data[6];
+  data[0] = width;
+  data[1] = height;
+  data[2] = bpp;
+  data[3] = (int)type;
+  data[4] = m_bMipmap ? 1 : 0;
+  data[5] = m_iNumLevel;
+  cache.Write( data, sizeof(data) );
+  cache.Write( m_ImageData, ImageSize() );
+}
+
+/**
+ * Find a texture in the list of the already loaded textures, decode it if
+ * needed. No OpenGL call: the loading threads of the models use it
+ * (the texture is sent to OpenGL later by Upload).
+ */
+GLTexture * GLTexture::GetDecodedTexture( const char * sPath, const char * sName, bool bMipmap )
+{
+  GLTexture * tex = NULL;
+  int i;
+
+  asset_loader.Lock();
+  for( i=0; i<g_iNbLoadedTexture; i++ )
   {
      if( strcmp( sName, g_aLoadedTexture[i]->m_sTextureName )==0 )
      {
-       return g_aLoadedTexture[i];
+       tex = g_aLoadedTexture[i];
+       break;
      }
   }
 
-  GLTexture * tex = new GLTexture();
-  int error = tex->Load( sPath, sName, bMipmap );
+  if( tex!=NULL )
+  {
+    // Another thread is decoding it
+    while( tex->m_iState==TEXTURE_DECODING )
+    {
+      asset_loader.Wait();
+    }
+    asset_loader.Unlock();
+  }
+  else
+  {
+    if( g_iNbLoadedTexture>=MAX_TEXTURES )
+    {
+      exitOnError( "GLTexture::GetDecodedTexture: too many textures (max %d)", MAX_TEXTURES );
+    }
+    tex = new GLTexture();
+    strcpy( tex->m_sTextureName, sName );
+    g_aLoadedTexture[g_iNbLoadedTexture++] = tex;
+    asset_loader.Unlock();
+
+    int error = tex->Decode( sPath, sName, bMipmap );
+
+    asset_loader.Lock();
+    tex->m_iState = error ? TEXTURE_FAILED : TEXTURE_DECODED;
+    asset_loader.Signal();
+    asset_loader.Unlock();
+
+    if( error )
+    {
+      warning( "GLTexture::GetLoadedTexture: Error '%d' while loading texture '%s%s'", error, sPath, sName );
+    }
+  }
 
-  if( error )
+  if( tex->m_iState==TEXTURE_FAILED )
   {
-    warning( "GLTexture::GetLoadedTexture: Error '%d' while loading texture '%s%s'", error, sPath, sName );
-    return GetLoadedTexture( "tracks/texture/", "unknown.bmp", true );
+    return GetDecodedTexture( "tracks/texture/", "unknown.bmp", true );
   }
+  return tex;
+}
 
+/**
+ * Find a texture in the list of the already loaded textures
+ * (load it and send it to OpenGL if needed)
+ */
+GLTexture * GLTexture::GetLoadedTexture( const char * sPath, const char * sName, bool bMipmap )
+{
+  GLTexture * tex = GetDecodedTexture( sPath, sName, bMipmap );
+  tex->Upload();
   return tex;
 }
 
@@ -987,7 +1221,10 @@ void GLTexture::RebindLoadedTexture()
 {
   for( int i=0; i<g_iNbLoadedTexture; i++ )
   {
-    g_aLoadedTexture[i]->BindTexture();
+    if( g_aLoadedTexture[i]->m_iState==TEXTURE_BOUND )
+    {
+      g_aLoadedTexture[i]->BindTexture();
+    }
   }
 }
 
@@ -997,11 +1234,15 @@ void GLTexture::RebindLoadedTexture()
 void GLTexture::UnbindLoadedTexture()
 {
   GLuint todel[MAX_TEXTURES];
+  int n = 0;
   for( int i=0; i<g_iNbLoadedTexture; i++ )
   {
-    todel[i] = g_aLoadedTexture[i]->m_iOpenglId;
+    if( g_aLoadedTexture[i]->m_iState==TEXTURE_BOUND )
+    {
+      todel[n++] = g_aLoadedTexture[i]->m_iOpenglId;
+    }
   }
-  glDeleteTextures( g_iNbLoadedTexture, todel );
+  glDeleteTextures( n, todel );
 }
 
 /**
@@ -17,28 +17,48 @@
 #include <GL/gl.h>      // Header File For The OpenGL32 Library
 #include <GL/glu.h>     // Header File For The GLu32 Library
 
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+// State of a texture (m_iState)
+#define TEXTURE_DECODING  0  // being read by a thread
+#define TEXTURE_DECODED   1  // image in memory, not in OpenGL yet
+#define TEXTURE_BOUND     2  // in OpenGL
+#define TEXTURE_FAILED    3  // error while reading the file
+
 //--------------------------------------------------------------------------
 //                             T Y P E S
 //--------------------------------------------------------------------------
 
+struct TGA;
+struct BMPFileHeader;
+struct BMPInfoHeader;
+class AssetCache;
+
 /**
  * Class GLTexture
  */
 class GLTexture  
 {
 private:
-  GLubyte * m_ImageData;                         // Image data (up to 32 Bits)
+  GLubyte * m_ImageData;                         // Image data (up to 32 Bits), then the mipmaps
   bool m_bMipmap;                                // Use Mipmap
+  int m_iNumLevel;                               // Number of images in m_ImageData (BuildMipmaps)
 
-  int LoadUncompressedTGA( FILE * file );
-  int LoadCompressedTGA( FILE * file );
-  int ReadBMPHeaders( FILE * file, int &info_size );
+  int LoadUncompressedTGA( FILE * file, TGA &tga );
+  int LoadCompressedTGA( FILE * file, TGA &tga );
+  int ReadBMPHeaders( FILE * file, int &info_size, BMPFileHeader &bmpHeader, BMPInfoHeader &bmpInfo );
   void FindAlphaChannel();
   void CheckWidth();
+  void BuildMipmaps();
+  int  ImageSize();
+  bool ReadCache( AssetCache &cache );
+  void WriteCache( AssetCache &cache );
 
   int LoadTGA( FILE * file );                    // Loads a targa file
   int LoadBMP( FILE * file );                    // Loads a bmp file
-  int Load( const char * sPath, const char * sName, bool bMipmap );   // Load the texture
+  int Decode( const char * sPath, const char * sName, bool bMipmap ); // Read the texture in memory
 
 public:
   char m_sTextureName[128];                      // The textures name
@@ -47,6 +67,7 @@ public:
   int height;                                    // Texture's height
   int bpp;                                       // Bits per pixel
   GLuint type;                                   // Texture type
+  int m_iState;                                  // TEXTURE_DECODING, ...
 
   GLTexture();                                   // Constructor
   virtual ~GLTexture();                          // Destructor
@@ -54,8 +75,10 @@ public:
   void Use();                                    // Binds the texture for use
   void BuildColorTexture(unsigned char r, unsigned char g, unsigned char b);
   void BindTexture();                            // Bind the texture in OpenGL
+  void Upload();                                 // Bind a decoded texture (once)
 
   static GLTexture * GetLoadedTexture( const char * sPath, const char * sName, bool bMipmap );
+  static GLTexture * GetDecodedTexture( const char * sPath, const char * sName, bool bMipmap );
   static void RebindLoadedTexture();
   static void UnbindLoadedTexture();
   static void DeleteLoadedTexture();
@@ -78,6 +78,8 @@
 #include <math.h>
 #include <string.h>
 #include "model_3ds.h"
+#include "asset_loader.h"
+#include "asset_cache.h"
 #include "../misc.h"
 #include "../os.h"
 #include "../graphics/g_opengl.h"
@@ -125,6 +127,16 @@ Model_3DS::Object::Object()
   aTexCoord = NULL;
   aFace = NULL;
   aMatFace = NULL;
+  bVideoMemory = false;
+
+  maxFileVertex = 0;
+  maxFaces = 0;
+  aHashHead = NULL;
+  aHashNext = NULL;
+  numHashBucket = 0;
+
+  iVertexBuffer = 0;
+  iIndexBuffer = 0;
 
   strcpy( name, "object" );
 }
@@ -133,6 +145,7 @@ void Model_3DS::Object::SetNumFileVerts( int _numFileVertex )
 {
   // Assign the number of vertices for future use
   numFileVertex = _numFileVertex;
+  maxFileVertex = _numFileVertex;
 
   // Allocate arrays for the vertices and normals
   aFileVertex  = new Vertex[numFileVertex];
@@ -153,6 +166,7 @@ void Model_3DS::Object::SetNumFaces( int _numFaces )
 {
   // Store the number of faces
   numFaces = _numFaces;
+  maxFaces = _numFaces;
   // Allocate an array to hold the faces
   aFace = new Face[numFaces];
 }
@@ -222,6 +236,10 @@ Model_3DS::Model_3DS()
   // OpenGL list
   m_iOpenglId = -1;
   m_iOpenglIdTransp = -1;
+
+  // Loading
+  m_iState = MODEL_READY;
+  m_bRecenter = false;
 }
 
 /**
@@ -238,6 +256,7 @@ Model_3DS::~Model_3DS()
 void Model_3DS::RemoveAll()
 {
   int i, j;
+  glDeleteBuffers();
   for( i=0; i<numObjects; i++ )
   {
     Object * o = &( aObject[i] );
@@ -265,13 +284,23 @@ void Model_3DS::RemoveAll()
     {
       delete o->aFileVertex;
       delete o->aFile2Real;
+    }
+    if( o->bVideoMemory )
+    {
+      // (no file vertices for a model read from the cache)
       opengl.VideoMemoryFree( o->aRealVertex );
       opengl.VideoMemoryFree( o->aNormal );
+      opengl.VideoMemoryFree( o->aTexCoord );
     }
-    if( o->aTexCoord!=NULL )
+    else
     {
-      opengl.VideoMemoryFree( o->aTexCoord );
+      // not uploaded yet
+      delete [] o->aRealVertex;
+      delete [] o->aNormal;
+      delete [] o->aTexCoord;
     }
+    delete [] o->aHashHead;
+    delete [] o->aHashNext;
   }
 
   if( aObject!=NULL )
@@ -296,16 +325,35 @@ void Model_3DS::RemoveAll()
  * @param name : name of the 3DS file
  */
 void Model_3DS::Load( char * name )
+{
+  strcpy( m_sName, name );
+  Decode();
+  Upload();
+}
+
+/**
+ * Read the 3DS file m_sName in memory. There is no OpenGL call: it may run
+ * in a loading thread (see AssetLoader), Upload finishes the work.
+ */
+void Model_3DS::Decode()
 {
   // holds the main chunk header
   ChunkHeader main;
+  char buf[256];
+  char * name = buf;
 
-  // For future reference
-  strcpy( m_sName, name );
+  strcpy( buf, m_sName );
 
-  // strip "'s
-  if (strstr(name, "\""))
-    name = strtok(name, "\"");
+  // strip "'s (not strtok: several threads may load)
+  while( *name=='"' )
+  {
+    name++;
+  }
+  char * quote = strchr( name, '"' );
+  if( quote!=NULL )
+  {
+    *quote = 0;
+  }
 
   // Find the path
   if (strstr(name, "/") || strstr(name, "\\"))
@@ -337,6 +385,14 @@ void Model_3DS::Load( char * name )
     path[src-name] = 0;
   }
 
+  // Already read in a previous run ? The cache depends on the scale
+  unsigned int param = AssetCache::Hash( &scale, sizeof(scale) ) + (m_bRecenter ? 1 : 0);
+  AssetCache cache( name, "mdl", param );
+  if( cache.Load() && ReadCache( cache ) )
+  {
+    return;
+  }
+
   // Load the file
   bin3ds = fopen(name,"rb");
 
@@ -359,13 +415,233 @@ void Model_3DS::Load( char * name )
   // Don't need the file anymore so close it
   fclose(bin3ds);
 
-  PostCalc();
+  // pos and rot belong to the caller while the model is loading
+  Prepare( false );
+
+  CalculateSphere();
+  if( m_bRecenter )
+  {
+    Recenter();
+  }
+
+  if( cache.Create() )
+  {
+    WriteCache( cache );
+    cache.Close();
+  }
+}
+
+/**
+ * Read the model prepared by Decode from the cache (arrays ready to be
+ * uploaded, the normals and the bounds are not calculated again)
+ *
+ * @param cache         (in) cache file loaded
+ * @return false if the cache file is not complete
+ */
+bool Model_3DS::ReadCache( AssetCache &cache )
+{
+  int i, j;
+  int data[5];
+  char sTexName[128];
+  bool bValid = true;
+
+  cache.Read( data, sizeof(data) );
+  numObjects     = data[0];
+  numMaterials   = data[1];
+  m_bTransparent = data[2]!=0;
+  m_iNumFace     = data[3];
+  if( !cache.IsOk() || numObjects<0 || numMaterials<0 || data[4]!=(int)sizeof(Vertex) )
+  {
+    numObjects = numMaterials = 0;
+    return false;
+  }
+
+  float bounds[10];
+  cache.Read( bounds, sizeof(bounds) );
+  m_fCenterX = bounds[0];
+  m_fCenterY = bounds[1];
+  m_fCenterZ = bounds[2];
+  m_fMinX = bounds[3];
+  m_fMaxX = bounds[4];
+  m_fMinY = bounds[5];
+  m_fMaxY = bounds[6];
+  m_fMinZ = bounds[7];
+  m_fMaxZ = bounds[8];
+  m_fRay  = bounds[9];
+
+  aMaterial = new Material[numMaterials];
+  for( i=0; i<numMaterials && cache.IsOk(); i++ )
+  {
+    Material * mat = &( aMaterial[i] );
+    cache.Read( mat->name, sizeof(mat->name) );
+    cache.Read( &mat->bTextured, sizeof(mat->bTextured) );
+    cache.Read( &mat->color, sizeof(mat->color) );
+    cache.Read( &mat->iTransparency, sizeof(mat->iTransparency) );
+    if( mat->bTextured )
+    {
+      cache.Read( sTexName, sizeof(sTexName) );
+      sTexName[sizeof(sTexName)-1] = 0;
+      if( cache.IsOk() )
+      {
+        mat->tex = GLTexture::GetDecodedTexture( path, sTexName, true );
+      }
+    }
+  }
+
+  aObject = new Object[numObjects];
+  totalFaces = 0;
+  totalVerts = 0;
+  for( i=0; i<numObjects && bValid && cache.IsOk(); i++ )
+  {
+    Object * o = &( aObject[i] );
+    cache.Read( o->name, sizeof(o->name) );
+    cache.Read( data, sizeof(data) );
+    o->numRealVertex = data[0];
+    o->numTexCoords  = data[1];
+    o->numFaces      = data[2];
+    o->numMatFaces   = data[3];
+    o->bTextured     = data[4]!=0;
+    cache.Read( &o->pos, sizeof(o->pos) );
+    cache.Read( &o->rot, sizeof(o->rot) );
+    if( !cache.IsOk() || o->numRealVertex<0 || o->numTexCoords<0 || o->numMatFaces<0 )
+    {
+      o->numRealVertex = o->numTexCoords = o->numMatFaces = 0;
+      bValid = false;
+      break;
+    }
+
+    // the arrays are read straight in video memory (see Upload)
+    o->aRealVertex = (Vertex *) opengl.VideoMemoryAlloc( o->numRealVertex*sizeof(Vertex) );
+    o->aNormal     = (Vect3D *) opengl.VideoMemoryAlloc( o->numRealVertex*sizeof(Vect3D) );
+    o->aTexCoord   = (Vect2D *) opengl.VideoMemoryAlloc( o->numTexCoords*sizeof(Vect2D) );
+    o->bVideoMemory = true;
+    cache.Read( o->aRealVertex, o->numRealVertex*sizeof(Vertex) );
+    cache.Read( o->aNormal, o->numRealVertex*sizeof(Vect3D) );
+    cache.Read( o->aTexCoord, o->numTexCoords*sizeof(Vect2D) );
+
+    o->aMatFace = new MaterialFaces[o->numMatFaces];
+    for( j=0; j<o->numMatFaces && cache.IsOk(); j++ )
+    {
+      MaterialFaces * mf = &( o->aMatFace[j] );
+      cache.Read( &mf->MatIndex, sizeof(mf->MatIndex) );
+      cache.Read( &mf->numSubFaces, sizeof(mf->numSubFaces) );
+      if( !cache.IsOk() || mf->numSubFaces<0 || mf->MatIndex<0 || mf->MatIndex>=numMaterials )
+      {
+        mf->numSubFaces = 0;
+        bValid = false;
+        break;
+      }
+      mf->aSubFace = new Face[mf->numSubFaces];
+      cache.Read( mf->aSubFace, mf->numSubFaces*sizeof(Face) );
+    }
+    totalFaces += o->numFaces;
+    totalVerts += o->numRealVertex;
+  }
+  if( bValid && cache.IsOk() )
+  {
+    scale = 1.0f;
+    return true;
+  }
+
+  // Incomplete: forget it
+  for( i=0; i<numObjects; i++ )
+  {
+    Object * o = &( aObject[i] );
+    for( j=0; o->aMatFace!=NULL && j<o->numMatFaces; j++ )
+    {
+      delete [] o->aMatFace[j].aSubFace;
+    }
+    delete [] o->aMatFace;
+    if( o->bVideoMemory )
+    {
+      opengl.VideoMemoryFree( o->aRealVertex );
+      opengl.VideoMemoryFree( o->aNormal );
+      opengl.VideoMemoryFree( o->aTexCoord );
+    }
+  }
+  delete [] aObject;
+  delete [] aMaterial;
+  aObject = NULL;
+  aMaterial = NULL;
+  numObjects = numMaterials = 0;
+  return false;
+}
+
+/**
+ * Write the model prepared by Decode in the cache
+ */
+void Model_3DS::WriteCache( AssetCache &cache )
+{
+  int i, j;
+  int data[5];
+  char sTexName[128];
+
+  data[0] = numObjects;
+  data[1] = numMaterials;
+  data[2] = m_bTransparent ? 1 : 0;
+  data[3] = m_iNumFace;
+  data[4] = sizeof(Vertex);
+  cache.Write( data, sizeof(data) );
+
+  float bounds[10] = { m_fCenterX, m_fCenterY, m_fCenterZ,
+                       m_fMinX, m_fMaxX, m_fMinY, m_fMaxY, m_fMinZ, m_fMaxZ, m_fRay };
+  cache.Write( bounds, sizeof(bounds) );
+
+  for( i=0; i<numMaterials; i++ )
+  {
+    Material * mat = &( aMaterial[i] );
+    cache.Write( mat->name, sizeof(mat->name) );
+    cache.Write( &mat->bTextured, sizeof(mat->bTextured) );
+    cache.Write( &mat->color, sizeof(mat->color) );
+    cache.Write( &mat->iTransparency, sizeof(mat->iTransparency) );
+    if( mat->bTextured )
+    {
+      memset( sTexName, 0, sizeof(sTexName) );
+      strncpy( sTexName, mat->tex->m_sTextureName, sizeof(sTexName)-1 );
+      cache.Write( sTexName, sizeof(sTexName) );
+    }
+  }
+
+  for( i=0; i<numObjects; i++ )
+  {
+    Object * o = &( aObject[i] );
+    cache.Write( o->name, sizeof(o->name) );
+    data[0] = o->numRealVertex;
+    data[1] = o->numTexCoords;
+    data[2] = o->numFaces;
+    data[3] = o->numMatFaces;
+    data[4] = o->bTextured ? 1 : 0;
+    cache.Write( data, sizeof(data) );
+    cache.Write( &o->pos, sizeof(o->pos) );
+    cache.Write( &o->rot, sizeof(o->rot) );
+    cache.Write( o->aRealVertex, o->numRealVertex*sizeof(Vertex) );
+    cache.Write( o->aNormal, o->numRealVertex*sizeof(Vect3D) );
+    cache.Write( o->aTexCoord, o->numTexCoords*sizeof(Vect2D) );
+    for( j=0; j<o->numMatFaces; j++ )
+    {
+      MaterialFaces * mf = &( o->aMatFace[j] );
+      cache.Write( &mf->MatIndex, sizeof(mf->MatIndex) );
+      cache.Write( &mf->numSubFaces, sizeof(mf->numSubFaces) );
+      cache.Write( mf->aSubFace, mf->numSubFaces*sizeof(Face) );
+    }
+  }
 }
 
 /**
  * Post calculation (calculate all missing stuff to draw the model)
  */
 void Model_3DS::PostCalc()
+{
+  Prepare( true );
+  Upload();
+}
+
+/**
+ * Calculate the data to draw the model in memory
+ *
+ * @param bMove : true: move the points by pos (and reset it)
+ */
+void Model_3DS::Prepare( bool bMove )
 {
   int i, j;
 
@@ -379,9 +655,18 @@ void Model_3DS::PostCalc()
     for( j=0; j<aObject[i].numRealVertex; j++ )
     {
       Vertex * v = &(aObject[i].aRealVertex[j]);
-      v->x = v->x*scale+pos.x;
-      v->y = v->y*scale+pos.y;
-      v->z = v->z*scale+pos.z;
+      if( bMove )
+      {
+        v->x = v->x*scale+pos.x;
+        v->y = v->y*scale+pos.y;
+        v->z = v->z*scale+pos.z;
+      }
+      else
+      {
+        v->x = v->x*scale;
+        v->y = v->y*scale;
+        v->z = v->z*scale;
+      }
     }
 
     // Transform the data of the face for OpenGL rendering
@@ -393,7 +678,10 @@ void Model_3DS::PostCalc()
     m_iNumFace += aObject[i].numFaces;
   }
   scale = 1.0f;
-  pos.x = pos.y = pos.z = 0;
+  if( bMove )
+  {
+    pos.x = pos.y = pos.z = 0;
+  }
 
   // Calculate the vertex normals
   UnitNormals();
@@ -441,10 +729,23 @@ void Model_3DS::PostCalc()
       } 
     }
   }
+}
+
+/**
+ * Send the model to the video memory and its textures to OpenGL
+ * (OpenGL thread). After that the model is drawn.
+ */
+void Model_3DS::Upload()
+{
+  int i, j;
 
-  // Copy the point to the Video memory
+  // Copy the point to the Video memory (already there if read from the cache)
   for( i=0; i<numObjects; i++ )
   {
+    if( aObject[i].bVideoMemory )
+    {
+      continue;
+    }
     Vertex * a = aObject[i].aRealVertex;
     Vect3D * b = aObject[i].aNormal;
     aObject[i].aRealVertex = (Vertex *) opengl.VideoMemoryAlloc( aObject[i].numRealVertex*sizeof(Vertex) );
@@ -454,8 +755,8 @@ void Model_3DS::PostCalc()
       aObject[i].aRealVertex[j] = a[j];
       aObject[i].aNormal[j]     = b[j];
     }
-    delete a;
-    delete b;
+    delete [] a;
+    delete [] b;
 
     Vect2D * c = aObject[i].aTexCoord;
     aObject[i].aTexCoord = (Vect2D *) opengl.VideoMemoryAlloc( aObject[i].numTexCoords*sizeof(Vect2D) );
@@ -463,8 +764,19 @@ void Model_3DS::PostCalc()
     {
       aObject[i].aTexCoord[j] = c[j];
     }
-    delete c;
+    delete [] c;
+    aObject[i].bVideoMemory = true;
+  }
+
+  for( i=0; i<numMaterials; i++ )
+  {
+    if( aMaterial[i].tex!=NULL )
+    {
+      aMaterial[i].tex->Upload();
+    }
   }
+  glCreateBuffers();
+  m_iState = MODEL_READY;
 }
 
 /**
@@ -472,7 +784,7 @@ void Model_3DS::PostCalc()
  */
 void Model_3DS::Draw()
 {
-  if( m_bVisible )
+  if( m_bVisible && IsReady() )
   {
     glPushMatrix();
 
@@ -496,7 +808,7 @@ void Model_3DS::Draw()
  */
 void Model_3DS::DrawList( bool bTransparent )
 {
-  if( m_bVisible )
+  if( m_bVisible && IsReady() )
   {
     glPushMatrix();
 
@@ -532,193 +844,233 @@ void Model_3DS::DrawList( bool bTransparent )
  */
 void Model_3DS::DrawObjects( bool bTransparent )
 {
+  if( !IsReady() )
+  {
+    return;
+  }
+
   // Loop through the objects
   for( int i=0; i<numObjects; i++ )
   {
-    if( m_bEnvMap )
-    {
-	    glActiveTextureARB(GL_TEXTURE1_ARB);
-      glEnable(GL_TEXTURE_2D);
-      //Bind the texture.
-      glBindTexture(GL_TEXTURE_2D, g_TextureEnvMap->m_iOpenglId);
-      //Use sphere mapping auto coord generation.
-      glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
-      glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
-      //Turn on auto coord generation. N.B.! This is a per texture unit operation here!
-      glEnable(GL_TEXTURE_GEN_S);
-      glEnable(GL_TEXTURE_GEN_T);
-      //Multiply this texture by the ships material colors.
-      glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MULT);
-  	  glActiveTextureARB(GL_TEXTURE0_ARB);
-    }
-
-    // Enable texture coordiantes, normals, and vertices arrays
-    glEnableClientState(GL_VERTEX_ARRAY);
+    DrawObject( i, bTransparent );
+  }
+  opengl.BufferBind( false, 0 );
+  opengl.BufferBind( true, 0 );
+}
 
-    if( aObject[i].bTextured )
-    {
-      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-      glTexCoordPointer(2, GL_FLOAT, 0, aObject[i].aTexCoord);
-      if( m_bEnvMap )
-      {
-        // TODO - Does not work
-        // glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_ADD);
-      }
-      else
-      {
-        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MULT);
-      }
-    }
-    else
-    {
-      glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-    }
-    if( m_bLit )
+/**
+ * Draw one object of the model. Its buffers stay bound: unbind them after
+ * the last object (see DrawObjects).
+ *
+ * @param i             (in) index in aObject
+ * @param bTransparent  (in) draw the transparent or the opaque faces
+ */
+void Model_3DS::DrawObject( int i, bool bTransparent )
+{
+  if( m_bEnvMap )
+  {
+	    glActiveTextureARB(GL_TEXTURE1_ARB);
+    glEnable(GL_TEXTURE_2D);
+    //Bind the texture.
+    glBindTexture(GL_TEXTURE_2D, g_TextureEnvMap->m_iOpenglId);
+    //Use sphere mapping auto coord generation.
+    glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
+    glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
+    //Turn on auto coord generation. N.B.! This is a per texture unit operation here!
+    glEnable(GL_TEXTURE_GEN_S);
+    glEnable(GL_TEXTURE_GEN_T);
+    //Multiply this texture by the ships material colors.
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MULT);
+	  glActiveTextureARB(GL_TEXTURE0_ARB);
+  }
+
+  // The arrays are in the buffers of the object, or in memory
+  Object * o = &( aObject[i] );
+  const GLvoid * pVertex   = o->aRealVertex;
+  const GLvoid * pNormal   = o->aNormal;
+  const GLvoid * pTexCoord = o->aTexCoord;
+  opengl.BufferBind( false, o->iVertexBuffer );
+  opengl.BufferBind( true, o->iIndexBuffer );
+  if( o->iVertexBuffer!=0 )
+  {
+    pVertex   = (const GLvoid *)0;
+    pNormal   = (const GLvoid *)( o->numRealVertex*sizeof(Vertex) );
+    pTexCoord = (const GLvoid *)( o->numRealVertex*(sizeof(Vertex)+sizeof(Vect3D)) );
+  }
+
+  // Enable texture coordiantes, normals, and vertices arrays
+  glEnableClientState(GL_VERTEX_ARRAY);
+
+  if( aObject[i].bTextured )
+  {
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    if( m_bEnvMap )
     {
-      glEnableClientState(GL_NORMAL_ARRAY);
+      // TODO - Does not work
+      // glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_ADD);
     }
     else
     {
-      glDisableClientState(GL_NORMAL_ARRAY);
+      glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MULT);
     }
-    // Point them to the objects arrays
+  }
+  else
+  {
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  }
+  if( m_bLit )
+  {
+    glEnableClientState(GL_NORMAL_ARRAY);
+  }
+  else
+  {
+    glDisableClientState(GL_NORMAL_ARRAY);
+  }
+  // Point them to the objects arrays
 
-    glVertexPointer(3, GL_FLOAT, 0, aObject[i].aRealVertex);
-    if( aObject[i].bTextured )
-    {
-      glTexCoordPointer(2, GL_FLOAT, 0, aObject[i].aTexCoord);
-    }
-    if( m_bLit )
-    {
-      glNormalPointer(GL_FLOAT, 0, aObject[i].aNormal);
-    }
+  glVertexPointer(3, GL_FLOAT, 0, pVertex);
+  if( aObject[i].bTextured )
+  {
+    glTexCoordPointer(2, GL_FLOAT, 0, pTexCoord);
+  }
+  if( m_bLit )
+  {
+    glNormalPointer(GL_FLOAT, 0, pNormal);
+  }
 
-    // Loop through the faces as sorted by material and draw them
-    for( int j=0; j<aObject[i].numMatFaces; j++ )
-    {
-      int matindex = aObject[i].aMatFace[j].MatIndex;
-      bool mat_transparent = aMaterial[matindex].iTransparency!=0;
+  // Loop through the faces as sorted by material and draw them
+  for( int j=0; j<aObject[i].numMatFaces; j++ )
+  {
+    int matindex = aObject[i].aMatFace[j].MatIndex;
+    bool mat_transparent = aMaterial[matindex].iTransparency!=0;
 
-      if( mat_transparent==bTransparent )
+    if( mat_transparent==bTransparent )
+    {
+      if( m_bMaterial )
       {
-        if( m_bMaterial )
-        {
-          // Use the material's texture
-          float a = 1.0f;
-          if( mat_transparent )
-          {
-            glEnable(GL_BLEND);
-            a = (100.0f-aMaterial[matindex].iTransparency)/100.0f;
-          }
-      
-          if( aMaterial[matindex].bTextured )
-          {
-            aMaterial[matindex].tex->Use();
-            GLfloat mat1[4]  = { 1.0f, 1.0f, 1.0f, 1.0f };
-            glMaterialfv( GL_FRONT_AND_BACK, GL_DIFFUSE, mat1 );
-            glEnable(GL_TEXTURE_2D);
-          }
-          else
-          {
-            float r = aMaterial[matindex].color.r/255.0f;
-            float g = aMaterial[matindex].color.g/255.0f;
-            float b = aMaterial[matindex].color.b/255.0f;
-            GLfloat mat2[4]  = { r, g, b, a };
-            glMaterialfv( GL_FRONT_AND_BACK, GL_DIFFUSE, mat2 );
-            glDisable(GL_TEXTURE_2D);
-          }
-        }
-
-        glPushMatrix();
-
-        // Move the model (only if needed -> the model is compiled into a OpenGL list)
-        if( aObject[i].pos.x!=0.0 || aObject[i].pos.y!=0.0 || aObject[i].pos.z!=0.0 )
-        {
-          glTranslatef(aObject[i].pos.x, aObject[i].pos.y, aObject[i].pos.z);
-        }
-        if( aObject[i].rot.z!=0.0 )
+        // Use the material's texture
+        float a = 1.0f;
+        if( mat_transparent )
         {
-          glRotatef(aObject[i].rot.z, 0.0f, 0.0f, 1.0f);
+          glEnable(GL_BLEND);
+          a = (100.0f-aMaterial[matindex].iTransparency)/100.0f;
         }
-        if( aObject[i].rot.y!=0.0 )
+    
+        if( aMaterial[matindex].bTextured )
         {
-          glRotatef(aObject[i].rot.y, 0.0f, 1.0f, 0.0f);
+          aMaterial[matindex].tex->Use();
+          GLfloat mat1[4]  = { 1.0f, 1.0f, 1.0f, 1.0f };
+          glMaterialfv( GL_FRONT_AND_BACK, GL_DIFFUSE, mat1 );
+          glEnable(GL_TEXTURE_2D);
         }
-        if( aObject[i].rot.x!=0.0 )
+        else
         {
-          glRotatef(aObject[i].rot.x, 1.0f, 0.0f, 0.0f);
+          float r = aMaterial[matindex].color.r/255.0f;
+          float g = aMaterial[matindex].color.g/255.0f;
+          float b = aMaterial[matindex].color.b/255.0f;
+          GLfloat mat2[4]  = { r, g, b, a };
+          glMaterialfv( GL_FRONT_AND_BACK, GL_DIFFUSE, mat2 );
+          glDisable(GL_TEXTURE_2D);
         }
-        // Draw the faces using an index to the vertex array
-        glDrawElements(GL_TRIANGLES, aObject[i].aMatFace[j].numSubFaces*3, GL_UNSIGNED_SHORT, aObject[i].aMatFace[j].aSubFace);
+      }
 
-        if( mat_transparent )
-        {
-          glDisable(GL_BLEND);
-        }
+      glPushMatrix();
+
+      // Move the model (only if needed -> the model is compiled into a OpenGL list)
+      if( aObject[i].pos.x!=0.0 || aObject[i].pos.y!=0.0 || aObject[i].pos.z!=0.0 )
+      {
+        glTranslatef(aObject[i].pos.x, aObject[i].pos.y, aObject[i].pos.z);
+      }
+      if( aObject[i].rot.z!=0.0 )
+      {
+        glRotatef(aObject[i].rot.z, 0.0f, 0.0f, 1.0f);
+      }
+      if( aObject[i].rot.y!=0.0 )
+      {
+        glRotatef(aObject[i].rot.y, 0.0f, 1.0f, 0.0f);
+      }
+      if( aObject[i].rot.x!=0.0 )
+      {
+        glRotatef(aObject[i].rot.x, 1.0f, 0.0f, 0.0f);
+      }
+      // Draw the faces using an index to the vertex array
+      MaterialFaces * mf = &( o->aMatFace[j] );
+      if( o->iIndexBuffer!=0 )
+      {
+        glDrawElements(GL_TRIANGLES, mf->numSubFaces*3, GL_UNSIGNED_SHORT, (const GLvoid *)( mf->iFirstSubFace*sizeof(Face) ));
+      }
+      else
+      {
+        glDrawElements(GL_TRIANGLES, mf->numSubFaces*3, GL_UNSIGNED_SHORT, mf->aSubFace);
+      }
 
-        glPopMatrix();
+      if( mat_transparent )
+      {
+        glDisable(GL_BLEND);
       }
+
+      glPopMatrix();
     }
-    if( m_bEnvMap )
-    {
+  }
+  if( m_bEnvMap )
+  {
 	    glActiveTextureARB(GL_TEXTURE1_ARB);
-      glDisable(GL_TEXTURE_2D);
-      glDisable(GL_TEXTURE_GEN_S);
-      glDisable(GL_TEXTURE_GEN_T);
-  	  glActiveTextureARB(GL_TEXTURE0_ARB);
-    }
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_TEXTURE_GEN_S);
+    glDisable(GL_TEXTURE_GEN_T);
+	  glActiveTextureARB(GL_TEXTURE0_ARB);
+  }
 
-    /*
-    // Loop through the faces as sorted by material and draw them
-    for( int j=0; j<aObject[i].numMatFaces; j++ )
+  /*
+  // Loop through the faces as sorted by material and draw them
+  for( int j=0; j<aObject[i].numMatFaces; j++ )
+  {
+    for( int k=0; k<aObject[i].aMatFace[j].numSubFaces; k++ )
     {
-      for( int k=0; k<aObject[i].aMatFace[j].numSubFaces; k++ )
-      {
-        int v1 = aObject[i].aMatFace[j].aSubFace[k].a;
-        int v2 = aObject[i].aMatFace[j].aSubFace[k].b;
-        int v3 = aObject[i].aMatFace[j].aSubFace[k].c;
-        glBegin (GL_TRIANGLES);
-        // Materials[aObject[i].MatFaces[j].MatIndex].tex->Use();
-        glNormal3f( aObject[i].aNormal[v1].x, aObject[i].aNormal[v1].y, aObject[i].aNormal[v1].z );
-        glVertex3f( aObject[i].aRealVertex[v1].x, aObject[i].aRealVertex[v1].y, aObject[i].aRealVertex[v1].z );
-        glNormal3f( aObject[i].aNormal[v2].x, aObject[i].aNormal[v2].y, aObject[i].aNormal[v2].z );
-        glVertex3f( aObject[i].aRealVertex[v2].x, aObject[i].aRealVertex[v2].y, aObject[i].aRealVertex[v2].z );
-        glNormal3f( aObject[i].aNormal[v3].x, aObject[i].aNormal[v3].y, aObject[i].aNormal[v3].z );
-        glVertex3f( aObject[i].aRealVertex[v3].x, aObject[i].aRealVertex[v3].y, aObject[i].aRealVertex[v3].z );
-        glEnd ();
-      }
+      int v1 = aObject[i].aMatFace[j].aSubFace[k].a;
+      int v2 = aObject[i].aMatFace[j].aSubFace[k].b;
+      int v3 = aObject[i].aMatFace[j].aSubFace[k].c;
+      glBegin (GL_TRIANGLES);
+      // Materials[aObject[i].MatFaces[j].MatIndex].tex->Use();
+      glNormal3f( aObject[i].aNormal[v1].x, aObject[i].aNormal[v1].y, aObject[i].aNormal[v1].z );
+      glVertex3f( aObject[i].aRealVertex[v1].x, aObject[i].aRealVertex[v1].y, aObject[i].aRealVertex[v1].z );
+      glNormal3f( aObject[i].aNormal[v2].x, aObject[i].aNormal[v2].y, aObject[i].aNormal[v2].z );
+      glVertex3f( aObject[i].aRealVertex[v2].x, aObject[i].aRealVertex[v2].y, aObject[i].aRealVertex[v2].z );
+      glNormal3f( aObject[i].aNormal[v3].x, aObject[i].aNormal[v3].y, aObject[i].aNormal[v3].z );
+      glVertex3f( aObject[i].aRealVertex[v3].x, aObject[i].aRealVertex[v3].y, aObject[i].aRealVertex[v3].z );
+      glEnd ();
     }
-    */
-      
-    // Show the normals?
-    if( m_bShowNormal )
+  }
+  */
+    
+  // Show the normals?
+  if( m_bShowNormal )
+  {
+    // Loop through the vertices and normals and draw the normal
+    for( int k=0; k<aObject[i].numRealVertex; k++ )
     {
-      // Loop through the vertices and normals and draw the normal
-      for( int k=0; k<aObject[i].numRealVertex; k++ )
+      // Disable texturing
+      glDisable(GL_TEXTURE_2D);
+      // Disbale lighting if the model is lit
+      if( m_bLit )
       {
-        // Disable texturing
-        glDisable(GL_TEXTURE_2D);
-        // Disbale lighting if the model is lit
-        if( m_bLit )
-        {
-          glDisable(GL_LIGHTING);
-        }
-        // Draw the normals blue
-        glColor3f(0.0f, 0.0f, 1.0f);
-
-        // Draw a line between the vertex and the end of the normal
-        glBegin(GL_LINES);
-          glVertex3f(aObject[i].aRealVertex[k].x, aObject[i].aRealVertex[k].y, aObject[i].aRealVertex[k].z);
-          glVertex3f(aObject[i].aRealVertex[k].x+aObject[i].aNormal[k].x, aObject[i].aRealVertex[k].y+aObject[i].aNormal[k].y, aObject[i].aRealVertex[k].z+aObject[i].aNormal[k].z);
-        glEnd();
-
-        // Reset the color to white
-        glColor3f(1.0f, 1.0f, 1.0f);
-        // If the model is lit then renable lighting
-        if( m_bLit )
-        {
-          glEnable(GL_LIGHTING);
-        }
+        glDisable(GL_LIGHTING);
+      }
+      // Draw the normals blue
+      glColor3f(0.0f, 0.0f, 1.0f);
+
+      // Draw a line between the vertex and the end of the normal
+      glBegin(GL_LINES);
+        glVertex3f(aObject[i].aRealVertex[k].x, aObject[i].aRealVertex[k].y, aObject[i].aRealVertex[k].z);
+        glVertex3f(aObject[i].aRealVertex[k].x+aObject[i].aNormal[k].x, aObject[i].aRealVertex[k].y+aObject[i].aNormal[k].y, aObject[i].aRealVertex[k].z+aObject[i].aNormal[k].z);
+      glEnd();
+
+      // Reset the color to white
+      glColor3f(1.0f, 1.0f, 1.0f);
+      // If the model is lit then renable lighting
+      if( m_bLit )
+      {
+        glEnable(GL_LIGHTING);
       }
     }
   }
@@ -1121,7 +1473,7 @@ void Model_3DS::MapNameChunkProcessor(long /*length*/, long findex, int matindex
   }
 
   // Load the name and indicate that the material has a texture
-  aMaterial[matindex].tex = GLTexture::GetLoadedTexture( path, name, true ); 
+  aMaterial[matindex].tex = GLTexture::GetDecodedTexture( path, name, true ); 
   aMaterial[matindex].bTextured = true;
   if( aMaterial[matindex].tex->type==GL_RGBA )
   {
@@ -1572,6 +1924,79 @@ void Model_3DS::glCreateList()
   }
 }
 
+/**
+ * Copy the arrays of each object in OpenGL buffers (OpenGL thread). The
+ * arrays stay in memory for the edition and the normals.
+ */
+void Model_3DS::glCreateBuffers()
+{
+  int i, j;
+
+  glDeleteBuffers();
+  if( !opengl.m_bBuffer )
+  {
+    return;
+  }
+  for( i=0; i<numObjects; i++ )
+  {
+    Object * o = &( aObject[i] );
+    if( o->numRealVertex==0 || o->numTexCoords<o->numRealVertex )
+    {
+      continue;
+    }
+
+    // Vertices, then normals, then texture coordinates
+    long size_vertex = o->numRealVertex*sizeof(Vertex);
+    long size_normal = o->numRealVertex*sizeof(Vect3D);
+    long size_coord  = o->numRealVertex*sizeof(Vect2D);
+    char * data = new char[size_vertex+size_normal+size_coord];
+    memcpy( data, o->aRealVertex, size_vertex );
+    memcpy( data+size_vertex, o->aNormal, size_normal );
+    memcpy( data+size_vertex+size_normal, o->aTexCoord, size_coord );
+
+    // Faces of all the materials one after the other
+    int num_face = 0;
+    for( j=0; j<o->numMatFaces; j++ )
+    {
+      num_face += o->aMatFace[j].numSubFaces;
+    }
+    Face * face = new Face[num_face+1];
+    num_face = 0;
+    for( j=0; j<o->numMatFaces; j++ )
+    {
+      MaterialFaces * mf = &( o->aMatFace[j] );
+      mf->iFirstSubFace = num_face;
+      memcpy( face+num_face, mf->aSubFace, mf->numSubFaces*sizeof(Face) );
+      num_face += mf->numSubFaces;
+    }
+
+    o->iVertexBuffer = opengl.BufferCreate( false, size_vertex+size_normal+size_coord, data );
+    o->iIndexBuffer  = opengl.BufferCreate( true, num_face*sizeof(Face), face );
+    if( o->iIndexBuffer==0 )
+    {
+      opengl.BufferDelete( o->iVertexBuffer );
+      o->iVertexBuffer = 0;
+    }
+    delete [] data;
+    delete [] face;
+  }
+}
+
+/**
+ * Delete the OpenGL buffers of the objects
+ */
+void Model_3DS::glDeleteBuffers()
+{
+  for( int i=0; i<numObjects; i++ )
+  {
+    Object * o = &( aObject[i] );
+    opengl.BufferDelete( o->iVertexBuffer );
+    opengl.BufferDelete( o->iIndexBuffer );
+    o->iVertexBuffer = 0;
+    o->iIndexBuffer = 0;
+  }
+}
+
 /**
  * Delete an Opengl List
  */
@@ -1803,8 +2228,9 @@ void Model_3DS::Save( const char * path, const char * name )
 
 #define CR_MAX_OBJECTS   15 
 #define CR_MAX_MATERIALS 10 
-#define CR_MAX_FILEVERTS 600 
-#define CR_MAX_FACES     600 
+#define CR_FILEVERTS     600      // initial size of the vertex arrays (they grow)
+#define CR_FACES         600      // initial size of the face arrays (they grow)
+#define CR_MAX_INDEX     0xFFFF   // the 3DS format stores the vertex and face ids in 16 bits
 #define CR_MAX_MATFACES  10
 
 /**
@@ -1825,11 +2251,11 @@ int Model_3DS::AddObject()
 {
   int id = numObjects;
 
-  aObject[id].SetNumFileVerts( CR_MAX_FILEVERTS );
+  aObject[id].SetNumFileVerts( CR_FILEVERTS );
   aObject[id].numFileVertex = 0;
-  aObject[id].SetNumFaces( CR_MAX_FACES );
+  aObject[id].SetNumFaces( CR_FACES );
   aObject[id].numFaces = 0;
-  aObject[id].SetNumTexCoords( CR_MAX_FILEVERTS );
+  aObject[id].SetNumTexCoords( CR_FILEVERTS );
   aObject[id].numTexCoords = 0;
   aObject[id].SetNumMatFaces( CR_MAX_MATFACES );
   aObject[id].numMatFaces = 0;
@@ -1898,22 +2324,146 @@ int Model_3DS::AddMaterialColor( unsigned char r, unsigned char g, unsigned char
   return id;
 }
 
+/**
+ * Hash of the position of a vertex (see AddVertex)
+ */
+static unsigned int VertexHash( Vertex v )
+{
+  float f[3];
+  unsigned int bits[3];
+
+  // +0.0f turns -0 into 0: they are equal, so they need the same hash
+  f[0] = v.x+0.0f;
+  f[1] = v.y+0.0f;
+  f[2] = v.z+0.0f;
+  memcpy( bits, f, sizeof(bits) );
+  unsigned int h = bits[0]*73856093u ^ bits[1]*19349663u ^ bits[2]*83492791u;
+  return h ^ (h>>16);
+}
+
+/**
+ * Find a vertex with the same position (not the same texture coordinate)
+ *
+ * @return the first vertex with this position, -1 if none
+ */
+int Model_3DS::Object::FindVertex( Vertex v )
+{
+  int i = aHashHead[ VertexHash(v) & (numHashBucket-1) ];
+  while( i>=0 )
+  {
+    if( aFileVertex[i]==v )
+    {
+      return i;
+    }
+    i = aHashNext[i];
+  }
+  return -1;
+}
+
+/**
+ * Add a vertex to the hash table, unless its position is already there
+ * (so the table finds the first vertex of each position)
+ */
+void Model_3DS::Object::HashVertex( int id )
+{
+  if( FindVertex(aFileVertex[id])<0 )
+  {
+    int bucket = VertexHash( aFileVertex[id] ) & (numHashBucket-1);
+    aHashNext[id] = aHashHead[bucket];
+    aHashHead[bucket] = id;
+  }
+}
+
+/**
+ * Double the size of the vertex arrays when they are full,
+ * and rebuild the hash table for the new size
+ */
+void Model_3DS::Object::GrowVertex()
+{
+  int i;
+
+  if( numFileVertex>=maxFileVertex )
+  {
+    if( maxFileVertex>=CR_MAX_INDEX )
+    {
+      exitOnError( "3DS: too many vertices in object %s (max %d)", name, CR_MAX_INDEX );
+    }
+    int max = maxFileVertex*2;
+    if( max<CR_FILEVERTS ) max = CR_FILEVERTS;
+    if( max>CR_MAX_INDEX ) max = CR_MAX_INDEX;
+
+    Vertex * file_vertex = new Vertex[max];
+    Vertex * real_vertex = new Vertex[max];
+    Vect3D * normal      = new Vect3D[max];
+    int    * file2real   = new int[max];
+    Vect2D * tex_coord   = new Vect2D[max];
+    for( i=0; i<numFileVertex; i++ )
+    {
+      file_vertex[i] = aFileVertex[i];
+      real_vertex[i] = aRealVertex[i];
+      normal[i]      = aNormal[i];
+      file2real[i]   = aFile2Real[i];
+    }
+    for( i=0; i<numTexCoords && i<numFileVertex; i++ )
+    {
+      tex_coord[i]   = aTexCoord[i];
+    }
+    for( i=numFileVertex; i<max; i++ )
+    {
+      normal[i].x = normal[i].y = normal[i].z = 0.0f;
+    }
+    delete [] aFileVertex;
+    delete [] aRealVertex;
+    delete [] aNormal;
+    delete [] aFile2Real;
+    delete [] aTexCoord;
+    aFileVertex = file_vertex;
+    aRealVertex = real_vertex;
+    aNormal     = normal;
+    aFile2Real  = file2real;
+    aTexCoord   = tex_coord;
+    maxFileVertex = max;
+  }
+
+  // Hash table: at least 2 buckets per vertex
+  delete [] aHashHead;
+  delete [] aHashNext;
+  numHashBucket = 1;
+  while( numHashBucket<2*maxFileVertex )
+  {
+    numHashBucket *= 2;
+  }
+  aHashHead = new int[numHashBucket];
+  aHashNext = new int[maxFileVertex];
+  for( i=0; i<numHashBucket; i++ )
+  {
+    aHashHead[i] = -1;
+  }
+  for( i=0; i<numFileVertex; i++ )
+  {
+    HashVertex( i );
+  }
+}
+
 /**
  * Add a vertex to an object
  * v : coordinates
  * t : texture coord.
+ * bCheckDuplicate : return the vertex with the same coordinates if there is one
  */
 int Model_3DS::Object::AddVertex( Vertex v, Vect2D t, bool bCheckDuplicate )
 {
+  if( aHashHead==NULL || numFileVertex>=maxFileVertex )
+  {
+    GrowVertex();
+  }
   if( bCheckDuplicate )
   {
-    for( int i=0; i<numFileVertex; i++ )
+    // Check only the point and not the texture coordinate
+    int i = FindVertex( v );
+    if( i>=0 )
     {
-      // Check only the point and not the texture coordinate
-      if( aFileVertex[i].x==v.x && aFileVertex[i].y==v.y && aFileVertex[i].z==v.z )
-      {
-        return i;
-      }
+      return i;
     }
   }
 
@@ -1922,12 +2472,9 @@ int Model_3DS::Object::AddVertex( Vertex v, Vect2D t, bool bCheckDuplicate )
   aRealVertex[id] = v;
   aTexCoord[id] = t;
   aFile2Real[id] = id;
+  HashVertex( id );
 
   numFileVertex ++;
-  if( numFileVertex>CR_MAX_FILEVERTS )
-  {
-    exitOnError( "3DS: Increase CR_MAX_FILEVERTS" );
-  }
   numTexCoords = numFileVertex;
   numRealVertex = numFileVertex;
 
@@ -1950,7 +2497,8 @@ int Model_3DS::Object::AddMatFace( int iMaterial )
 
   int id = numMatFaces;
   aMatFace[id].MatIndex = iMaterial;
-  aMatFace[id].aFileFace = new GLushort[CR_MAX_FACES];
+  aMatFace[id].aFileFace = new GLushort[CR_FACES];
+  aMatFace[id].maxFileFaces = CR_FACES;
 
   numMatFaces ++;
   if( numMatFaces>CR_MAX_MATFACES )
@@ -1981,25 +2529,52 @@ int Model_3DS::Object::AddFace( int iMatFace, int p0, int p1, int p2 )
     p1 = p2;
     p2 = tmp;
   }
+  int i;
+  MaterialFaces * mf = &( aMatFace[iMatFace] );
+
+  // Grow the arrays of faces when they are full
+  if( numFaces>=CR_MAX_INDEX )
+  {
+    exitOnError( "3DS: too many faces in object %s (max %d)", name, CR_MAX_INDEX );
+  }
+  if( numFaces>=maxFaces )
+  {
+    int max = maxFaces*2;
+    if( max<CR_FACES ) max = CR_FACES;
+    if( max>CR_MAX_INDEX ) max = CR_MAX_INDEX;
+    Face * face = new Face[max];
+    for( i=0; i<numFaces; i++ )
+    {
+      face[i] = aFace[i];
+    }
+    delete [] aFace;
+    aFace = face;
+    maxFaces = max;
+  }
+  if( mf->numFileFaces>=mf->maxFileFaces )
+  {
+    int max = mf->maxFileFaces*2;
+    if( max<CR_FACES ) max = CR_FACES;
+    if( max>CR_MAX_INDEX ) max = CR_MAX_INDEX;
+    GLushort * file_face = new GLushort[max];
+    for( i=0; i<mf->numFileFaces; i++ )
+    {
+      file_face[i] = mf->aFileFace[i];
+    }
+    delete [] mf->aFileFace;
+    mf->aFileFace = file_face;
+    mf->maxFileFaces = max;
+  }
+
   int id = numFaces;
   aFace[id].a = p0;
   aFace[id].b = p1;
   aFace[id].c = p2;
   CalcFaceNormal( p0, p1, p2 ); 
 
-  aMatFace[iMatFace].aFileFace[aMatFace[iMatFace].numFileFaces] = id;
-
+  mf->aFileFace[mf->numFileFaces] = id;
+  mf->numFileFaces ++;
   numFaces ++;
-  if( numFaces>CR_MAX_FACES )
-  {
-    exitOnError( "3DS: Increase CR_MAX_FACES" );
-  }
-
-  aMatFace[iMatFace].numFileFaces ++;
-  if( aMatFace[iMatFace].numFileFaces>CR_MAX_FACES )
-  {
-    exitOnError( "3DS: Increase CR_MAX_FACES" );
-  }
 
   return id;
 }
@@ -2037,6 +2612,7 @@ ModelLoader::~ModelLoader()
 
 void ModelLoader::Reset()
 {
+  asset_loader.Reset();
   for( int i=0; i<iNumModel; i++ )
   {
     delete aModel[i];
@@ -2071,11 +2647,48 @@ Model_3DS * ModelLoader::GetModel( bool &bNew, const char * sName, float scale,
 
 Model_3DS * ModelLoader::LoadModel( const char * sName, float scale, float rotz, bool bMaterial )
 {
+  Model_3DS * model = NewModel( sName, scale, rotz, bMaterial );
+  model->Decode();
+  model->Upload();
+  return model;
+}
+
+/**
+ * Find a model in the list of the already loaded models, or load it in
+ * the background (see AssetLoader). The model is drawn when it is ready.
+ *
+ * @param bRecenter     (in) recenter a new model in (0,0,0) (wheels)
+ */
+Model_3DS * ModelLoader::QueueModel( const char * sName, float scale, float rotz, bool bMaterial, bool bRecenter )
+{
+  for( int i=0; i<model_loader.iNumModel; i++ )
+  {
+    if( strcmp( sName, model_loader.aModel[i]->m_sName )==0 )
+    {
+      return model_loader.aModel[i];
+    }
+  }
+
+  Model_3DS * model = NewModel( sName, scale, rotz, bMaterial );
+  model->m_bRecenter = bRecenter;
+  asset_loader.Queue( model );
+  return model;
+}
+
+/**
+ * Create an empty model in the list
+ */
+Model_3DS * ModelLoader::NewModel( const char * sName, float scale, float rotz, bool bMaterial )
+{
+  if( model_loader.iNumModel>=MAX_MODELS )
+  {
+    exitOnError( "ModelLoader: too many models (max %d)", MAX_MODELS );
+  }
   Model_3DS * model = new Model_3DS();
   model->rot.z = rotz;
   model->scale = scale;
   model->m_bMaterial = bMaterial;
-  model->Load( (char *)sName );
+  strcpy( model->m_sName, sName );
 
   model_loader.aModel[model_loader.iNumModel++] = model;
   return model;
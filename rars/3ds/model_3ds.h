@@ -82,6 +82,10 @@
 #define warn( x )  message( __FILE__LINE__ #x "\n" )
 #define MAX_MODELS 1000
 
+// State of a model (m_iState)
+#define MODEL_LOADING         0  // queued in the AssetLoader, not drawn
+#define MODEL_READY           1
+
 // The chunk's id numbers
 #define CHUNK_MAIN3DS         0x4D4D
  #define CHUNK_MAIN_VERS      0x0002
@@ -141,6 +145,8 @@
 #include <stdio.h>
 #include "../graphics/g_geom.h"
 
+class AssetCache;
+
 //--------------------------------------------------------------------------
 //                             T Y P E S
 //--------------------------------------------------------------------------
@@ -350,16 +356,20 @@ public:
 
       unsigned short * aFileFace; // A file face is the id of the face
       int numFileFaces;           // The number of faces
+      int maxFileFaces;           // Allocated size of aFileFace (edition)
 
       Face * aSubFace;            // A sub face is the list of the 3 vertexes of the face
       int numSubFaces;            // The number of faces
+      int iFirstSubFace;          // Position of aSubFace in the index buffer of the object
 
       MaterialFaces()
       {
         aFileFace = NULL;
         aSubFace = NULL;
         numFileFaces = 0;
+        maxFileFaces = 0;
         numSubFaces = 0;
+        iFirstSubFace = 0;
       }
   };
 
@@ -385,6 +395,19 @@ public:
       Vect3D pos;               // The position to move the object to
       Vect3D rot;               // The angles to rotate the object
       bool bFlipNewFace;        // Flip new added faces (AddFace)
+      bool bVideoMemory;        // aRealVertex, aNormal and aTexCoord are from opengl.VideoMemoryAlloc
+
+      // Edition: the arrays grow when vertices and faces are added, and
+      // AddVertex finds the duplicates with a hash table of the positions
+      int maxFileVertex;        // Allocated size of the vertex arrays
+      int maxFaces;             // Allocated size of aFace
+      int * aHashHead;          // First vertex of each bucket (-1 = empty)
+      int * aHashNext;          // Next vertex of the same bucket
+      int numHashBucket;        // Size of aHashHead (power of 2)
+
+      // OpenGL buffers (0: drawn from the arrays in memory)
+      unsigned int iVertexBuffer; // vertices, normals and texture coordinates
+      unsigned int iIndexBuffer;  // aSubFace of all the materials
 
       Object();
       void CalcFaceNormal( int a, int b, int c ); // Calculate the normal of a face;
@@ -396,6 +419,9 @@ public:
       void SetNumTexCoords( int _numTexCoords );
       void SetNumMatFaces( int _numMatFaces );
       int AddVertex( Vertex v, Vect2D t, bool bCheckDuplicate=false );
+      int FindVertex( Vertex v );
+      void HashVertex( int id );
+      void GrowVertex();
       int AddMatFace( int iMaterial );
       void AddRect( int iMatFace, int p0, int p1, int p2, int p3 );
       int AddFace( int iMatFace, int p0, int p1, int p2 );
@@ -432,14 +458,22 @@ public:
   // Variables for information only
   int   m_iNumFace;       // Number of face for the model
 
+  // Loading (see AssetLoader)
+  int   m_iState;         // MODEL_LOADING or MODEL_READY
+  bool  m_bRecenter;      // Recenter the model after loading (wheels)
+
   Model_3DS();            // Constructor
   virtual ~Model_3DS();   // Destructor
 
   void Load( char * name ); // Loads a model
+  void Decode();            // Reads the model m_sName in memory (any thread)
+  void Upload();            // Sends it to OpenGL (OpenGL thread)
   void PostCalc();          // Post calculation (after loading)
+  bool IsReady() { return m_iState==MODEL_READY; }
   void Draw();              // Draws the model
   void DrawList( bool bTransparent ); // Draw one of the list (opaque or transp)
   void DrawObjects( bool bTransparent );
+  void DrawObject( int i, bool bTransparent ); // One object (relief tiles)
   void SetEnvMap( bool val );
 
   void CalculateSphere();   // Calculate the Sphere conating the object
@@ -453,13 +487,19 @@ public:
   int AddObject();
   int AddMaterialTexture( const char * sPath, const char * name );
   int AddMaterialColor( unsigned char r, unsigned char g, unsigned char b );
+  void glCreateBuffers();   // Send the vertices to OpenGL (vertex buffer objects)
 
 private:
   bool  m_bEnvMap;          // True: use the environment mapping
 
+  void Prepare( bool bMove ); // Calculation of PostCalc before the upload
+  bool ReadCache( AssetCache &cache );  // Preprocessed model (see AssetCache)
+  void WriteCache( AssetCache &cache );
+
   // The lists are automatally create in the first call.
   void glCreateList();      // Create a opengl list
   void glDeleteList();      // Delete the opengl list
+  void glDeleteBuffers();
 
   void IntColorChunkProcessor(long length, long findex, int matindex);
   void FloatColorChunkProcessor(long length, long findex, int matindex);
@@ -515,6 +555,10 @@ class ModelLoader
     Model_3DS * GetModel( const char * sName, float scale, float rotz, bool bMaterial);
     Model_3DS * GetModel( bool &bNew, const char * sName, float scale, float rotz, bool bMaterial);
     Model_3DS * LoadModel( const char * sName, float scale, float rotz, bool bMaterial);
+    Model_3DS * QueueModel( const char * sName, float scale, float rotz, bool bMaterial, bool bRecenter=false );
+
+  private:
+    Model_3DS * NewModel( const char * sName, float scale, float rotz, bool bMaterial );
 };
 
 extern ModelLoader model_loader;
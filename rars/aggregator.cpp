@@ -0,0 +1,495 @@
+/**
+ * AGGREGATOR.CPP - statistics of the drivers over the results of many runs
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       aggregator.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream.h>
+#include "aggregator.h"
+#include "misc.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+// fields read in the result lines (AggregateLine)
+#define AGG_SESSION   0
+#define AGG_TRACK     1
+#define AGG_DRIVER    2
+#define AGG_POS       3
+#define AGG_DONE      4
+#define AGG_POINTS    5
+#define AGG_DAMAGE    6
+#define AGG_BESTLAP   7
+#define AGG_FIELDS    8
+
+static const char * s_aFieldName[AGG_FIELDS] =
+{
+  "session", "track", "driver", "pos", "done", "points", "damage", "best_lap"
+};
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Copy a text value of a result line (with or without quotes)
+ *
+ * @param dst       (out) text
+ * @param src       (in) value in the line
+ * @param size      (in) size of dst
+ */
+static void CopyValue( char * dst, const char * src, int size )
+{
+  int i = 0;
+  if( *src=='"' )
+  {
+    src++;
+  }
+  while( i<size-1 && src[i] && strchr( "\",\r\n", src[i] )==NULL )
+  {
+    dst[i] = src[i];
+    i++;
+  }
+  dst[i] = 0;
+}
+
+/**
+ * Fill a line from the values of its fields
+ *
+ * @param v         (in) value of each field (NULL if absent)
+ * @param r         (out) the line
+ * @return          false if the line has no session, track, driver or position
+ */
+static bool FillLine( const char ** v, AggregateLine * r )
+{
+  if( !v[AGG_SESSION] || !v[AGG_TRACK] || !v[AGG_DRIVER] || !v[AGG_POS] )
+  {
+    return false;
+  }
+  CopyValue( r->m_sSession, v[AGG_SESSION], sizeof(r->m_sSession) );
+  CopyValue( r->m_sTrack, v[AGG_TRACK], sizeof(r->m_sTrack) );
+  CopyValue( r->m_sDriver, v[AGG_DRIVER], sizeof(r->m_sDriver) );
+  r->m_iPos = atoi( v[AGG_POS] );
+  r->m_iDone = v[AGG_DONE] ? atoi( v[AGG_DONE] ) : 0;
+  r->m_iPoints = v[AGG_POINTS] ? atoi( v[AGG_POINTS] ) : 0;
+  r->m_iDamage = v[AGG_DAMAGE] ? atol( v[AGG_DAMAGE] ) : 0;
+  r->m_fBestLap = v[AGG_BESTLAP] ? atof( v[AGG_BESTLAP] ) : 0.0;
+  return r->m_iPos>0 && r->m_sDriver[0];
+}
+
+/**
+ * Constructor
+ */
+Aggregator::Aggregator()
+{
+  int i;
+  for( i=0; i<MAX_AGGREGATE_DRIVERS; i++ )
+  {
+    m_aDriver[i] = NULL;
+  }
+  for( i=0; i<MAX_AGGREGATE_LAPS; i++ )
+  {
+    m_aLap[i] = NULL;
+  }
+  m_iNumDriver = 0;
+  m_iNumLap = 0;
+  m_iNumRace = 0;
+  m_iNumLine = 0;
+  m_iNumSkipped = 0;
+  m_iNumFile = 0;
+  m_aBuffer = new char[AGGREGATE_LINE];
+  for( i=0; i<AGG_FIELDS; i++ )
+  {
+    m_aColumn[i] = -1;
+  }
+}
+
+/**
+ * Destructor
+ */
+Aggregator::~Aggregator()
+{
+  int i;
+  for( i=0; i<MAX_AGGREGATE_DRIVERS; i++ )
+  {
+    delete m_aDriver[i];
+  }
+  for( i=0; i<MAX_AGGREGATE_LAPS; i++ )
+  {
+    delete m_aLap[i];
+  }
+  delete [] m_aBuffer;
+}
+
+/**
+ * Read all the files and write the statistics
+ *
+ * @param iNumFile  (in) number of files
+ * @param aFile     (in) names of the files ("-" for the standard input)
+ */
+void Aggregator::Run( int iNumFile, char ** aFile )
+{
+  for( int i=0; i<iNumFile; i++ )
+  {
+    FILE * f = strcmp( aFile[i], "-" ) ? fopen( aFile[i], "r" ) : stdin;
+    if( f==NULL )
+    {
+      warning( "Aggregator: unable to read %s", aFile[i] );
+      continue;
+    }
+    ReadFile( f );
+    if( f!=stdin )
+    {
+      fclose( f );
+    }
+    m_iNumFile++;
+  }
+  WriteReport( "result_aggregate.txt" );
+}
+
+/**
+ * Add the lines of a file: JSON lines, or CSV with its header
+ *
+ * @param f         (in) the file
+ */
+void Aggregator::ReadFile( FILE * f )
+{
+  AggregateLine r;
+
+  for( int i=0; i<AGG_FIELDS; i++ )
+  {
+    m_aColumn[i] = -1;
+  }
+  while( fgets( m_aBuffer, AGGREGATE_LINE, f )!=NULL )
+  {
+    char * line = m_aBuffer;
+    int len = strlen( line );
+    // too long: the end of the line (lap times) is skipped
+    if( len>0 && line[len-1]!='\n' )
+    {
+      int c;
+      while( (c = fgetc( f ))!=EOF && c!='\n' );
+    }
+
+    bool ok;
+    if( *line=='{' )
+    {
+      ok = ParseJson( line, &r );
+    }
+    else if( !strncmp( line, s_aFieldName[AGG_SESSION], strlen(s_aFieldName[AGG_SESSION]) ) )
+    {
+      ParseCsvHeader( line );
+      continue;
+    }
+    else if( *line=='\n' || *line=='\r' || *line==0 )
+    {
+      continue;
+    }
+    else
+    {
+      ok = ParseCsv( line, &r );
+    }
+
+    if( !ok )
+    {
+      m_iNumSkipped++;
+    }
+    else if( !strcmp( r.m_sSession, "race" ) )
+    {
+      AddLine( &r );
+    }
+  }
+}
+
+/**
+ * @param line      (in) {"name":value,...}
+ * @param r         (out) the fields of the line
+ * @return          false if the line is not a result line
+ */
+bool Aggregator::ParseJson( const char * line, AggregateLine * r )
+{
+  const char * v[AGG_FIELDS];
+  char key[40];
+
+  for( int i=0; i<AGG_FIELDS; i++ )
+  {
+    sprintf( key, "\"%s\":", s_aFieldName[i] );
+    v[i] = strstr( line, key );
+    if( v[i]!=NULL )
+    {
+      v[i] += strlen( key );
+    }
+  }
+  return FillLine( v, r );
+}
+
+/**
+ * Column of each field in the CSV lines that follow
+ *
+ * @param line      (in/out) header of a CSV file (names separated by ',')
+ */
+void Aggregator::ParseCsvHeader( char * line )
+{
+  char * p;
+  int col = 0;
+
+  for( p=strtok( line, ",\r\n" ); p!=NULL; p=strtok( NULL, ",\r\n" ), col++ )
+  {
+    for( int i=0; i<AGG_FIELDS; i++ )
+    {
+      if( !strcmp( p, s_aFieldName[i] ) )
+      {
+        m_aColumn[i] = col;
+      }
+    }
+  }
+}
+
+/**
+ * @param line      (in/out) values separated by ',' (texts and lists in quotes)
+ * @param r         (out) the fields of the line
+ * @return          false if the line is not a result line
+ */
+bool Aggregator::ParseCsv( char * line, AggregateLine * r )
+{
+  const char * v[AGG_FIELDS];
+  const char * col[64];
+  int i, n = 0;
+  bool quote = false;
+
+  col[n++] = line;
+  for( char * p=line; *p && n<64; p++ )
+  {
+    if( *p=='"' )
+    {
+      quote = !quote;
+    }
+    else if( *p==',' && !quote )
+    {
+      col[n++] = p+1;
+    }
+  }
+  for( i=0; i<AGG_FIELDS; i++ )
+  {
+    v[i] = ( m_aColumn[i]>=0 && m_aColumn[i]<n ) ? col[m_aColumn[i]] : NULL;
+  }
+  return FillLine( v, r );
+}
+
+/**
+ * @param name      (in) name of a driver
+ * @return          index of the driver in m_aDriver (added if new),
+ *                  -1 if there are too many drivers
+ */
+int Aggregator::FindDriver( const char * name )
+{
+  int i;
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    if( !strcmp( m_aDriver[i]->m_sName, name ) )
+    {
+      return i;
+    }
+  }
+  if( m_iNumDriver==MAX_AGGREGATE_DRIVERS )
+  {
+    return -1;
+  }
+  AggregateDriver * d = new AggregateDriver;
+  strcpy( d->m_sName, name );
+  d->m_iNumRace = 0;
+  d->m_iNumWin = 0;
+  d->m_iNumDnf = 0;
+  memset( d->m_aPos, 0, sizeof(d->m_aPos) );
+  m_aDriver[m_iNumDriver] = d;
+  return m_iNumDriver++;
+}
+
+/**
+ * @param driver    (in) index of the driver
+ * @param track     (in) name of the track
+ * @return          best laps of the driver on the track (added if new),
+ *                  NULL if the table is full
+ */
+AggregateLap * Aggregator::FindLap( int driver, const char * track )
+{
+  unsigned long h = driver;
+  const char * p;
+
+  for( p=track; *p; p++ )
+  {
+    h = h*31+(unsigned char)*p;
+  }
+  for( int n=0; n<MAX_AGGREGATE_LAPS; n++ )
+  {
+    AggregateLap * & lap = m_aLap[( h+n )%MAX_AGGREGATE_LAPS];
+    if( lap==NULL )
+    {
+      if( m_iNumLap>=MAX_AGGREGATE_LAPS*3/4 )
+      {
+        return NULL;
+      }
+      lap = new AggregateLap;
+      lap->m_iDriver = driver;
+      strcpy( lap->m_sTrack, track );
+      m_iNumLap++;
+      return lap;
+    }
+    if( lap->m_iDriver==driver && !strcmp( lap->m_sTrack, track ) )
+    {
+      return lap;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Add a car of a race to the statistics
+ *
+ * @param r         (in) the result of the car
+ */
+void Aggregator::AddLine( const AggregateLine * r )
+{
+  int k = FindDriver( r->m_sDriver );
+  if( k<0 )
+  {
+    m_iNumSkipped++;
+    return;
+  }
+  AggregateDriver * d = m_aDriver[k];
+
+  m_iNumLine++;
+  if( r->m_iPos==1 )
+  {
+    m_iNumRace++;
+    d->m_iNumWin++;
+  }
+  d->m_iNumRace++;
+  if( !r->m_iDone )
+  {
+    d->m_iNumDnf++;
+  }
+  if( r->m_iPos<=MAX_CARS )
+  {
+    d->m_aPos[r->m_iPos-1]++;
+  }
+  d->m_oPoints.Add( r->m_iPoints );
+  d->m_oPointsQ.Add( r->m_iPoints );
+  d->m_oPos.Add( r->m_iPos );
+  d->m_oDamage.Add( r->m_iDamage );
+  d->m_oDamageQ.Add( r->m_iDamage );
+
+  if( r->m_fBestLap>0.0 )
+  {
+    AggregateLap * lap = FindLap( k, r->m_sTrack );
+    if( lap!=NULL )
+    {
+      lap->m_oBestLap.Add( r->m_fBestLap );
+      lap->m_oBestLapQ.Add( r->m_fBestLap );
+    }
+  }
+}
+
+/**
+ * Order of the best laps: by track, then by median
+ */
+static int CompareLap( const void * a, const void * b )
+{
+  const AggregateLap * x = *(const AggregateLap **)a;
+  const AggregateLap * y = *(const AggregateLap **)b;
+  int c = strcmp( x->m_sTrack, y->m_sTrack );
+  if( c!=0 )
+  {
+    return c;
+  }
+  return x->m_fMedian<y->m_fMedian ? -1 : ( x->m_fMedian>y->m_fMedian ? 1 : 0 );
+}
+
+/**
+ * Write the statistics to the screen and to a file: the drivers by
+ * average points, then the best laps on each track.
+ *
+ * @param file      (in) name of the report
+ */
+void Aggregator::WriteReport( const char * file )
+{
+  int order[MAX_AGGREGATE_DRIVERS];
+  AggregateLap * laps[MAX_AGGREGATE_LAPS];
+  char line[256];
+  int i, j, k, n;
+  FILE * f;
+
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    // insertion sort on the average points
+    for( j=i; j>0 && m_aDriver[order[j-1]]->m_oPoints.Mean()<m_aDriver[i]->m_oPoints.Mean(); j-- )
+    {
+      order[j] = order[j-1];
+    }
+    order[j] = i;
+  }
+
+  f = fopen( file, "w" );
+  sprintf( line, "Aggregate: %ld races, %ld cars from %d files (%ld lines skipped)",
+           m_iNumRace, m_iNumLine, m_iNumFile, m_iNumSkipped );
+  cout << endl << line << endl;
+  if( f ) fprintf( f, "%s\n", line );
+  sprintf( line, "%4s  %-12s %7s %6s %5s | %6s %6s %5s %5s %5s | %5s %4s | %7s %7s",
+           "Rank", "Driver", "Races", "Wins", "DNF%", "Points", "sd", "p10", "p50", "p90",
+           "Pos", "p50", "Damage", "p90" );
+  cout << line << endl;
+  if( f ) fprintf( f, "%s\n", line );
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    AggregateDriver * d = m_aDriver[order[i]];
+    // median position from the histogram
+    long half = ( d->m_iNumRace+1 )/2, sum = 0;
+    for( k=0; k<MAX_CARS-1 && ( sum += d->m_aPos[k] )<half; k++ );
+    sprintf( line, "%4d  %-12s %7ld %6ld %5.1f | %6.2f %6.2f %5.0f %5.0f %5.0f | %5.2f %4d | %7.0f %7.0f",
+             i+1, d->m_sName, d->m_iNumRace, d->m_iNumWin,
+             d->m_iNumRace ? 100.0*d->m_iNumDnf/d->m_iNumRace : 0.0,
+             d->m_oPoints.Mean(), d->m_oPoints.StdDev(), d->m_oPointsQ.Quantile( 0.1 ),
+             d->m_oPointsQ.Quantile( 0.5 ), d->m_oPointsQ.Quantile( 0.9 ),
+             d->m_oPos.Mean(), k+1, d->m_oDamage.Mean(), d->m_oDamageQ.Quantile( 0.9 ) );
+    cout << line << endl;
+    if( f ) fprintf( f, "%s\n", line );
+  }
+
+  // best laps
+  for( i=0, n=0; i<MAX_AGGREGATE_LAPS; i++ )
+  {
+    if( m_aLap[i]!=NULL )
+    {
+      m_aLap[i]->m_fMedian = m_aLap[i]->m_oBestLapQ.Quantile( 0.5 );
+      laps[n++] = m_aLap[i];
+    }
+  }
+  qsort( laps, n, sizeof(AggregateLap *), CompareLap );
+  sprintf( line, "%-12s %-12s %7s %8s %8s %8s %8s %8s",
+           "Track", "Driver", "Races", "Best", "p10", "p50", "p90", "sd" );
+  cout << endl << line << endl;
+  if( f ) fprintf( f, "\n%s\n", line );
+  for( i=0; i<n; i++ )
+  {
+    AggregateLap * lap = laps[i];
+    sprintf( line, "%-12s %-12s %7ld %8.3f %8.3f %8.3f %8.3f %8.3f",
+             lap->m_sTrack, m_aDriver[lap->m_iDriver]->m_sName, lap->m_oBestLap.Count(),
+             lap->m_oBestLap.Min(), lap->m_oBestLapQ.Quantile( 0.1 ), lap->m_fMedian,
+             lap->m_oBestLapQ.Quantile( 0.9 ), lap->m_oBestLap.StdDev() );
+    cout << line << endl;
+    if( f ) fprintf( f, "%s\n", line );
+  }
+  if( f ) fclose( f );
+}
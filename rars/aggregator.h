@@ -0,0 +1,121 @@
+/**
+ * aggregator.h - statistics of the drivers over the results of many runs
+ *
+ * With -A, RARS reads the structured results written with -O by other
+ * runs (JSON lines or CSV, see Report::WriteStructured), possibly
+ * thousands of files and millions of races, and writes the distributions
+ * of each driver: points, finishing position, DNF rate and damage, and of
+ * the best lap of each driver on each track:
+ *   rars -A results1.jsonl -A results2.csv     (or: rars -A *.jsonl)
+ *
+ * The files are read line by line and each line is added to streaming
+ * statistics (OnlineStat, TDigest), so the memory depends on the number
+ * of drivers and tracks, not on the number of races.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       aggregator.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_AGGREGATOR_H
+#define __RARSCORE_AGGREGATOR_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "globals.h"
+#include "statistics.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_AGGREGATE_DRIVERS  256
+#define MAX_AGGREGATE_LAPS     4096      // (driver, track) pairs
+#define AGGREGATE_LINE         65536     // longest line read (the lists of the end are not needed)
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Fields of a result line used by the aggregator
+ */
+struct AggregateLine
+{
+  char   m_sSession[8];
+  char   m_sTrack[32];
+  char   m_sDriver[32];
+  int    m_iPos;
+  int    m_iDone;
+  int    m_iPoints;
+  long   m_iDamage;
+  double m_fBestLap;
+};
+
+/**
+ * Statistics of a driver over all the races
+ */
+struct AggregateDriver
+{
+  char       m_sName[32];
+  long       m_iNumRace;
+  long       m_iNumWin;
+  long       m_iNumDnf;         // race not completed
+  long       m_aPos[MAX_CARS];  // number of races finished at each position
+  OnlineStat m_oPoints;
+  OnlineStat m_oPos;
+  OnlineStat m_oDamage;
+  TDigest    m_oPointsQ;
+  TDigest    m_oDamageQ;
+};
+
+/**
+ * Best laps of a driver on a track
+ */
+struct AggregateLap
+{
+  int        m_iDriver;         // index in Aggregator::m_aDriver
+  char       m_sTrack[32];
+  OnlineStat m_oBestLap;
+  TDigest    m_oBestLapQ;
+  double     m_fMedian;         // for the sort of the report
+};
+
+/**
+ * Aggregator (used by RaceManager with option -A)
+ */
+class Aggregator
+{
+  private:
+    AggregateDriver * m_aDriver[MAX_AGGREGATE_DRIVERS];
+    int            m_iNumDriver;
+    AggregateLap * m_aLap[MAX_AGGREGATE_LAPS];      // hash table on (driver, track)
+    int            m_iNumLap;
+    long           m_iNumRace;
+    long           m_iNumLine;
+    long           m_iNumSkipped;   // lines not understood
+    int            m_iNumFile;
+    char         * m_aBuffer;       // line read
+    int            m_aColumn[8];    // CSV: column of each field of AggregateLine (-1 if none)
+
+    void   ReadFile( FILE * f );
+    bool   ParseJson( const char * line, AggregateLine * r );
+    void   ParseCsvHeader( char * line );
+    bool   ParseCsv( char * line, AggregateLine * r );
+    void   AddLine( const AggregateLine * r );
+    int    FindDriver( const char * name );
+    AggregateLap * FindLap( int driver, const char * track );
+    void   WriteReport( const char * file );
+
+  public:
+    Aggregator();
+    ~Aggregator();
+    void   Run( int iNumFile, char ** aFile );
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "os.h"
 #include "misc.h"
 #include "draw.h"
+#include "profiles.h"
 
 using namespace std;
 
@@ -56,6 +57,32 @@ Args::Args()
   m_iNumLap = 0;                 // Length of the race in laps, initially undefined
   m_iNumCar = 12;                // How many cars in the race
   m_iSurface = 1;                // default surface (1 hard)
+  m_bFastFriction = false;       // friction computed with exp()
+  m_bEvolvingGrip = false;       // grip map of the track does not change
+  m_iPhysics = 0;                // default physics profile (INDYCAR)
+  m_iScoring = 0;                // default scoring profile (INDYCAR)
+  m_iNumRandomTrack = 0;         // no batch of random tracks
+  m_sResultFile[0] = 0;          // no result store
+  m_sStructuredFile[0] = 0;      // no JSON/CSV results
+  m_sTournamentFile[0] = 0;      // no tournament
+  m_iNumAggregate = 0;           // no aggregation
+  m_iPitPlanStops = 0;           // no pit plans
+  m_iIntegrator = INTEGRATOR_REFERENCE; // one step per tick
+  m_iNumSubstep = 1;
+  m_fIntegratorTolerance = INTEGRATOR_TOLERANCE;
+  m_bContinuousCollision = true; // collisions tested during the whole step
+  m_iCollisionCheck = 0;         // no check of the collision tests
+  m_sVideoFile[0] = 0;           // no video
+  m_iVideoSizeX = 640;
+  m_iVideoSizeY = 480;
+  m_iVideoFps = 25;
+  m_iVideoThread = 0;            // one thread per processor
+  m_iVideoFollow = -2;           // whole track (VIDEO_WHOLE_TRACK)
+  m_iVideoZoom = 8;
+  m_iNumSector = 0;              // sectors of the track
+  m_iMiniSector = 200;           // mini-sectors of 200 feet
+  m_sServer[0] = 0;              // no race server
+  m_iServerDecimate = 1;         // state streamed at each step
 }
 
 /**
@@ -63,25 +90,43 @@ Args::Args()
  * It sets m_iNumLap, m_iNumCar, real_speed and trackfile[], and options.
  * RARS command line options:             ( - or / signifies an option)
  * -h or -H or -?  shows this help screen         (/ may be used in place of -)
+ * -A  meaning  aggregate the results written with -O by other runs (eg. -A *.jsonl)
+ * -C  meaning  championship scoring: -CINDYCAR, -CF1, -CNASCAR or -CBTCC
+ * -cc meaning  check the collision tests on n random poses (eg. -cc1000000), and exit
  * -d  meaning  drivers (followed by space and then list of driver's names)
  * -D  meaning  ignore drivers (followed by space and list of names to not use)
  * -f  meaning  fastest that computer can compute (default is realistic)
+ * -F  meaning  best pit plans of the cars after the race, up to n stops (eg. -F4)
+ * -g  meaning  generate random tracks, followed by how many, and exit
+ * -I  meaning  physics sub-steps of each tick (eg. -I4), the difference with one step per tick is written after the race
+ * -Ia meaning  adaptive sub-steps: only where the error is above a tolerance (eg. -Ia.02)
  * -l  meaning  followed by race length in miles.
  * -mp meaning  playback movie (can be followed by filename, eg. -mpmovie)
  * -mr meaning  record movie (can be followed by filename, eg. -mrmovie)
+ * -nc meaning  collisions tested at the end of each step only (no continuous test)
  * -nd meaning  no display (there is a results report written to RAC.OUT)
  * -ni meaning  keystrokes supplied by computer, no waiting.
  * -nr meaning  no randomization of r.v.g.  (same initial seed every time)
  *         (-nr may be followed by a seed value, without a space)
  * -nR meaning  car motion is deterministic, and also r.v.g. not randomized
  * -o  meaning  order (starting order as given in driver list or as compiled)
+ * -O  meaning  append the results in JSON lines or CSV (eg. -Oresults.jsonl, -Oresults.csv)
  * -p  meaning  practice, followed by the number of practice laps.
+ * -P  meaning  physics profile: -PINDYCAR or -PF1
  * -q  meaning  qualifying mode (1-fastest lap, 2-avg speed)
  * -ql meaning  qualifying laps, how many
  * -qr meaning  qualifying sessions, how many
  * -r  meaning  races, how many
+ * -R  meaning  append the race results to a file (eg. -Rresults.res)
  * -s  meaning  surface type, s0 = loose surface, s1 = harder surface, default 0
+ * -se meaning  evolving grip: the cars rubber the track in
+ * -sf meaning  fast friction: tabulated exp() in the friction models
  * -sr meaning  starting rows. Default is given in track file.
+ * -S  meaning  stream the race on a local socket (eg. -S7000 or -S/tmp/rars.sock)
+ * -Sd meaning  state of the cars streamed every n steps (eg. -Sd5)
+ * -T  meaning  run the tournament described in a file (eg. -Ttournament.txt)
+ * -ts meaning  timing sectors, how many (default is in track file)
+ * -tm meaning  length of the timing mini-sectors in feet (0 for none)
  * -v  meaning  Just show the version and exit.
  * -z  meaning  disable "side vision" for all drivers
  *
@@ -118,6 +163,38 @@ void Args::GetArgs(int argc, char* argv[])
         case '?':  case 'h': case 'H': // H for Help
           PrintHelpFile();
           exit(0);
+        case 'A':                      // A for aggregate
+          if( *ptr )                   // -Afile
+          {
+            if( m_iNumAggregate<MAX_AGGREGATE_FILES )
+            {
+              m_aAggregate[m_iNumAggregate++] = ptr;
+            }
+          }
+          else                         // -A file1 file2 ...
+          {
+            while( cur_arg+1<argc && ( argv[cur_arg+1][0]!='-' || argv[cur_arg+1][1]==0 ) )
+            {
+              ++cur_arg;
+              if( m_iNumAggregate<MAX_AGGREGATE_FILES )
+              {
+                m_aAggregate[m_iNumAggregate++] = argv[cur_arg];
+              }
+            }
+          }
+          break;
+        case 'C':                      // C for championship scoring
+          if( (m_iScoring = FindScoringProfile(ptr))<0 )
+          {
+            exitOnError("Unknown scoring %s (INDYCAR, F1, NASCAR or BTCC)", ptr);
+          }
+          break;
+        case 'c':                      // cc for check of the collision tests
+          if( *ptr=='c' )
+          {
+            m_iCollisionCheck = isdigit(*(ptr+1)) ? atol(ptr+1) : COLLISION_CHECK_POSES;
+          }
+          break;
         case 'd':                          // d for drivers
           // re-arrange drivers[] array according to names in command line
           for( n=0; n<MAX_CARS; n++ )  
@@ -180,6 +257,41 @@ void Args::GetArgs(int argc, char* argv[])
             draw.m_iFastDisplay = -1;
           }
           break;
+        case 'F':                      // F for fuel and pit plans
+          if (isdigit(*ptr))
+          {
+            m_iPitPlanStops = atoi(ptr);
+          }
+          else
+          {
+            m_iPitPlanStops = 4;
+          }
+          break;
+        case 'g':                      // g for generate random tracks
+          if (isdigit(*ptr))
+          {
+            m_iNumRandomTrack = atoi(ptr);
+          }
+          else
+          {
+            m_iNumRandomTrack = 1;
+          }
+          break;
+        case 'I':                      // I for integrator
+          if( *ptr=='a' )              // Ia for adaptive sub-steps
+          {
+            m_iIntegrator = INTEGRATOR_ADAPTIVE;
+            if( *(ptr+1) )
+            {
+              m_fIntegratorTolerance = atof(ptr+1);
+            }
+          }
+          else if( isdigit(*ptr) )
+          {
+            m_iIntegrator = INTEGRATOR_SUBSTEP;
+            m_iNumSubstep = atoi(ptr);
+          }
+          break;
         case 'l':                      // l for race length (in miles)
           if (isdigit(*ptr))
           {
@@ -216,6 +328,10 @@ void Args::GetArgs(int argc, char* argv[])
             m_bRndmiz = false;
             m_bRandomMotion = false;
           }
+          else if(*ptr == 'c')         // nc for non-continuous collisions
+          {
+            m_bContinuousCollision = false;
+          }
           else if(*ptr == 'd')         // nd for no display
           {
             draw.m_bDisplay = false;
@@ -224,6 +340,10 @@ void Args::GetArgs(int argc, char* argv[])
         case 'o':                      // o for order
           m_bKeepOrder = true;
           break;
+        case 'O':                      // O for structured output
+          strncpy( m_sStructuredFile, ptr, sizeof(m_sStructuredFile)-1 );
+          m_sStructuredFile[sizeof(m_sStructuredFile)-1] = 0;
+          break;
         case 'p':                      // p for practice
           m_bPractice = 1;        // practice mode
           if(isdigit(*ptr))
@@ -232,6 +352,12 @@ void Args::GetArgs(int argc, char* argv[])
           }
           break;
             
+        case 'P':                      // P for physics profile
+          if( (m_iPhysics = FindPhysicsProfile(ptr))<0 )
+          {
+            exitOnError("Unknown physics profile %s (INDYCAR or F1)", ptr);
+          }
+          break;
         case 'q':
         {
           // Do ugly adjustment to new structure
@@ -293,11 +419,82 @@ void Args::GetArgs(int argc, char* argv[])
           }
           m_iNumRace = atol(ptr);      // number of races entered without space
           break;
+        case 'R':                      // R for result store
+          strncpy( m_sResultFile, ptr, sizeof(m_sResultFile)-1 );
+          m_sResultFile[sizeof(m_sResultFile)-1] = 0;
+          break;
+        case 'S':                      // S for race server
+          if( *ptr=='d' && isdigit(*(ptr+1)) )      // Sd5 for the decimation
+          {
+            m_iServerDecimate = atoi(ptr+1);
+            if( m_iServerDecimate<1 )
+            {
+              m_iServerDecimate = 1;
+            }
+          }
+          else
+          {
+            strncpy( m_sServer, ptr, sizeof(m_sServer)-1 );
+            m_sServer[sizeof(m_sServer)-1] = 0;
+          }
+          break;
+        case 't':                      // t for timing
+          if( *ptr=='s' && isdigit(*(ptr+1)) )      // ts3 for the sectors
+          {
+            m_iNumSector = atoi(ptr+1);
+          }
+          else if( *ptr=='m' && isdigit(*(ptr+1)) ) // tm200 for the mini-sectors
+          {
+            m_iMiniSector = atoi(ptr+1);
+          }
+          break;
+        case 'T':                      // T for tournament
+          strncpy( m_sTournamentFile, ptr, sizeof(m_sTournamentFile)-1 );
+          m_sTournamentFile[sizeof(m_sTournamentFile)-1] = 0;
+          break;
+        case 'V':                      // V for video of a replayed movie
+          if( *ptr=='s' && isdigit(*(ptr+1)) )      // Vs640x480 for the size
+          {
+            m_iVideoSizeX = atoi(ptr+1);
+            char *p = strchr( ptr, 'x' );
+            m_iVideoSizeY = p ? atoi(p+1) : m_iVideoSizeX*3/4;
+          }
+          else if( *ptr=='r' && isdigit(*(ptr+1)) ) // Vr25 for the frame rate
+          {
+            m_iVideoFps = atoi(ptr+1);
+          }
+          else if( *ptr=='t' && isdigit(*(ptr+1)) ) // Vt4 for the rendering threads
+          {
+            m_iVideoThread = atoi(ptr+1);
+          }
+          else if( *ptr=='z' && isdigit(*(ptr+1)) ) // Vz8 for the zoom
+          {
+            m_iVideoZoom = atoi(ptr+1);
+          }
+          else if( *ptr=='f' && ( *(ptr+1)=='\0' || isdigit(*(ptr+1)) ) ) // Vf follows the leader, Vf3 the car 3
+          {
+            m_iVideoFollow = *(ptr+1) ? atoi(ptr+1) : -1;
+          }
+          else                         // V<file> for the name of the video
+          {
+            strncpy( m_sVideoFile, ptr, sizeof(m_sVideoFile)-1 );
+            m_sVideoFile[sizeof(m_sVideoFile)-1] = 0;
+            draw.m_bDisplay = false;   // rendered off-screen
+          }
+          break;
         case 's':
           if(*ptr == 'r')              // sr for starting rows
           {
             m_iStartRows = atoi(ptr+1);
           }
+          else if(*ptr == 'f')         // sf for fast (tabulated) friction
+          {
+            m_bFastFriction = true;
+          }
+          else if(*ptr == 'e')         // se for evolving grip
+          {
+            m_bEvolvingGrip = true;
+          }
           else
           {
             m_iSurface = atoi(ptr);
@@ -377,6 +574,14 @@ void Args::GetArgs(int argc, char* argv[])
       qualifying = 1;         // only 0,1,2 allowed (not necessary anymore)
   }
   */
+  if( m_iVideoFps<=0 )
+  {
+    m_iVideoFps = 25;
+  }
+  if( m_iVideoZoom<1 )
+  {
+    m_iVideoZoom = 1;
+  }
   if( m_iStartRows<0 || m_iStartRows>8 ) // starting rows
   {
     m_iStartRows = 1;
@@ -423,25 +628,44 @@ void Args::PrintHelpFile()
   {
     cout << " RARS.HLP is missing.  The command line options are:" << endl;   
     cout << "-h or -?  or /H  -  HELP " << endl;   
+    cout << "-A   aggregate the results of other runs (eg. -A *.jsonl, see -O)" << endl;
+    cout << "-C   scoring: -CINDYCAR, -CF1, -CNASCAR or -CBTCC" << endl;
+    cout << "-cc  check the collision tests on n random poses (eg. -cc1000000), and exit" << endl;
     cout << "-d   drivers (followed by list of drivers names)" << endl;   
     cout << "-D   ignore drivers (followed by list of drivers names)" << endl;   
     cout << "-f   fast speed (not realistic speed)" << endl;   
+    cout << "-F   best pit plans of the cars after the race, up to n stops (eg. -F4)" << endl;
+    cout << "-g   generate random tracks, how many (random000.trk, ...)" << endl;
+    cout << "-I   physics sub-steps of each tick (eg. -I4), -Ia adaptive sub-steps (eg. -Ia.02)" << endl;
     cout << "-l   followed by race length in miles" << endl;
     cout << "-mp  playback movie (can be followed by filename, eg. -mpmovie)" << endl;   
     cout << "-mr  record movie (can be followed by filename, eg. -mrmovie)" << endl;   
+    cout << "-nc  collisions tested at the end of each step only" << endl;
     cout << "-nd  no graphics display" << endl;   
     cout << "-ni  non/interactive: don't wait for keystroke" << endl;   
     cout << "-nr  no randomization (always same output from r.v. generator)" << endl;   
     cout << "-nR  no randomization (car motion is deterministic)" << endl;   
     cout << "-o   order (starting order as given in driver file)" << endl;   
+    cout << "-O   append the results in JSON lines or CSV (eg. -Oresults.jsonl, -Oresults.csv)" << endl;
     cout << "-p   practice laps, how many" << endl;   
+    cout << "-P   physics profile: -PINDYCAR or -PF1" << endl;
     cout << "-q   qualification mode: 1-fastest lap, 2-average speed" << endl;  
     cout << "-ql  qualification laps, how many" << endl;
     cout << "-qr  qualification sessions, how many" << endl;
     cout << "-r   races, how many" << endl;   
-    cout << "-s   surface type, -s0 or -s1" << endl;   
+    cout << "-R   append the race results to a file (eg. -Rresults.res)" << endl;
+    cout << "-s   surface type, -s0 loose, -s1 hard, -s2 skidding, -s3 wet" << endl;   
+    cout << "-se  evolving grip (the cars rubber the track in)" << endl;
+    cout << "-sf  fast friction (tabulated)" << endl;
     cout << "-sr  start rows, how many" << endl;   
+    cout << "-S   stream the race on a local socket (eg. -S7000 or -S/tmp/rars.sock)" << endl;
+    cout << "-Sd  state of the cars streamed every n steps (eg. -Sd5)" << endl;
+    cout << "-T   run a tournament described in a file (eg. -Ttournament.txt)" << endl;
+    cout << "-ts  timing sectors, how many, -tm length of the mini-sectors (feet)" << endl;
     cout << "-v   just show version" << endl;   
+    cout << "-V   render the replayed movie in a video (eg. -mprace -Vrace.y4m, .png or raw rgb)" << endl;
+    cout << "-Vs  size of the video (eg. -Vs640x480), -Vr frames per second, -Vt threads" << endl;
+    cout << "-Vf  video follows the leader (or a car, eg. -Vf3), -Vz zoom" << endl;
     cout << "-z   disable side vision for all drivers" << endl;   
   }
   else
@@ -81,11 +81,9 @@ const double METER_BY_FEET = 0.30480061;
 #define RAND_MAX 0x7fff
 #endif
 
-// Choose ONE of the following scoring systems:
-//#define F1
-#define INDYCAR
-//#define NASCAR
-//#define BTCC
+// The scoring system (INDYCAR, F1, NASCAR, BTCC) and the physics are
+// chosen at run time with -C and -P: see profiles.h.
+// The physics constants below are the ones of the INDYCAR profile.
 
 #define VERSION 0.90
 
@@ -104,6 +102,8 @@ const double MAX_FUEL = 150; // 440;   // inital fuel supply, lb.,ca 68(200) kg
 const double SFC = .45e-6;//1e-6;      // Fuel Consumption, lb.s/ft-lb.
             //(should take f1 car with 200 l tank through 190 mile race)
 const unsigned long MAX_DAMAGE = 30000; // out of race with this damage
+const double PIT_REPAIR_TIME = 0.005;  // pit stop, seconds per unit of damage repaired
+const double PIT_REFUEL_TIME = 0.05;   // pit stop, seconds per lb of fuel
 static const double STARTING_SPEED = 20.0;  // cars start at this speed, ft/sec
 static const double REVERSE_GEAR_LIMIT = 20; // ft/sec max to allow reverse
 static const int PRIV_DATA_SIZE = 4096;// size of robot's private data area
@@ -299,64 +299,78 @@ public:
 
 
 /** 
- * Each car is an instance of this class:
+ * Each car is an instance of this class.
+ *
+ * The data is laid out in three groups: the state of the simulation used
+ * at each step (hot), the statistics updated at the line crossings and
+ * the pit stops (warm), and the data of the reports and of the display
+ * (cold). The pit stops are kept in a growable log outside the car. The
+ * views draw copies of the displayed values (TCarSnapshot), not the car.
+ * The other objects read the car with the get_ functions.
  */
 class Car
 {
-  int nose_color, tail_color;          // the car's colors
-  int collision_draw;                  // draw car in different color
-  int backward_count;                  // don't allow driving backwards
+  // Hot: state of the simulation, at each step
   double x, y, xdot, ydot, ang, adot;  // current state of car (feet, seconds)
-  double prex, prey, prang;            // previous state drawn on screen 
   double pre_xdot, pre_ydot;           // previous velocity components 
-  int lap_flag;                        // changes from 0 to 1 on each crossing of finish line 
-  double to_end;                       // same as in s.to_end, above
-  double to_rgt;                       // same as in s.to_rgt, above 
-  double vn;                           // same as in s.vn, above 
-  double cen_a, tan_a;                 // centripetal, tangential acceleration 
   double pre_x_a, pre_y_a;             // previous acceleration components
+  double cen_a, tan_a;                 // centripetal, tangential acceleration 
   double alpha, vc;                    // wheel angle of attack and wheel command velocity 
   double prev_alpha;                   // previous value of alpha
-  int which;                           // which car (index into pcar[] array) 
-  int offroad, veryoffroad;            // flags, set if off the track
   double power_req;                    // power requested by driver, divided by PwrMax 
   double power;                        // power delivered, divided by PwrMax
   double fuel;                         // lbs of fuel remaining 
   unsigned long damage;                // accumulated damage units (out of race 30000)
+  double to_end;                       // same as in s.to_end, above
+  double to_rgt;                       // same as in s.to_rgt, above 
+  double vn;                           // same as in s.vn, above 
+  double distance;                     // how many feets travelled from SF lane 
+  int seg_id;                          // current track segment index
+  int which;                           // which car (index into pcar[] array) 
+  int out;                             // out of race when 1, in pits when 2, 3 did not qualify
+  int done;                            // completed race when set
+  int offroad, veryoffroad;            // flags, set if off the track
   int dead_ahead;                      // set if there is another car dead ahead 
-  unsigned int init_flag;              // for use only by control program (driver)
-  double start_time;                   // time instant of 1st crossing starting line 
-  double last_crossing;                // time instant of most recent crossing  
-  int starting;                        // if not zero, robot knows to initialize
-  int repair_amount;                   // repair to do during next pitting
-  double fuel_amount;                  // how much fuel to add to the tank 
+  int backward_count;                  // don't allow driving backwards
+  int lap_flag;                        // changes from 0 to 1 on each crossing of finish line 
   int go_pits;                         // becomes 1 when main program takes over for pitting 
   int out_pits;                        // 1 when exiting pits 
-  double pit_done_time;                // moment when all done in pits
-  double full_load;                    // desired tank load (fuel + fuel_amount) 
-  Driver * driver;                     // pointer to the car's driver program
-  void* data_ptr;                      // pointer to driver's scratchpad RAM area 
-  situation s;                         // situation data
-  int done;                            // completed race when set
-  int out;                             // out of race when 1, in pits when 2 
-  int seg_id;                          // current track segment index
-  double distance;                     // how many feets travelled from SF lane 
-  long laps;                           // laps completed 
-  long laps_lead;                      // lead race at SF crossing   
-  long last_pit_visit;                 // at end of lap # 
-  int started;                         // cars position on the starting grid
-  int pit_stops;                       // number of pit visits 
   int on_pit_lane;                     // approaching  or exiting pits
   int coming_from_pits;                // flagged if car is just about to drive out
   int pitting;                         // set when car is standing in pits
+  long laps;                           // laps completed 
+  int started;                         // cars position on the starting grid
+  int starting;                        // if not zero, robot knows to initialize
+  unsigned int init_flag;              // for use only by control program (driver)
+  Driver * driver;                     // pointer to the car's driver program
+  void* data_ptr;                      // pointer to driver's scratchpad RAM area 
+  situation s;                         // situation data
+
+  // Warm: line crossings and pit stops
+  double start_time;                   // time instant of 1st crossing starting line 
+  double last_crossing;                // time instant of most recent crossing  
+  double lap_time;                     // most recent lap time
   double speed_avg, speed_max;         // average and maximum speed 
   double bestlap_speed, lastlap_speed; // speed of this cars best lap & last lap   
-  double lap_time;                     // most recent lap time
-  double q_bestlap;                    // best lap time in qualifying  
-  double q_avgspeed;                   // average speed of qual attempt
   double last_fuel[3];                 // fuel amount at prev. SF crossing 
   double fuel_mileage;                 // miles/gallon at last lap
   long projected_laps;                 // how far can go with this fuel?
+  long laps_lead;                      // lead race at SF crossing   
+  long last_pit_visit;                 // at end of lap # 
+  int pit_stops;                       // number of pit visits 
+  int * pit_log;                       // [stop] lap of each pit visit (pit_stops used)
+  int pit_log_size;                    // allocated in pit_log
+  int repair_amount;                   // repair to do during next pitting
+  double fuel_amount;                  // how much fuel to add to the tank 
+  double pit_done_time;                // moment when all done in pits
+  double full_load;                    // desired tank load (fuel + fuel_amount) 
+
+  // Cold: reports and display
+  int nose_color, tail_color;          // the car's colors
+  int collision_draw;                  // draw car in different color
+  double prex, prey, prang;            // previous state drawn on screen 
+  double q_bestlap;                    // best lap time in qualifying  
+  double q_avgspeed;                   // average speed of qual attempt
   double RobotTime;                    // Time in milliseconds used by the robot
 
   void Observe();                      // computes the car's local situation
@@ -364,6 +378,8 @@ class Car
   void Control();                      // the "driver" - actual code selected by cntrl[]
   void MoveCar();                      // simulates the physics of car, track, control
   void CheckCollisions();              // checks for collisions between cars
+  void Bounce(Car*, double, double, double); // shock on another car
+  static double Overlap(double, double, double, double, double); // of the rectangles of two cars
   void DrawCar();                      // erases and redraws the car
   void PutCar(double, double, double); // puts car on track
   int  Farther(Car*);                  // is the car farther than another car
@@ -371,41 +387,23 @@ class Car
   void RecordMovie( Movie* );          // the void* is pointer to the data file
   void ReplayMovie( Movie* );
   double getAirResistance(int);        // calculate relative air resistance for a given car
+  void AddPitLog(long lap);            // records a pit visit in pit_log
 
 public: 
-  int Out; 
-  int Done; 
-  int Seg_id;                          // current track segment index
-  int Started;                         // car's position on the starting grid
-  int Pit_stops;                       // number of pit visits 
-  int On_pit_lane;                     // approaching  or exiting pits
-  int Coming_from_pits;                // flagged if car is just about to drive out
-  int Pitting;                         // set when car is standing in pits
-  int Offroad, Veryoffroad;            // flags, set if off the track
-  int Pitstops[1000];                  // At which laps were your pitstops?
-  unsigned long Damage;                // accumulated damage units (out of race 30000)
-  long Laps;                           // how many laps done
-  long Laps_to_go;                     // how many laps to finish
-  long Laps_lead;                      // lead race at SF crossing   
-  long Last_pit_visit;                 // at end of lap # 
-  double X, Y;                         // Car absolute coordinates!
+  double X, Y;                         // position at the last Observe(), coherent with seg_id and to_end (views)
   double Z;                            // Value not used by the simulation (used only by G_VIEW3D) 
-  double Distance;                     // how many feets travelled from SF lane 
   double Total_pit_time;               // Total time spent standing in pits
-  double Speed_avg, Speed_max;         // average and maximum speed 
-  double Bestlap_speed, Lastlap_speed; // speed of this cars best lap & last lap   
-  double Lap_time;                     // most recent lap time
-  double Last_crossing;                // time instant of most recent crossing  
   double Behind_leader;                // seconds behind leader on last SF crossing  
   double Behind_next;                  // seconds behind the car in front on last SF crossing  
   double Ahead_next;                   // seconds ahead the car behind on last SF crossing  
-  double Q_bestlap;                    // best lap time in qualifying  
-  double Q_avgspeed;                   // average speed of qual attempt
   double prex2, prey2, prang2;
 
   Car(int);                            // constructor
   ~Car();                              // destructor
 
+  template <class Physics, FrictionModel Myu>
+  void MoveCarT();                     // MoveCar() of a physics profile and a surface (see profiles.h)
+
   inline double get_speed() const;     // returns the car's true speed
   inline double get_speed_x() const;   // returns the car's speed in x
   inline double get_speed_y() const;   // returns the car's speed in y
@@ -417,6 +415,23 @@ public:
   inline double get_lin_acc() const;   // returns the car's in-line acceleration
   inline double get_fuel_mileage() const;// returns the car's fuel mileage miles/lb
   inline long get_proj_laps() const;   // returns laps the car can go with this fuel
+  int  get_out() const { return out; }          // 1 out of the race, 2 in the pits, 3 did not qualify
+  int  get_done() const { return done; }        // completed the race
+  int  get_started() const { return started; }  // position on the starting grid
+  long get_laps() const { return laps; }        // laps completed
+  long get_laps_lead() const { return laps_lead; }
+  double get_distance() const { return distance; } // from the line
+  int  get_offroad() const { return offroad; }
+  int  get_on_pit_lane() const { return on_pit_lane; }
+  int  get_pit_stops() const { return pit_stops; }
+  const int * get_pit_laps() const { return pit_log; } // [stop] lap of the pit visits
+  long get_last_pit_visit() const { return last_pit_visit; }
+  double get_speed_avg() const { return speed_avg; }
+  double get_speed_max() const { return speed_max; }
+  double get_bestlap_speed() const { return bestlap_speed; }
+  double get_lastlap_speed() const { return lastlap_speed; }
+  double get_q_bestlap() const { return q_bestlap; }
+  double get_q_avgspeed() const { return q_avgspeed; }
    
   friend class Report;
   friend class InstantReplay;
@@ -429,7 +444,12 @@ public:
   friend class TViewBoard;
   friend class TViewTelemetry;
   friend class TTrack3D;
+  friend class TVideo;
+  friend class TSnapshotBuffer;
   friend class ChartData;
+  friend class RaceServer;
+  friend class RaceResults;
+  friend class CollisionSolver;
 
   // see deprecated.h
   friend double alpha_limit(double, double);
@@ -42,6 +42,7 @@
 #include "misc.h"            // vec_mag(), coreRand(), qsortem()
 #include "movie.h"           // movie recording and replay stuff
 #include "draw.h"
+#include "profiles.h"        // physics profiles
 
 using namespace std;
 
@@ -60,15 +61,20 @@ using namespace std;
  * The target power used by zbrent() is therefore .9975 * PM.
  * We use this instead of full power because zbrent() can err slightly
  * on either side of the target, and we should not exceed PM.
+ * (PM comes from the physics profile)
  *
  * @param vc            (in) the desired speed of the car [feet/sec]
  * @param sine          (in) sin(alpha)
  * @param cosine        (in) sin(alpha)
  * @param v             (in) the current speed of the car [feet/sec]
  * @param mass          (in) the mass of the car [unit]
+ * @param grip          (in) grip factor of the cell of the car (GripMap)
  * @return              power excess
+ * (Myu is the friction model of the segment)
  */
-static double power_excess(double vc, double sine, double cosine, double v, double mass)
+template <class Physics, FrictionModel Myu>
+static double power_excess(double vc, double sine, double cosine, double v, double mass,
+                           double grip)
 {
   double Ln, Lt;             // normal and tangential components of slip vector
   double l;                  // magnitude of slip vector, ft. per sec.
@@ -77,7 +83,7 @@ static double power_excess(double vc, double sine, double cosine, double v, doub
 
   Ln = -vc * sine;   Lt = v - vc * cosine; // vector sum to compute slip vector
   l = vec_mag(Lt, Ln);                     // compute slip speed
-  F = mass * g * friction(l);              // compute friction force from track
+  F = mass * g * Myu(l, SLIPPING) * grip;  // compute friction force from track
   if(l < .0001)                            // to prevent possible division by zero
   {
     Fn = Ft = 0.0;
@@ -88,7 +94,7 @@ static double power_excess(double vc, double sine, double cosine, double v, doub
     Ft = -F * Lt/l;
   }
   // compute power excess over target value of .9975*PM:
-  return (vc < 0.0 ? -vc : vc) * (Ft * cosine + Fn * sine) - .9975*PM;
+  return (vc < 0.0 ? -vc : vc) * (Ft * cosine + Fn * sine) - .9975*Physics::PowerMax();
 }
 
 /**
@@ -117,18 +123,21 @@ inline double SIGN(double a, double b)
  * @param x1            (in) vc coodinate 1 (v*cosine) [feet/sec]
  * @param x2            (in) vc coodinate 2 (vc) [feet/sec]
  * @param mass          (in) the mass of the car [unit]
+ * @param grip          (in) grip factor of the cell of the car (GripMap)
  * @param tol           (in)
  * @return              the max vc depending of the powerpi
+ * (Myu is the friction model of the segment)
  */
+template <class Physics, FrictionModel Myu>
 static double zbrent(double sine, double cosine, double v, double x1, double x2, double mass,
-              double tol)
+              double grip, double tol)
 {
   const int ITMAX = 20;
   const double EPS = 1.0e-8;
   int iter;
   double a=x1, b=x2, c=x2, d=0, e=0, min1, min2;
-  double fa=power_excess(a, sine, cosine, v, mass);
-  double fb=power_excess(b, sine, cosine, v, mass);
+  double fa=power_excess<Physics, Myu>(a, sine, cosine, v, mass, grip);
+  double fb=power_excess<Physics, Myu>(b, sine, cosine, v, mass, grip);
   double fc,p,q,r,s,tol1,xm;
   double Ln, Lt;      // normal and tangential components of slip vector
   double l;           // magnitude of slip vector, ft. per sec.
@@ -213,7 +222,7 @@ static double zbrent(double sine, double cosine, double v, double x1, double x2,
     }
     Ln = -b * sine;   Lt = v - b * cosine; // vector sum to compute slip vector
     l = vec_mag(Lt, Ln);               // compute slip speed
-    F = mass * g * friction(l);        // compute friction force from track
+    F = mass * g * Myu(l, SLIPPING) * grip; // compute friction force from track
     if(l < .0001)                      // to prevent possible division by zero
     {
       Fn = Ft = 0.0;
@@ -224,7 +233,7 @@ static double zbrent(double sine, double cosine, double v, double x1, double x2,
       Ft = -F * Lt/l;
     }
     // compute power delivered:
-    fb = (b < 0.0 ? -b : b) * (Ft * cosine + Fn * sine) - .9975*PM;
+    fb = (b < 0.0 ? -b : b) * (Ft * cosine + Fn * sine) - .9975*Physics::PowerMax();
   }
   return b;
 }
@@ -234,66 +243,17 @@ static double zbrent(double sine, double cosine, double v, double x1, double x2,
  * provides propulsion, cornering, and braking.  Force is assumed to depend
  * only on the slip speed, rising very rapidly with small slip speed,
  * and then asymtotically approaching an upper limit.  (This is similar to
- * tires on unpaved surfaces.)  There are two models here, the global
- * variable "surface" chooses between them.
+ * tires on unpaved surfaces.)  The model of each surface type is in
+ * profiles.h, the one of the track is chosen at the start of the race
+ * (see RaceData::InitFriction).
+ * (exported to the robots)
  *
  * @param               (in) given the slip speed [ft.per sec]
  * @return              returns the coef. of friction,
  */
 double friction(double slip)
 {
-  if( args.m_iSurface==0 )           // (very loose surface)
-  {
-    return (MYU_MAX0 * slip)/(SLIPPING + slip);
-  }
-  else if( args.m_iSurface==1 )      // (harder surface, ordinary cars)
-  {
-    return MYU_MAX1 * (1.0 - exp(-slip/SLIPPING));
-  }
-  else                       // surface == 2 - (asphalt, F1 tyres)
-  {
-    if(slip > 20)
-    {
-      return MYU_MAX2 * (1.0 - exp(-slip/SLIPPING)) - .2; // skidding
-    }
-    else
-    {
-      return MYU_MAX2 * (1.0 - exp(-slip/SLIPPING));
-    }
-  }
-}
-
-/**
- * A version of the friction model with randomness in the "slipping" variable
- *
- * @param               (in) given the slip speed [ft.per sec]
- * @return              returns the coef. of friction,
- */
-static double rfriction(double slip)
-{
-  double slipping;           // slip speed at which half maximum force is reached
-
-  slipping = 1.5 + (double)coreRand()/MAXRAND;    // range is 1.5 to 2.5 fps
-
-  if( args.m_iSurface==0 )           // (very loose surface)
-  {
-    return (MYU_MAX0 * slip)/(slipping + slip);
-  }
-  else if( args.m_iSurface==1 )      // (harder surface, ordinary cars)
-  {
-    return MYU_MAX1 * (1.0 - exp(-slip/slipping));
-  }
-  else                       // surface == 2 - (asphalt, F1 tyres)
-  {
-    if(slip > 20)
-    {
-      return MYU_MAX2 * (1.0 - exp(-slip/slipping)) - .2; // skidding
-    }
-    else
-    {
-      return MYU_MAX2 * (1.0 - exp(-slip/slipping));
-    }
-  }
+  return race_data.m_pFriction(slip, SLIPPING);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -311,6 +271,10 @@ Car::Car(int i)
   tail_color = drivers[i]->getTailColor();
   x = y = 0;   // This is for initializing of cars in qualifications
   X = Y = Z = 0;
+  started = 0;
+  pit_stops = 0;
+  pit_log = NULL;               // allocated at the first pit visit
+  pit_log_size = 0;
   prex = 0;        // These 3 are initialized so that
   prey = 0;        // draw_car() will work OK the
   prang = 0.0;     // first time it is called.
@@ -334,6 +298,7 @@ Car::~Car()
 {
   // changed to use array delete
   delete [] (char *)data_ptr;
+  delete [] pit_log;
   driver->~Driver();          // execute drivers destructor
 }
 
@@ -348,7 +313,6 @@ Car::~Car()
 void Car::Control()
 {
   con_vec output;
-  int i;
 
   if(out)
   {
@@ -370,9 +334,9 @@ void Car::Control()
     if (starting)            // new in version 0.70
     {
       fuel = output.fuel_amount;
-      if (fuel < 1 || fuel > MAX_FUEL) // make it maximum if
+      if (fuel < 1 || fuel > race_data.m_pPhysics->m_fMaxFuel) // make it maximum if
       {
-        fuel = MAX_FUEL;     // fuel is not initialized in robot driver
+        fuel = race_data.m_pPhysics->m_fMaxFuel; // fuel is not initialized in robot driver
       }
       starting = 0;
     }
@@ -403,14 +367,7 @@ void Car::Control()
     // car that is at pit entry has asked for a pit stop
     go_pits = 1;
     last_pit_visit = laps+1;
-    ++pit_stops;
-    for(i=0;i<1000;i++)      // record when were pitstops
-    {
-      if(!Pitstops[i]){
-        Pitstops[i]=laps+1;
-        break;
-      }
-    }
+    AddPitLog(laps+1);       // record when were pitstops
     repair_amount = output.repair_amount;
     fuel_amount = output.fuel_amount;
     if (repair_amount < 0)             // exclude some bogus values
@@ -425,13 +382,36 @@ void Car::Control()
     {
       fuel_amount = 0;
     }
-    if (fuel_amount > MAX_FUEL - fuel)
+    if (fuel_amount > race_data.m_pPhysics->m_fMaxFuel - fuel)
     {
-      fuel_amount = MAX_FUEL - fuel;   // no more than full tank!
+      fuel_amount = race_data.m_pPhysics->m_fMaxFuel - fuel;   // no more than full tank!
     }
   }
 }
 
+/**
+ * Record a pit visit. The log grows by doubling, it is kept for the
+ * following races (pit_stops is reset by PutCar).
+ *
+ * @param lap           (in) lap of the visit
+ */
+void Car::AddPitLog(long lap)
+{
+  if(pit_stops == pit_log_size)
+  {
+    int size = pit_log_size ? 2*pit_log_size : 8;
+    int * log = new int[size];
+    for(int i=0; i<pit_stops; i++)
+    {
+      log[i] = pit_log[i];
+    }
+    delete [] pit_log;
+    pit_log = log;
+    pit_log_size = size;
+  }
+  pit_log[pit_stops++] = (int)lap;
+}
+
 /**
  * Calculate relative air density/resistance for a given car
  * @param car           (in) number of the car
@@ -481,8 +461,22 @@ double Car::getAirResistance(int car)
  * "vc" is the speed of the bottom of the wheel relative to the car.
  * This model is like a four-wheel drive car, since the forces are not
  * computed separately for front and rear wheels.
+ *
+ * The constants come from the physics profile of the race and the
+ * friction from the surface of the segment of the car (see profiles.h):
+ * MoveCar() calls the MoveCarT instantiation of the segment, chosen for
+ * each segment at the start of the race (RaceData::InitFriction).
  */
 void Car::MoveCar()
+{
+  (this->*race_data.m_aSegMoveCar[seg_id])();
+}
+
+/**
+ * The car model for one physics profile and one friction model (see MoveCar)
+ */
+template <class Physics, FrictionModel Myu>
+void Car::MoveCarT()
 {
   double D;           // force on car from air, lb.
   double Fn, Ft;      // normal & tangential components of track force vector
@@ -494,6 +488,8 @@ void Car::MoveCar()
   double x_a, y_a;    // accelleration components in x & y directions
   double sine, cosine, temp;
   double mass;                 // current mass of car
+  int cell = race_data.m_oGripMap.Cell(seg_id, to_end, to_rgt); // grip map cell of the car
+  double grip = race_data.m_oGripMap.Grip(cell);
 
   v = vec_mag(xdot, ydot);             // the car's speed, feet/sec
   if(v > speed_max)                    // keep track of max speed
@@ -501,7 +497,7 @@ void Car::MoveCar()
     speed_max = v;
 
   }
-  mass = M + fuel/g;                   // current mass of car + fuel
+  mass = Physics::Mass() + fuel/g;     // current mass of car + fuel
 
   // Don't allow reverse gear
   if(vc < 0.0)                         // This would be a reverse gear request
@@ -548,7 +544,7 @@ void Car::MoveCar()
 
       if(!out) // the race is over :-(
       {
-        out = Out = 1;
+        out = 1;
       }
       return;
     }
@@ -620,7 +616,7 @@ void Car::MoveCar()
           {
             draw.m_aNewData[which] = 1;       // to change color on leaderboard
           }
-          on_pit_lane = On_pit_lane = 1;// disappears from s.nearby
+          on_pit_lane = 1;// disappears from s.nearby
         }
       }
     }
@@ -629,16 +625,16 @@ void Car::MoveCar()
       vc = 0.0;
       if (v < 15.0)
       {
-        out = Out = 2;                 // temporarily out
+        out = 2;                 // temporarily out
         if(!pitting)                   // pit stop is just starting!
         {
           pitting = 1;                 // set until standing in pits
           draw.m_aNewData[which] = 1;  // to change leaderboard
           // find time required for pit stop:
-          double pit_time = 0.005*repair_amount; // repair time
-          if (pit_time < 0.05*fuel_amount) // refuel takes longer?
+          double pit_time = PIT_REPAIR_TIME*repair_amount; // repair time
+          if (pit_time < PIT_REFUEL_TIME*fuel_amount) // refuel takes longer?
           {
-            pit_time = 0.05*fuel_amount; // refuel time
+            pit_time = PIT_REFUEL_TIME*fuel_amount; // refuel time
           }
           full_load = fuel + fuel_amount; // refuel up to full_load
           pit_done_time = pit_time + race_data.m_fElapsedTime; // when is stop over?
@@ -652,13 +648,13 @@ void Car::MoveCar()
             draw.m_aNewData[which] = 1;       // to change leaderboard
             go_pits = 0;
             s.out_pits = out_pits = 1;
-            out = Out = 0;
+            out = 0;
             damage -= repair_amount;   // set new value for damage
           }
 
           if(fuel < full_load-1)
           {
-              fuel += delta_time/0.05; // you will see fuel coming in
+              fuel += delta_time/PIT_REFUEL_TIME; // you will see fuel coming in
           }
         }
       }
@@ -686,7 +682,7 @@ void Car::MoveCar()
       {
         draw.m_aNewData[which] = 1; // to change name color back to black
       }
-      on_pit_lane = On_pit_lane = 0;
+      on_pit_lane = 0;
       alpha = 0.01 * currentTrack->m_iPitSide*(.6*CARWID - target) - vn/v;
       vc = v+.2;//v < PITLANE_SPEED ? v + 5.0:PITLANE_SPEED;
     }
@@ -702,76 +698,154 @@ void Car::MoveCar()
     return;
   }
 
-  sine = sin(alpha);
-  cosine = cos(alpha); // alpha is angle of attack
+  ////
+  //// CALC POWER AND MOVE CAR
+  ////
+  // The tick is cut in the sub-steps of the integrator (see integrator.h),
+  // the controls of the driver are kept for the whole tick.
+
+  IntegratorCar * ic = race_data.m_oIntegrator.State(which); // NULL: one step per tick
+  double vc_req = vc;                  // request of the driver, for each sub-step
+  double slipping = -1.0;              // random slip speed of the tick, once drawn
+  double h = delta_time;               // step
+  double ab;                           // Adams-Bashforth weight of the previous step
+  double a2 = 0.0;                     // squared acceleration over the tick (damage)
+  int n = 1;                           // sub-steps of the tick
+
+  for(int step = 0; step < n; step++)
+  {
+    if(step)                           // the state has moved since the start of the tick
+    {
+      v = vec_mag(xdot, ydot);
+      mass = Physics::Mass() + fuel/g;
+      vc = vc_req;
+    }
+
+    sine = sin(alpha);
+    cosine = cos(alpha); // alpha is angle of attack
+
+    // air drag force (add up to 200% air drag for damage!)
+    D = Physics::DragCon() * v * v * (2*damage+MAX_DAMAGE)/MAX_DAMAGE * getAirResistance(which);
+    if(offroad && !go_pits && !out_pits) // if the car is off the track,
+    {
+      D += (0.6 + .008 * v) * mass * g;  // add a lot more resistance
+      if(veryoffroad  && !go_pits && !out_pits)
+      {
+        D += 1.7 * mass * g;
+      }
+    }
 
+    int it = 0;  // This is a loop counter.
+VC:    // maybe loop to control power (we don't permit P > PM)
 
+    Ln = -vc * sine;
+    Lt = v - vc * cosine;                // vector sum to compute slip vector
+    l = vec_mag(Lt, Ln);                 // compute slip speed
+    F = mass * g * Myu(l, SLIPPING) * grip; // compute friction force from track
 
-	// air drag force (add up to 200% air drag for damage!)
-  D = DRAG_CON * v * v * (2*damage+MAX_DAMAGE)/MAX_DAMAGE * getAirResistance(which);
-  if(offroad && !go_pits && !out_pits) // if the car is off the track,
-  {
-    D += (0.6 + .008 * v) * mass * g;  // add a lot more resistance
-    if(veryoffroad  && !go_pits && !out_pits)
+    if(l < .0001)                        // to prevent possible division by zero
     {
-      D += 1.7 * mass * g;
+      Fn = Ft = 0.0;
     }
-  }
+    else
+    {
+      Fn = -F * Ln/l;                    // compute components of force vector
+      Ft = -F * Lt/l;
+    }
+    // compute power delivered:
+    P = (vc < 0.0 ? -vc : vc) * (Ft * cosine + Fn * sine);
 
-  ////
-  //// CALC POWER AND MOVE CAR
-  ////
+    if(!it)                              // If this is the first time through here, then:
+    {
+      if(!step)
+      {
+        power_req = P/Physics::PowerMax(); // Tell the driver how much power it requested.
+      }
+      if(P > Physics::PowerMax())        // If the request was too high, reduce it to 100% pwr.
+      {
+        ++it;
+        vc = zbrent<Physics, Myu>(sine, cosine, v, v * cosine, vc, mass, grip, .006);
+        goto VC;
+      }
+    }
+    power = P/Physics::PowerMax();       // store this value in the car object
 
-  int it = 0;  // This is a loop counter.
-VC:    // maybe loop to control power (we don't permit P > PM)
+    // put some randomness in the magnitude of the traction force, F:
+    // (Ft might be set to 0.0 above, in which case F will be zero.)
+    // the "slipping" variable ranges from 1.5 to 2.5 fps
+    if(Ft != 0.0 && args.m_bRandomMotion)
+    {
+      if(slipping < 0.0)
+      {
+        slipping = 1.5 + (double)coreRand()/MAXRAND;
+      }
+      temp = Myu(l, slipping) * grip * mass * g / F; // ratio of new to original force
+    }
+    else
+    {
+      temp = 1.0;
+    }
 
-  Ln = -vc * sine;
-  Lt = v - vc * cosine;                // vector sum to compute slip vector
-  l = vec_mag(Lt, Ln);                 // compute slip speed
-  F = mass * g * friction(l);          // compute friction force from track
+    // compute centripetal and tangential acceleration components:
+    cen_a = Fn * temp /  mass;
+    tan_a = (Ft * temp - D) / mass;
 
-  if(l < .0001)                        // to prevent possible division by zero
-  {
-    Fn = Ft = 0.0;
-  }
-  else
-  {
-    Fn = -F * Ln/l;                    // compute components of force vector
-    Ft = -F * Lt/l;
-  }
-  // compute power delivered:
-  P = (vc < 0.0 ? -vc : vc) * (Ft * cosine + Fn * sine);
+    if(v < .0001)                        // prevent division by zero
+    {
+      adot = sine = cosine = 0.0;
+    }
+    else
+    {
+      adot = cen_a / v;                  // angular velocity
+      sine = ydot/v;   cosine = xdot/v;  // direction of motion
+    }
+    x_a = tan_a * cosine - cen_a * sine; // x & y components of acceleration
+    y_a = cen_a * cosine + tan_a * sine;
 
-  if(!it)                              // If this is the first time through here, then:
-  {
-    power_req = P/PM;                  // Tell the driver how much power it requested.
-    if(P > PM)                         // If the request was too high, reduce it to 100% pwr.
+    ab = .5;
+    if(ic)
     {
-      ++it;
-      vc = zbrent(sine, cosine, v, v * cosine, vc, mass, .006);
-      goto VC;
+      if(!step)
+      {
+        n = race_data.m_oIntegrator.BeginTick(which, x, y, xdot, ydot, x_a, y_a);
+        h = delta_time / n;
+      }
+      if(ic->m_fPreStep > 0.0)         // the previous step may be of another length
+      {
+        ab = .5 * h / ic->m_fPreStep;
+      }
+      ic->m_fPreStep = h;
     }
-  }
-  power = P/PM;                        // store this value in the car object
 
-  // put some randomness in the magnitude of the traction force, F:
-  // (Ft might be set to 0.0 above, in which case F will be zero.)
-  if(Ft != 0.0 && args.m_bRandomMotion)
-  {
-    temp = rfriction(l) * mass * g / F; // ratio of new to original force
-  }
-  else
-  {
-    temp = 1.0;
-  }
+    // the step is known: the fuel and the damage of the sub-step
+    if(P > 0.0)
+    {
+      fuel -= P * Physics::Sfc() * h;
+      if(ic)
+      {
+        ic->m_fFuel += P * Physics::Sfc() * h;
+        if(!step)
+        {
+          ic->m_fRefFuel += P * Physics::Sfc() * delta_time;
+        }
+      }
+    }
 
-  // compute centripetal and tangential acceleration components:
-  cen_a = Fn * temp /  mass;
-  tan_a = (Ft * temp - D) / mass;
+    // damage is proportional to square of acceleration (see below):
+    a2 += (tan_a * tan_a + cen_a * cen_a) * (h / delta_time);
 
-  if(P > 0.0)
+    // Advance the state using the Adam's predictor formula:
+    x += ((1.0 + ab) * xdot - ab * pre_xdot) * h;
+    y += ((1.0 + ab) * ydot - ab * pre_ydot) * h;
+    pre_xdot = xdot;  pre_ydot = ydot;
+    xdot += ((1.0 + ab) * x_a - ab * pre_x_a) * h;
+    ydot += ((1.0 + ab) * y_a - ab * pre_y_a) * h;
+    pre_x_a = x_a;   pre_y_a = y_a;
+  }
+
+  if(ic)
   {
-    fuel -= P * SFC * delta_time;
+    race_data.m_oIntegrator.EndTick(which, x, y, xdot, ydot);
   }
 
   if(offroad && !go_pits && !out_pits && !args.m_bPractice)
@@ -779,28 +853,15 @@ VC:    // maybe loop to control power (we don't permit P > PM)
     // If off the track the car accumulates damage.
     // damage is proportional to square of acceleration:
     // damage from grass reduced 5x in version 0.70
-    damage += (unsigned long)((tan_a * tan_a + cen_a * cen_a) / 50);
+    damage += (unsigned long)(a2 / 50);
   }
 
-  if(v < .0001)                        // prevent division by zero
-  {
-    adot = sine = cosine = 0.0;
-  }
-  else
+  // the car rubbers in the track where it drives
+  if(race_data.m_oGripMap.m_bEvolve && !offroad)
   {
-    adot = cen_a / v;                  // angular velocity
-    sine = ydot/v;   cosine = xdot/v;  // direction of motion
+    race_data.m_oGripMap.Pass(cell);
   }
-  x_a = tan_a * cosine - cen_a * sine; // x & y components of acceleration
-  y_a = cen_a * cosine + tan_a * sine;
-
-  // Advance the state using the Adam's predictor formula:
-  x += (1.5 * xdot - .5 * pre_xdot) * delta_time;
-  y += (1.5 * ydot - .5 * pre_ydot) * delta_time;
-  pre_xdot = xdot;  pre_ydot = ydot;
-  xdot += (1.5 * x_a - .5 * pre_x_a) * delta_time;
-  ydot += (1.5 * y_a - .5 * pre_y_a) * delta_time;
-  pre_x_a = x_a;   pre_y_a = y_a;
+
   if(v >= .0001)
   {
     ang = atan2(ydot,xdot);            // new orientation angle
@@ -859,18 +920,16 @@ static double GetOverlap(double *txMe,
 }
 
 /**
- * Check this car against other cars to see if a collision occurred.
- * This routine models a semi-elastic collision in that some energy
- * is absorbed by the car in the form of damage, while the rest is
- * reflected back, causing the cars to bounce off each other. The
- * amount of energy absorbed is related to the collective speed at
- * which the cars collide.
+ * Check this car against other cars: is there a car dead ahead, and
+ * with -nc, did a collision occur (test of the positions at the end of
+ * the step, see Bounce). Otherwise the cars near this one are given to
+ * the continuous test (CollisionSolver::Resolve, after all the cars).
  */
 void Car::CheckCollisions()
 {
   double pvec_x, pvec_y;               // pointing vector of car (velocity vec + alpha)
   double sine, cosine, separation, dx, dy;
-  double dot, mag_prod, temp, v;
+  double dot, mag_prod, v;
   double rel_xdot, rel_ydot;           // velocity relative to other car being hit
   double theta, rel_y, rel_x;
   int i, other_seg;
@@ -915,6 +974,17 @@ void Car::CheckCollisions()
      dead_ahead = 1;                   // there is a car more-or-less dead ahead
     }
 
+    if(race_data.m_oCollision.m_bContinuous)
+    {
+      // candidate of the continuous test, given by one of the two cars
+      if(!out && separation <= race_data.m_oCollision.m_fReach &&
+         (seg_id != other_seg ? which < i || incseg(other_seg) != seg_id : which < i))
+      {
+        race_data.m_oCollision.AddPair(which, i);
+      }
+      continue;
+    }
+
     //
     // Now check for collisions and handle shocks
     //
@@ -941,100 +1011,136 @@ void Car::CheckCollisions()
     rel_x = (dx * pvec_y - dy * pvec_x) / v;
     rel_y = dot / v;        // based on properties of dot product
 
-    double c_cosine,c_sine,c_x1,c_x2,c_x3,c_x4,c_y1,c_y2,e;
-    const double ELASTICITY_CONSTANT = 200;
-    const double COLLISION_FRICTION = 0.99;
-    const double MINIMUM_DAMAGE = 10;
-    const double DAMAGE_MULTIPLIER = 100;
-
     // calculate angle of impact
-    c_cosine = dx / separation;
-    c_sine = dy / separation;
-
-    // Test whether the car rectangles overlap and how much
-    double txMe[4] = {CARLEN/2, CARLEN/2, -CARLEN/2, -CARLEN/2};
-    double tyMe[4] = {-CARWID/2, CARWID/2, CARWID/2, -CARWID/2};
-    double txHim[4] = {CARLEN/2, CARLEN/2, -CARLEN/2, -CARLEN/2};
-    double tyHim[4] = {-CARWID/2, CARWID/2, CARWID/2, -CARWID/2};
-
-    RotateCorners(txMe, tyMe, c_cosine, -c_sine, ang + alpha);
-    RotateCorners(txHim, tyHim, c_cosine, -c_sine, race_data.cars[i]->ang + race_data.cars[i]->alpha);
-    {
-     for (int k = 4; --k >= 0;)
-      txHim[k] += separation;
-    }
-
-    double Overlap1 = GetOverlap(txMe, tyMe, txHim, tyHim);
-    {
-     for (int k = 4; --k >= 0;)
-     {
-      txMe[k] = -txMe[k];
-      txHim[k] = -txHim[k];
-     }
-    }
-    double Overlap2 = GetOverlap(txHim, tyHim, txMe, tyMe);
-
-    double Overlap = 0;
-    if (Overlap1 > Overlap2)
-     Overlap = Overlap1;
-    else
-     Overlap = Overlap2;
+    double c_cosine = dx / separation;
+    double c_sine = dy / separation;
 
+    // Test whether the car rectangles overlap (CollisionSolver::Penetration
+    // on the rectangles of the step), then how much along the line of the
+    // centres
+    if (!race_data.m_oCollision.Touch(which, i))
+     continue;
+    double Overlap = Car::Overlap(separation, c_cosine, c_sine, ang + alpha,
+                                  race_data.cars[i]->ang + race_data.cars[i]->alpha);
     if (Overlap == 0)
      continue;
 
-    // calculate this car's collision vector wrt impact angle
-    c_x1 = xdot * c_cosine + ydot * c_sine;
-    c_y1 = -xdot * c_sine + ydot * c_cosine;
-
-    // calculate other car's collision vector wrt impact angle
-    c_x2 = race_data.cars[i]->xdot * c_cosine + race_data.cars[i]->ydot * c_sine;
-    c_y2 = -race_data.cars[i]->xdot * c_sine + race_data.cars[i]->ydot * c_cosine;
+    Bounce(race_data.cars[i], c_cosine, c_sine, Overlap);
+    v = vec_mag(xdot,ydot);
+  }
+}
 
-    // calculate the impact speed along impact vector
-    temp = fabs(c_x2 - c_x1);
+/**
+ * Overlap of the rectangles of two cars, along the line of their centres
+ *
+ * @param separation    (in) distance between the centres
+ * @param c_cosine      (in) direction from this car to the other one
+ * @param c_sine        (in)
+ * @param a_me          (in) orientation of this car (ang+alpha)
+ * @param a_him         (in) orientation of the other car
+ * @return              overlap in feet, 0 if the cars do not touch
+ */
+double Car::Overlap(double separation, double c_cosine, double c_sine, double a_me, double a_him)
+{
+  double txMe[4] = {CARLEN/2, CARLEN/2, -CARLEN/2, -CARLEN/2};
+  double tyMe[4] = {-CARWID/2, CARWID/2, CARWID/2, -CARWID/2};
+  double txHim[4] = {CARLEN/2, CARLEN/2, -CARLEN/2, -CARLEN/2};
+  double tyHim[4] = {-CARWID/2, CARWID/2, CARWID/2, -CARWID/2};
 
-    // calculate coefficient of elasticity
-    e = exp(-temp / ELASTICITY_CONSTANT);
+  RotateCorners(txMe, tyMe, c_cosine, -c_sine, a_me);
+  RotateCorners(txHim, tyHim, c_cosine, -c_sine, a_him);
+  {
+   for (int k = 4; --k >= 0;)
+    txHim[k] += separation;
+  }
 
-    // calculate new x components, we're ignoring mass for now
-    c_x3 = 0.5 * (c_x1 + c_x2 - e * (c_x1 - c_x2));
-    c_x4 = 0.5 * (c_x1 + c_x2 + e * (c_x1 - c_x2));
+  double Overlap1 = GetOverlap(txMe, tyMe, txHim, tyHim);
+  {
+   for (int k = 4; --k >= 0;)
+   {
+    txMe[k] = -txMe[k];
+    txHim[k] = -txHim[k];
+   }
+  }
+  double Overlap2 = GetOverlap(txHim, tyHim, txMe, tyMe);
 
-    // calculate new velocity vector for this car
-    // assume that friction slows it down a bit
-    c_y1 *= COLLISION_FRICTION;
-    xdot = c_x3 * c_cosine - c_y1 * c_sine;
-    ydot = c_y1 * c_cosine + c_x3 * c_sine;
-    v = vec_mag(xdot,ydot);
+  if (Overlap1 > Overlap2)
+   return Overlap1;
+  else
+   return Overlap2;
+}
 
-    // calculate new velocity vector for the other car
-    race_data.cars[i]->xdot = c_x4 * c_cosine - c_y2 * c_sine;
-    race_data.cars[i]->ydot = c_y2 * c_cosine + c_x4 * c_sine;
-
-    // calculate new position for this car
-    x -= c_cosine * Overlap / 2;
-    y -= c_sine * Overlap / 2;
-
-    // calculate new position for the other car
-    race_data.cars[i]->x += c_cosine * Overlap / 2;
-    race_data.cars[i]->y += c_sine * Overlap / 2;
-
-    // I assume that the cars can absorb a certain amount
-    // of punishment without taking damage, but begin
-    // taking damage in larger proportion above that level
-    // I also assume that a certain amount of energy is
-    // dissipated in heat and vibration
-    // I also assume that the rear car will take the
-    // majority of the damage
-    temp *= (1 - e);
-    temp = (temp * temp) * DAMAGE_MULTIPLIER - MINIMUM_DAMAGE;
-    if (temp > 0 && !go_pits && !out_pits && !args.m_bPractice)
-    {
-      damage +=(unsigned long) (.50 * temp);
-      race_data.cars[i]->damage +=(unsigned long) (.25 * temp);
-      collision_draw = race_data.cars[i]->collision_draw = COLLISION_FLASH | 1;
-    }
+/**
+ * Shock of this car, the faster one, on another car.
+ * This routine models a semi-elastic collision in that some energy
+ * is absorbed by the car in the form of damage, while the rest is
+ * reflected back, causing the cars to bounce off each other. The
+ * amount of energy absorbed is related to the collective speed at
+ * which the cars collide.
+ *
+ * @param other         (in) the car hit
+ * @param c_cosine      (in) direction from this car to the other one
+ * @param c_sine        (in)
+ * @param Overlap       (in) of the rectangles (see Overlap), the cars are moved apart
+ */
+void Car::Bounce(Car * other, double c_cosine, double c_sine, double Overlap)
+{
+  double c_x1,c_x2,c_x3,c_x4,c_y1,c_y2,e,temp;
+  const double ELASTICITY_CONSTANT = 200;
+  const double COLLISION_FRICTION = 0.99;
+  const double MINIMUM_DAMAGE = 10;
+  const double DAMAGE_MULTIPLIER = 100;
+
+  // calculate this car's collision vector wrt impact angle
+  c_x1 = xdot * c_cosine + ydot * c_sine;
+  c_y1 = -xdot * c_sine + ydot * c_cosine;
+
+  // calculate other car's collision vector wrt impact angle
+  c_x2 = other->xdot * c_cosine + other->ydot * c_sine;
+  c_y2 = -other->xdot * c_sine + other->ydot * c_cosine;
+
+  // calculate the impact speed along impact vector
+  temp = fabs(c_x2 - c_x1);
+
+  // calculate coefficient of elasticity
+  e = exp(-temp / ELASTICITY_CONSTANT);
+
+  // calculate new x components, we're ignoring mass for now
+  c_x3 = 0.5 * (c_x1 + c_x2 - e * (c_x1 - c_x2));
+  c_x4 = 0.5 * (c_x1 + c_x2 + e * (c_x1 - c_x2));
+
+  // calculate new velocity vector for this car
+  // assume that friction slows it down a bit
+  c_y1 *= COLLISION_FRICTION;
+  xdot = c_x3 * c_cosine - c_y1 * c_sine;
+  ydot = c_y1 * c_cosine + c_x3 * c_sine;
+
+  // calculate new velocity vector for the other car
+  other->xdot = c_x4 * c_cosine - c_y2 * c_sine;
+  other->ydot = c_y2 * c_cosine + c_x4 * c_sine;
+
+  // calculate new position for this car
+  x -= c_cosine * Overlap / 2;
+  y -= c_sine * Overlap / 2;
+
+  // calculate new position for the other car
+  other->x += c_cosine * Overlap / 2;
+  other->y += c_sine * Overlap / 2;
+
+  // I assume that the cars can absorb a certain amount
+  // of punishment without taking damage, but begin
+  // taking damage in larger proportion above that level
+  // I also assume that a certain amount of energy is
+  // dissipated in heat and vibration
+  // I also assume that the rear car will take the
+  // majority of the damage
+  temp *= (1 - e);
+  temp = (temp * temp) * DAMAGE_MULTIPLIER - MINIMUM_DAMAGE;
+  if (temp > 0 && !go_pits && !out_pits && !args.m_bPractice)
+  {
+    damage +=(unsigned long) (.50 * temp);
+    other->damage +=(unsigned long) (.25 * temp);
+    collision_draw = other->collision_draw = COLLISION_FLASH | 1;
   }
 }
 
@@ -1067,7 +1173,7 @@ void Car::PutCar(double x_pos, double y_pos, double alf_ang)
   pit_done_time = full_load = 0.0;
   lap_time = speed_avg = speed_max = lastlap_speed = bestlap_speed = 0.0;
   backward_count = 100;
-  laps = Laps = -1;                    // to become 0 crossing the finish line at start of race
+  laps = -1;                    // to become 0 crossing the finish line at start of race
   starting = 1;
   if(race_data.stage == QUALIFYING) seg_id = 0;  //in race this is set by arrange_cars
   laps_lead = last_pit_visit = pit_stops = 0;
@@ -1079,19 +1185,15 @@ void Car::PutCar(double x_pos, double y_pos, double alf_ang)
   ydot = STARTING_SPEED*sin(ang);
   pre_xdot = pre_ydot = 0.0;
   pre_x_a = pre_y_a = 0.0;
+  race_data.m_oIntegrator.Reset(which);
   tan_a = cen_a = 0.0;
   projected_laps = 0;
   fuel_mileage = 0;
-  fuel = last_fuel[0] = last_fuel[1] = last_fuel[2] = MAX_FUEL;
+  fuel = last_fuel[0] = last_fuel[1] = last_fuel[2] = race_data.m_pPhysics->m_fMaxFuel;
   //car starts with full tank, can be changed by robot in start of race
 
   // Also initialize car's public variables:
-  X = Y = Distance = Speed_max = Speed_avg = Lap_time = 0.0;
-  Done = Out = Laps_lead = Seg_id = Started = Pit_stops = 0;
-  Last_pit_visit = On_pit_lane = Coming_from_pits = Pitting = 0;
-  Bestlap_speed = Lastlap_speed = Last_crossing = 0.0;
-  Q_bestlap = Q_avgspeed = Total_pit_time = 0.0;
-  Offroad = Veryoffroad = Damage = 0;
+  X = Y = Total_pit_time = 0.0;
 
   if(draw.m_bDisplay)
   {
@@ -1110,7 +1212,6 @@ void Car::Observe()
   double dx, dy, xp, yp;
   double sine, cosine;
   double temp;
-  long i;                              // how many laps down?
   int nex_seg;                         // segment ID of the next segment
   int flag = 1;                        // controls possible repetition of calculations due to
   // completion of a lap.
@@ -1139,17 +1240,8 @@ void Car::Observe()
   s.fuel_mileage = fuel_mileage;       // miles per lb.
   s.behind_leader = Behind_leader;
 
-  // Copy private variables to public area:
-  X = x;    Y = y;    Done = done;    Out = out;
-
-  Seg_id = seg_id; Distance = distance;
-  Pit_stops = pit_stops;    Last_pit_visit = last_pit_visit;
-  Coming_from_pits = coming_from_pits; Pitting = pitting;
-  Speed_avg = speed_avg;    Speed_max = speed_max;
-  Lap_time = lap_time;
-  Q_bestlap = q_bestlap;    Q_avgspeed = q_avgspeed;
-  Last_crossing = last_crossing;    Offroad = offroad;
-  Veryoffroad = veryoffroad;    Damage = damage;
+  // Position drawn by the views with seg_id and to_end (before MoveCar):
+  X = x;    Y = y;
 
 
   // Computations below are based on the data in lftwall[] and
@@ -1225,7 +1317,6 @@ void Car::Observe()
 
           // Add 1 lap to lap count:
           ++laps;
-          ++Laps;
 
           // Accurate line crossing time
           double xv = xdot * cosine + ydot * sine;
@@ -1237,12 +1328,12 @@ void Car::Observe()
           }
           else if (!done)   // after first lap update speed and car's data
           {
-            Speed_avg = speed_avg = currentTrack->length * laps / race_data.m_fElapsedTime;
+            speed_avg = currentTrack->length * laps / race_data.m_fElapsedTime;
             lap_time = LineTime - last_crossing;
-            Lastlap_speed = lastlap_speed = currentTrack->length / lap_time;
+            lastlap_speed = currentTrack->length / lap_time;
             if (lastlap_speed > bestlap_speed)
             {
-              Bestlap_speed = bestlap_speed = lastlap_speed;
+              bestlap_speed = lastlap_speed;
               if (bestlap_speed > race_data.m_oLapRecord.speed)
               {
                 race_data.m_oLapRecord.speed = bestlap_speed;
@@ -1254,17 +1345,16 @@ void Car::Observe()
             {
               if (bestlap_speed > q_bestlap)
               {
-                Q_bestlap = q_bestlap =  bestlap_speed;
+                q_bestlap = bestlap_speed;
               }
               if(laps == args.m_iNumQualLap && speed_avg > q_avgspeed)
               {
-                Q_avgspeed = q_avgspeed = speed_avg;
+                q_avgspeed = speed_avg;
               }
             }
             if (s.position == 0)
             {
               ++laps_lead;
-              ++Laps_lead;
             }
             last_crossing = LineTime;
 
@@ -1294,10 +1384,11 @@ void Car::Observe()
           if (race_data.stage == RACING)
           {
             // calculate difference with other cars
-            race_data.m_aLapFinishingTimes[which][laps] = LineTime;
+            LapTiming & timing = race_data.m_oLapTiming;
+            timing.Lap(which, laps, LineTime);
 
             // distance to leader:
-            Behind_leader = LineTime - race_data.m_aLapFinishingTimes[race_data.m_aCarInPos[0]][laps];
+            Behind_leader = timing.Gap(which, race_data.m_aCarInPos[0], laps);
             if (race_data.cars[race_data.m_aCarInPos[0]]->laps - laps) // more than a lap down
             {
               Behind_leader = laps - race_data.cars[race_data.m_aCarInPos[0]]->laps; //negative!
@@ -1306,7 +1397,7 @@ void Car::Observe()
             // distance to car ahead:
             if (s.position)            // this car is NOT the leader!
             {
-              Behind_next = LineTime - race_data.m_aLapFinishingTimes[race_data.m_aCarInPos[race_data.m_aPosOfCar[which]-1]][laps];
+              Behind_next = timing.Gap(which, race_data.m_aCarInPos[race_data.m_aPosOfCar[which]-1], laps);
             }
             else
             {
@@ -1321,26 +1412,20 @@ void Car::Observe()
             }
             else
             {
-              Ahead_next = race_data.m_aLapFinishingTimes[race_data.m_aCarInPos[race_data.m_aPosOfCar[which]+1]][laps-1] - race_data.m_aLapFinishingTimes[which][laps-1];
-            }
+              int behind = race_data.m_aCarInPos[race_data.m_aPosOfCar[which]+1];
+              Ahead_next = timing.Gap(behind, which, laps-1);
 
-            // check if other car is more than 1 lap down:
-            if (Ahead_next < 0)
-            {
-              if (!race_data.m_aLapFinishingTimes[race_data.m_aCarInPos[race_data.m_aPosOfCar[which]+1]][laps-1])
+              // check if other car is more than 1 lap down:
+              if (Ahead_next < 0)
               {
-                for(i=1;i<args.m_iNumLap;i++)
+                if (timing.LastLap(behind) < laps-1)
                 {
-                  if(race_data.m_aLapFinishingTimes[race_data.m_aCarInPos[race_data.m_aPosOfCar[which]+1]][laps-i])
-                  {
-                    Ahead_next = double(1-i); // How many laps down?
-                    break;
-                  }
+                  Ahead_next = double(1 - timing.LapsDown(behind, which)); // How many laps down?
+                }
+                else //  car was just passed
+                {
+                  Ahead_next = 999;
                 }
-              }
-              else //  car was just passed
-              {
-                Ahead_next = 999;
               }
             }
           }
@@ -1480,6 +1565,11 @@ void Car::Observe()
   }
   s.distance = distance;
 
+  if (race_data.stage == RACING)  // splits of the sectors
+  {
+    race_data.m_oLapTiming.Sector(which, laps, distance, race_data.m_fElapsedTime);
+  }
+
   if(s.backward)
   {
     if(--backward_count == 0)
@@ -1712,4 +1802,17 @@ double Car::AlphaLimit(double was,
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// Instantiations used by the physics profiles (see profiles.cpp)
+////////////////////////////////////////////////////////////////////////////
+
+#define MOVE_CAR_INSTANCES(Physics, Exp) \
+  template void Car::MoveCarT< Physics, loose_friction<Physics,Exp> >(); \
+  template void Car::MoveCarT< Physics, hard_friction<Physics,Exp> >(); \
+  template void Car::MoveCarT< Physics, skid_friction<Physics,Exp> >(); \
+  template void Car::MoveCarT< Physics, wet_friction<Physics,Exp> >();
 
+MOVE_CAR_INSTANCES( IndycarPhysics, ExactExp )
+MOVE_CAR_INSTANCES( IndycarPhysics, TableExp )
+MOVE_CAR_INSTANCES( F1Physics, ExactExp )
+MOVE_CAR_INSTANCES( F1Physics, TableExp )
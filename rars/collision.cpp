@@ -0,0 +1,554 @@
+/**
+ * COLLISION.CPP - collisions between the cars during a time step
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       collision.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "car.h"
+#include "collision.h"
+#include "misc.h"
+#include "os.h"
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+CollisionSolver::CollisionSolver()
+{
+  m_aSweep = NULL;
+  m_aBox = NULL;
+  m_aPair = NULL;
+  m_iNumPair = 0;
+  m_aContact = NULL;
+  m_iNumContact = 0;
+  m_iMaxContact = 0;
+  m_iNumCar = 0;
+  m_bContinuous = true;
+  m_fReach = 0.0;
+}
+
+/**
+ * Destructor
+ */
+CollisionSolver::~CollisionSolver()
+{
+  delete [] m_aSweep;
+  delete [] m_aBox;
+  delete [] m_aPair;
+  delete [] m_aContact;
+}
+
+/**
+ * @param bContinuous   (in) continuous test, else Car::CheckCollisions
+ * @param iNumCar       (in) cars of the race
+ */
+void CollisionSolver::Init( bool bContinuous, int iNumCar )
+{
+  m_bContinuous = bContinuous;
+  delete [] m_aSweep;
+  delete [] m_aBox;
+  delete [] m_aPair;
+  delete [] m_aContact;
+  m_iNumCar = iNumCar;
+  m_aSweep = new CarSweep[iNumCar>0 ? iNumCar : 1];
+  m_aBox = new CarBox[iNumCar>0 ? iNumCar : 1];
+  m_aPair = new int[iNumCar>1 ? iNumCar*( iNumCar-1 ) : 2];
+  m_iNumPair = 0;
+  // each car is in a few contacts at most, the list grows if needed
+  m_iMaxContact = 4*iNumCar+4;
+  m_aContact = new CarContact[m_iMaxContact];
+  m_iNumContact = 0;
+}
+
+/**
+ * Position of the cars at the start of the step (before MoveCar)
+ */
+void CollisionSolver::BeginStep()
+{
+  if( !m_bContinuous )
+  {
+    return;
+  }
+  m_iNumPair = 0;
+  double v2 = 0.0;
+  for( int i=0; i<m_iNumCar; i++ )
+  {
+    Car * car = race_data.cars[i];
+    CarSweep * s = m_aSweep+i;
+    s->m_fX0 = car->x;
+    s->m_fY0 = car->y;
+    s->m_fA0 = car->ang + car->alpha;
+    s->m_fCos0 = cos( s->m_fA0 );
+    s->m_fSin0 = sin( s->m_fA0 );
+    if( car->xdot*car->xdot+car->ydot*car->ydot>v2 )
+    {
+      v2 = car->xdot*car->xdot+car->ydot*car->ydot;
+    }
+  }
+  // two cars move apart at most twice the speed of the fastest one
+  m_fReach = sqrt( CARLEN*CARLEN+CARWID*CARWID )+2.0*( sqrt( v2 )+COLLISION_SPEED_GAIN )*delta_time;
+}
+
+/**
+ * Rectangles of the cars after MoveCar, for the narrow phase of both
+ * tests: computed once per step.
+ */
+void CollisionSolver::ComputeBoxes()
+{
+  for( int i=0; i<m_iNumCar; i++ )
+  {
+    Car * car = race_data.cars[i];
+    CarBox * b = m_aBox+i;
+    double a = car->ang + car->alpha;
+    b->m_fX = car->x;
+    b->m_fY = car->y;
+    b->m_fCos = cos( a );
+    b->m_fSin = sin( a );
+  }
+}
+
+/**
+ * Do two cars touch (test at the end of the step, Car::CheckCollisions)
+ *
+ * @param i, j          (in) cars
+ */
+bool CollisionSolver::Touch( int i, int j )
+{
+  double nx, ny;
+
+  // the cars may have moved since ComputeBoxes (Car::Bounce), not turned
+  m_aBox[i].m_fX = race_data.cars[i]->x;
+  m_aBox[i].m_fY = race_data.cars[i]->y;
+  m_aBox[j].m_fX = race_data.cars[j]->x;
+  m_aBox[j].m_fY = race_data.cars[j]->y;
+  return Penetration( m_aBox+i, m_aBox+j, &nx, &ny )>0.0;
+}
+
+/**
+ * Separating axis test of the rectangles of two cars. The axes are the
+ * length and the width of each car; the depths on the 4 axes are
+ * computed in one loop without branches, then the smallest is kept.
+ *
+ * @param a, b          (in) rectangles
+ * @param nx, ny        (out) normal of the contact, from a to b (if they touch)
+ * @return              penetration depth along the normal (feet), 0 if they do not touch
+ */
+double CollisionSolver::Penetration( const CarBox * a, const CarBox * b, double * nx, double * ny )
+{
+  const double ax[4] = { a->m_fCos, -a->m_fSin, b->m_fCos, -b->m_fSin };
+  const double ay[4] = { a->m_fSin,  a->m_fCos, b->m_fSin,  b->m_fCos };
+  double dx = b->m_fX-a->m_fX, dy = b->m_fY-a->m_fY;
+  double depth[4];
+  int k, m;
+
+  // overlap of the projections of the two rectangles on each axis
+  for( k=0; k<4; k++ )
+  {
+    depth[k] = CARLEN/2*( fabs( a->m_fCos*ax[k]+a->m_fSin*ay[k] )+fabs( b->m_fCos*ax[k]+b->m_fSin*ay[k] ) )
+             + CARWID/2*( fabs( a->m_fCos*ay[k]-a->m_fSin*ax[k] )+fabs( b->m_fCos*ay[k]-b->m_fSin*ax[k] ) )
+             - fabs( dx*ax[k]+dy*ay[k] );
+  }
+  m = 0;
+  for( k=1; k<4; k++ )
+  {
+    if( depth[k]<depth[m] )
+    {
+      m = k;
+    }
+  }
+
+  if( depth[m]<=0.0 )
+  {
+    return 0.0;                 // separated along axis m
+  }
+  // the least move that separates them
+  if( dx*ax[m]+dy*ay[m]<0.0 )
+  {
+    *nx = -ax[m];
+    *ny = -ay[m];
+  }
+  else
+  {
+    *nx = ax[m];
+    *ny = ay[m];
+  }
+  return depth[m];
+}
+
+/**
+ * Random number in [0,1[ (coreRand gives 15 bits)
+ */
+static double RandomUnit()
+{
+  return ( coreRand()*32768.0+coreRand() )/( 32768.0*32768.0 );
+}
+
+/**
+ * Side by side test of Penetration and of the original test
+ * (Car::Overlap) on random poses of two cars: the centres are less than
+ * the diagonal of a car apart in x and y, the directions are any. Both
+ * tests must find the same contacts (within COLLISION_CHECK_EPS feet).
+ * The first poses where they disagree are written. Option -cc.
+ *
+ * @param iNumPose      (in) number of random poses
+ * @param iSeed         (in) seed of coreRand (0 for 1), the same poses every time
+ * @return              number of poses where the tests disagree
+ */
+long CollisionSolver::Check( long iNumPose, long iSeed )
+{
+  double range = vec_mag( CARLEN, CARWID );
+  long iNumTouch = 0, iNumError = 0;
+  CarBox a, b;
+  double nx, ny;
+
+  if( iSeed==0 )
+  {
+    iSeed = 1;
+  }
+  seedRandomFunctions( iSeed );
+  a.m_fX = 0.0;
+  a.m_fY = 0.0;
+  for( long n=0; n<iNumPose; n++ )
+  {
+    double ang_a = RandomUnit()*2.0*PI, ang_b = RandomUnit()*2.0*PI;
+    b.m_fX = ( 2.0*RandomUnit()-1.0 )*range;
+    b.m_fY = ( 2.0*RandomUnit()-1.0 )*range;
+    a.m_fCos = cos( ang_a );
+    a.m_fSin = sin( ang_a );
+    b.m_fCos = cos( ang_b );
+    b.m_fSin = sin( ang_b );
+
+    double separation = vec_mag( b.m_fX, b.m_fY );
+    if( separation<COLLISION_CHECK_EPS )
+    {
+      continue;                 // no line of the centres for Car::Overlap
+    }
+    double depth = Penetration( &a, &b, &nx, &ny );
+    double overlap = Car::Overlap( separation, b.m_fX/separation, b.m_fY/separation, ang_a, ang_b );
+    if( overlap>0.0 )
+    {
+      iNumTouch++;
+    }
+    if( ( overlap>COLLISION_CHECK_EPS && depth==0.0 ) || ( overlap==0.0 && depth>COLLISION_CHECK_EPS ) )
+    {
+      if( iNumError<10 )
+      {
+        printf( "Car at (%g, %g), angles %g and %g: penetration %g, Car::Overlap %g\n",
+                b.m_fX, b.m_fY, ang_a, ang_b, depth, overlap );
+      }
+      iNumError++;
+    }
+  }
+  printf( "Collision check: %ld poses (seed %ld), %ld contacts, %ld disagreements\n",
+          iNumPose, iSeed, iNumTouch, iNumError );
+  return iNumError;
+}
+
+/**
+ * Closest approach of two points moving in straight lines
+ *
+ * @param dx, dy        (in) relative position at the start
+ * @param ex, ey        (in) relative motion
+ * @param u             (out) when (0 to 1)
+ * @return              square of the distance
+ */
+double CollisionSolver::Closest( double dx, double dy, double ex, double ey, double * u )
+{
+  double e2 = ex*ex+ey*ey;
+  *u = 1.0;
+  if( e2>0.0 )
+  {
+    *u = -( dx*ex+dy*ey )/e2;
+    *u = *u<0.0 ? 0.0 : ( *u>1.0 ? 1.0 : *u );
+  }
+  dx += *u*ex;
+  dy += *u*ey;
+  return dx*dx+dy*dy;
+}
+
+/**
+ * Pair of cars given by Car::CheckCollisions (same or next segment, the
+ * other car is in the race): kept if the bounding circles meet during
+ * the step.
+ *
+ * @param i, j          (in) cars
+ */
+void CollisionSolver::AddPair( int i, int j )
+{
+  const CarSweep * a = m_aSweep+i;
+  const CarSweep * b = m_aSweep+j;
+  const Car * ca = race_data.cars[i];
+  const Car * cb = race_data.cars[j];
+  double dx = b->m_fX0-a->m_fX0, dy = b->m_fY0-a->m_fY0;
+  double u;
+  if( Closest( dx, dy, cb->x-ca->x-dx, cb->y-ca->y-dy, &u )<=CARLEN*CARLEN+CARWID*CARWID )
+  {
+    m_aPair[2*m_iNumPair] = i<j ? i : j;
+    m_aPair[2*m_iNumPair+1] = i<j ? j : i;
+    m_iNumPair++;
+  }
+}
+
+/**
+ * Same test for a pair after a contact, with the new motion of the cars
+ */
+bool CollisionSolver::Candidate( int i, int j )
+{
+  CarBox bi, bj;
+  double u;
+  double t0 = m_aSweep[i].m_fT0>m_aSweep[j].m_fT0 ? m_aSweep[i].m_fT0 : m_aSweep[j].m_fT0;
+  Pose( i, t0, &bi );
+  Pose( j, t0, &bj );
+  double dx = bj.m_fX-bi.m_fX, dy = bj.m_fY-bi.m_fY;
+  double ex = m_aSweep[j].m_fX1-m_aSweep[i].m_fX1-dx, ey = m_aSweep[j].m_fY1-m_aSweep[i].m_fY1-dy;
+  return Closest( dx, dy, ex, ey, &u )<=CARLEN*CARLEN+CARWID*CARWID;
+}
+
+/**
+ * Pose of a car in the step
+ *
+ * @param i             (in) car
+ * @param t             (in) time (fraction of the step, not before m_fT0)
+ * @param box           (out) rectangle of the car
+ * @return              orientation
+ */
+double CollisionSolver::Pose( int i, double t, CarBox * box )
+{
+  const CarSweep * s = m_aSweep+i;
+  double u = s->m_fT0<1.0 ? ( t-s->m_fT0 )/( 1.0-s->m_fT0 ) : 1.0;
+  box->m_fX = s->m_fX0+u*( s->m_fX1-s->m_fX0 );
+  box->m_fY = s->m_fY0+u*( s->m_fY1-s->m_fY0 );
+
+  // the ends of the motion are known, only the bisection turns the cars
+  if( u<=0.0 )
+  {
+    box->m_fCos = s->m_fCos0;
+    box->m_fSin = s->m_fSin0;
+    return s->m_fA0;
+  }
+  if( u>=1.0 )
+  {
+    box->m_fCos = s->m_fCos1;
+    box->m_fSin = s->m_fSin1;
+    return s->m_fA1;
+  }
+  double da = s->m_fA1-s->m_fA0;
+  while( da>PI ) da -= 2.0*PI;
+  while( da<-PI ) da += 2.0*PI;
+  double a = s->m_fA0+u*da;
+  box->m_fCos = cos( a );
+  box->m_fSin = sin( a );
+  return a;
+}
+
+/**
+ * @param nx, ny        (out) normal of the contact, from i to j
+ * @return              penetration of the rectangles of two cars at a time of the step
+ */
+double CollisionSolver::OverlapAt( int i, int j, double t, double * nx, double * ny )
+{
+  CarBox bi, bj;
+  Pose( i, t, &bi );
+  Pose( j, t, &bj );
+  return Penetration( &bi, &bj, nx, ny );
+}
+
+/**
+ * Time of impact of two cars after a time of the step
+ *
+ * @param i, j          (in) cars, candidates
+ * @param t0            (in) start (the cars move in straight lines after t0)
+ * @return              time of impact, the rectangles overlap a little, -1 if none
+ */
+double CollisionSolver::ImpactTime( int i, int j, double t0 )
+{
+  // closest approach of the centres after t0
+  CarBox bi, bj;
+  double nx, ny, u;
+  Pose( i, t0, &bi );
+  Pose( j, t0, &bj );
+  double dx = bj.m_fX-bi.m_fX, dy = bj.m_fY-bi.m_fY;
+  Closest( dx, dy, m_aSweep[j].m_fX1-m_aSweep[i].m_fX1-dx, m_aSweep[j].m_fY1-m_aSweep[i].m_fY1-dy, &u );
+
+  double lo = t0;
+  double hi = t0+u*( 1.0-t0 );
+  if( OverlapAt( i, j, hi, &nx, &ny )==0.0 )
+  {
+    return -1.0;
+  }
+  for( int k=0; k<COLLISION_BISECTIONS && hi>lo; k++ )
+  {
+    double mid = ( lo+hi )/2.0;
+    if( OverlapAt( i, j, mid, &nx, &ny )>0.0 )
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid;
+    }
+  }
+  return hi;
+}
+
+/**
+ * Insert a contact in the list, sorted by time of impact then by cars
+ */
+void CollisionSolver::AddContact( double toi, double t0, int i, int j )
+{
+  if( m_iNumContact==m_iMaxContact )
+  {
+    CarContact * a = new CarContact[2*m_iMaxContact];
+    for( int k=0; k<m_iNumContact; k++ )
+    {
+      a[k] = m_aContact[k];
+    }
+    delete [] m_aContact;
+    m_aContact = a;
+    m_iMaxContact *= 2;
+  }
+
+  // the list is sorted in decreasing order, the next contact is the last one
+  int k = m_iNumContact++;
+  while( k>0 )
+  {
+    const CarContact * c = m_aContact+k-1;
+    if( c->m_fToi>toi || ( c->m_fToi==toi && ( c->m_iCar1>i || ( c->m_iCar1==i && c->m_iCar2>j ) ) ) )
+    {
+      break;
+    }
+    m_aContact[k] = *c;
+    k--;
+  }
+  m_aContact[k].m_fToi = toi;
+  m_aContact[k].m_fT0 = t0;
+  m_aContact[k].m_iCar1 = i;
+  m_aContact[k].m_iCar2 = j;
+}
+
+/**
+ * Resolve a contact: the cars are put at their position at the time of
+ * impact, the faster one bounces on the other along the normal of the
+ * contact, then they move with their new velocity until the end of the
+ * step.
+ */
+void CollisionSolver::Collide( const CarContact * c )
+{
+  int me = c->m_iCar1, him = c->m_iCar2;
+  Car * a = race_data.cars[me];
+  Car * b = race_data.cars[him];
+
+  // The faster car of the two is considered responsible for the shock
+  if( a->xdot*a->xdot + a->ydot*a->ydot < b->xdot*b->xdot + b->ydot*b->ydot )
+  {
+    me = c->m_iCar2;
+    him = c->m_iCar1;
+    a = race_data.cars[me];
+    b = race_data.cars[him];
+  }
+
+  double t = c->m_fToi;
+  CarBox ba, bb;
+  double ama = Pose( me, t, &ba );
+  double amb = Pose( him, t, &bb );
+  double nx = 1.0, ny = 0.0;
+  double depth = Penetration( &ba, &bb, &nx, &ny );
+  a->x = ba.m_fX;  a->y = ba.m_fY;
+  b->x = bb.m_fX;  b->y = bb.m_fY;
+  a->Bounce( b, nx, ny, depth );
+
+  // rest of the step with the new velocities
+  double rest = ( 1.0-t )*delta_time;
+  CarSweep * sa = m_aSweep+me;
+  CarSweep * sb = m_aSweep+him;
+  sa->m_fX0 = a->x;  sa->m_fY0 = a->y;  sa->m_fA0 = ama;
+  sb->m_fX0 = b->x;  sb->m_fY0 = b->y;  sb->m_fA0 = amb;
+  sa->m_fCos0 = ba.m_fCos;  sa->m_fSin0 = ba.m_fSin;
+  sb->m_fCos0 = bb.m_fCos;  sb->m_fSin0 = bb.m_fSin;
+  sa->m_fT0 = sb->m_fT0 = t;
+  a->x += a->xdot*rest;
+  a->y += a->ydot*rest;
+  b->x += b->xdot*rest;
+  b->y += b->ydot*rest;
+  sa->m_fX1 = a->x;  sa->m_fY1 = a->y;
+  sb->m_fX1 = b->x;  sb->m_fY1 = b->y;
+  sa->m_iNumContact++;
+  sb->m_iNumContact++;
+}
+
+/**
+ * Find and resolve the collisions of the step (after MoveCar)
+ */
+void CollisionSolver::Resolve()
+{
+  double nx, ny;
+  int i, j, k;
+
+  if( !m_bContinuous )
+  {
+    return;
+  }
+  for( i=0; i<m_iNumCar; i++ )
+  {
+    Car * car = race_data.cars[i];
+    CarSweep * s = m_aSweep+i;
+    s->m_fX1 = m_aBox[i].m_fX;
+    s->m_fY1 = m_aBox[i].m_fY;
+    s->m_fA1 = car->ang + car->alpha;
+    s->m_fCos1 = m_aBox[i].m_fCos;
+    s->m_fSin1 = m_aBox[i].m_fSin;
+    s->m_fT0 = 0.0;
+    s->m_iNumContact = 0;
+  }
+
+  m_iNumContact = 0;
+  for( k=0; k<m_iNumPair; k++ )
+  {
+    i = m_aPair[2*k];
+    j = m_aPair[2*k+1];
+    double toi = ImpactTime( i, j, 0.0 );
+    if( toi>=0.0 )
+    {
+      AddContact( toi, 0.0, i, j );
+    }
+  }
+
+  while( m_iNumContact>0 )
+  {
+    CarContact c = m_aContact[--m_iNumContact];
+    const CarSweep * a = m_aSweep+c.m_iCar1;
+    const CarSweep * b = m_aSweep+c.m_iCar2;
+    double t0 = a->m_fT0>b->m_fT0 ? a->m_fT0 : b->m_fT0;
+    if( t0!=c.m_fT0 )
+    {
+      // one of the cars bounced since: new motion, new contact. An
+      // overlap at t0 is what is left of the last contact, the cars
+      // move apart.
+      if( a->m_iNumContact<=COLLISION_RETRIES && b->m_iNumContact<=COLLISION_RETRIES
+          && Candidate( c.m_iCar1, c.m_iCar2 ) && OverlapAt( c.m_iCar1, c.m_iCar2, t0, &nx, &ny )==0.0 )
+      {
+        double toi = ImpactTime( c.m_iCar1, c.m_iCar2, t0 );
+        if( toi>t0 )
+        {
+          AddContact( toi, t0, c.m_iCar1, c.m_iCar2 );
+        }
+      }
+      continue;
+    }
+    Collide( &c );
+  }
+}
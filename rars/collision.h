@@ -0,0 +1,133 @@
+/**
+ * collision.h - collisions between the cars during a time step
+ *
+ * A car moves up to about 20 feet in a step, as much as CARLEN, so the
+ * test of the positions at the end of the step (Car::CheckCollisions,
+ * option -nc) misses the cars that went through each other, and finds
+ * the others after they went deep into each other.
+ *
+ * The continuous test (default) sweeps the rectangle of each car from
+ * its position at the start of the step to the one at the end:
+ *  - the candidates are the pairs of cars of the original test, given by
+ *    Car::CheckCollisions (same or next segment, and not farther than
+ *    the fastest car can move in the step), whose bounding circles meet
+ *    during the step (closest distance of the centres moving in straight
+ *    lines);
+ *  - the narrow phase is the separating axis test of the rectangles
+ *    (Penetration) at the closest approach of the centres (the end of the
+ *    step if they are still closing, as in the original test). If the
+ *    rectangles overlap, the time of impact is found by bisection (1/64
+ *    step), so a pair costs one test unless there is a contact;
+ *  - the contacts are resolved in the order of their time of impact
+ *    (then of the index of the cars, so the result does not depend on
+ *    anything else). The cars are put back at their position at the
+ *    time of impact, they bounce (Car::Bounce, the response of the
+ *    original test, along the normal of the contact given by the
+ *    separating axis test) and move with their new velocity for the rest
+ *    of the step. The contacts not resolved yet of these cars are
+ *    computed again with their new motion.
+ *
+ * The rectangles of the cars (CarBox: centre and direction) are computed
+ * once per step, after MoveCar (ComputeBoxes). The test at the end of the
+ * step uses them too: the separating axis test tells whether two cars
+ * touch, and only then Car::Overlap gives the overlap along the line of
+ * the centres for the original response. Both tests find the same
+ * contacts; the option -cc checks it on random poses (Check).
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       collision.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_COLLISION_H
+#define __RARSCORE_COLLISION_H
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define COLLISION_BISECTIONS  6      // time of impact within 1/64 of a step
+#define COLLISION_RETRIES     4      // contacts computed again per car and step
+#define COLLISION_SPEED_GAIN  10.0   // fps, most a car speeds up in a step (accel. or shock)
+#define COLLISION_CHECK_POSES 1000000 // random poses of the option -cc
+#define COLLISION_CHECK_EPS   1e-6   // feet, contacts the tests may disagree on (Check)
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Rectangle of a car (CARLEN x CARWID)
+ */
+struct CarBox
+{
+  double m_fX, m_fY;            // centre
+  double m_fCos, m_fSin;        // direction of the length (ang+alpha)
+};
+
+/**
+ * Motion of a car during the step: straight line from the pose at
+ * m_fT0 (0 or time of its last contact) to the pose at the end (1)
+ */
+struct CarSweep
+{
+  double m_fX0, m_fY0, m_fA0;   // position and orientation (ang+alpha)
+  double m_fX1, m_fY1, m_fA1;
+  double m_fCos0, m_fSin0;      // of m_fA0 and m_fA1
+  double m_fCos1, m_fSin1;
+  double m_fT0;
+  int    m_iNumContact;         // contacts resolved in the step
+};
+
+/**
+ * Contact between two cars
+ */
+struct CarContact
+{
+  double m_fToi;                // time of impact (fraction of the step)
+  double m_fT0;                 // start of the motions when the contact was computed
+  int    m_iCar1, m_iCar2;      // m_iCar1 < m_iCar2
+};
+
+/**
+ * Collisions of the cars (see RaceData)
+ */
+class CollisionSolver
+{
+  private:
+    CarSweep   * m_aSweep;
+    CarBox     * m_aBox;          // rectangles of the cars after MoveCar
+    int        * m_aPair;         // candidates of the step (2 cars each)
+    int          m_iNumPair;
+    CarContact * m_aContact;
+    int          m_iNumContact;
+    int          m_iMaxContact;
+    int          m_iNumCar;
+
+    bool   Candidate( int i, int j );
+    static double Closest( double dx, double dy, double ex, double ey, double * u );
+    double Pose( int i, double t, CarBox * box );
+    double OverlapAt( int i, int j, double t, double * nx, double * ny );
+    double ImpactTime( int i, int j, double t0 );
+    void   AddContact( double toi, double t0, int i, int j );
+    void   Collide( const CarContact * c );
+
+  public:
+    bool   m_bContinuous;       // false: test of the end of the step (Car::CheckCollisions)
+    double m_fReach;            // farthest distance at the end of a step of two cars that touched during the step
+
+    CollisionSolver();
+    ~CollisionSolver();
+    void   Init( bool bContinuous, int iNumCar );
+    void   BeginStep();
+    void   ComputeBoxes();
+    bool   Touch( int i, int j );
+    void   AddPair( int i, int j );
+    void   Resolve();
+    static double Penetration( const CarBox * a, const CarBox * b, double * nx, double * ny );
+    static long   Check( long iNumPose, long iSeed );
+};
+
+#endif
@@ -661,21 +661,21 @@ void Draw::Leaders(int i, int* order)
   {
     gi.SetColor(IP_NAME_COLOR);  // car instruments shown on IP
   }
-  else if(race_data.cars[order[i]]->On_pit_lane)
+  else if(race_data.cars[order[i]]->get_on_pit_lane())
   {
     gi.SetColor(PIT_COLOR);  // car on pit lane shown red
   }
-  else if (race_data.cars[order[i]]->Out)
+  else if (race_data.cars[order[i]]->get_out())
   {
     gi.SetColor(OUT_COLOR);  //out of race shown gray
   }
   if( race_data.stage==QUALIFYING && args.m_iQualMode==QUAL_FASTEST_LAP &&
-     race_data.cars[order[i]]->Q_bestlap >= race_data.cars[order[0]]->Q_bestlap / Q_CUTOFF)
+     race_data.cars[order[i]]->get_q_bestlap() >= race_data.cars[order[0]]->get_q_bestlap() / Q_CUTOFF)
   {
     gi.SetColor(TEXT_COLOR); // qualifyier :-)
   }
   else if( race_data.stage==QUALIFYING && args.m_iQualMode==QUAL_AVERAGE_SPEED &&
-          race_data.cars[order[i]]->Q_avgspeed >= race_data.cars[order[0]]->Q_avgspeed / Q_CUTOFF)
+          race_data.cars[order[i]]->get_q_avgspeed() >= race_data.cars[order[0]]->get_q_avgspeed() / Q_CUTOFF)
   {
     gi.SetColor(TEXT_COLOR); // qualifyier :-)
   }
@@ -689,11 +689,11 @@ void Draw::Leaders(int i, int* order)
 
   // Now write data:
   // Data color:
-  if(race_data.cars[order[i]]->Out == 1 || race_data.cars[order[i]]->Out == 3)
+  if(race_data.cars[order[i]]->get_out() == 1 || race_data.cars[order[i]]->get_out() == 3)
   {
     gi.SetColor(OUT_COLOR);
   }
-  else if(race_data.cars[order[i]]->On_pit_lane)
+  else if(race_data.cars[order[i]]->get_on_pit_lane())
   {
     gi.SetColor(PIT_COLOR);  // car on pit lane shown red
   }
@@ -705,49 +705,49 @@ void Draw::Leaders(int i, int* order)
   if( m_iLeaderboardMode==0 )
   {
     // the fastest lap speed:    
-    sprintf(string, "%.2f", race_data.cars[order[i]]->Bestlap_speed * MPH_FPS);
+    sprintf(string, "%.2f", race_data.cars[order[i]]->get_bestlap_speed() * MPH_FPS);
     if( race_data.stage==QUALIFYING && args.m_iQualMode==QUAL_AVERAGE_SPEED ) // qual. for average speed
     {
-      sprintf(string, "%.2f", race_data.cars[order[i]]->Q_avgspeed * MPH_FPS);
+      sprintf(string, "%.2f", race_data.cars[order[i]]->get_q_avgspeed() * MPH_FPS);
     }
     gi.TextOutput(currentTrack->m_fLeaderBoardX+7.5*CHR_WID, Y, string);
     if( race_data.stage==QUALIFYING ) // print laps
     {
-      sprintf(string, "%ld", race_data.cars[order[i]]->Laps);
+      sprintf(string, "%ld", race_data.cars[order[i]]->get_laps());
     }
     else // print the speed of last lap:    
     {
-      sprintf(string, "%.2f", race_data.cars[order[i]]->Lastlap_speed * MPH_FPS);
+      sprintf(string, "%.2f", race_data.cars[order[i]]->get_lastlap_speed() * MPH_FPS);
     }
     gi.TextOutput(currentTrack->m_fLeaderBoardX+13.5*CHR_WID, Y, string);
   }
   else if( m_iLeaderboardMode==1 )
   {
     // the average speed:    
-    sprintf(string, "%.2f", race_data.cars[order[i]]->Speed_avg * MPH_FPS);
+    sprintf(string, "%.2f", race_data.cars[order[i]]->get_speed_avg() * MPH_FPS);
     gi.TextOutput(currentTrack->m_fLeaderBoardX+7.5*CHR_WID, Y, string);
     // the maximum speed:    
-    sprintf(string, "%.2f", race_data.cars[order[i]]->Speed_max * MPH_FPS);
+    sprintf(string, "%.2f", race_data.cars[order[i]]->get_speed_max() * MPH_FPS);
     gi.TextOutput(currentTrack->m_fLeaderBoardX+13.5*CHR_WID, Y, string);
   }
   else if( m_iLeaderboardMode==2 )
   {
      // Distance behind leader:
-    if (race_data.cars[order[i]]->Out == 1)
+    if (race_data.cars[order[i]]->get_out() == 1)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 9 * CHR_WID, Y, "out");
     }
-    else if (race_data.cars[order[i]]->Out == 2)
+    else if (race_data.cars[order[i]]->get_out() == 2)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 8.5*CHR_WID, Y, "pits");
     }
-    else if (race_data.cars[order[i]]->Out == 3)
+    else if (race_data.cars[order[i]]->get_out() == 3)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 9 * CHR_WID, Y, "DNQ");
     }
     else if (!race_data.cars[order[i]]->Behind_leader) // Leading car
     { 
-      sprintf(string, "%ld", race_data.cars[order[i]]->Laps);
+      sprintf(string, "%ld", race_data.cars[order[i]]->get_laps());
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 7.5 * CHR_WID, Y, string);
       gi.TextOutput(currentTrack->m_fLeaderBoardX + (7.5 + strlen(string)) * CHR_WID, Y, "laps");
     } 
@@ -763,20 +763,20 @@ void Draw::Leaders(int i, int* order)
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 8.5*CHR_WID, Y, string);
     }   
     // laps lead:
-    sprintf(string, "%ld", race_data.cars[order[i]]->Laps_lead);
+    sprintf(string, "%ld", race_data.cars[order[i]]->get_laps_lead());
     gi.TextOutput(currentTrack->m_fLeaderBoardX + 14.5*CHR_WID, Y, string);
   }
   else if( m_iLeaderboardMode==3 )
   {
-    if (race_data.cars[order[i]]->Out == 1)
+    if (race_data.cars[order[i]]->get_out() == 1)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 11 * CHR_WID, Y, "out");
     }
-    else if (race_data.cars[order[i]]->Out == 2)
+    else if (race_data.cars[order[i]]->get_out() == 2)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX +  9 * CHR_WID, Y, "pitting");
     }
-    else if (race_data.cars[order[i]]->Out == 3)
+    else if (race_data.cars[order[i]]->get_out() == 3)
     {
       gi.TextOutput(currentTrack->m_fLeaderBoardX + 11 * CHR_WID, Y, "DNQ");
     }
@@ -806,10 +806,10 @@ void Draw::Leaders(int i, int* order)
   else if( m_iLeaderboardMode==4 )
   {
     // the total number of pit visits:    
-    sprintf(string, "%d", race_data.cars[order[i]]->Pit_stops);
+    sprintf(string, "%d", race_data.cars[order[i]]->get_pit_stops());
     gi.TextOutput(currentTrack->m_fLeaderBoardX+7.5*CHR_WID, Y, string);
     // the last pit visit:    
-    sprintf(string, "%ld", race_data.cars[order[i]]->Last_pit_visit);
+    sprintf(string, "%ld", race_data.cars[order[i]]->get_last_pit_visit());
     gi.TextOutput(currentTrack->m_fLeaderBoardX+10.5*CHR_WID, Y, string);
     // time spent in pits:
     sprintf(string, "%ld", long(race_data.cars[order[i]]->Total_pit_time));
@@ -838,14 +838,14 @@ void Draw::Leaders(int i, int* order)
     // qualification result:
     if( args.m_iQualMode==QUAL_AVERAGE_SPEED )
     {
-      sprintf(string, "%.2f", race_data.cars[order[i]]->Q_avgspeed * MPH_FPS);
+      sprintf(string, "%.2f", race_data.cars[order[i]]->get_q_avgspeed() * MPH_FPS);
     }
     else
     {
-      sprintf(string, "%.2f", race_data.cars[order[i]]->Q_bestlap * MPH_FPS);
+      sprintf(string, "%.2f", race_data.cars[order[i]]->get_q_bestlap() * MPH_FPS);
       gi.TextOutput(currentTrack->m_fLeaderBoardX+7.5*CHR_WID, Y, string);
       // starting position:
-      sprintf(string, "%d", race_data.cars[order[i]]->Started + 1);
+      sprintf(string, "%d", race_data.cars[order[i]]->get_started() + 1);
       gi.TextOutput(currentTrack->m_fLeaderBoardX+14.5*CHR_WID, Y, string);
     }
   }
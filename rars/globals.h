@@ -21,6 +21,10 @@
 //--------------------------------------------------------------------------
 
 #include "track.h"
+#include "gripmap.h"
+#include "integrator.h"
+#include "collision.h"
+#include "lap_timing.h"
 
 //--------------------------------------------------------------------------
 //                            D E F I N E
@@ -28,12 +32,28 @@
 
 #define MAX_CARS   32 // This must be greater than the number of drivers defined in drivers.cpp
 #define MAX_TRACKS 32
+#define MAX_AGGREGATE_FILES 1024
 
 //--------------------------------------------------------------------------
 //                             T Y P E S
 //--------------------------------------------------------------------------
 
 class Car;          // Forward declaration (declared in car.h)
+struct PhysicsProfile; // Forward declaration (declared in profiles.h)
+struct ScoringProfile; // Forward declaration (declared in profiles.h)
+
+/**
+ * Friction model of a surface: coef. of friction for a slip speed
+ * (slipping is the slip speed at which half maximum force is reached)
+ * The models are in profiles.h
+ */
+typedef double (*FrictionModel)( double slip, double slipping );
+
+/**
+ * Car model of a physics profile and a surface: Car::MoveCarT<Physics,Myu>
+ */
+class Car;
+typedef void (Car::*MoveCarProc)();
 
 /**
  * Stage
@@ -79,7 +99,34 @@ class Args
     long m_iNumRace;            // There will be this many races per track
     long m_iNumLap;             // There will be this many laps.
     int  m_iNumCar;             // This many cars will race
-    int  m_iSurface;            // 0 is looser, 1 is harder
+    int  m_iSurface;            // 0 is looser, 1 is harder (when the track has no surface)
+    bool m_bFastFriction;       // Tabulated friction curve (TableExp)
+    bool m_bEvolvingGrip;       // Grip map rubbered in by the cars (GripMap)
+    int  m_iPhysics;            // Physics profile, index in g_aPhysicsProfiles
+    int  m_iScoring;            // Scoring profile, index in g_aScoringProfiles
+    int  m_iNumRandomTrack;     // If not 0, generate this many random tracks and exit
+    char m_sResultFile[128];    // If not empty, append the race results to this file
+    char m_sStructuredFile[128]; // If not empty, append the results in JSON lines or CSV to this file
+    char m_sTournamentFile[128]; // If not empty, run the tournament described in this file
+    char * m_aAggregate[MAX_AGGREGATE_FILES]; // Result files of other runs to aggregate (Aggregator)
+    int  m_iNumAggregate;
+    int  m_iPitPlanStops;       // If not 0, write the best pit plan of each car after the race, up to this many stops
+    int  m_iIntegrator;         // INTEGRATOR_REFERENCE, INTEGRATOR_SUBSTEP or INTEGRATOR_ADAPTIVE (Integrator)
+    int  m_iNumSubstep;         // Sub-steps of a tick with INTEGRATOR_SUBSTEP
+    double m_fIntegratorTolerance; // Error of a tick above which INTEGRATOR_ADAPTIVE cuts it
+    bool m_bContinuousCollision; // Collisions tested during the whole step (CollisionSolver)
+    long m_iCollisionCheck;     // If not 0, compare the collision tests on this many random poses and exit
+    char m_sVideoFile[128];     // If not empty, render the replayed movie in this file (TVideo)
+    int  m_iVideoSizeX;         // Size of the frames of the video
+    int  m_iVideoSizeY;
+    int  m_iVideoFps;           // Frames per second of the video
+    int  m_iVideoThread;        // Rendering threads, 0 for one per processor
+    int  m_iVideoFollow;        // Car followed by the video, VIDEO_LEADER or VIDEO_WHOLE_TRACK
+    int  m_iVideoZoom;          // Zoom when a car is followed
+    int  m_iNumSector;          // Timing sectors of the lap, 0 for the number of the track (LapTiming)
+    int  m_iMiniSector;         // Length of the timing mini-sectors (feet), 0 for none
+    char m_sServer[108];        // If not empty, stream the race on this socket (RaceServer)
+    int  m_iServerDecimate;     // State of the cars streamed every this many steps
     char * m_aTracks[MAX_TRACKS]; // String names of track files
     int  m_iNumTrack;           // Number of tracks in trackFileNames
     int  m_iCurrentTrack;       // Index of current
@@ -102,18 +149,26 @@ class RaceData
     ~RaceData();
     void QSortem();               // Sorts the m_aCarInPos[] array
     void OrderStartPos(int);      // Define the order of the cars
+    void InitFriction();          // Resolve the friction models of the race
 
     Car ** cars;                  // Cars
     Stage stage;                  // What stage of the competition are we in
     int m_iNumCarFinished;        // Number of cars that have finished the race
     int m_iNumCarOut;             // Number of cars out of the race
     double m_fElapsedTime;        // Number of seconds since race start
-    double** m_aLapFinishingTimes;// Finishing times for all laps and all cars
+    LapTiming m_oLapTiming;       // Finishing times and splits for all laps and all cars
     fastest_lap m_oLapRecord;     //
     int m_aStartPos[MAX_CARS];    // The order of cars at the start of the race
     int m_aCarInPos[MAX_CARS];    // m_aCarInPos[i] is the index of the car (in cars) that is in position i
     int m_aPosOfCar[MAX_CARS];    // m_aPosOfCar[i] is the position of the car in cars[i]
     long m_iInitialSeed;          // Initial random seed
+    const PhysicsProfile * m_pPhysics; // Physics of the current race
+    const ScoringProfile * m_pScoring; // Scoring of the current race
+    FrictionModel m_pFriction;    // Friction of the surface of the track
+    MoveCarProc * m_aSegMoveCar;  // Car model of each segment of the track (friction of its surface)
+    GripMap m_oGripMap;           // Grip along and across the segments of the track
+    Integrator m_oIntegrator;     // Sub-steps of the car model
+    CollisionSolver m_oCollision; // Collisions between the cars during a step
 };
 
 //--------------------------------------------------------------------------
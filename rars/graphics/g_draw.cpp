@@ -50,6 +50,7 @@ void Draw::GraphSetup( InstantReplay * ir )
     Palette.Init();
     g_ViewManager = new TViewManager( ir );
     g_ViewManager->InitAllViews();
+    g_ViewManager->StartRender();
   }
 }
 
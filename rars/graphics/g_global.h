@@ -26,6 +26,7 @@
 #include "../instant_replay.h"
 #include "g_main.h"
 #include "g_view.h"
+#include "g_snapshot.h"
 #include "g_rars_ini.h"
 #include "g_opengl.h"
 
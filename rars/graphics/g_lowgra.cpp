@@ -18,6 +18,7 @@
 //--------------------------------------------------------------------------
 
 #include <stdlib.h>
+#include <string.h>
 #include "g_global.h"
 
 //--------------------------------------------------------------------------
@@ -41,6 +42,8 @@ TLowGraphic::TLowGraphic( int x, int  y, bool bVirtual )
   m_ScreenSizeX = m_SizeX;
   m_Bitmap = NULL;
   m_bVirtual = bVirtual;
+  m_aDirty = NULL;
+  m_bDamage = false;
 
   if( m_bVirtual )
   {
@@ -51,6 +54,7 @@ TLowGraphic::TLowGraphic( int x, int  y, bool bVirtual )
     MallocBitmap();
   }
   m_BitmapFont.PCX_Read( "bitmap/font8x8.pcx" );
+  AllocDirty();
 }
 
 //__ TLowGraphic::~TLowGraphic _____________________________________________
@@ -61,6 +65,7 @@ TLowGraphic::TLowGraphic( int x, int  y, bool bVirtual )
 TLowGraphic::~TLowGraphic()
 {
   FreeBitmap();
+  delete[] m_aDirty;
 }
 
 //__ TLowGraphic::Resize ___________________________________________________
@@ -76,6 +81,7 @@ void TLowGraphic::Resize( int x, int y )
   m_MaxX = x-1; m_MaxY = y-1;
   m_ScreenSizeX = m_SizeX;
   MallocBitmap();
+  AllocDirty();
 }
 
 //__ TLowGraphic::ClearBitmap ______________________________________________
@@ -86,16 +92,14 @@ void TLowGraphic::Resize( int x, int y )
 
 void TLowGraphic::ClearBitmap( int c )
 {
-   uint32 * p = (uint32 *) m_Bitmap;
-   uint32 c2= c+(c<<8);
-   c2= c2+(c2<<16);
-   for( long i=(m_SizeX*m_SizeY/4)-1; i>=0; i-- )
-      *p++=c2;
+   memset( m_Bitmap, c, m_SizeX*m_SizeY );
 }
 
 //__ TLowGraphic::ClearBitmapTexture _______________________________________
 //
-// Fill the bitmap with a pattern given by a bitmap
+// Fill the bitmap with a pattern given by a bitmap (8x8). All the rows
+// using the same row of the texture are identical: each of them is drawn
+// once, then copied.
 // In : double x, y  : the texture coordonates for the pixel (0,0)
 //      double d     : the step to use in the texture coordonates
 //      TBitmap * t : the texture
@@ -105,25 +109,39 @@ void TLowGraphic::ClearBitmapTexture( double x, double y, double d, TBitmap * t
 {
    char * p = m_Bitmap;
    char * pt;
-   int ix, ix_start, iy, id, i, j;
+   char * row[8];
+   int ix, ix_start, iy, id, i, j, k;
 
    d *= 4096.0;
    ix_start = (int)(x*d)&0x7fff;
    iy = (int)(y*d)&0x7fff;
    id = (int)(d)&0x7fff;
+   for( k=0; k<8; k++ )
+   {
+      row[k] = NULL;
+   }
    for( i=m_SizeY; i>0; i-- ) 
    {
-      ix = ix_start;
-      pt = t->m_Bitmap+((iy&0x7000)>>9);
-      for( j=m_SizeX; j>0; j-- ) 
+      k = (iy&0x7000)>>12;
+      if( row[k]!=NULL )
+      {
+         memcpy( p, row[k], m_SizeX );
+      }
+      else
       {
-         *p++=*(pt+(ix>>12));
-         ix+=id;
-         ix&=0x7fff;
+         row[k] = p;
+         ix = ix_start;
+         pt = t->m_Bitmap+(k<<3);
+         for( j=0; j<m_SizeX; j++ ) 
+         {
+            p[j]=*(pt+(ix>>12));
+            ix+=id;
+            ix&=0x7fff;
+         }
       }
       iy+=id;
       iy&=0x7fff;
-      p += m_ScreenSizeX-m_SizeX;
+      p += m_ScreenSizeX;
    }
 }
 
@@ -304,7 +322,7 @@ void TLowGraphic::DrawLine(Int2D p1, Int2D p2, int c)
 
 void TLowGraphic::DrawHorzLine( int x1, int x2, int y, int c )
 {
-   int i, temp;
+   int temp;
    char * p;
 
    if( x1>x2 ) SWAP(x1,x2);
@@ -314,7 +332,7 @@ void TLowGraphic::DrawHorzLine( int x1, int x2, int y, int c )
    if( y>m_MaxY  ) return;
    if( y<0 ) return;
    p = m_Bitmap+y*m_ScreenSizeX+x1;
-   for( i=x2-x1; i>=0; i-- ) *p++ = (char)c;
+   memset( p, c, x2-x1+1 );
 }
 
 //__ TLowGraphic::DrawVertLine _____________________________________________
@@ -361,264 +379,149 @@ void TLowGraphic::DrawPoint( int x, int y, int c )
    *p = (char)c;
 }
 
-//__ TLowGraphic::DrawPoly _________________________________________________
+//__ PolyEdge ______________________________________________________________
 //
-// Draw a polygon
-// In : Int2D v[] : the vertexes of the polygon
-//      int v_nb  : the number of vertexes
-//      int c     : the color of the line
+// One side of a convex polygon, walked from its top vertex to its bottom
+// vertex, one row at a time (see TLowGraphic::FillPoly)
 //__________________________________________________________________________
 
-void TLowGraphic::DrawPoly(Int2D v[], int v_nb, int c)
+struct PolyEdge
 {
-   #define mod(x,y)   (((x)<(y))?(x):(x-y))
-   #define rgt_add(a,b)                                             \
-     temp= a; temp2= b;                                             \
-     if( temp2>y_prv ) {                                            \
-    x_prv = rgt[rgt_nb].x = temp;                               \
-    y_prv = rgt[rgt_nb++].y = temp2;                            \
-     } else if( temp>x_prv ) {                                      \
-    x_prv = rgt[rgt_nb-1].x = temp;                             \
-    y_prv = rgt[rgt_nb-1].y = temp2;                            \
-     }
-   #define lft_add(a,b)                                             \
-     temp= a; temp2= b;                                             \
-     if( temp2>y_prv) {                                             \
-    x_prv = lft[lft_nb].x = temp;                               \
-    y_prv = lft[lft_nb++].y = temp2;                            \
-     } else if( temp<x_prv ) {                                      \
-    x_prv = lft[lft_nb-1].x = temp;                             \
-    y_prv = lft[lft_nb-1].y = temp2;                            \
-     }
-
+   Int2D * v;
+   int v_nb;
+   int step;                   // +1 or -1: direction in the vertexes
+   int cur;                    // top vertex of the current edge
+   int left;                   // vertexes not walked yet
+   int y;                      // row of x
+   double x, dx;               // x of the edge on the row y, step per row
+};
+
+static void EdgeInit( PolyEdge * e, Int2D v[], int v_nb, int top, int step )
+{
+   e->v = v;
+   e->v_nb = v_nb;
+   e->step = step;
+   e->cur = top;
+   e->left = v_nb-1;
+   e->y = -0x7fffffff;
+   e->x = v[top].x;
+   e->dx = 0.0;
+}
 
-   #define mod(x,y)   (((x)<(y))?(x):(x-y))
+//__ EdgeRow _______________________________________________________________
+//
+// Move an edge to the row y: skip the vertexes above or on the row, then
+// step x (next row) or compute it (new edge, first row after clipping)
+//__________________________________________________________________________
 
-   int i, nxt, temp, temp2;
-   long x, y, x_prv, y_prv;
-   int ymin_pos, ymin_val, xmin_val;
-   int ymax_pos, ymax_val, xmax_val;
+static void EdgeRow( PolyEdge * e, int y )
+{
+   Int2D * v = e->v;
+   int nxt = ( e->cur+e->step+e->v_nb )%e->v_nb;
+   bool new_edge = ( y!=e->y+1 );
+
+   while( e->left>0 && v[nxt].y<=y && v[nxt].y>=v[e->cur].y ) {
+      e->cur = nxt;
+      e->left--;
+      nxt = ( nxt+e->step+e->v_nb )%e->v_nb;
+      new_edge = true;
+   }
+   if( new_edge ) {
+      if( e->left>0 && v[nxt].y>v[e->cur].y ) {
+         e->dx = (double)( v[nxt].x-v[e->cur].x )/( v[nxt].y-v[e->cur].y );
+         e->x = v[e->cur].x + e->dx*( y-v[e->cur].y );
+      } else {
+         e->dx = 0.0;
+         e->x = v[e->cur].x;
+      }
+   } else {
+      e->x += e->dx;
+   }
+   e->y = y;
+}
 
-   Int2D lft[10];
-   Int2D rgt[10];
-   int rgt_nb, rgt_cpt, xr, xr2, yr, xr_inc;
-   int lft_nb, lft_cpt, xl, xl2, yl, xl_inc;
+//__ TLowGraphic::FillPoly _________________________________________________
+//
+// Span rasterizer of DrawPoly and DrawPolyTexture. The two sides of the
+// polygon are walked from the top vertex; each row is clipped and filled
+// with memset (one color) or a texture span. Any number of vertexes.
+// In : Int2D v[]          : the vertexes of the convex polygon
+//      int v_nb           : the number of vertexes
+//      int c              : the color (t==NULL)
+//      TBitmap * t        : the texture or NULL
+//      double sine, cosine : the steps to use in the texture coordonates
+//__________________________________________________________________________
 
+void TLowGraphic::FillPoly( Int2D v[], int v_nb, int c, TBitmap * t, double sine, double cosine )
+{
+   PolyEdge e1, e2;
+   int i, y, y_end, top, xl, xr;
+   int xmin, xmax, ymin, ymax;
+   double l, r;
    char * p;
 
-   rgt_nb=1; lft_nb=1;
-   xmin_val=v[0].x;
-   xmax_val=v[0].x;
-   ymin_pos=0; ymin_val=v[0].y;
-   ymax_pos=0; ymax_val=v[0].y;
-   for( i=1;i<v_nb;i++ ) {
-      if( ymin_val>=v[i].y ) {
-         if( ymin_val>v[i].y || v[i].x<v[ymin_pos].x  ) {
-        ymin_pos=i;
-        ymin_val=v[i].y;
-         }
-      }
-      if( ymax_val<=v[i].y ) {
-         if( ymax_val<v[i].y || v[i].x>v[ymax_pos].x  ) {
-        ymax_pos=i;
-        ymax_val=v[i].y;
-         }
-      }
-      if( xmin_val>v[i].x ) xmin_val=v[i].x;
-      if( xmax_val<v[i].x ) xmax_val=v[i].x;
-   }
-   if( xmax_val<0 ) return;
-   if( xmin_val>=m_SizeX ) return;
-   if( ymax_val<0 ) return;
-   if( ymin_val>=m_SizeY ) return;
-   if( ymin_val==ymax_val ) {
-      DrawHorzLine( xmin_val, xmax_val, ymin_val, c );
+   top = 0;
+   xmin = xmax = v[0].x;
+   ymin = ymax = v[0].y;
+   for( i=1; i<v_nb; i++ ) {
+      if( v[i].y<ymin ) { ymin = v[i].y; top = i; }
+      if( v[i].y>ymax ) ymax = v[i].y;
+      if( v[i].x<xmin ) xmin = v[i].x;
+      if( v[i].x>xmax ) xmax = v[i].x;
+   }
+   if( xmax<0 || xmin>m_MaxX || ymax<0 || ymin>m_MaxY ) return;
+   if( ymin==ymax ) {
+      DrawHorzLine( xmin, xmax, ymin, t==NULL ? c : 1 );
       return;
    }
 
-   y_prv = -10000; x_prv=-10000;
-   i=ymin_pos;
-   while( i!=ymax_pos ) {
-      nxt=mod(i+1,v_nb);
-      y = v[i].y;
-      if( y>=-10000 ) {
-         x= v[i].x;
-         // x clipping
-         if( x<0 ) {
-        if( v[nxt].x>=0) {
-           rgt_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           if( v[nxt].x>m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        }
-         } else {
-        if( x>m_MaxX ) {
-           if( v[nxt].x<=m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        } else {
-           rgt_add( x, y );
+   // texture: v[0] has the coordonates 0,0 (10 bits of fraction)
+   int16 aux1, aux2, t_x, t_y;
+   int16 t_sin = (int16)( sine*1024.0 );
+   int16 t_cos = (int16)( cosine*1024.0 );
+   char * t_p = t!=NULL ? t->m_Bitmap : NULL;
 
-           if( v[nxt].x>m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        }
-        if( v[nxt].x<0) {
-           rgt_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-            }
-         }
-      }
-      i= nxt;
-   }
-   x=v[ymax_pos].x; y=v[ymax_pos].y;
-   if( x>=0 && x<=m_MaxX ) {
-      rgt_add( x, y );
-   }
-   while( rgt[1].y<0 ) {
-      if( rgt_nb>2 ) {
-         rgt[1].x= rgt[1].x-(long)(rgt[2].x-rgt[1].x)*rgt[1].y/(rgt[2].y-rgt[1].y);
-         rgt[1].y= 0;
-         if( rgt[2].y<=0 ) {
-            rgt_nb--;
-            for( i=1; i<rgt_nb; i++ ) rgt[i]=rgt[i+1];
-         }
+   EdgeInit( &e1, v, v_nb, top, 1 );
+   EdgeInit( &e2, v, v_nb, top, -1 );
+   y = max( ymin, 0 );
+   y_end = min( ymax, m_MaxY );
+   p = m_Bitmap+y*m_ScreenSizeX;
+   for( ; y<=y_end; y++, p+=m_ScreenSizeX ) {
+      EdgeRow( &e1, y );
+      EdgeRow( &e2, y );
+      l = e1.x; r = e2.x;
+      if( l>r ) { l = e2.x; r = e1.x; }
+      if( r<0.0 || l>=m_SizeX ) continue;
+      xl = l<=0.0 ? 0 : (int)l;
+      xr = r>=m_MaxX ? m_MaxX : (int)r;
+      if( t_p==NULL ) {
+         memset( p+xl, c, xr-xl+1 );
       } else {
-         rgt[1].y= 0;
-      }
-   }
-
-   y_prv = -10000; x_prv=10000;
-   i=ymin_pos;
-   while( i!=ymax_pos ) {
-      nxt=mod(i+v_nb-1,v_nb);
-      y = v[i].y;
-      if( y>=0 || v[nxt].y>=0 ) {
-         x= v[i].x;
-     // x clipping
-     if( x>m_MaxX ) {
-        if( v[nxt].x<=m_MaxX) {
-           lft_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-           if( v[nxt].x<0)
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-        }
-     } else {
-        if( x<0 ) {
-           if( v[nxt].x>=0 ) {
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           }
-        } else {
-           lft_add( x, y );
-
-           if( v[nxt].x<0 ) {
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           }
-        }
-        if( v[nxt].x>m_MaxX ) {
-           lft_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-        }
-     }
-      }
-      i= nxt;
-   }
-   x=v[ymax_pos].x; y=v[ymax_pos].y;
-   if( x>=0 && x<=m_MaxX ) {
-      lft_add( x, y );
-   }
-   while( lft[1].y<0 ) {
-      if( lft_nb>2 ) {
-         lft[1].x= lft[1].x-(long)(lft[2].x-lft[1].x)*lft[1].y/(lft[2].y-lft[1].y);
-         lft[1].y= 0;
-         if( lft[2].y<=0 ) {
-            lft_nb--;
-            for( i=1; i<lft_nb; i++ ) lft[i]=lft[i+1];
+         char * q = p+xl;
+         aux2 = (int16)( y-v[0].y );
+         aux1 = (int16)( xl-v[0].x );
+         t_x = (int16)( aux1*t_cos + 1024-aux2*t_sin );
+         t_y = (int16)( aux1*t_sin + 1024+aux2*t_cos );
+         for( i=xr-xl; i>=0; i-- ) {
+            *q++ = t_p[(t_x>>10)+((t_y&0x7c00)>>6)];
+            t_x = (int16)( t_x+t_cos );
+            t_y = (int16)( t_y+t_sin );
          }
-      } else {
-         lft[1].y= 0;
       }
    }
+}
 
+//__ TLowGraphic::DrawPoly _________________________________________________
+//
+// Draw a polygon
+// In : Int2D v[] : the vertexes of the polygon
+//      int v_nb  : the number of vertexes
+//      int c     : the color of the line
+//__________________________________________________________________________
 
-   if( rgt_nb>=2 && (lft_nb<2 || lft[lft_nb-1].y<rgt[rgt_nb-1].y) ) {
-      lft[lft_nb].x= 0;
-      lft[lft_nb++].y= rgt[rgt_nb-1].y;
-   }
-   if( lft_nb>=2 && (rgt_nb<2 || lft[lft_nb-1].y>rgt[rgt_nb-1].y) ) {
-      rgt[rgt_nb].x= m_MaxX;
-      rgt[rgt_nb++].y= lft[lft_nb-1].y;
-   }
-
-   if( rgt_nb<=2 && lft_nb<=2 ) return;   // normal DrawHorzLine
-
-   rgt_cpt=2;
-   lft_cpt=2;
-
-   if( rgt_nb==1 ) {
-      rgt[0].x=m_MaxX;
-      rgt[0].y=lft[1].y;
-      rgt[1].x=m_MaxX;
-      rgt[1].y=lft[lft_nb-1].y;
-      rgt_nb++;
-      rgt_cpt--;
-   } else if( lft_nb==1 ) {
-      lft[0].x=0;
-      lft[0].y=rgt[1].y;
-      lft[1].x=0;
-      lft[1].y=rgt[rgt_nb-1].y;
-      lft_nb++;
-      lft_cpt--;
-   } else if( lft[1].y<rgt[1].y ) {
-      rgt[0].x=m_MaxX;
-      rgt[0].y=lft[1].y;
-      rgt_cpt--;
-   } else if( lft[1].y>rgt[1].y ) {
-      lft[0].x=0;
-      lft[0].y=rgt[1].y;
-      lft_cpt--;
-   }
-
-#define calc_xl2_yl                                               \
-   xl2 = lft[lft_cpt-1].x<<6;                                     \
-   yl = lft[lft_cpt].y;                                           \
-   xl_inc = ((lft[lft_cpt].x<<6)-xl2)/(yl-lft[lft_cpt-1].y);
-#define calc_xr2_yr                                               \
-   xr2 = rgt[rgt_cpt-1].x<<6;                                     \
-   yr = rgt[rgt_cpt].y;                                           \
-   xr_inc = ((rgt[rgt_cpt].x<<6)-xr2)/(yr-rgt[rgt_cpt-1].y);
-
-   y = lft[lft_cpt-1].y;
-   p = m_Bitmap+y*m_ScreenSizeX;
-   calc_xl2_yl;
-   calc_xr2_yr;
-   while( y<m_SizeY && lft_cpt!=lft_nb ) {
-      if( yr<yl ) {
-     rgt_cpt++;
-     do {
-        xl=xl2>>6; xr=xr2>>6;
-        p += xl;
-        for(i=xr-xl;i>=0; i--) *p++=(char)c;
-        p += m_ScreenSizeX-xr-1;
-        xl2 += xl_inc;
-        xr2 += xr_inc;
-     } while( yr>++y && y<m_SizeY );
-     calc_xr2_yr;
-      } else {
-     lft_cpt++;
-     if( lft_cpt==lft_nb ) yl++;
-     do {
-        xl=xl2>>6; xr=xr2>>6;
-        p += xl;
-        for( i=xr-xl; i>=0; i-- ) *p++=(char)c;
-        p += m_ScreenSizeX-xr-1;
-        xl2 += xl_inc;
-        xr2 += xr_inc;
-     } while( yl>++y && y<m_SizeY );
-     if( yr==yl ) {
-        rgt_cpt++;
-        calc_xr2_yr;
-     }
-     if( lft_cpt!=lft_nb ) { calc_xl2_yl };
-      }
-   }
+void TLowGraphic::DrawPoly(Int2D v[], int v_nb, int c)
+{
+   FillPoly( v, v_nb, c, NULL, 0.0, 0.0 );
 }
 
 //__ TLowGraphic::DrawPolyTexture __________________________________________
@@ -633,284 +536,7 @@ void TLowGraphic::DrawPoly(Int2D v[], int v_nb, int c)
 
 void TLowGraphic::DrawPolyTexture( Int2D v[], int v_nb, double sine, double cosine, TBitmap * t )
 {
-   #define rgt_add(a,b)                                             \
-     temp= a; temp2= b;                                             \
-     if( temp2>y_prv ) {                                            \
-    x_prv = rgt[rgt_nb].x = temp;                               \
-    y_prv = rgt[rgt_nb++].y = temp2;                            \
-     } else if( temp>x_prv ) {                                      \
-    x_prv = rgt[rgt_nb-1].x = temp;                             \
-    y_prv = rgt[rgt_nb-1].y = temp2;                            \
-     }
-   #define lft_add(a,b)                                             \
-     temp= a; temp2= b;                                             \
-     if( temp2>y_prv) {                                             \
-    x_prv = lft[lft_nb].x = temp;                               \
-    y_prv = lft[lft_nb++].y = temp2;                            \
-     } else if( temp<x_prv ) {                                      \
-    x_prv = lft[lft_nb-1].x = temp;                             \
-    y_prv = lft[lft_nb-1].y = temp2;                            \
-     }
-
-   int i, nxt, temp, temp2;
-   long x, y, x_prv, y_prv;
-   int ymin_pos, ymin_val, xmin_val;
-   int ymax_pos, ymax_val, xmax_val;
-
-   Int2D lft[10];
-   Int2D rgt[10];
-   int rgt_nb, rgt_cpt, xr, xr2, yr, xr_inc;
-   int lft_nb, lft_cpt, xl, xl2, yl, xl_inc;
-
-   char * p;
-
-   rgt_nb=1; lft_nb=1;
-   xmin_val=v[0].x;
-   xmax_val=v[0].x;
-   ymin_pos=0; ymin_val=v[0].y;
-   ymax_pos=0; ymax_val=v[0].y;
-   for( i=1;i<v_nb;i++ ) {
-      if( ymin_val>=v[i].y ) {
-         if( ymin_val>v[i].y || v[i].x<v[ymin_pos].x  ) {
-        ymin_pos=i;
-        ymin_val=v[i].y;
-         }
-      }
-      if( ymax_val<=v[i].y ) {
-         if( ymax_val<v[i].y || v[i].x>v[ymax_pos].x  ) {
-        ymax_pos=i;
-        ymax_val=v[i].y;
-         }
-      }
-      if( xmin_val>v[i].x ) xmin_val=v[i].x;
-      if( xmax_val<v[i].x ) xmax_val=v[i].x;
-   }
-   if( xmax_val<0 ) return;
-   if( xmin_val>=m_SizeX ) return;
-   if( ymax_val<0 ) return;
-   if( ymin_val>=m_SizeY ) return;
-   if( ymin_val==ymax_val ) {
-      DrawHorzLine( xmin_val, xmax_val, ymin_val, 1 );
-      return;
-   }
-
-   y_prv = -10000; x_prv=-10000;
-   i=ymin_pos;
-   while( i!=ymax_pos ) {
-      nxt=mod(i+1,v_nb);
-      y = v[i].y;
-      if( y>=-10000 ) {
-         x= v[i].x;
-         // x clipping
-         if( x<0 ) {
-        if( v[nxt].x>=0) {
-           rgt_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           if( v[nxt].x>m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        }
-         } else {
-        if( x>m_MaxX ) {
-           if( v[nxt].x<=m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        } else {
-           rgt_add( x, y );
-
-           if( v[nxt].x>m_MaxX) {
-              rgt_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-               }
-        }
-        if( v[nxt].x<0) {
-           rgt_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-            }
-         }
-      }
-      i= nxt;
-   }
-   x=v[ymax_pos].x; y=v[ymax_pos].y;
-   if( x>=0 && x<=m_MaxX ) {
-      rgt_add( x, y );
-   }
-   while( rgt[1].y<0 ) {
-      if( rgt_nb>2 ) {
-         rgt[1].x= rgt[1].x-(long)(rgt[2].x-rgt[1].x)*rgt[1].y/(rgt[2].y-rgt[1].y);
-         rgt[1].y= 0;
-         if( rgt[2].y<=0 ) {
-            rgt_nb--;
-            for( i=1; i<rgt_nb; i++ ) rgt[i]=rgt[i+1];
-         }
-      } else {
-         rgt[1].y= 0;
-      }
-   }
-
-   y_prv = -10000; x_prv=10000;
-   i=ymin_pos;
-   while( i!=ymax_pos ) {
-      nxt=mod(i+v_nb-1,v_nb);
-      y = v[i].y;
-      if( y>=0 || v[nxt].y>=0 ) {
-         x= v[i].x;
-     // x clipping
-     if( x>m_MaxX ) {
-        if( v[nxt].x<=m_MaxX) {
-           lft_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-           if( v[nxt].x<0)
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-        }
-     } else {
-        if( x<0 ) {
-           if( v[nxt].x>=0 ) {
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           }
-        } else {
-           lft_add( x, y );
-
-           if( v[nxt].x<0 ) {
-          lft_add( 0, y-x*(v[nxt].y-y)/(v[nxt].x-x) );
-           }
-        }
-        if( v[nxt].x>m_MaxX ) {
-           lft_add( m_MaxX, y-(x-m_MaxX)*(v[nxt].y-y)/(v[nxt].x-x) );
-        }
-     }
-      }
-      i= nxt;
-   }
-   x=v[ymax_pos].x; y=v[ymax_pos].y;
-   if( x>=0 && x<=m_MaxX ) {
-      lft_add( x, y );
-   }
-   while( lft[1].y<0 ) {
-      if( lft_nb>2 ) {
-         lft[1].x= lft[1].x-(long)(lft[2].x-lft[1].x)*lft[1].y/(lft[2].y-lft[1].y);
-         lft[1].y= 0;
-         if( lft[2].y<=0 ) {
-            lft_nb--;
-            for( i=1; i<lft_nb; i++ ) lft[i]=lft[i+1];
-         }
-      } else {
-         lft[1].y= 0;
-      }
-   }
-
-
-   if( rgt_nb>=2 && (lft_nb<2 || lft[lft_nb-1].y<rgt[rgt_nb-1].y) ) {
-      lft[lft_nb].x= 0;
-      lft[lft_nb++].y= rgt[rgt_nb-1].y;
-   }
-   if( lft_nb>=2 && (rgt_nb<2 || lft[lft_nb-1].y>rgt[rgt_nb-1].y) ) {
-      rgt[rgt_nb].x= m_MaxX;
-      rgt[rgt_nb++].y= lft[lft_nb-1].y;
-   }
-
-   if( rgt_nb<=2 && lft_nb<=2 ) return;   // normal DrawHorzLine
-
-   rgt_cpt=2;
-   lft_cpt=2;
-
-   if( rgt_nb==1 ) {
-      rgt[0].x=m_MaxX;
-      rgt[0].y=lft[1].y;
-      rgt[1].x=m_MaxX;
-      rgt[1].y=lft[lft_nb-1].y;
-      rgt_nb++;
-      rgt_cpt--;
-   } else if( lft_nb==1 ) {
-      lft[0].x=0;
-      lft[0].y=rgt[1].y;
-      lft[1].x=0;
-      lft[1].y=rgt[rgt_nb-1].y;
-      lft_nb++;
-      lft_cpt--;
-   } else if( lft[1].y<rgt[1].y ) {
-      rgt[0].x=m_MaxX;
-      rgt[0].y=lft[1].y;
-      rgt_cpt--;
-   } else if( lft[1].y>rgt[1].y ) {
-      lft[0].x=0;
-      lft[0].y=rgt[1].y;
-      lft_cpt--;
-   }
-
-#define calc_xl2_yl                                               \
-   xl2 = lft[lft_cpt-1].x<<6;                                     \
-   yl = lft[lft_cpt].y;                                           \
-   xl_inc = ((lft[lft_cpt].x<<6)-xl2)/(yl-lft[lft_cpt-1].y);
-#define calc_xr2_yr                                               \
-   xr2 = rgt[rgt_cpt-1].x<<6;                                     \
-   yr = rgt[rgt_cpt].y;                                           \
-   xr_inc = ((rgt[rgt_cpt].x<<6)-xr2)/(yr-rgt[rgt_cpt-1].y);
-
-   int16 aux1, aux2, t_x0, t_y0, t_x, t_y;
-   int16 t_sin, t_cos;
-   char * t_p;
-
-   y = lft[lft_cpt-1].y;
-   p = m_Bitmap+y*m_ScreenSizeX;
-
-   t_sin = (int16)( sine*1024.0);
-   t_cos = (int16)( cosine*1024.0);
-   aux2  = (int16)( lft[lft_cpt-1].y-v[0].y );
-   t_x0  = (int16)( 1024-aux2*t_sin );
-   t_y0  = (int16)( 1024+aux2*t_cos );
-   t_p   = t->m_Bitmap;
-
-   calc_xl2_yl;
-   calc_xr2_yr;
-   while( y<m_SizeY && lft_cpt!=lft_nb ) {
-      if( yr<yl ) {
-     rgt_cpt++;
-     do {
-        xl=xl2>>6; xr=xr2>>6;
-        p += xl;
-            aux1 = (int16)( xl-v[0].x );
-            t_x = (int16)( aux1*t_cos + t_x0 );
-            t_y = (int16)( aux1*t_sin + t_y0 );
-        for(i=xr-xl;i>=0; i--) 
-        {
-            *p++= t_p[(t_x>>10)+((t_y&0x7c00)>>6)];
-            t_x = (int16)( t_x + t_cos );
-
-            t_y = (int16)( t_y + t_sin );
-        }
-        p += m_ScreenSizeX-xr-1;
-        xl2 += xl_inc;
-        xr2 += xr_inc;
-        t_x0 = (int16)( t_x0-t_sin );
-        t_y0 = (int16)( t_y0+t_cos );
-     } 
-     while( yr>++y && y<m_SizeY );
-     calc_xr2_yr;
-   } else {
-     lft_cpt++;
-     if( lft_cpt==lft_nb ) yl++;
-     do {
-        xl=xl2>>6; xr=xr2>>6;
-        p += xl;
-        aux1 = (int16)( xl-v[0].x );
-        t_x = (int16)( aux1*t_cos + t_x0 );
-        t_y = (int16)( aux1*t_sin + t_y0 );
-        for(i=xr-xl;i>=0; i--) 
-        {
-           *p++= t_p[(t_x>>10)+((t_y&0x7c00)>>6)];
-           t_x = (int16)( t_x+t_cos );
-           t_y = (int16)( t_y+t_sin );
-        }
-        p += m_ScreenSizeX-xr-1;
-        xl2 += xl_inc;
-        xr2 += xr_inc;
-        t_x0 = (int16)( t_x0-t_sin );
-        t_y0 = (int16)( t_y0+t_cos );
-     } while( yl>++y && y<m_SizeY );
-     if( yr==yl ) {
-        rgt_cpt++;
-        calc_xr2_yr;
-     }
-     if( lft_cpt!=lft_nb ) { calc_xl2_yl };
-      }
-   }
+   FillPoly( v, v_nb, 0, t, sine, cosine );
 }
 
 //__ TLowGraphic::DrawString ________________________________________________
@@ -1047,3 +673,130 @@ unsigned char * TLowGraphic::GetOneBitPerPixel( int color )
 }
 
 
+/**
+ * Allocate the damage list for the size of the bitmap. All the bitmap
+ * is dirty.
+ */
+void TLowGraphic::AllocDirty()
+{
+  delete[] m_aDirty;
+  m_iTileX = (m_SizeX+(1<<DIRTY_TILE_SHIFT)-1)>>DIRTY_TILE_SHIFT;
+  m_iTileY = (m_SizeY+(1<<DIRTY_TILE_SHIFT)-1)>>DIRTY_TILE_SHIFT;
+  m_aDirty = new unsigned char[m_iTileX*m_iTileY];
+  SetAllDirty();
+}
+
+/**
+ * Add a rectangle of the bitmap that was modified in the damage list
+ *
+ * @param x1, y1        (in) top left corner
+ * @param x2, y2        (in) bottom right corner (included)
+ */
+void TLowGraphic::AddDirty( int x1, int y1, int x2, int y2 )
+{
+  if( x1<0 ) x1 = 0;
+  if( y1<0 ) y1 = 0;
+  if( x2>m_MaxX ) x2 = m_MaxX;
+  if( y2>m_MaxY ) y2 = m_MaxY;
+  if( x1>x2 || y1>y2 ) return;
+
+  int tx1 = x1>>DIRTY_TILE_SHIFT, tx2 = x2>>DIRTY_TILE_SHIFT;
+  for( int ty=y1>>DIRTY_TILE_SHIFT; ty<=(y2>>DIRTY_TILE_SHIFT); ty++ )
+  {
+    memset( m_aDirty+ty*m_iTileX+tx1, 1, tx2-tx1+1 );
+  }
+}
+
+/**
+ * Mark all the bitmap as dirty
+ */
+void TLowGraphic::SetAllDirty()
+{
+  memset( m_aDirty, 1, m_iTileX*m_iTileY );
+}
+
+/**
+ * Get the rectangles of the bitmap that changed since the last call and
+ * clear the damage list. The dirty tiles of a row are joined in
+ * rectangles, and a rectangle with the same columns in the row below
+ * is extended. If the view does not fill the damage list (m_bDamage),
+ * the result is the whole bitmap.
+ *
+ * @param r             (out) the rectangles
+ * @param max           (in) size of r
+ * @return              number of rectangles
+ */
+int TLowGraphic::GetDirtyRects( IntRect r[], int max )
+{
+  int n = 0;
+  int row_start = 0;                  // r[row_start..n-1] can be extended in the next row
+  bool bFull = false;
+
+  if( !m_bDamage )
+  {
+    bFull = true;
+  }
+  for( int ty=0; ty<m_iTileY && !bFull; ty++ )
+  {
+    unsigned char * d = m_aDirty+ty*m_iTileX;
+    int row_end = n;
+    int tx = 0;
+    while( tx<m_iTileX )
+    {
+      if( !d[tx] )
+      {
+        tx++;
+        continue;
+      }
+      int x1 = tx;
+      while( tx<m_iTileX && d[tx] ) tx++;
+      x1 <<= DIRTY_TILE_SHIFT;
+      int x2 = min( (tx<<DIRTY_TILE_SHIFT)-1, m_MaxX );
+      int y1 = ty<<DIRTY_TILE_SHIFT;
+      int y2 = min( y1+(1<<DIRTY_TILE_SHIFT)-1, m_MaxY );
+
+      int i;
+      for( i=row_start; i<row_end; i++ )
+      {
+        if( r[i].x1==x1 && r[i].x2==x2 && r[i].y2==y1-1 ) break;
+      }
+      if( i<row_end )
+      {
+        r[i].y2 = y2;
+      }
+      else if( n<max )
+      {
+        r[n].x1 = x1; r[n].y1 = y1;
+        r[n].x2 = x2; r[n].y2 = y2;
+        n++;
+      }
+      else
+      {
+        bFull = true;                 // too many rectangles
+        break;
+      }
+    }
+    // the rectangles not extended in this row are closed: move them
+    // before the ones that are still candidates for the next row
+    int j = row_start;
+    int y_end = min( (ty<<DIRTY_TILE_SHIFT)+(1<<DIRTY_TILE_SHIFT)-1, m_MaxY );
+    for( int i=row_start; i<n; i++ )
+    {
+      if( r[i].y2!=y_end )
+      {
+        IntRect tmp = r[j]; r[j] = r[i]; r[i] = tmp;
+        j++;
+      }
+    }
+    row_start = j;
+  }
+  memset( m_aDirty, 0, m_iTileX*m_iTileY );
+
+  if( bFull )
+  {
+    r[0].x1 = 0; r[0].y1 = 0;
+    r[0].x2 = m_MaxX; r[0].y2 = m_MaxY;
+    return max>0 ? 1 : 0;
+  }
+  return n;
+}
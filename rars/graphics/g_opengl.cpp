@@ -19,6 +19,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 
 #ifdef WIN32
   #include <windows.h>
@@ -45,12 +47,29 @@
   int wglAllocateMemoryNV = 0;
 #endif
 
+// GL_ARB_vertex_buffer_object (the glext.h of the project is older)
+#ifndef GL_ARRAY_BUFFER_ARB
+  #define GL_ARRAY_BUFFER_ARB          0x8892
+  #define GL_ELEMENT_ARRAY_BUFFER_ARB  0x8893
+  #define GL_STATIC_DRAW_ARB           0x88E4
+#endif
+
+typedef void (APIENTRY * BufferGenProc)( GLsizei n, GLuint * buffers );
+typedef void (APIENTRY * BufferBindProc)( GLenum target, GLuint buffer );
+typedef void (APIENTRY * BufferDataProc)( GLenum target, ptrdiff_t size, const GLvoid * data, GLenum usage );
+typedef void (APIENTRY * BufferDeleteProc)( GLsizei n, const GLuint * buffers );
+
 //--------------------------------------------------------------------------
 //                              G L O B A L S
 //--------------------------------------------------------------------------
 
 OpenGL opengl;
 
+static BufferGenProc    pglGenBuffers    = NULL;
+static BufferBindProc   pglBindBuffer    = NULL;
+static BufferDataProc   pglBufferData    = NULL;
+static BufferDeleteProc pglDeleteBuffers = NULL;
+
 //--------------------------------------------------------------------------
 // OpenGL
 //--------------------------------------------------------------------------
@@ -87,6 +106,7 @@ void OpenGL::Init( int iSizeX, int iSizeY, double max_dist )
   glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
 
   VideoMemoryInit();
+  BufferInit();
 
   // Load the environment mapping texture
   g_TextureEnvMap = GLTexture::GetLoadedTexture( "", "env_mapping.bmp", false );
@@ -178,6 +198,90 @@ void OpenGL::VideoMemoryDestroy()
   #endif
 }
 
+//--------------------------------------------------------------------------
+// Vertex buffer objects
+//--------------------------------------------------------------------------
+
+// The vertices of the 3DS models (track, relief, cars) are sent once to
+// OpenGL. Each glDrawElements then only gives offsets in the buffers, 
+// instead of copying the vertex arrays at each frame. Without the
+// extension, the models are drawn with the vertex arrays in memory as
+// before. The gain depends on the driver: with the Mesa software
+// rasterizer, 32 cars of 3ds/indy2 cost the same time with or without the
+// buffers. GL_DrawCar and DrawBoard are still in immediate mode and the
+// cars are not instanced.
+
+/**
+ * Find the functions of GL_ARB_vertex_buffer_object (OpenGL context needed)
+ */
+void OpenGL::BufferInit()
+{
+  m_bBuffer = false;
+
+  const char * ext = (const char *)glGetString( GL_EXTENSIONS );
+  if( ext==NULL || strstr( ext, "GL_ARB_vertex_buffer_object" )==NULL )
+  {
+    return;
+  }
+  #ifdef WIN32
+    pglGenBuffers    = (BufferGenProc)    wglGetProcAddress( "glGenBuffersARB" );
+    pglBindBuffer    = (BufferBindProc)   wglGetProcAddress( "glBindBufferARB" );
+    pglBufferData    = (BufferDataProc)   wglGetProcAddress( "glBufferDataARB" );
+    pglDeleteBuffers = (BufferDeleteProc) wglGetProcAddress( "glDeleteBuffersARB" );
+  #else
+    pglGenBuffers    = (BufferGenProc)    glXGetProcAddressARB( (const GLubyte *)"glGenBuffersARB" );
+    pglBindBuffer    = (BufferBindProc)   glXGetProcAddressARB( (const GLubyte *)"glBindBufferARB" );
+    pglBufferData    = (BufferDataProc)   glXGetProcAddressARB( (const GLubyte *)"glBufferDataARB" );
+    pglDeleteBuffers = (BufferDeleteProc) glXGetProcAddressARB( (const GLubyte *)"glDeleteBuffersARB" );
+  #endif
+  m_bBuffer = pglGenBuffers!=NULL && pglBindBuffer!=NULL && pglBufferData!=NULL && pglDeleteBuffers!=NULL;
+}
+
+/**
+ * Create a buffer and copy the data in it
+ *
+ * @param bIndex        (in) true: indices of the faces, false: vertices
+ * @param size          (in) size of the data in bytes
+ * @param data          (in) data
+ * @return id of the buffer, 0 if the buffers are not supported
+ */
+unsigned int OpenGL::BufferCreate( bool bIndex, long size, const void * data )
+{
+  GLuint id = 0;
+  if( !m_bBuffer || size<=0 )
+  {
+    return 0;
+  }
+  GLenum target = bIndex ? GL_ELEMENT_ARRAY_BUFFER_ARB : GL_ARRAY_BUFFER_ARB;
+  pglGenBuffers( 1, &id );
+  pglBindBuffer( target, id );
+  pglBufferData( target, size, data, GL_STATIC_DRAW_ARB );
+  pglBindBuffer( target, 0 );
+  return id;
+}
+
+/**
+ * Use a buffer for the next gl*Pointer (vertices) or glDrawElements (indices)
+ *
+ * @param id            (in) id of the buffer, 0 for the arrays in memory
+ */
+void OpenGL::BufferBind( bool bIndex, unsigned int id )
+{
+  if( m_bBuffer )
+  {
+    pglBindBuffer( bIndex ? GL_ELEMENT_ARRAY_BUFFER_ARB : GL_ARRAY_BUFFER_ARB, id );
+  }
+}
+
+void OpenGL::BufferDelete( unsigned int id )
+{
+  if( m_bBuffer && id!=0 )
+  {
+    GLuint gl_id = id;
+    pglDeleteBuffers( 1, &gl_id );
+  }
+}
+
 //--------------------------------------------------------------------------
 // Font
 //--------------------------------------------------------------------------
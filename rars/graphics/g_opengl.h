@@ -38,6 +38,13 @@ class OpenGL
     void VideoMemoryFree( void * p );
     void VideoMemoryDestroy();
 
+    // Vertex buffer objects (static geometry kept by OpenGL)
+    bool m_bBuffer;                    // true if supported
+    void BufferInit();
+    unsigned int BufferCreate( bool bIndex, long size, const void * data );
+    void BufferBind( bool bIndex, unsigned int id );
+    void BufferDelete( unsigned int id );
+
     void BuildFont();
     void KillFont();
     void glPrint( int base, const char *fmt, ...);
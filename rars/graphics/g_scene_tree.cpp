@@ -0,0 +1,464 @@
+//--------------------------------------------------------------------------
+//
+//    FILE: G_SCENE_TREE.CPP (portable)
+//
+//      - Bounding volume hierarchy of the track scenery (culling of the
+//        3D view)
+//
+//    Version       Author          Date
+//      0.1
+//
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "g_scene_tree.h"
+#include "../misc.h"
+
+//--------------------------------------------------------------------------
+//                           D E F I N E
+//--------------------------------------------------------------------------
+
+#define SCENE_EMPTY  1e30f      // bounds of an empty box (min>max)
+#define SCENE_NEAR   5          // index of the near plane in the frustum
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+static float * s_aSortCenter;   // centers sorted by CompareCenter
+static int     s_iSortAxis;
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Order of the items along the axis s_iSortAxis
+ */
+static int CompareCenter( const void * pa, const void * pb )
+{
+  float a = s_aSortCenter[ *(const int *)pa*3+s_iSortAxis ];
+  float b = s_aSortCenter[ *(const int *)pb*3+s_iSortAxis ];
+  if( a<b ) return -1;
+  if( a>b ) return 1;
+  return 0;
+}
+
+static void EmptyBox( float * aMin, float * aMax )
+{
+  for( int k=0; k<3; k++ )
+  {
+    aMin[k] = SCENE_EMPTY;
+    aMax[k] = -SCENE_EMPTY;
+  }
+}
+
+static void AddBox( float * aMin, float * aMax, const float * aMin2, const float * aMax2 )
+{
+  for( int k=0; k<3; k++ )
+  {
+    if( aMin2[k]<aMin[k] ) aMin[k] = aMin2[k];
+    if( aMax2[k]>aMax[k] ) aMax[k] = aMax2[k];
+  }
+}
+
+//--------------------------------------------------------------------------
+//                          Class GSceneTree
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+GSceneTree::GSceneTree()
+{
+  m_aItem = NULL;
+  m_aOrder = NULL;
+  m_aNode = NULL;
+  m_aPending = NULL;
+  m_aVisible = NULL;
+  m_iMaxItem = 0;
+  m_iFrame = 0;
+  Reset();
+}
+
+/**
+ * Destructor
+ */
+GSceneTree::~GSceneTree()
+{
+  Reset();
+}
+
+/**
+ * Free the tree
+ */
+void GSceneTree::Reset()
+{
+  delete [] m_aItem;
+  delete [] m_aOrder;
+  delete [] m_aNode;
+  delete [] m_aPending;
+  delete [] m_aVisible;
+  m_aItem = NULL;
+  m_aOrder = NULL;
+  m_aNode = NULL;
+  m_aPending = NULL;
+  m_aVisible = NULL;
+  m_iMaxItem = 0;
+  m_iNumItem = 0;
+  m_iNumNode = 0;
+  m_iNumPending = 0;
+  m_iNumVisible = 0;
+}
+
+/**
+ * Allocate an empty tree
+ *
+ * @param iMaxItem    (in) number of items that will be added
+ */
+void GSceneTree::Init( int iMaxItem )
+{
+  Reset();
+  m_iMaxItem = iMaxItem;
+  m_aItem    = new GSceneItem[iMaxItem+1];
+  m_aOrder   = new int[iMaxItem+1];
+  m_aNode    = new GSceneNode[2*iMaxItem+1];
+  m_aPending = new int[iMaxItem+1];
+  m_aVisible = new int[iMaxItem+1];
+}
+
+/**
+ * Add a whole model
+ *
+ * @param model       (in) model
+ * @param bPlaced     (in) true: the model has a position (3D objects)
+ * @return index of the item
+ */
+int GSceneTree::AddModel( Model_3DS * model, bool bPlaced )
+{
+  int i = AddObject( model, -1 );
+  m_aItem[i].bPlaced = bPlaced;
+  return i;
+}
+
+/**
+ * Add one object of a model (the relief is cut in several objects)
+ *
+ * @param model       (in) model (the position of the model is not used)
+ * @param iObject     (in) index of the object in the model, -1: all
+ * @return index of the item
+ */
+int GSceneTree::AddObject( Model_3DS * model, int iObject )
+{
+  if( m_iNumItem>=m_iMaxItem )
+  {
+    exitOnError( "GSceneTree::AddObject: too many items (max %d)", m_iMaxItem );
+  }
+  GSceneItem * item = &m_aItem[m_iNumItem];
+  item->pModel = model;
+  item->iObject = iObject;
+  item->bPlaced = false;
+  item->bKnown = false;
+  item->iNode = -1;
+  item->iFrame = -1;
+  item->fDist = 0.0f;
+  item->bSorted = false;
+  EmptyBox( item->aMin, item->aMax );
+  return m_iNumItem++;
+}
+
+/**
+ * Calculate the box of an item
+ *
+ * @return false if the model is not loaded yet
+ */
+bool GSceneTree::ItemBox( GSceneItem * item )
+{
+  Model_3DS * model = item->pModel;
+  if( !model->IsReady() )
+  {
+    return false;
+  }
+
+  if( item->iObject<0 )
+  {
+    // The sphere of the model (the rotation is not taken into account)
+    float x = model->m_fCenterX, y = model->m_fCenterY, z = model->m_fCenterZ;
+    float r = model->m_fRay;
+    if( item->bPlaced )
+    {
+      x += model->pos.x;
+      y += model->pos.y;
+      z += model->pos.z;
+    }
+    item->aMin[0] = x-r; item->aMax[0] = x+r;
+    item->aMin[1] = y-r; item->aMax[1] = y+r;
+    item->aMin[2] = z-r; item->aMax[2] = z+r;
+  }
+  else
+  {
+    // The vertices of the object
+    Model_3DS::Object * obj = &model->aObject[item->iObject];
+    EmptyBox( item->aMin, item->aMax );
+    for( int j=0; j<obj->numRealVertex; j++ )
+    {
+      float v[3] = { obj->aRealVertex[j].x, obj->aRealVertex[j].y, obj->aRealVertex[j].z };
+      AddBox( item->aMin, item->aMax, v, v );
+    }
+  }
+  item->bKnown = true;
+  return true;
+}
+
+/**
+ * Build the tree (once all the items are added)
+ */
+void GSceneTree::Build()
+{
+  int i, k;
+
+  // Center of the items: the center of the box or the position of the
+  // models being loaded
+  float * aCenter = new float[3*m_iNumItem+1];
+  m_iNumPending = 0;
+  for( i=0; i<m_iNumItem; i++ )
+  {
+    GSceneItem * item = &m_aItem[i];
+    m_aOrder[i] = i;
+    if( ItemBox( item ) )
+    {
+      for( k=0; k<3; k++ )
+      {
+        aCenter[i*3+k] = (item->aMin[k]+item->aMax[k])/2.0f;
+      }
+    }
+    else
+    {
+      aCenter[i*3+0] = item->pModel->pos.x;
+      aCenter[i*3+1] = item->pModel->pos.y;
+      aCenter[i*3+2] = item->pModel->pos.z;
+      m_aPending[m_iNumPending++] = i;
+    }
+  }
+
+  m_iNumNode = 0;
+  if( m_iNumItem>0 )
+  {
+    BuildNode( -1, 0, m_iNumItem, aCenter );
+  }
+  delete [] aCenter;
+}
+
+/**
+ * Build a node: the items are cut in two halves along the longest side
+ * of the box of their centers
+ *
+ * @return index of the node
+ */
+int GSceneTree::BuildNode( int iParent, int iFirst, int iNum, float * aCenter )
+{
+  int i, k;
+  int iNode = m_iNumNode++;
+  GSceneNode * node = &m_aNode[iNode];
+
+  node->iParent = iParent;
+  node->iRight = -1;
+  node->iFirstItem = iFirst;
+  node->iNumItem = iNum;
+
+  if( iNum<=SCENE_LEAF_SIZE )
+  {
+    for( i=iFirst; i<iFirst+iNum; i++ )
+    {
+      m_aItem[m_aOrder[i]].iNode = iNode;
+    }
+    Refit( iNode );
+    return iNode;
+  }
+
+  float aMin[3], aMax[3];
+  EmptyBox( aMin, aMax );
+  for( i=iFirst; i<iFirst+iNum; i++ )
+  {
+    float * c = &aCenter[m_aOrder[i]*3];
+    AddBox( aMin, aMax, c, c );
+  }
+  s_iSortAxis = 0;
+  for( k=1; k<3; k++ )
+  {
+    if( aMax[k]-aMin[k]>aMax[s_iSortAxis]-aMin[s_iSortAxis] )
+    {
+      s_iSortAxis = k;
+    }
+  }
+  s_aSortCenter = aCenter;
+  qsort( &m_aOrder[iFirst], iNum, sizeof(int), CompareCenter );
+
+  // The left child is the next node
+  int iHalf = iNum/2;
+  BuildNode( iNode, iFirst, iHalf, aCenter );
+  int iRight = BuildNode( iNode, iFirst+iHalf, iNum-iHalf, aCenter );
+  m_aNode[iNode].iRight = iRight;
+  Refit( iNode );
+  return iNode;
+}
+
+/**
+ * Calculate the box of a node from its children or its items
+ */
+void GSceneTree::Refit( int iNode )
+{
+  GSceneNode * node = &m_aNode[iNode];
+  EmptyBox( node->aMin, node->aMax );
+  if( node->iRight<0 )
+  {
+    for( int i=node->iFirstItem; i<node->iFirstItem+node->iNumItem; i++ )
+    {
+      GSceneItem * item = &m_aItem[m_aOrder[i]];
+      AddBox( node->aMin, node->aMax, item->aMin, item->aMax );
+    }
+  }
+  else
+  {
+    GSceneNode * left = &m_aNode[iNode+1];
+    GSceneNode * right = &m_aNode[node->iRight];
+    AddBox( node->aMin, node->aMax, left->aMin, left->aMax );
+    AddBox( node->aMin, node->aMax, right->aMin, right->aMax );
+  }
+}
+
+/**
+ * Find the visible items (once per view and per frame)
+ *
+ * @param aFrustum    (in) planes of the view (see TView3D::ExtractFrustum),
+ *                         the last one is the near plane
+ * @return number of visible items (see GetVisible)
+ */
+int GSceneTree::Cull( float aFrustum[6][4] )
+{
+  int i;
+
+  m_iFrame++;
+  m_iNumVisible = 0;
+  if( m_iNumNode==0 )
+  {
+    return 0;
+  }
+
+  // The models loaded since the last frame enlarge the boxes
+  for( i=0; i<m_iNumPending; i++ )
+  {
+    GSceneItem * item = &m_aItem[m_aPending[i]];
+    if( ItemBox( item ) )
+    {
+      for( int iNode=item->iNode; iNode>=0; iNode=m_aNode[iNode].iParent )
+      {
+        Refit( iNode );
+      }
+      m_aPending[i--] = m_aPending[--m_iNumPending];
+    }
+  }
+
+  CullNode( 0, (1<<6)-1, aFrustum );
+  return m_iNumVisible;
+}
+
+/**
+ * Test a box against the planes of the mask. The children are only tested
+ * against the planes cutting the box.
+ *
+ * @param iNode       (in) node
+ * @param iMask       (in) bit p set: the plane p must be tested
+ * @param aFrustum    (in) planes of the view
+ */
+void GSceneTree::CullNode( int iNode, int iMask, float aFrustum[6][4] )
+{
+  GSceneNode * node = &m_aNode[iNode];
+  if( node->aMin[0]>node->aMax[0] )
+  {
+    return;   // empty (models not loaded)
+  }
+
+  for( int p=0; p<6; p++ )
+  {
+    if( iMask & (1<<p) )
+    {
+      float * plane = aFrustum[p];
+      // Corner the most in front of the plane, and the most behind
+      float d_in  = plane[3];
+      float d_out = plane[3];
+      for( int k=0; k<3; k++ )
+      {
+        if( plane[k]>=0.0f )
+        {
+          d_in  += plane[k]*node->aMax[k];
+          d_out += plane[k]*node->aMin[k];
+        }
+        else
+        {
+          d_in  += plane[k]*node->aMin[k];
+          d_out += plane[k]*node->aMax[k];
+        }
+      }
+      if( d_in<0.0f )
+      {
+        return;
+      }
+      if( d_out>=0.0f )
+      {
+        iMask &= ~(1<<p);
+      }
+    }
+  }
+
+  if( node->iRight>=0 )
+  {
+    CullNode( iNode+1, iMask, aFrustum );
+    CullNode( node->iRight, iMask, aFrustum );
+    return;
+  }
+
+  // Leaf: test the items alone if the box is cut by a plane
+  for( int i=node->iFirstItem; i<node->iFirstItem+node->iNumItem; i++ )
+  {
+    int iItem = m_aOrder[i];
+    GSceneItem * item = &m_aItem[iItem];
+    if( !item->bKnown )
+    {
+      continue;
+    }
+    bool bVisible = true;
+    for( int p=0; p<6 && bVisible; p++ )
+    {
+      if( iMask & (1<<p) )
+      {
+        float * plane = aFrustum[p];
+        float d_in = plane[3];
+        for( int k=0; k<3; k++ )
+        {
+          d_in += plane[k]*( plane[k]>=0.0f ? item->aMax[k] : item->aMin[k] );
+        }
+        bVisible = d_in>=0.0f;
+      }
+    }
+    if( bVisible )
+    {
+      // Distance of the center to the near plane
+      float * plane = aFrustum[SCENE_NEAR];
+      item->fDist = plane[3];
+      for( int k=0; k<3; k++ )
+      {
+        item->fDist += plane[k]*(item->aMin[k]+item->aMax[k])/2.0f;
+      }
+      item->iFrame = m_iFrame;
+      m_aVisible[m_iNumVisible++] = iItem;
+    }
+  }
+}
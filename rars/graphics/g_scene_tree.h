@@ -0,0 +1,122 @@
+/**
+ * FILE: G_SCENE_TREE.H (portable)
+ *
+ * Bounding volume hierarchy of the track scenery (culling of the 3D view)
+ *
+ * The segments of the track, the objects of the relief and the 3D objects
+ * are the leaves of a binary tree of boxes, built once when the track is
+ * loaded. Each frame, the tree is tested against the frustum of the view
+ * from the root: a box outside one plane removes all its leaves, a box
+ * inside a plane is not tested again against it in its children. The
+ * visible items come out with their distance to the camera.
+ *
+ * The 3D objects are loaded in the background (see AssetLoader): their
+ * box is empty until the model is ready, then it is set and the boxes of
+ * the parents are enlarged.
+ *
+ * History
+ *  ver. 0.1  Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __G_SCENE_TREE_H
+#define __G_SCENE_TREE_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "../3ds/model_3ds.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define SCENE_LEAF_SIZE 4       // max items per leaf
+
+//--------------------------------------------------------------------------
+//                            T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * A model (or one object of a model) in the tree
+ */
+struct GSceneItem
+{
+  Model_3DS * pModel;
+  int    iObject;         // object of the model, -1 for the whole model
+  bool   bPlaced;         // drawn at its position (Model_3DS::Draw)
+  bool   bKnown;          // the box is known (the model is loaded)
+  float  aMin[3];         // box
+  float  aMax[3];
+  int    iNode;           // leaf containing the item
+  int    iFrame;          // last Cull where the item was visible
+  float  fDist;           // distance to the camera (last Cull)
+  bool   bSorted;         // in the list of the transparent items (TTrack3D)
+};
+
+/**
+ * A box of the tree
+ */
+struct GSceneNode
+{
+  float  aMin[3];
+  float  aMax[3];
+  int    iParent;         // -1 for the root
+  int    iRight;          // right child (the left one is the next node), -1 for a leaf
+  int    iFirstItem;      // leaf: items m_aOrder[iFirstItem..iFirstItem+iNumItem-1]
+  int    iNumItem;
+};
+
+/**
+ * Culling tree
+ *
+ * Usage:
+ *   tree.Init( n );
+ *   tree.AddModel( &segment_model, false );
+ *   tree.AddObject( &relief, i );
+ *   tree.Build();
+ *   ...
+ *   int num = tree.Cull( m_aFrustum );  // each frame
+ *   for( i=0; i<num; i++ ) draw tree.GetItem( tree.GetVisible(i) )
+ */
+class GSceneTree
+{
+  private:
+    GSceneItem * m_aItem;
+    int          m_iNumItem;
+    int          m_iMaxItem;
+    int        * m_aOrder;       // items sorted by leaf
+    GSceneNode * m_aNode;
+    int          m_iNumNode;
+    int        * m_aPending;     // items with an unknown box
+    int          m_iNumPending;
+    int        * m_aVisible;     // result of Cull
+    int          m_iNumVisible;
+    int          m_iFrame;
+
+    bool   ItemBox( GSceneItem * item );
+    int    BuildNode( int iParent, int iFirst, int iNum, float * aCenter );
+    void   Refit( int iNode );
+    void   CullNode( int iNode, int iMask, float aFrustum[6][4] );
+
+  public:
+    GSceneTree();
+    ~GSceneTree();
+
+    void   Init( int iMaxItem );
+    void   Reset();
+    int    AddModel( Model_3DS * model, bool bPlaced );
+    int    AddObject( Model_3DS * model, int iObject );
+    void   Build();
+
+    int    Cull( float aFrustum[6][4] );
+    int    GetVisible( int i ) { return m_aVisible[i]; }
+    GSceneItem * GetItem( int i ) { return &m_aItem[i]; }
+    int    GetNumItem() { return m_iNumItem; }
+    int    GetFrame() { return m_iFrame; }
+};
+
+#endif // __G_SCENE_TREE_H
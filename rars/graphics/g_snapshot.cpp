@@ -0,0 +1,328 @@
+//--------------------------------------------------------------------------
+//
+//    FILE: G_SNAPSHOT.CPP (portable)
+//
+//    TSnapshotBuffer
+//      - Snapshots of the race published by the simulation after each
+//        step and read by the views
+//
+//    Version       Author          Date
+//      0.1
+//
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <string.h>
+#include <math.h>
+#include "g_global.h"
+#include "g_snapshot.h"
+#include "../globals.h"
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+TSnapshotBuffer g_oSnapshot;
+TRaceSnapshot * g_pSnapshot = NULL;
+
+//--------------------------------------------------------------------------
+//                       Class TSnapshotBuffer
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+TSnapshotBuffer::TSnapshotBuffer()
+{
+  for( int i=0; i<3; i++ )
+  {
+    InitSnapshot( &m_aBuffer[i] );
+  }
+  InitSnapshot( &m_oDrawn );
+  m_iBack = 0;
+  m_iReady = 1;
+  m_iFront = 2;
+  m_bNew = false;
+  m_iNumPublished = 0;
+  m_fPrevWallTime = 0.0;
+  m_oClock.startTimer();
+#ifndef WIN32
+  pthread_mutex_init( &m_oMutex, NULL );
+#endif
+  // the views can read it before the first step
+  g_pSnapshot = &m_aBuffer[m_iFront];
+}
+
+/**
+ * Destructor
+ */
+TSnapshotBuffer::~TSnapshotBuffer()
+{
+#ifndef WIN32
+  pthread_mutex_destroy( &m_oMutex );
+#endif
+}
+
+/**
+ * Empty snapshot: the cars are zeroed
+ *
+ * @param s             (out) snapshot
+ */
+void TSnapshotBuffer::InitSnapshot( TRaceSnapshot * s )
+{
+  memset( s->m_aCar, 0, sizeof(s->m_aCar) );
+  for( int i=0; i<MAX_CARS; i++ )
+  {
+    s->cars[i] = &s->m_aCar[i];
+    s->m_aCarInPos[i] = i;
+    s->m_aPosOfCar[i] = i;
+  }
+  memset( s->m_aSector, 0, sizeof(s->m_aSector) );
+  memset( s->m_aDelta, 0, sizeof(s->m_aDelta) );
+  s->m_iNumSector = 0;
+  s->m_fElapsedTime = 0.0;
+  s->m_iNumCar = 0;
+  s->m_fWallTime = 0.0;
+}
+
+void TSnapshotBuffer::Lock()
+{
+#ifndef WIN32
+  pthread_mutex_lock( &m_oMutex );
+#endif
+}
+
+void TSnapshotBuffer::Unlock()
+{
+#ifndef WIN32
+  pthread_mutex_unlock( &m_oMutex );
+#endif
+}
+
+/**
+ * Time since the start of the program (both threads: a copy of the
+ * clock is stopped)
+ *
+ * @return              time in ms
+ */
+double TSnapshotBuffer::GetWallTime()
+{
+  Timer clock = m_oClock;
+  return clock.stopTimer();
+}
+
+/**
+ * Copy the cars and the order of the race of a snapshot
+ *
+ * @param to            (out) copy
+ * @param from          (in) snapshot
+ */
+void TSnapshotBuffer::CopyCars( TRaceSnapshot * to, TRaceSnapshot * from )
+{
+  memcpy( to->m_aCar, from->m_aCar, from->m_iNumCar*sizeof(TCarSnapshot) );
+  memcpy( to->m_aCarInPos, from->m_aCarInPos, sizeof(to->m_aCarInPos) );
+  memcpy( to->m_aPosOfCar, from->m_aPosOfCar, sizeof(to->m_aPosOfCar) );
+  memcpy( to->m_aSector, from->m_aSector, from->m_iNumCar*sizeof(to->m_aSector[0]) );
+  memcpy( to->m_aDelta, from->m_aDelta, from->m_iNumCar*sizeof(to->m_aDelta[0]) );
+  to->m_iNumSector = from->m_iNumSector;
+  to->m_fElapsedTime = from->m_fElapsedTime;
+  to->m_iNumCar = from->m_iNumCar;
+  to->m_fWallTime = from->m_fWallTime;
+}
+
+/**
+ * Copy the values of a car drawn by the views
+ *
+ * @param to            (out) copy
+ * @param from          (in) car of the simulation
+ */
+void TSnapshotBuffer::CopyCar( TCarSnapshot * to, Car * from )
+{
+  to->x = from->x;
+  to->y = from->y;
+  to->ang = from->ang;
+  to->X = from->X;
+  to->Y = from->Y;
+  to->Z = from->Z;
+  to->xdot = from->xdot;
+  to->ydot = from->ydot;
+  to->alpha = from->get_alpha();
+  to->lin_acc = from->get_lin_acc();
+  to->lat_acc = from->get_lat_acc();
+  to->to_end = from->to_end;
+  to->to_rgt = from->to_rgt;
+  to->seg_id = from->seg_id;
+  to->distance = from->distance;
+  to->laps = from->laps;
+  to->laps_lead = from->laps_lead;
+  to->position = from->s.position;
+  to->out = from->out;
+  to->offroad = from->offroad;
+  to->collision_draw = from->collision_draw;
+  to->nose_color = from->nose_color;
+  to->tail_color = from->tail_color;
+  to->last_crossing = from->last_crossing;
+  to->lap_time = from->lap_time;
+  to->Behind_next = from->Behind_next;
+  to->Ahead_next = from->Ahead_next;
+  to->speed_avg = from->speed_avg;
+  to->bestlap_speed = from->bestlap_speed;
+  to->lastlap_speed = from->lastlap_speed;
+  to->pit_stops = from->pit_stops;
+  to->last_pit_visit = from->last_pit_visit;
+  to->Total_pit_time = from->Total_pit_time;
+  to->damage = from->damage;
+  to->fuel = from->fuel;
+  to->fuel_mileage = from->fuel_mileage;
+  to->projected_laps = from->projected_laps;
+  to->RobotTime = from->RobotTime;
+  to->prex2 = from->prex2;
+  to->prey2 = from->prey2;
+  to->prang2 = from->prang2;
+}
+
+/**
+ * Last time of each car in each sector: in the current lap if the car
+ * left the sector, else in the previous lap. And the delta to the best
+ * lap.
+ *
+ * @param s             (out) snapshot
+ */
+void TSnapshotBuffer::CopySectors( TRaceSnapshot * s )
+{
+  const LapTiming & timing = race_data.m_oLapTiming;
+
+  s->m_iNumSector = timing.IsOpen() ? timing.NumSector() : 0;
+  for( int i=0; i<s->m_iNumCar; i++ )
+  {
+    int lap = timing.IsOpen() ? timing.LastLap( i ) : -1;
+    s->m_aDelta[i] = lap>=0 ? (float)timing.Delta( i ) : 0.0f;
+    for( int j=0; j<s->m_iNumSector; j++ )
+    {
+      double t = 0.0;
+      if( lap>=0 )
+      {
+        t = timing.SectorTime( i, lap+1, j );
+        if( t==0.0 )
+        {
+          t = timing.SectorTime( i, lap, j );
+        }
+      }
+      s->m_aSector[i][j] = (float)t;
+    }
+  }
+}
+
+/**
+ * Simulation: copy the state of the race in the back buffer and make it
+ * the last published snapshot. Never waits for the views.
+ */
+void TSnapshotBuffer::Publish()
+{
+  TRaceSnapshot * s = &m_aBuffer[m_iBack];
+  int n = min( args.m_iNumCar, MAX_CARS );
+
+  for( int i=0; i<n; i++ )
+  {
+    if( race_data.cars[i]!=NULL )
+    {
+      CopyCar( s->cars[i], race_data.cars[i] );
+    }
+  }
+  memcpy( s->m_aCarInPos, race_data.m_aCarInPos, sizeof(s->m_aCarInPos) );
+  memcpy( s->m_aPosOfCar, race_data.m_aPosOfCar, sizeof(s->m_aPosOfCar) );
+  s->m_fElapsedTime = race_data.m_fElapsedTime;
+  s->m_iNumCar = n;
+  CopySectors( s );
+  s->m_fWallTime = GetWallTime();
+
+  Lock();
+  m_iBack = m_iReady;
+  m_iReady = s-m_aBuffer;
+  m_bNew = true;
+  m_iNumPublished++;
+  Unlock();
+}
+
+/**
+ * Views: take the last published snapshot. It stays valid until the
+ * next call.
+ *
+ * @return              the snapshot to draw
+ */
+TRaceSnapshot * TSnapshotBuffer::Acquire()
+{
+  Lock();
+  if( m_bNew )
+  {
+    int tmp = m_iFront;
+    m_iFront = m_iReady;
+    m_iReady = tmp;
+    m_bNew = false;
+  }
+  Unlock();
+  return &m_aBuffer[m_iFront];
+}
+
+/**
+ * Render thread: take the last published snapshot and move the cars
+ * between their positions in the previous snapshot and in this one,
+ * according to the time elapsed since it was published. The frame is
+ * one step late, but the cars move smoothly when the simulation is
+ * slower than the display.
+ *
+ * @return              the snapshot to draw (valid until the next call)
+ */
+TRaceSnapshot * TSnapshotBuffer::Interpolate()
+{
+  TRaceSnapshot * prev = &m_aBuffer[m_iFront];
+  double aX[MAX_CARS], aY[MAX_CARS], aAng[MAX_CARS];
+  int i;
+
+  for( i=0; i<prev->m_iNumCar; i++ )
+  {
+    aX[i] = prev->cars[i]->x;
+    aY[i] = prev->cars[i]->y;
+    aAng[i] = prev->cars[i]->ang;
+  }
+  double fPrevWallTime = prev->m_fWallTime;
+  int iPrevNumCar = prev->m_iNumCar;
+
+  TRaceSnapshot * cur = Acquire();
+  if( cur!=prev )
+  {
+    memcpy( m_aPrevX, aX, iPrevNumCar*sizeof(double) );
+    memcpy( m_aPrevY, aY, iPrevNumCar*sizeof(double) );
+    memcpy( m_aPrevAng, aAng, iPrevNumCar*sizeof(double) );
+    m_fPrevWallTime = iPrevNumCar==cur->m_iNumCar ? fPrevWallTime : 0.0;
+  }
+  CopyCars( &m_oDrawn, cur );
+
+  double span = cur->m_fWallTime-m_fPrevWallTime;
+  if( m_fPrevWallTime<=0.0 || span<=0.0 )
+  {
+    return &m_oDrawn;
+  }
+  double a = ( GetWallTime()-cur->m_fWallTime )/span;
+  if( a>=1.0 )
+  {
+    return &m_oDrawn;
+  }
+  a = max( a, 0.0 );
+  for( i=0; i<cur->m_iNumCar; i++ )
+  {
+    TCarSnapshot * car = m_oDrawn.cars[i];
+    double d_ang = car->ang-m_aPrevAng[i];
+    if( d_ang>PI ) d_ang -= 2.0*PI;
+    if( d_ang<-PI ) d_ang += 2.0*PI;
+    car->x = m_aPrevX[i]+a*( car->x-m_aPrevX[i] );
+    car->y = m_aPrevY[i]+a*( car->y-m_aPrevY[i] );
+    car->ang = m_aPrevAng[i]+a*d_ang;
+    if( car->ang<0.0 ) car->ang += 2.0*PI;
+    if( car->ang>=2.0*PI ) car->ang -= 2.0*PI;
+  }
+  return &m_oDrawn;
+}
@@ -0,0 +1,151 @@
+/**
+ * FILE: G_SNAPSHOT.H (portable)
+ *
+ * Snapshots of the race published by the simulation for the views
+ *
+ * After each step, the simulation copies the state of the cars and the
+ * order of the race in a snapshot (TSnapshotBuffer::Publish). Only the
+ * values drawn by the views are copied (TCarSnapshot): the drivers, the
+ * data of the robots and the pit logs stay in the live cars. The snapshots are in a
+ * triple buffer: the simulation writes in one, the last published one
+ * waits in the second and the views read the third. The buffers are
+ * only swapped under the lock, so the simulation never waits for a
+ * frame, and the views never see a snapshot being written.
+ *
+ * The views draw g_pSnapshot instead of race_data. When they are drawn
+ * by the render thread (see TViewManager::StartRender), the positions
+ * of the cars are interpolated between the last two snapshots at the
+ * time of the frame.
+ *
+ * History
+ *  ver. 0.1  Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __G_SNAPSHOT_H
+#define __G_SNAPSHOT_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#ifndef WIN32
+  #include <pthread.h>
+#endif
+#include "../car.h"
+#include "../timer.h"
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * State of one car drawn by the views. The names are the ones of Car,
+ * so that the views read g_pSnapshot->cars[i]->x like race_data.cars[i]->x.
+ * Plain values only: the snapshots are copied with memcpy. The driver
+ * of the car is drivers[i].
+ */
+struct TCarSnapshot
+{
+  double x, y, ang;             // current position
+  double X, Y;                  // position at the last Observe(), coherent with seg_id and to_end
+  double Z;                     // height, computed by G_VIEW3D
+  double xdot, ydot;
+  double alpha;
+  double lin_acc, lat_acc;      // Car::get_lin_acc(), Car::get_lat_acc()
+  double to_end, to_rgt;
+  int    seg_id;
+  double distance;
+  long   laps, laps_lead;
+  int    position;              // s.position: 0 means leading
+  int    out, offroad;
+  int    collision_draw;
+  int    nose_color, tail_color;
+  double last_crossing, lap_time;
+  double Behind_next, Ahead_next;
+  double speed_avg, bestlap_speed, lastlap_speed;
+  int    pit_stops;
+  long   last_pit_visit;
+  double Total_pit_time;
+  unsigned long damage;
+  double fuel, fuel_mileage;
+  long   projected_laps;
+  double RobotTime;
+  double prex2, prey2, prang2;  // position drawn by the classical view
+};
+
+/**
+ * State of the race after one step. The names are the ones of RaceData,
+ * so that the views read g_pSnapshot->cars[i] like race_data.cars[i].
+ */
+struct TRaceSnapshot
+{
+  TCarSnapshot * cars[MAX_CARS]; // points to m_aCar
+  int    m_aCarInPos[MAX_CARS];
+  int    m_aPosOfCar[MAX_CARS];
+  double m_fElapsedTime;
+  int    m_iNumCar;
+  float  m_aSector[MAX_CARS][MAX_LAP_SECTORS]; // last time of each car in each sector
+  float  m_aDelta[MAX_CARS];    // time to the best lap of each car (LapTiming::Delta)
+  int    m_iNumSector;
+  double m_fWallTime;           // ms (TSnapshotBuffer::m_oClock) when it was published
+  TCarSnapshot m_aCar[MAX_CARS];
+};
+
+/**
+ * Triple buffer of snapshots
+ *
+ * Usage:
+ *   g_oSnapshot.Publish();                     // simulation, after each step
+ *   g_pSnapshot = g_oSnapshot.Acquire();       // views, same thread
+ *   g_pSnapshot = g_oSnapshot.Interpolate();   // views, render thread
+ */
+class TSnapshotBuffer
+{
+  private:
+    TRaceSnapshot m_aBuffer[3];
+    int    m_iBack;             // written by the simulation
+    int    m_iReady;            // last published
+    int    m_iFront;            // read by the views
+    bool   m_bNew;              // m_iReady is newer than m_iFront
+    long   m_iNumPublished;
+    Timer  m_oClock;
+
+    // interpolation (render thread)
+    TRaceSnapshot m_oDrawn;
+    double m_aPrevX[MAX_CARS];  // cars in the snapshot before m_iFront
+    double m_aPrevY[MAX_CARS];
+    double m_aPrevAng[MAX_CARS];
+    double m_fPrevWallTime;
+
+#ifndef WIN32
+    pthread_mutex_t m_oMutex;
+#endif
+    void   Lock();
+    void   Unlock();
+    void   InitSnapshot( TRaceSnapshot * s );
+    void   CopyCars( TRaceSnapshot * to, TRaceSnapshot * from );
+    void   CopyCar( TCarSnapshot * to, Car * from );
+    void   CopySectors( TRaceSnapshot * s );
+
+  public:
+    TSnapshotBuffer();
+    ~TSnapshotBuffer();
+
+    void   Publish();
+    TRaceSnapshot * Acquire();
+    TRaceSnapshot * Interpolate();
+    double GetWallTime();
+    bool   IsEmpty() { return m_iNumPublished==0; }
+};
+
+//--------------------------------------------------------------------------
+//                           E X T E R N S
+//--------------------------------------------------------------------------
+
+extern TSnapshotBuffer g_oSnapshot;
+extern TRaceSnapshot * g_pSnapshot;     // snapshot drawn by the views
+
+#endif // __G_SNAPSHOT_H
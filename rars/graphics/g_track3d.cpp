@@ -26,6 +26,7 @@
 #include "g_global.h"
 #include "misc.h"
 #include "g_tracked.h"
+#include "../3ds/asset_loader.h"
 
 #ifdef TRACK_EDITOR
   #include "compatibility.h"
@@ -46,9 +47,6 @@
 //                         G L O B A L S
 //--------------------------------------------------------------------------
 
-const int kSMALL_ENOUGH = 15;
-const int kBIG = 50000; // Relying on int = long
-
 extern GLTexture * t_road;
 extern GLTexture * t_pitstop;
 extern GLTexture * t_red_brick;
@@ -59,19 +57,22 @@ extern GLTexture * t_red_brick;
 
 TTrack3D::TTrack3D()
 {
+  m_aTransp = NULL;
+  m_iNumTransp = 0;
 }
 
 TTrack3D::~TTrack3D()
 {
+  delete [] m_aTransp;
 }
 
 void TTrack3D::Load()
 {
   char s[256];
 
-  // Sky
+  // Sky (the models are read in the background, see AssetLoader)
   sprintf( s, "tracks/%s", currentTrack->m_oSky.m_sModel );
-  m_ModelSky = model_loader.LoadModel( s, 1.0f, 0, true );
+  m_ModelSky = model_loader.QueueModel( s, 1.0f, 0, true );
   m_ModelSky->m_bLit = false;
 
   // Track and Relief
@@ -83,7 +84,7 @@ void TTrack3D::Load()
   {
     Object3D * obj = &currentTrack->m_aObject3D[i];
     sprintf( s, "tracks/%s/%s.3ds", currentTrack->m_sShortName, obj->m_sModel );
-    Model_3DS * pModel = model_loader.LoadModel( s, (float)currentTrack->m_fUnitDistanceScale, 0, true );
+    Model_3DS * pModel = model_loader.QueueModel( s, (float)currentTrack->m_fUnitDistanceScale, 0, true );
     pModel->m_bLit = false;
     pModel->pos.x = float(obj->x);
     pModel->pos.y = float(obj->y);
@@ -91,9 +92,43 @@ void TTrack3D::Load()
     pModel->rot.x = float(obj->rot_x*180/PI);
     pModel->rot.y = float(obj->rot_y*180/PI);
     pModel->rot.z = float(obj->rot_z*180/PI);
-    pModel->CalculateSphere();
     m_aOject3DModel[i] = pModel;
   }
+
+  // Culling tree (the boxes of the objects are known when they are loaded)
+  int iNumItem = m_iNbModel+m_ModelRelief.numObjects+currentTrack->m_iNumObject3D;
+  m_oScene.Init( iNumItem );
+  for( int i=0; i<m_iNbModel; i++ )
+  {
+    m_oScene.AddModel( &m_aModel[i], false );
+  }
+  for( int i=0; i<m_ModelRelief.numObjects; i++ )
+  {
+    m_oScene.AddObject( &m_ModelRelief, i );
+  }
+  for( int i=0; i<currentTrack->m_iNumObject3D; i++ )
+  {
+    m_oScene.AddModel( m_aOject3DModel[i], true );
+  }
+  m_oScene.Build();
+
+  delete [] m_aTransp;
+  m_aTransp = new int[iNumItem+1];
+  m_iNumTransp = 0;
+}
+
+/**
+ * Planes of the view used by the culling (see TView3D::ExtractFrustum)
+ */
+void TTrack3D::SetFrustum( float aFrustum[6][4] )
+{
+  for( int p=0; p<6; p++ )
+  {
+    for( int k=0; k<4; k++ )
+    {
+      m_aFrustum[p][k] = aFrustum[p][k];
+    }
+  }
 }
 
 void TTrack3D::Destroy()
@@ -105,6 +140,8 @@ void TTrack3D::Destroy()
     m_aModel[i].RemoveAll();
   }
   m_iNbModel = 0;
+  m_oScene.Reset();
+  m_iNumTransp = 0;
 }
 
 /**
@@ -128,38 +165,93 @@ void TTrack3D::DrawSky( double cam_x, double cam_y )
 void TTrack3D::Draw()
 {
   int i;
-  int iNbSeen = 0;
-  float dist;
-  Seen aSeen[MAX_MODEL];
 
-  // 1. Draw the objects, the relief
-  m_ModelRelief.Draw();
-  DrawObject3D();
+  // 1. Find the segments, the parts of the relief and the objects seen
+  int iNumVisible = m_oScene.Cull( m_aFrustum );
 
   // 2. Draw the opaque objects.
-  for( i=0; i<m_iNbModel; i++ )
+  for( i=0; i<iNumVisible; i++ )
   {
-    dist=SphereInFrustum( m_aModel[i].m_fCenterX, m_aModel[i].m_fCenterY, m_aModel[i].m_fCenterZ, m_aModel[i].m_fRay );
-    if( dist>0.0 )
+    GSceneItem * item = m_oScene.GetItem( m_oScene.GetVisible(i) );
+    if( item->bPlaced )
     {
-      m_aModel[i].DrawObjects( false );
-      // 2. Get the distance of the transparent objects.
-      if( m_aModel[i].m_bTransparent )
-      {
-        aSeen[iNbSeen].pModel = &m_aModel[i];
-        aSeen[iNbSeen].dist = dist;
-        iNbSeen++;
-      }
+      item->pModel->Draw();
+    }
+    else if( item->iObject>=0 )
+    {
+      item->pModel->DrawObject( item->iObject, false );
+    }
+    else
+    {
+      item->pModel->DrawObjects( false );
     }
   }
 
-  // 3. Quicksort the transparent objects seen
-  Quicksort( aSeen, 0, iNbSeen-1 );
+  // 3. Sort the transparent objects seen
+  SortTransparent( iNumVisible );
 
   // 4. Draw the transparent objects
-  for( i=iNbSeen-1; i>=0; i-- )
+  for( i=m_iNumTransp-1; i>=0; i-- )
   {
-    aSeen[i].pModel->DrawObjects( true );
+    GSceneItem * item = m_oScene.GetItem( m_aTransp[i] );
+    if( item->iObject>=0 )
+    {
+      item->pModel->DrawObject( item->iObject, true );
+    }
+    else
+    {
+      item->pModel->DrawObjects( true );
+    }
+  }
+  opengl.BufferBind( false, 0 );
+  opengl.BufferBind( true, 0 );
+}
+
+/**
+ * Update the list of the transparent objects seen, sorted from near to far
+ *
+ * The list of the last frame is kept: the objects not seen anymore are
+ * removed, the new ones are added at the end. The order changes little
+ * from a frame to the next, so an insertion sort is almost linear.
+ */
+void TTrack3D::SortTransparent( int iNumVisible )
+{
+  int i, j, n = 0;
+  int iFrame = m_oScene.GetFrame();
+
+  for( i=0; i<m_iNumTransp; i++ )
+  {
+    GSceneItem * item = m_oScene.GetItem( m_aTransp[i] );
+    if( item->iFrame==iFrame )
+    {
+      m_aTransp[n++] = m_aTransp[i];
+    }
+    else
+    {
+      item->bSorted = false;
+    }
+  }
+  for( i=0; i<iNumVisible; i++ )
+  {
+    int iItem = m_oScene.GetVisible(i);
+    GSceneItem * item = m_oScene.GetItem( iItem );
+    if( !item->bPlaced && !item->bSorted && item->pModel->m_bTransparent )
+    {
+      item->bSorted = true;
+      m_aTransp[n++] = iItem;
+    }
+  }
+  m_iNumTransp = n;
+
+  for( i=1; i<n; i++ )
+  {
+    int iItem = m_aTransp[i];
+    float dist = m_oScene.GetItem( iItem )->fDist;
+    for( j=i-1; j>=0 && m_oScene.GetItem( m_aTransp[j] )->fDist>dist; j-- )
+    {
+      m_aTransp[j+1] = m_aTransp[j];
+    }
+    m_aTransp[j+1] = iItem;
   }
 }
 
@@ -197,134 +289,16 @@ void TTrack3D::DrawRoad3D()
  */
 void TTrack3D::DrawObject3D()
 {
-  ExtractFrustum();
-
   for( int i=0; i<currentTrack->m_iNumObject3D; i++ )
   {
     Model_3DS * pModel = m_aOject3DModel[i];
-    if( SphereInFrustum( pModel->m_fCenterX+pModel->pos.x, pModel->m_fCenterY+pModel->pos.y, pModel->m_fCenterZ+pModel->pos.z, pModel->m_fRay ) )
+    if( pModel->IsReady() && SphereInFrustum( pModel->m_fCenterX+pModel->pos.x, pModel->m_fCenterY+pModel->pos.y, pModel->m_fCenterZ+pModel->pos.z, pModel->m_fRay ) )
     {
       pModel->Draw();
     }
   }
 }
 
-/**
- * Extract the fustrum from the OpenGL view.
- */
-void TTrack3D::ExtractFrustum()
-{
-   float   proj[16];
-   float   modl[16];
-   float   clip[16];
-   float   t;
-
-   /* Get the current PROJECTION matrix from OpenGL */
-   glGetFloatv( GL_PROJECTION_MATRIX, proj );
-
-   /* Get the current MODELVIEW matrix from OpenGL */
-   glGetFloatv( GL_MODELVIEW_MATRIX, modl );
-
-   /* Combine the two matrices (multiply projection by modelview) */
-   clip[ 0] = modl[ 0] * proj[ 0] + modl[ 1] * proj[ 4] + modl[ 2] * proj[ 8] + modl[ 3] * proj[12];
-   clip[ 1] = modl[ 0] * proj[ 1] + modl[ 1] * proj[ 5] + modl[ 2] * proj[ 9] + modl[ 3] * proj[13];
-   clip[ 2] = modl[ 0] * proj[ 2] + modl[ 1] * proj[ 6] + modl[ 2] * proj[10] + modl[ 3] * proj[14];
-   clip[ 3] = modl[ 0] * proj[ 3] + modl[ 1] * proj[ 7] + modl[ 2] * proj[11] + modl[ 3] * proj[15];
-
-   clip[ 4] = modl[ 4] * proj[ 0] + modl[ 5] * proj[ 4] + modl[ 6] * proj[ 8] + modl[ 7] * proj[12];
-   clip[ 5] = modl[ 4] * proj[ 1] + modl[ 5] * proj[ 5] + modl[ 6] * proj[ 9] + modl[ 7] * proj[13];
-   clip[ 6] = modl[ 4] * proj[ 2] + modl[ 5] * proj[ 6] + modl[ 6] * proj[10] + modl[ 7] * proj[14];
-   clip[ 7] = modl[ 4] * proj[ 3] + modl[ 5] * proj[ 7] + modl[ 6] * proj[11] + modl[ 7] * proj[15];
-
-   clip[ 8] = modl[ 8] * proj[ 0] + modl[ 9] * proj[ 4] + modl[10] * proj[ 8] + modl[11] * proj[12];
-   clip[ 9] = modl[ 8] * proj[ 1] + modl[ 9] * proj[ 5] + modl[10] * proj[ 9] + modl[11] * proj[13];
-   clip[10] = modl[ 8] * proj[ 2] + modl[ 9] * proj[ 6] + modl[10] * proj[10] + modl[11] * proj[14];
-   clip[11] = modl[ 8] * proj[ 3] + modl[ 9] * proj[ 7] + modl[10] * proj[11] + modl[11] * proj[15];
-
-   clip[12] = modl[12] * proj[ 0] + modl[13] * proj[ 4] + modl[14] * proj[ 8] + modl[15] * proj[12];
-   clip[13] = modl[12] * proj[ 1] + modl[13] * proj[ 5] + modl[14] * proj[ 9] + modl[15] * proj[13];
-   clip[14] = modl[12] * proj[ 2] + modl[13] * proj[ 6] + modl[14] * proj[10] + modl[15] * proj[14];
-   clip[15] = modl[12] * proj[ 3] + modl[13] * proj[ 7] + modl[14] * proj[11] + modl[15] * proj[15];
-
-   /* Extract the numbers for the RIGHT plane */
-   m_aFrustum[0][0] = clip[ 3] - clip[ 0];
-   m_aFrustum[0][1] = clip[ 7] - clip[ 4];
-   m_aFrustum[0][2] = clip[11] - clip[ 8];
-   m_aFrustum[0][3] = clip[15] - clip[12];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[0][0] * m_aFrustum[0][0] + m_aFrustum[0][1] * m_aFrustum[0][1] + m_aFrustum[0][2] * m_aFrustum[0][2] ) );
-   m_aFrustum[0][0] /= t;
-   m_aFrustum[0][1] /= t;
-   m_aFrustum[0][2] /= t;
-   m_aFrustum[0][3] /= t;
-
-   /* Extract the numbers for the LEFT plane */
-   m_aFrustum[1][0] = clip[ 3] + clip[ 0];
-   m_aFrustum[1][1] = clip[ 7] + clip[ 4];
-   m_aFrustum[1][2] = clip[11] + clip[ 8];
-   m_aFrustum[1][3] = clip[15] + clip[12];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[1][0] * m_aFrustum[1][0] + m_aFrustum[1][1] * m_aFrustum[1][1] + m_aFrustum[1][2] * m_aFrustum[1][2] ) );
-   m_aFrustum[1][0] /= t;
-   m_aFrustum[1][1] /= t;
-   m_aFrustum[1][2] /= t;
-   m_aFrustum[1][3] /= t;
-
-   /* Extract the BOTTOM plane */
-   m_aFrustum[2][0] = clip[ 3] + clip[ 1];
-   m_aFrustum[2][1] = clip[ 7] + clip[ 5];
-   m_aFrustum[2][2] = clip[11] + clip[ 9];
-   m_aFrustum[2][3] = clip[15] + clip[13];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[2][0] * m_aFrustum[2][0] + m_aFrustum[2][1] * m_aFrustum[2][1] + m_aFrustum[2][2] * m_aFrustum[2][2] ) );
-   m_aFrustum[2][0] /= t;
-   m_aFrustum[2][1] /= t;
-   m_aFrustum[2][2] /= t;
-   m_aFrustum[2][3] /= t;
-
-   /* Extract the TOP plane */
-   m_aFrustum[3][0] = clip[ 3] - clip[ 1];
-   m_aFrustum[3][1] = clip[ 7] - clip[ 5];
-   m_aFrustum[3][2] = clip[11] - clip[ 9];
-   m_aFrustum[3][3] = clip[15] - clip[13];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[3][0] * m_aFrustum[3][0] + m_aFrustum[3][1] * m_aFrustum[3][1] + m_aFrustum[3][2] * m_aFrustum[3][2] ) );
-   m_aFrustum[3][0] /= t;
-   m_aFrustum[3][1] /= t;
-   m_aFrustum[3][2] /= t;
-   m_aFrustum[3][3] /= t;
-
-   /* Extract the FAR plane */
-   m_aFrustum[4][0] = clip[ 3] - clip[ 2];
-   m_aFrustum[4][1] = clip[ 7] - clip[ 6];
-   m_aFrustum[4][2] = clip[11] - clip[10];
-   m_aFrustum[4][3] = clip[15] - clip[14];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[4][0] * m_aFrustum[4][0] + m_aFrustum[4][1] * m_aFrustum[4][1] + m_aFrustum[4][2] * m_aFrustum[4][2] ) );
-   m_aFrustum[4][0] /= t;
-   m_aFrustum[4][1] /= t;
-   m_aFrustum[4][2] /= t;
-   m_aFrustum[4][3] /= t;
-
-   /* Extract the NEAR plane */
-   m_aFrustum[5][0] = clip[ 3] + clip[ 2];
-   m_aFrustum[5][1] = clip[ 7] + clip[ 6];
-   m_aFrustum[5][2] = clip[11] + clip[10];
-   m_aFrustum[5][3] = clip[15] + clip[14];
-
-   /* Normalize the result */
-   t = float( sqrt( m_aFrustum[5][0] * m_aFrustum[5][0] + m_aFrustum[5][1] * m_aFrustum[5][1] + m_aFrustum[5][2] * m_aFrustum[5][2] ) );
-   m_aFrustum[5][0] /= t;
-   m_aFrustum[5][1] /= t;
-   m_aFrustum[5][2] /= t;
-   m_aFrustum[5][3] /= t;
-}
-
 /**
  * SphereInFrustum
  *
@@ -345,70 +319,6 @@ float TTrack3D::SphereInFrustum( float x, float y, float z, float radius )
    return d + radius;
 }
 
-void TTrack3D::SelectionSort(Seen data[], int left, int right)
-{
-  for(int i = left; i < right; i++) 
-  {
-    int min = i;
-    for(int j=i+1; j <= right; j++)
-    {
-      if(data[j].dist < data[min].dist)
-      {
-        min = j;
-      }
-    }
-    Seen temp = data[min];
-    data[min] = data[i];
-    data[i] = temp;
-  }
-}
-
-int TTrack3D::Partition( Seen d[], int left, int right)
-{
-  float val =d[left].dist;
-  int lm = left-1;
-  int rm = right+1;
-  for(;;) 
-  {
-    do
-    {
-      rm--;
-    }
-    while (d[rm].dist > val);
-  
-    do
-    {
-      lm++;
-    }
-    while( d[lm].dist < val);
-
-    if(lm < rm)
-    {
-      Seen tempr = d[rm];
-      d[rm] = d[lm];
-      d[lm] = tempr;
-    }
-    else 
-    {
-      return rm;
-    }
-  }
-}
-
-void TTrack3D::Quicksort( Seen d[], int left, int right)
-{
-  if(left < (right-kSMALL_ENOUGH)) 
-  {
-    int split_pt = Partition(d,left, right);
-    Quicksort(d, left, split_pt);
-    Quicksort(d, split_pt+1, right);
-  }
-  else
-  {
-    SelectionSort(d, left, right);
-  }
-}
-
 /**
  * Draw the road
  */
@@ -697,11 +607,11 @@ double TTrack3D::CarHeight( int iCar, double to_end_offset, double &banking )
    file containing the point of the car. And calculate the height of this point
   */
   double h = 0;
-  int seg_id  = race_data.cars[iCar]->seg_id;
+  int seg_id  = g_pSnapshot->cars[iCar]->seg_id;
   segment * seg  = &(currentTrack->rgtwall[seg_id]);
 
   // Add the 'to_end_offset' to 'to_end' and change the segment if needed
-  double to_end = race_data.cars[iCar]->to_end;
+  double to_end = g_pSnapshot->cars[iCar]->to_end;
   double dist_to_end;
   if( seg->radius==0.0 )
   {
@@ -782,7 +692,7 @@ double TTrack3D::CarHeight( int iCar, double to_end_offset, double &banking )
 
   // Banking 
   double half_width = currentTrack->width/2;
-  double b = race_data.cars[iCar]->to_rgt-half_width;
+  double b = g_pSnapshot->cars[iCar]->to_rgt-half_width;
   double c = (seg->length-to_end)/seg->length;
   if( b<-half_width) b = -half_width;
   if( b>half_width ) b = half_width;
@@ -805,8 +715,8 @@ double TTrack3D::CarHeight( int iCar, double to_end_offset, double &banking )
  */
 double TTrack3D::CarAngWithRoad( int iCar )
 {
-  Car * car = race_data.cars[iCar];
-  int seg_id  = race_data.cars[iCar]->seg_id;
+  TCarSnapshot * car = g_pSnapshot->cars[iCar];
+  int seg_id  = g_pSnapshot->cars[iCar]->seg_id;
   segment * seg  = &(currentTrack->rgtwall[seg_id]);
 
   if( seg->radius==0.0 )
@@ -11,6 +11,12 @@
 #ifndef __G_TRACK3D_H
 #define __G_TRACK3D_H
 
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "g_scene_tree.h"
+
 //--------------------------------------------------------------------------
 //                           D E F I N E S
 //--------------------------------------------------------------------------
@@ -21,15 +27,6 @@
 //                             T Y P E S
 //--------------------------------------------------------------------------
 
-/**
- * To sort the transparent objects
- */
-struct Seen
-{
-  Model_3DS * pModel;
-  float dist;
-};
-
 /**
  * TTrack3D
  */
@@ -45,18 +42,19 @@ class TTrack3D
 
     float  m_aFrustum[6][4];
 
-    float SphereInFrustum( float x, float y, float z, float radius );
-    void ExtractFrustum();
+    GSceneTree m_oScene;           // segments, relief and objects (culling)
+    int  * m_aTransp;              // transparent items seen, far to near
+    int    m_iNumTransp;
 
-    void SelectionSort( Seen data[], int left, int right);
-    int Partition( Seen d[], int left, int right);
-    void Quicksort( Seen d[], int left, int right);
+    float SphereInFrustum( float x, float y, float z, float radius );
+    void SortTransparent( int iNumVisible );
 
   public:
     TTrack3D();
     ~TTrack3D();
 
     void Load();
+    void SetFrustum( float aFrustum[6][4] );
     void DrawSky( double cam_x, double cam_y );
     void Draw();
     void DrawRoad3D();
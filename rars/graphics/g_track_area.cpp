@@ -379,6 +379,11 @@ void GTrackArea::RemoveDuplicate()
 {
   int j=1;
 
+  if( m_iNumVertex==0 )
+  {
+    return;
+  }
+
   for( int i=1; i<m_iNumVertex; i++ )
   {
     Vertex last = m_aVertex[j-1];
@@ -395,6 +400,12 @@ void GTrackArea::RemoveDuplicate()
       j ++; 
     }
   }
+  // The loop is closed: the last point may be the first one again
+  if( j>1 && TGeom::Dist(m_aVertex[j-1], m_aVertex[0])<0.01 )
+  {
+    j --;
+  }
+  m_iNumVertex = j;
 }
 
 /**
@@ -20,6 +20,7 @@
 #include "g_tracked.h"
 #include "../misc.h"
 #include "g_global.h"
+#include "g_triangulate.h"
 
 //--------------------------------------------------------------------------
 //                           D E F I N E 
@@ -728,6 +729,8 @@ void TrackEditor::GenerateRelief(  )
   ////
   //// TO IMPROVE
   //// Bad and easy algorithm = copy all the point of the left side, of the right side 
+  //// The intersections are searched pair by pair, O(n^2); the sweep line of
+  //// step 9 needs areas without crossings (see g_triangulate.h)
   ////
   listArea.SplitArea( lft.area, rgt.area );
 
@@ -844,12 +847,10 @@ void TrackEditor::GenerateRelief(  )
   ////
   Vertex &v0 = listArea.m_aArea[iArea]->m_aVertex[0];
   double fStartAngle = atan2( (v0.y-fCenterY), (v0.x-fCenterX)*fRayY/fRayX ); // !!! atan2(y,x)
+  int iNumTrackExternal = listArea.m_aArea[iArea]->m_iNumVertex;
 
-  // Add the first point at the end a second time
-  listArea.m_aArea[iArea]->Add( v0 ); 
-
-  // Add the oval
-  for( i=0; i<=RELIEF_BORDER_NUM; i++ )
+  // Add the oval (a second loop, the track is a hole inside it)
+  for( i=0; i<RELIEF_BORDER_NUM; i++ )
   {
     double ang= fStartAngle + i*2.0*PI/RELIEF_BORDER_NUM; 
     v.SetXYZ( fCenterX + fRayX*cos(ang), fCenterY + fRayY*sin(ang), RELIEF_BORDER_HEIGHT + 15*sin(ang*10) );
@@ -865,71 +866,29 @@ void TrackEditor::GenerateRelief(  )
   ////
   //// Step 9: create 3D objects based on this model
   ////
+  //// The areas are triangulated by a sweep line (see g_triangulate.h)
+  //// in O(n log n). The external area has 2 loops: the oval outside and
+  //// the track inside.
+  ////
   int mat_relief = model.AddMaterialTexture( "", "grass_out" );
   for( iArea=0; iArea<model.numObjects; iArea++ )
   {
     Model_3DS::Object * obj = &model.aObject[iArea];
-    Vertex * v = obj->aRealVertex;
     iNumVertex = obj->numRealVertex;
 
     int mf_relief  = obj->AddMatFace( mat_relief );
 
-    bool * aUsed = new bool[iNumVertex];
-
-    for( i=0; i<iNumVertex; i++ )
+    GTriangulator tri( obj->aRealVertex, iNumVertex );
+    if( iArea==iPosExternal )
     {
-      aUsed[i] = false;
+      tri.AddLoop( 0, iNumTrackExternal, true );
+      tri.AddLoop( iNumTrackExternal, iNumVertex-iNumTrackExternal, false );
     }
-
-    int iNumUsed=0, last = 0;
-    i = 0;
-    while( iNumUsed+2<iNumVertex )
+    else
     {
-      int nxt  = NextUnused( i, aUsed, iNumVertex );
-      int nxt2 = NextUnused( nxt, aUsed, iNumVertex );
-
-      // Check if the triangle has the 3 points in a anti-clock direction
-      bool bAddPoint = false;
-      if( TGeom::LeftSide(v[i], v[nxt], v[nxt2])> 0.05 )
-      {
-        bAddPoint = true;
-        // Check if there is no point inside the new face
-        for( int j=0; j<iNumVertex; j++ )
-        {
-          if( j!=i && j!=nxt && j!=nxt2 )
-          {
-            double d1 = TGeom::LeftSide(v[i], v[nxt], v[j]);
-            if( d1<=0 ) continue;
-            double d2 = TGeom::LeftSide(v[nxt], v[nxt2], v[j]);
-            if( d2<=0 ) continue;
-            double d3 = TGeom::LeftSide(v[nxt2], v[i], v[j]);
-            if( d3<=0 ) continue;
-            bAddPoint = false;
-            break;
-          }
-        }
-      }
-
-      if( bAddPoint )
-      {
-        obj->AddFace( mf_relief, i, nxt, nxt2 );
-
-        aUsed[nxt] = true;
-        i = nxt2;
-        iNumUsed ++;
-        last = nxt2;
-      }
-      else
-      {
-        i = nxt;
-        if( nxt==last )
-        {
-          break;
-        }
-      }
+      tri.AddLoop( 0, iNumVertex, false );
     }
-
-    delete aUsed;
+    tri.Triangulate( obj, mf_relief );
   } // iArea
 
   ////
@@ -959,17 +918,6 @@ void TrackEditor::GenerateRelief(  )
   model.PostCalc();
 }
 
-int TrackEditor::NextUnused( int i, bool aUsed[], int iNumVertex )
-{
-  int nxt = i;
-  do
-  {
-    nxt = mod( nxt+1, iNumVertex );
-  } while( aUsed[nxt] );
-
-  return nxt;
-}
-
 //--------------------------------------------------------------------------
 // Code for the graphical editor
 //--------------------------------------------------------------------------
@@ -1081,10 +1029,15 @@ void TrackEditor::Rebuild( bool bSave, bool bCreateList )
       if( bCreateList )
       {
         track3D.m_aModel[i].CalculateSphere();
+        track3D.m_aModel[i].glCreateBuffers();
       }
     }
 
     GenerateRelief();
+    if( bCreateList )
+    {
+      track3D.m_ModelRelief.glCreateBuffers();
+    }
     if( bSave )
     {
       track3D.m_ModelRelief.Save( path, "relief.3ds" );
@@ -299,7 +299,6 @@ class TrackEditor
 
     void GenerateSubSegment3DS( Model_3DS::Object * pObject, int j, double end_nb_tex );
     void GenerateSubSegmentSide3DS( Model_3DS::Object * pObject, int j, double end_nb_tex, TrackEditorSideData * side, bool bTextureSide, double dx, double dy );
-    int NextUnused( int i, bool aUsed[], int iNumVertex );
 
     // Os specific functions
     void Refresh( bool bRebuildList=true );
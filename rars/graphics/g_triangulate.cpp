@@ -0,0 +1,673 @@
+//--------------------------------------------------------------------------
+//
+//    FILE: G_TRIANGULATE.CPP (portable)
+//
+//      - Triangulation of a polygon with holes by monotone partition
+//        (used for the relief around the track)
+//
+//    Version       Author          Date
+//      0.1
+//
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "g_triangulate.h"
+#include "../misc.h"
+
+//--------------------------------------------------------------------------
+//                           D E F I N E
+//--------------------------------------------------------------------------
+
+// Type of the vertices for the sweep line
+#define TRI_START    0  // both neighbours below, convex
+#define TRI_END      1  // both neighbours above, convex
+#define TRI_SPLIT    2  // both neighbours below, reflex
+#define TRI_MERGE    3  // both neighbours above, reflex
+#define TRI_REGULAR  4
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * @param aVertex     (in) vertices of the polygon (only x and y are used)
+ * @param iNumVertex  (in) number of vertices
+ */
+GTriangulator::GTriangulator( Vertex * aVertex, int iNumVertex )
+{
+  m_aVertex = aVertex;
+  m_iNumVertex = iNumVertex;
+  m_iNumLoop = 0;
+
+  m_aNext   = new int[iNumVertex];
+  m_aPrev   = new int[iNumVertex];
+  m_aType   = new int[iNumVertex];
+  m_aHelper = new int[iNumVertex];
+  m_aStatus = new int[iNumVertex];
+  m_aDiagA  = new int[2*iNumVertex];
+  m_aDiagB  = new int[2*iNumVertex];
+  m_iNumStatus = 0;
+  m_iNumDiag = 0;
+  m_fSweepY = 0;
+}
+
+/**
+ * Destructor
+ */
+GTriangulator::~GTriangulator()
+{
+  delete [] m_aNext;
+  delete [] m_aPrev;
+  delete [] m_aType;
+  delete [] m_aHelper;
+  delete [] m_aStatus;
+  delete [] m_aDiagA;
+  delete [] m_aDiagB;
+}
+
+/**
+ * Add a loop of vertices
+ *
+ * @param iFirst  (in) first vertex of the loop
+ * @param iNum    (in) number of vertices of the loop
+ * @param bHole   (in) true: the loop is a hole in the polygon
+ */
+void GTriangulator::AddLoop( int iFirst, int iNum, bool bHole )
+{
+  if( m_iNumLoop>=TRIANGULATE_MAX_LOOP )
+  {
+    exitOnError( "GTriangulator::AddLoop: TRIANGULATE_MAX_LOOP (%d) too small", TRIANGULATE_MAX_LOOP );
+  }
+  m_aLoopFirst[m_iNumLoop] = iFirst;
+  m_aLoopNum[m_iNumLoop] = iNum;
+  m_aLoopHole[m_iNumLoop] = bHole;
+  m_iNumLoop++;
+}
+
+/**
+ * Is a above b in the order of the sweep line ?
+ */
+bool GTriangulator::Above( int a, int b )
+{
+  Vertex &va = m_aVertex[a];
+  Vertex &vb = m_aVertex[b];
+  return va.y>vb.y || ( va.y==vb.y && va.x<vb.x );
+}
+
+/**
+ * Sort vertices in the order of the sweep line (Above): from the top
+ * (biggest y) to the bottom, from the left to the right for the same y.
+ * Heap sort, O(n log n) without a global for the comparison.
+ *
+ * @param order   (in/out) indices of the vertices
+ * @param num     (in) number of indices
+ */
+void GTriangulator::SortVertices( int * order, int num )
+{
+  int i, k, t;
+
+  // the heap keeps the lowest vertex on the top
+  for( i=num/2-1; i>=0; i-- )
+  {
+    SiftDown( order, i, num );
+  }
+  for( k=num-1; k>0; k-- )
+  {
+    t = order[0];  order[0] = order[k];  order[k] = t;
+    SiftDown( order, 0, k );
+  }
+}
+
+/**
+ * Move an entry of the heap of SortVertices down to its place
+ */
+void GTriangulator::SiftDown( int * order, int i, int num )
+{
+  int c, t;
+
+  while( (c=2*i+1)<num )
+  {
+    if( c+1<num && Above( order[c], order[c+1] ) )
+    {
+      c++;
+    }
+    if( !Above( order[i], order[c] ) )
+    {
+      break;
+    }
+    t = order[i];  order[i] = order[c];  order[c] = t;
+    i = c;
+  }
+}
+
+/**
+ * Cross product of (a,b) and (b,c): >0 when a,b,c turn to the left
+ */
+double GTriangulator::Cross( int a, int b, int c )
+{
+  return TGeom::LeftSide( m_aVertex[a], m_aVertex[b], m_aVertex[c] );
+}
+
+/**
+ * X of the edge (e, next of e) at the height y
+ */
+double GTriangulator::EdgeX( int e, double y )
+{
+  Vertex &a = m_aVertex[e];
+  Vertex &b = m_aVertex[m_aNext[e]];
+  if( a.y==b.y )
+  {
+    return a.x<b.x ? a.x : b.x;
+  }
+  return a.x + (y-a.y)*(b.x-a.x)/(b.y-a.y);
+}
+
+/**
+ * Insert the edge starting at the current vertex in the status
+ */
+void GTriangulator::StatusInsert( int e )
+{
+  double x = m_aVertex[e].x;
+  int lo = 0, hi = m_iNumStatus;
+  while( lo<hi )
+  {
+    int mid = (lo+hi)/2;
+    if( EdgeX(m_aStatus[mid], m_fSweepY)<x )
+    {
+      lo = mid+1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  for( int i=m_iNumStatus; i>lo; i-- )
+  {
+    m_aStatus[i] = m_aStatus[i-1];
+  }
+  m_aStatus[lo] = e;
+  m_iNumStatus++;
+}
+
+/**
+ * Remove an edge from the status
+ */
+void GTriangulator::StatusRemove( int e )
+{
+  int i = 0;
+  while( i<m_iNumStatus && m_aStatus[i]!=e )
+  {
+    i++;
+  }
+  if( i==m_iNumStatus )
+  {
+    return;
+  }
+  for( ; i<m_iNumStatus-1; i++ )
+  {
+    m_aStatus[i] = m_aStatus[i+1];
+  }
+  m_iNumStatus--;
+}
+
+/**
+ * Find the edge of the status directly on the left of a vertex
+ *
+ * @return the edge, -1 if none
+ */
+int GTriangulator::StatusLeft( int v )
+{
+  double x = m_aVertex[v].x;
+  int lo = 0, hi = m_iNumStatus;
+  while( lo<hi )
+  {
+    int mid = (lo+hi)/2;
+    if( EdgeX(m_aStatus[mid], m_fSweepY)<x )
+    {
+      lo = mid+1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo>0 ? m_aStatus[lo-1] : -1;
+}
+
+/**
+ * Add a diagonal of the monotone partition
+ */
+void GTriangulator::AddDiagonal( int a, int b )
+{
+  if( a==b || b<0 )
+  {
+    return;
+  }
+  m_aDiagA[m_iNumDiag] = a;
+  m_aDiagB[m_iNumDiag] = b;
+  m_iNumDiag++;
+}
+
+/**
+ * Sweep a line from the top to the bottom and add the diagonals that
+ * cut the polygon in y-monotone pieces
+ */
+void GTriangulator::MonotonePartition()
+{
+  int i, k, v, e, j;
+  int * order = new int[m_iNumVertex];
+  int num = 0;
+
+  for( i=0; i<m_iNumLoop; i++ )
+  {
+    for( k=0; k<m_aLoopNum[i]; k++ )
+    {
+      order[num++] = m_aLoopFirst[i]+k;
+    }
+  }
+  SortVertices( order, num );
+
+  // Type of each vertex
+  for( k=0; k<num; k++ )
+  {
+    v = order[k];
+    bool bPrevBelow = Above( v, m_aPrev[v] );
+    bool bNextBelow = Above( v, m_aNext[v] );
+    bool bConvex = Cross( m_aPrev[v], v, m_aNext[v] )>0;
+    if( bPrevBelow && bNextBelow )
+    {
+      m_aType[v] = bConvex ? TRI_START : TRI_SPLIT;
+    }
+    else if( !bPrevBelow && !bNextBelow )
+    {
+      m_aType[v] = bConvex ? TRI_END : TRI_MERGE;
+    }
+    else
+    {
+      m_aType[v] = TRI_REGULAR;
+    }
+    m_aHelper[v] = v;
+  }
+
+  // Sweep
+  m_iNumStatus = 0;
+  m_iNumDiag = 0;
+  for( k=0; k<num; k++ )
+  {
+    v = order[k];
+    e = m_aPrev[v];          // edge (prev, v)
+    m_fSweepY = m_aVertex[v].y;
+
+    switch( m_aType[v] )
+    {
+      case TRI_START:
+        StatusInsert( v );
+        m_aHelper[v] = v;
+        break;
+
+      case TRI_END:
+        if( m_aType[m_aHelper[e]]==TRI_MERGE )
+        {
+          AddDiagonal( v, m_aHelper[e] );
+        }
+        StatusRemove( e );
+        break;
+
+      case TRI_SPLIT:
+        j = StatusLeft( v );
+        if( j>=0 )
+        {
+          AddDiagonal( v, m_aHelper[j] );
+          m_aHelper[j] = v;
+        }
+        StatusInsert( v );
+        m_aHelper[v] = v;
+        break;
+
+      case TRI_MERGE:
+        if( m_aType[m_aHelper[e]]==TRI_MERGE )
+        {
+          AddDiagonal( v, m_aHelper[e] );
+        }
+        StatusRemove( e );
+        j = StatusLeft( v );
+        if( j>=0 )
+        {
+          if( m_aType[m_aHelper[j]]==TRI_MERGE )
+          {
+            AddDiagonal( v, m_aHelper[j] );
+          }
+          m_aHelper[j] = v;
+        }
+        break;
+
+      default:
+        if( Above(m_aPrev[v], v) )
+        {
+          // the interior is on the right of the vertex
+          if( m_aType[m_aHelper[e]]==TRI_MERGE )
+          {
+            AddDiagonal( v, m_aHelper[e] );
+          }
+          StatusRemove( e );
+          StatusInsert( v );
+          m_aHelper[v] = v;
+        }
+        else
+        {
+          j = StatusLeft( v );
+          if( j>=0 )
+          {
+            if( m_aType[m_aHelper[j]]==TRI_MERGE )
+            {
+              AddDiagonal( v, m_aHelper[j] );
+            }
+            m_aHelper[j] = v;
+          }
+        }
+        break;
+    }
+  }
+
+  delete [] order;
+}
+
+/**
+ * Add a face, anti-clockwise
+ *
+ * @return 1 if the face is added, 0 if it is flat
+ */
+int GTriangulator::AddFace( int a, int b, int c, Model_3DS::Object * obj, int iMatFace )
+{
+  double cross = Cross( a, b, c );
+  if( cross>0 )
+  {
+    obj->AddFace( iMatFace, a, b, c );
+  }
+  else if( cross<0 )
+  {
+    obj->AddFace( iMatFace, a, c, b );
+  }
+  else
+  {
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Triangulate a y-monotone face (vertices anti-clockwise)
+ *
+ * @return the number of faces added
+ */
+int GTriangulator::TriangulateMonotone( int * face, int num, Model_3DS::Object * obj, int iMatFace )
+{
+  int i, top = 0, bottom = 0, added = 0;
+
+  if( num<3 )
+  {
+    return 0;
+  }
+  if( num==3 )
+  {
+    return AddFace( face[0], face[1], face[2], obj, iMatFace );
+  }
+
+  for( i=1; i<num; i++ )
+  {
+    if( Above(face[i], face[top]) ) top = i;
+    if( Above(face[bottom], face[i]) ) bottom = i;
+  }
+
+  // Merge the 2 chains from the top to the bottom:
+  // anti-clockwise from the top is the left chain
+  int * sorted = new int[num];
+  bool * left  = new bool[num];
+  int l = (top+1)%num;                 // next of the left chain
+  int r = (top-1+num)%num;             // next of the right chain
+  sorted[0] = face[top];
+  left[0] = true;
+  for( i=1; i<num; i++ )
+  {
+    bool bLeftDone  = (l==(bottom+1)%num);
+    bool bRightDone = (r==bottom);
+    if( !bLeftDone && (bRightDone || Above(face[l], face[r])) )
+    {
+      sorted[i] = face[l];
+      left[i] = true;
+      l = (l+1)%num;
+    }
+    else
+    {
+      sorted[i] = face[r];
+      left[i] = false;
+      r = (r-1+num)%num;
+    }
+  }
+
+  // Stack
+  int * stack = new int[num];
+  bool * stack_left = new bool[num];
+  int n = 0;
+  stack[n] = sorted[0]; stack_left[n++] = left[0];
+  stack[n] = sorted[1]; stack_left[n++] = left[1];
+
+  for( i=2; i<num-1; i++ )
+  {
+    int u = sorted[i];
+    if( left[i]!=stack_left[n-1] )
+    {
+      // other chain: fan from u to all the stack
+      for( int s=0; s<n-1; s++ )
+      {
+        added += AddFace( u, stack[s], stack[s+1], obj, iMatFace );
+      }
+      int last = stack[n-1];
+      bool last_left = stack_left[n-1];
+      n = 0;
+      stack[n] = last; stack_left[n++] = last_left;
+      stack[n] = u; stack_left[n++] = left[i];
+    }
+    else
+    {
+      // same chain: cut the triangles visible from u
+      int popped = stack[--n];
+      while( n>0 )
+      {
+        double cross = Cross( u, popped, stack[n-1] );
+        bool bInside = left[i] ? cross<0 : cross>0;
+        if( !bInside )
+        {
+          break;
+        }
+        added += AddFace( u, popped, stack[n-1], obj, iMatFace );
+        popped = stack[--n];
+      }
+      stack[n] = popped; stack_left[n++] = left[i];
+      stack[n] = u; stack_left[n++] = left[i];
+    }
+  }
+
+  // the last vertex sees all the stack
+  int u = sorted[num-1];
+  for( int s=0; s<n-1; s++ )
+  {
+    added += AddFace( u, stack[s], stack[s+1], obj, iMatFace );
+  }
+
+  delete [] sorted;
+  delete [] left;
+  delete [] stack;
+  delete [] stack_left;
+  return added;
+}
+
+/**
+ * Find the faces made by the edges of the loops and the diagonals
+ * and triangulate them
+ *
+ * Each vertex has the list of its edges sorted by angle. The face on the
+ * left of the edge (a,b) continues with the edge of b that comes just
+ * before (b,a) turning anti-clockwise.
+ *
+ * @return the number of faces added
+ */
+int GTriangulator::TriangulateFaces( Model_3DS::Object * obj, int iMatFace )
+{
+  int i, k, v, added = 0;
+
+  // Edges of each vertex: next, prev and the diagonals
+  int * start = new int[m_iNumVertex+1];
+  int * count = new int[m_iNumVertex];
+  for( v=0; v<m_iNumVertex; v++ )
+  {
+    count[v] = 0;
+  }
+  for( i=0; i<m_iNumLoop; i++ )
+  {
+    for( k=0; k<m_aLoopNum[i]; k++ )
+    {
+      count[m_aLoopFirst[i]+k] = 2;
+    }
+  }
+  for( i=0; i<m_iNumDiag; i++ )
+  {
+    count[m_aDiagA[i]]++;
+    count[m_aDiagB[i]]++;
+  }
+  start[0] = 0;
+  for( v=0; v<m_iNumVertex; v++ )
+  {
+    start[v+1] = start[v]+count[v];
+    count[v] = 0;
+  }
+  int num_edge = start[m_iNumVertex];
+  int * to = new int[num_edge];
+  bool * inside = new bool[num_edge];  // the face on the left is inside the polygon
+  bool * done = new bool[num_edge];
+  double * ang = new double[num_edge];
+
+  #define ADD_EDGE( a, b, in ) \
+    { int p = start[a]+count[a]++; to[p] = b; inside[p] = in; done[p] = false; \
+      ang[p] = atan2( m_aVertex[b].y-m_aVertex[a].y, m_aVertex[b].x-m_aVertex[a].x ); }
+
+  for( i=0; i<m_iNumLoop; i++ )
+  {
+    for( k=0; k<m_aLoopNum[i]; k++ )
+    {
+      v = m_aLoopFirst[i]+k;
+      ADD_EDGE( v, m_aNext[v], true );
+      ADD_EDGE( v, m_aPrev[v], false );
+    }
+  }
+  for( i=0; i<m_iNumDiag; i++ )
+  {
+    ADD_EDGE( m_aDiagA[i], m_aDiagB[i], true );
+    ADD_EDGE( m_aDiagB[i], m_aDiagA[i], true );
+  }
+  #undef ADD_EDGE
+
+  // Sort the edges of each vertex by angle (insertion sort, few edges)
+  for( v=0; v<m_iNumVertex; v++ )
+  {
+    for( i=start[v]+1; i<start[v+1]; i++ )
+    {
+      int t = to[i]; bool in = inside[i]; double a = ang[i];
+      int j = i-1;
+      while( j>=start[v] && ang[j]>a )
+      {
+        to[j+1] = to[j]; inside[j+1] = inside[j]; ang[j+1] = ang[j];
+        j--;
+      }
+      to[j+1] = t; inside[j+1] = in; ang[j+1] = a;
+    }
+  }
+
+  // Walk around the faces
+  int * face = new int[m_iNumVertex];
+  for( v=0; v<m_iNumVertex; v++ )
+  {
+    for( i=start[v]; i<start[v+1]; i++ )
+    {
+      if( !inside[i] || done[i] )
+      {
+        continue;
+      }
+      int num = 0;
+      int a = v, e = i;
+      while( !done[e] && num<m_iNumVertex )
+      {
+        done[e] = true;
+        face[num++] = a;
+        int b = to[e];
+        // find (b,a) in the edges of b, take the one before
+        int j = start[b];
+        while( j<start[b+1] && to[j]!=a )
+        {
+          j++;
+        }
+        j = (j==start[b]) ? start[b+1]-1 : j-1;
+        a = b;
+        e = j;
+      }
+      added += TriangulateMonotone( face, num, obj, iMatFace );
+    }
+  }
+
+  delete [] face;
+  delete [] start;
+  delete [] count;
+  delete [] to;
+  delete [] inside;
+  delete [] done;
+  delete [] ang;
+  return added;
+}
+
+/**
+ * Triangulate the polygon and add the faces to a 3DS object
+ *
+ * @param obj       (in) object containing the vertices
+ * @param iMatFace  (in) material of the faces
+ * @return the number of faces added
+ */
+int GTriangulator::Triangulate( Model_3DS::Object * obj, int iMatFace )
+{
+  int i, k;
+
+  // Link the vertices of the loops, the interior always on the left:
+  // the polygon anti-clockwise and the holes clockwise
+  for( i=0; i<m_iNumLoop; i++ )
+  {
+    int first = m_aLoopFirst[i];
+    int num = m_aLoopNum[i];
+    double area = 0;
+    for( k=0; k<num; k++ )
+    {
+      Vertex &a = m_aVertex[first+k];
+      Vertex &b = m_aVertex[first+(k+1)%num];
+      area += a.x*b.y - b.x*a.y;
+    }
+    bool bForward = (area>0)!=m_aLoopHole[i];
+    for( k=0; k<num; k++ )
+    {
+      int v = first+k;
+      int nxt = first+(k+1)%num;
+      int prv = first+(k-1+num)%num;
+      m_aNext[v] = bForward ? nxt : prv;
+      m_aPrev[v] = bForward ? prv : nxt;
+    }
+  }
+
+  MonotonePartition();
+  return TriangulateFaces( obj, iMatFace );
+}
@@ -0,0 +1,99 @@
+/**
+ * FILE: G_TRIANGULATE.H (portable)
+ *
+ * Triangulation of a polygon with holes (the relief around the track)
+ *
+ * The polygon is cut in y-monotone pieces by a sweep line (the diagonals
+ * start from the split and merge vertices), then each piece is
+ * triangulated with a stack. The sort of the vertices is O(n log n); the
+ * status of the sweep line only holds the edges crossing a horizontal
+ * line, a few ones for a track.
+ *
+ * Limits: the loops must be simple (no crossing edges). The crossings of
+ * the sides of the track are removed before, by GTrackListArea::SplitArea
+ * (TrackEditor::GenerateRelief), which still tests the sides pair by pair,
+ * O(n^2). The tracks that cross themselves (figure8.trk) are not handled
+ * by the sweep line.
+ *
+ * History
+ *  ver. 0.1  Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __G_TRIANGULATE_H
+#define __G_TRIANGULATE_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "../3ds/model_3ds.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define TRIANGULATE_MAX_LOOP 8
+
+//--------------------------------------------------------------------------
+//                            T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Triangulation of the vertices of a Model_3DS object
+ *
+ * Usage:
+ *   GTriangulator tri( obj->aRealVertex, obj->numRealVertex );
+ *   tri.AddLoop( 0, n, true );          // the track: a hole
+ *   tri.AddLoop( n, m, false );         // the border of the relief
+ *   tri.Triangulate( obj, mf );         // add the faces to the object
+ *
+ * The loops may be in any direction; the faces are added anti-clockwise.
+ */
+class GTriangulator
+{
+  private:
+    Vertex * m_aVertex;
+    int      m_iNumVertex;
+    int      m_iNumLoop;
+    int      m_aLoopFirst[TRIANGULATE_MAX_LOOP];
+    int      m_aLoopNum[TRIANGULATE_MAX_LOOP];
+    bool     m_aLoopHole[TRIANGULATE_MAX_LOOP];
+
+    // Work arrays (one entry per vertex)
+    int    * m_aNext;       // next vertex of the loop (interior on the left)
+    int    * m_aPrev;       // previous vertex of the loop
+    int    * m_aType;       // type of vertex for the sweep
+    int    * m_aHelper;     // helper of the edge (vertex, next)
+    int    * m_aStatus;     // edges crossing the sweep line, from left to right
+    int      m_iNumStatus;
+    int    * m_aDiagA;      // diagonals of the monotone partition
+    int    * m_aDiagB;
+    int      m_iNumDiag;
+    double   m_fSweepY;
+
+    bool   Above( int a, int b );
+    void   SortVertices( int * order, int num );
+    void   SiftDown( int * order, int i, int num );
+    double Cross( int a, int b, int c );
+    double EdgeX( int e, double y );
+    void   StatusInsert( int e );
+    void   StatusRemove( int e );
+    int    StatusLeft( int v );
+    void   AddDiagonal( int a, int b );
+    void   MonotonePartition();
+    int    TriangulateFaces( Model_3DS::Object * obj, int iMatFace );
+    int    TriangulateMonotone( int * face, int num, Model_3DS::Object * obj, int iMatFace );
+    int    AddFace( int a, int b, int c, Model_3DS::Object * obj, int iMatFace );
+
+  public:
+    GTriangulator( Vertex * aVertex, int iNumVertex );
+    ~GTriangulator();
+
+    void AddLoop( int iFirst, int iNum, bool bHole );
+    int  Triangulate( Model_3DS::Object * obj, int iMatFace );
+};
+
+#endif // __G_TRIANGULATE_H
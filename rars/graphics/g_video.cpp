@@ -0,0 +1,746 @@
+//--------------------------------------------------------------------------
+//
+//    FILE: G_VIDEO.CPP (portable)
+//
+//    TVideo
+//      - Capture of a replayed race and rendering of the frames of a
+//        video file in threads, without display
+//    TViewVideo
+//      - Off-screen classical view used for the frames
+//
+//    Version       Author          Date
+//      0.1
+//
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifndef WIN32
+  #include <unistd.h>
+#endif
+
+#include "g_global.h"
+#include "g_video.h"
+#include "../globals.h"
+#include "../misc.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define PNG_BLOCK  65535        // max size of a stored deflate block
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+static unsigned int s_aCrcTable[256];
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Table of the CRC of the PNG chunks (called before the threads start)
+ */
+static void CrcInit()
+{
+  for( unsigned int n=0; n<256; n++ )
+  {
+    unsigned int c = n;
+    for( int k=0; k<8; k++ )
+    {
+      c = ( c&1 ) ? 0xedb88320u^(c>>1) : c>>1;
+    }
+    s_aCrcTable[n] = c;
+  }
+}
+
+static unsigned int Crc( unsigned int crc, const unsigned char * p, long size )
+{
+  for( long i=0; i<size; i++ )
+  {
+    crc = s_aCrcTable[(crc^p[i])&0xff]^(crc>>8);
+  }
+  return crc;
+}
+
+/**
+ * Write a 32 bits integer, most significant byte first (PNG, zlib)
+ */
+static void PutInt32( unsigned char * p, unsigned int i )
+{
+  p[0] = (unsigned char)(i>>24);
+  p[1] = (unsigned char)(i>>16);
+  p[2] = (unsigned char)(i>>8);
+  p[3] = (unsigned char)i;
+}
+
+/**
+ * Write one chunk of a PNG file
+ *
+ * @param out           (in) file
+ * @param sType         (in) type of the chunk ("IHDR", ...)
+ * @param p             (in) data
+ * @param size          (in) size of the data
+ * @return false after a write error
+ */
+static bool PngChunk( FILE * out, const char * sType, const unsigned char * p, long size )
+{
+  unsigned char head[8], tail[4];
+
+  PutInt32( head, (unsigned int)size );
+  memcpy( head+4, sType, 4 );
+  unsigned int crc = Crc( 0xffffffffu, head+4, 4 );
+  crc = Crc( crc, p, size );
+  PutInt32( tail, crc^0xffffffffu );
+
+  return fwrite( head, 8, 1, out )==1
+      && ( size==0 || (long)fwrite( p, 1, size, out )==size )
+      && fwrite( tail, 4, 1, out )==1;
+}
+
+//--------------------------------------------------------------------------
+//                         Class TViewVideo
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * @param x, y          (in) size of the frames
+ * @param fZoom         (in) zoom around the followed car (1: whole track)
+ */
+TViewVideo::TViewVideo( int x, int y, double fZoom ) : TViewClassical( x, y, true )
+{
+  m_OptionFlash = 0;
+  m_fZoom = fZoom;
+  m_aTrack = NULL;
+  if( m_fZoom<=1.0 )
+  {
+    // The constructor of TViewClassical has drawn the whole track
+    m_aTrack = new char[m_SizeX*m_SizeY];
+    memcpy( m_aTrack, m_Bitmap, m_SizeX*m_SizeY );
+  }
+  else
+  {
+    m_ScaleX *= m_fZoom;
+    m_ScaleY *= m_fZoom;
+  }
+}
+
+/**
+ * Destructor
+ */
+TViewVideo::~TViewVideo()
+{
+  if( m_aTrack!=NULL )
+  {
+    delete [] m_aTrack;
+  }
+  delete [] m_Bitmap;
+  m_Bitmap = NULL;
+}
+
+/**
+ * Draw the grass and the road
+ *
+ * @param x, y          (in) center of the view (zoom only)
+ */
+void TViewVideo::DrawBackground( double x, double y )
+{
+  if( m_aTrack!=NULL )
+  {
+    memcpy( m_Bitmap, m_aTrack, m_SizeX*m_SizeY );
+    return;
+  }
+  m_TopX = x - m_SizeX/(2*m_ScaleX);
+  m_TopY = y - m_SizeY/(2*m_ScaleY);
+  ClearBitmapTexture( m_TopX*m_ScaleX, m_TopY*m_ScaleY, 1/(m_ScaleX*40.0), &m_BitmapGrass );
+  DrawRoad();
+}
+
+/**
+ * Draw one car (same shape as TViewClassical::DrawCars)
+ *
+ * @param car           (in) position of the car
+ * @param nose_color    (in) colors of the car
+ * @param tail_color    (in)
+ */
+void TViewVideo::DrawCar( TVideoCar * car, int nose_color, int tail_color )
+{
+  Int2D v[4];
+  double x, y, xx, yy, sine, cosine, dx, dy;
+
+  double S_CARLEN = CARLEN*m_ScaleX;
+  double S_CARWID = CARWID*m_ScaleX;
+
+  x = (car->x-m_TopX)*m_ScaleX;
+  y = (car->y-m_TopY)*m_ScaleY;
+  sine = sin(car->ang);    cosine = cos(car->ang);
+  x += cosine * S_CARLEN/2 + sine * S_CARWID/2;    // left front corner coords
+  y += cosine * S_CARWID/2 - sine * S_CARLEN/2;
+  dx = -cosine*S_CARLEN;
+  dy = +sine*S_CARLEN;
+  v[0].x = (int) x; v[0].y = (int) y;
+  v[3].x = (int)( x+dx ); v[3].y = (int)( y+dy );
+  xx = x + sine*S_CARWID;
+  yy = y + cosine*S_CARWID;
+  v[1].x = (int) xx; v[1].y = (int) yy;
+  v[2].x = (int)( xx+dx ); v[2].y = (int)( yy+dy );
+  if( car->bCollision )
+  {
+    DrawPoly( v, 4, FLASH_COLOR );
+    return;
+  }
+  DrawPoly( v, 4, nose_color );
+  dx *= 0.3; dy *= 0.3;
+  v[2].x = (int)( xx+dx ); v[2].y = (int)( yy+dy );
+  v[3].x = (int)( x+dx ); v[3].y = (int)( y+dy );
+  DrawPoly( v, 4, tail_color );
+}
+
+//--------------------------------------------------------------------------
+//                           Class TVideo
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+TVideo::TVideo()
+{
+  m_aCar = NULL;
+  m_aStep = NULL;
+  m_iNumStep = 0;
+  m_iMaxStep = 0;
+  m_iNumCar = 0;
+  m_pOut = NULL;
+#ifndef WIN32
+  pthread_mutex_init( &m_oMutex, NULL );
+  pthread_cond_init( &m_oWritten, NULL );
+#endif
+}
+
+/**
+ * Destructor
+ */
+TVideo::~TVideo()
+{
+  if( m_aCar!=NULL )
+  {
+    delete [] m_aCar;
+    delete [] m_aStep;
+  }
+#ifndef WIN32
+  pthread_mutex_destroy( &m_oMutex );
+  pthread_cond_destroy( &m_oWritten );
+#endif
+}
+
+/**
+ * Start of the race: colors of the cars and of the palette
+ * (the palette is not loaded without display)
+ */
+void TVideo::Init()
+{
+  int i;
+
+  m_iNumCar = args.m_iNumCar;
+  m_iNumStep = 0;
+  for( i=0; i<m_iNumCar; i++ )
+  {
+    m_aNoseColor[i] = race_data.cars[i]->nose_color;
+    m_aTailColor[i] = race_data.cars[i]->tail_color;
+  }
+
+  Palette.Load( "bitmap/color.pl0" );
+  for( i=0; i<COLOR_MAX; i++ )
+  {
+    int r = 0, g = 0, b = 0;
+    if( i<=Palette.m_ColorNb )
+    {
+      r = Palette.m_Color[i].r*255/63;
+      g = Palette.m_Color[i].g*255/63;
+      b = Palette.m_Color[i].b*255/63;
+    }
+    m_aRGB[i][0] = (unsigned char)r;
+    m_aRGB[i][1] = (unsigned char)g;
+    m_aRGB[i][2] = (unsigned char)b;
+
+    // Full range BT.601 (C420jpeg)
+    m_aYUV[i][0] = (unsigned char)( 0.299*r + 0.587*g + 0.114*b + 0.5 );
+    m_aYUV[i][1] = (unsigned char)( 128.5 - 0.168736*r - 0.331264*g + 0.5*b );
+    m_aYUV[i][2] = (unsigned char)( 128.5 + 0.5*r - 0.418688*g - 0.081312*b );
+  }
+}
+
+/**
+ * Keep the positions of the cars after one step of the race
+ */
+void TVideo::Capture()
+{
+  if( m_iNumStep==m_iMaxStep )
+  {
+    int iMaxStep = m_iMaxStep==0 ? 1024 : m_iMaxStep*2;
+    TVideoCar * aCar = new TVideoCar[iMaxStep*m_iNumCar];
+    TVideoStep * aStep = new TVideoStep[iMaxStep];
+    if( m_aCar!=NULL )
+    {
+      memcpy( aCar, m_aCar, m_iNumStep*m_iNumCar*sizeof(TVideoCar) );
+      memcpy( aStep, m_aStep, m_iNumStep*sizeof(TVideoStep) );
+      delete [] m_aCar;
+      delete [] m_aStep;
+    }
+    m_aCar = aCar;
+    m_aStep = aStep;
+    m_iMaxStep = iMaxStep;
+  }
+
+  TVideoCar * car = m_aCar + m_iNumStep*m_iNumCar;
+  for( int i=0; i<m_iNumCar; i++ )
+  {
+    car[i].x = (float)race_data.cars[i]->x;
+    car[i].y = (float)race_data.cars[i]->y;
+    car[i].ang = (float)race_data.cars[i]->ang;
+    car[i].bCollision = race_data.cars[i]->collision_draw!=0;
+  }
+  TVideoStep * step = m_aStep + m_iNumStep;
+  step->fTime = (float)race_data.m_fElapsedTime;
+  step->iLeader = race_data.m_aCarInPos[0];
+  step->iLap = (int)race_data.cars[step->iLeader]->laps;
+  m_iNumStep++;
+}
+
+/**
+ * Number of rendering threads (-Vt or one per processor)
+ */
+int TVideo::NumThread()
+{
+  int n = args.m_iVideoThread;
+#ifndef WIN32
+  if( n<=0 )
+  {
+    n = (int)sysconf( _SC_NPROCESSORS_ONLN );
+  }
+#endif
+  return max( 1, min( n, MAX_VIDEO_THREADS ) );
+}
+
+/**
+ * End of the race: render all the frames and write the file
+ */
+void TVideo::Render()
+{
+  TVideoWorker aWorker[MAX_VIDEO_THREADS];
+  int i, iNumThread;
+
+  if( m_iNumStep<2 )
+  {
+    return;
+  }
+
+  // Format
+  const char * ext = strrchr( args.m_sVideoFile, '.' );
+  m_iFormat = VIDEO_RAW;
+  if( ext!=NULL && ( strcmp( ext, ".y4m" )==0 || strcmp( ext, ".Y4M" )==0 ) )
+  {
+    m_iFormat = VIDEO_Y4M;
+  }
+  else if( ext!=NULL && ( strcmp( ext, ".png" )==0 || strcmp( ext, ".PNG" )==0 ) )
+  {
+    m_iFormat = VIDEO_PNG;
+  }
+  m_iSizeX = args.m_iVideoSizeX&~1;   // even for the 4:2:0 chroma
+  m_iSizeY = args.m_iVideoSizeY&~1;
+  if( m_iSizeX<16 || m_iSizeY<16 )
+  {
+    warning( "TVideo::Render: the video is too small" );
+    return;
+  }
+  m_iNumFrame = (int)( (m_aStep[m_iNumStep-1].fTime-m_aStep[0].fTime)*args.m_iVideoFps )+1;
+  m_iNumChunk = (m_iNumFrame+VIDEO_CHUNK-1)/VIDEO_CHUNK;
+  m_iNextChunk = 0;
+  m_iNextWrite = 0;
+  m_iNumDone = 0;
+  m_bError = false;
+
+  long iPixel = (long)m_iSizeX*m_iSizeY;
+  long iBuffer;
+  if( m_iFormat==VIDEO_PNG )
+  {
+    // zlib header, stored blocks, adler32
+    long raw = (long)(m_iSizeX+1)*m_iSizeY;
+    iBuffer = 2+((raw+PNG_BLOCK-1)/PNG_BLOCK)*5+raw+4;
+    m_iFrameSize = 0;
+    CrcInit();
+  }
+  else
+  {
+    m_iFrameSize = ( m_iFormat==VIDEO_Y4M ) ? 6+iPixel*3/2 : iPixel*3;
+    iBuffer = m_iFrameSize*VIDEO_CHUNK;
+    m_pOut = fopen( args.m_sVideoFile, "wb" );
+    if( m_pOut==NULL )
+    {
+      warning( "TVideo::Render: can not write %s", args.m_sVideoFile );
+      return;
+    }
+    if( m_iFormat==VIDEO_Y4M )
+    {
+      fprintf( m_pOut, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_iSizeX, m_iSizeY, args.m_iVideoFps );
+    }
+  }
+
+  // One view per thread: the views draw in their own bitmap
+  double fZoom = args.m_iVideoFollow==VIDEO_WHOLE_TRACK ? 1.0 : max( 1, args.m_iVideoZoom );
+  iNumThread = NumThread();
+  for( i=0; i<iNumThread; i++ )
+  {
+    aWorker[i].m_pVideo = this;
+    aWorker[i].m_pView = new TViewVideo( m_iSizeX, m_iSizeY, fZoom );
+    aWorker[i].m_aBuffer = new unsigned char[iBuffer];
+    aWorker[i].m_aPng = ( m_iFormat==VIDEO_PNG ) ? new unsigned char[(m_iSizeX+1)*m_iSizeY] : NULL;
+  }
+
+  printf( "Rendering %d frames (%dx%d, %d threads) to %s\n", m_iNumFrame, m_iSizeX, m_iSizeY, iNumThread, args.m_sVideoFile );
+
+#ifndef WIN32
+  int iNumStarted = 0;
+  for( i=1; i<iNumThread; i++ )
+  {
+    if( pthread_create( &aWorker[i].m_oThread, NULL, WorkerThread, &aWorker[i] )!=0 )
+    {
+      break;
+    }
+    iNumStarted++;
+  }
+  Work( &aWorker[0] );
+  for( i=1; i<=iNumStarted; i++ )
+  {
+    pthread_join( aWorker[i].m_oThread, NULL );
+  }
+#else
+  Work( &aWorker[0] );
+#endif
+
+  for( i=0; i<iNumThread; i++ )
+  {
+    delete aWorker[i].m_pView;
+    delete [] aWorker[i].m_aBuffer;
+    if( aWorker[i].m_aPng!=NULL )
+    {
+      delete [] aWorker[i].m_aPng;
+    }
+  }
+  if( m_pOut!=NULL )
+  {
+    if( fclose( m_pOut )!=0 )
+    {
+      m_bError = true;
+    }
+    m_pOut = NULL;
+  }
+  if( m_bError )
+  {
+    warning( "TVideo::Render: error writing %s", args.m_sVideoFile );
+  }
+  else if( m_iFormat==VIDEO_RAW )
+  {
+    printf( "Raw video: rgb24 %dx%d at %d fps\n", m_iSizeX, m_iSizeY, args.m_iVideoFps );
+  }
+}
+
+#ifndef WIN32
+/**
+ * Rendering thread
+ */
+void * TVideo::WorkerThread( void * arg )
+{
+  TVideoWorker * worker = (TVideoWorker *)arg;
+  worker->m_pVideo->Work( worker );
+  return NULL;
+}
+#endif
+
+/**
+ * Render chunks of frames until all are rendered. The chunks are written
+ * in the order of the frames: a thread waits until the previous chunks
+ * are written.
+ *
+ * @param worker        (in) view and buffers of the thread
+ */
+void TVideo::Work( TVideoWorker * worker )
+{
+  Lock();
+  while( !m_bError && m_iNextChunk<m_iNumChunk )
+  {
+    int iChunk = m_iNextChunk++;
+    Unlock();
+
+    int iFirst = iChunk*VIDEO_CHUNK;
+    int iLast = min( iFirst+VIDEO_CHUNK, m_iNumFrame );
+    bool bOk = true;
+    for( int f=iFirst; f<iLast && bOk; f++ )
+    {
+      RenderFrame( worker->m_pView, f );
+      if( m_iFormat==VIDEO_PNG )
+      {
+        bOk = WritePng( worker, f );
+      }
+      else
+      {
+        Convert( worker->m_pView, worker->m_aBuffer+(f-iFirst)*m_iFrameSize );
+      }
+    }
+
+    Lock();
+    if( !bOk )
+    {
+      m_bError = true;
+    }
+    if( m_iFormat!=VIDEO_PNG )
+    {
+#ifndef WIN32
+      while( m_iNextWrite!=iChunk && !m_bError )
+      {
+        pthread_cond_wait( &m_oWritten, &m_oMutex );
+      }
+#endif
+      if( !m_bError && (int)fwrite( worker->m_aBuffer, m_iFrameSize, iLast-iFirst, m_pOut )!=iLast-iFirst )
+      {
+        m_bError = true;
+      }
+      m_iNextWrite++;
+#ifndef WIN32
+      pthread_cond_broadcast( &m_oWritten );
+#endif
+    }
+    m_iNumDone += iLast-iFirst;
+  }
+  Unlock();
+}
+
+void TVideo::Lock()
+{
+#ifndef WIN32
+  pthread_mutex_lock( &m_oMutex );
+#endif
+}
+
+void TVideo::Unlock()
+{
+#ifndef WIN32
+  pthread_mutex_unlock( &m_oMutex );
+#endif
+}
+
+/**
+ * Draw one frame: the positions are interpolated between the two steps
+ * of the race around the time of the frame.
+ *
+ * @param view          (in) bitmap of the thread
+ * @param iFrame        (in) number of the frame
+ */
+void TVideo::RenderFrame( TViewVideo * view, int iFrame )
+{
+  TVideoCar aCar[MAX_CARS];
+  char s[64];
+  int i;
+
+  double fStep = (double)iFrame/(args.m_iVideoFps*delta_time);
+  int iStep = (int)fStep;
+  if( iStep>=m_iNumStep-1 )
+  {
+    iStep = m_iNumStep-2;
+    fStep = iStep+1;
+  }
+  double a = fStep-iStep;
+  TVideoCar * car0 = m_aCar+iStep*m_iNumCar;
+  TVideoCar * car1 = car0+m_iNumCar;
+  for( i=0; i<m_iNumCar; i++ )
+  {
+    double ang = car1[i].ang-car0[i].ang;
+    if( ang>PI )
+    {
+      ang -= 2*PI;
+    }
+    else if( ang<-PI )
+    {
+      ang += 2*PI;
+    }
+    aCar[i].x = (float)( car0[i].x+(car1[i].x-car0[i].x)*a );
+    aCar[i].y = (float)( car0[i].y+(car1[i].y-car0[i].y)*a );
+    aCar[i].ang = (float)( car0[i].ang+ang*a );
+    aCar[i].bCollision = car0[i].bCollision || car1[i].bCollision;
+  }
+  TVideoStep * step = m_aStep+( a<0.5 ? iStep : iStep+1 );
+
+  // Track and cars
+  int iFollow = args.m_iVideoFollow;
+  if( iFollow==VIDEO_LEADER )
+  {
+    iFollow = step->iLeader;
+  }
+  if( iFollow>=m_iNumCar )
+  {
+    iFollow = 0;
+  }
+  if( iFollow>=0 )
+  {
+    view->DrawBackground( aCar[iFollow].x, aCar[iFollow].y );
+  }
+  else
+  {
+    view->DrawBackground( 0, 0 );
+  }
+  for( i=0; i<m_iNumCar; i++ )
+  {
+    view->DrawCar( &aCar[i], m_aNoseColor[i], m_aTailColor[i] );
+  }
+
+  // Lap and time
+  double fTime = m_aStep[0].fTime+iFrame/(double)args.m_iVideoFps;
+  int iMin = (int)( fTime/60.0 );
+  sprintf( s, "lap %d/%ld %d:%04.1f", min( step->iLap+1, (int)args.m_iNumLap ), args.m_iNumLap, iMin, fTime-iMin*60.0 );
+  view->DrawStringOpaque( s, 1, 1 );
+  if( iFollow>=0 )
+  {
+    sprintf( s, "%.16s", drivers[iFollow]->getName() );
+    view->DrawStringOpaque( s, 1, view->m_SizeY-9 );
+  }
+}
+
+/**
+ * Convert the bitmap of a view (palette) to a frame of the file
+ *
+ * @param view          (in) bitmap
+ * @param out           (out) RGB24 or "FRAME" and YUV 4:2:0
+ */
+void TVideo::Convert( TViewVideo * view, unsigned char * out )
+{
+  const unsigned char * p = (const unsigned char *)view->m_Bitmap;
+  long iPixel = (long)m_iSizeX*m_iSizeY;
+  long i;
+  int x, y;
+
+  if( m_iFormat==VIDEO_RAW )
+  {
+    for( i=0; i<iPixel; i++ )
+    {
+      const unsigned char * c = m_aRGB[p[i]];
+      *out++ = c[0];
+      *out++ = c[1];
+      *out++ = c[2];
+    }
+    return;
+  }
+
+  memcpy( out, "FRAME\n", 6 );
+  unsigned char * pY = out+6;
+  unsigned char * pU = pY+iPixel;
+  unsigned char * pV = pU+iPixel/4;
+  for( i=0; i<iPixel; i++ )
+  {
+    pY[i] = m_aYUV[p[i]][0];
+  }
+  for( y=0; y<m_iSizeY; y+=2 )
+  {
+    const unsigned char * p0 = p+(long)y*m_iSizeX;
+    const unsigned char * p1 = p0+m_iSizeX;
+    for( x=0; x<m_iSizeX; x+=2 )
+    {
+      *pU++ = (unsigned char)( ( m_aYUV[p0[x]][1]+m_aYUV[p0[x+1]][1]+m_aYUV[p1[x]][1]+m_aYUV[p1[x+1]][1]+2 )>>2 );
+      *pV++ = (unsigned char)( ( m_aYUV[p0[x]][2]+m_aYUV[p0[x+1]][2]+m_aYUV[p1[x]][2]+m_aYUV[p1[x+1]][2]+2 )>>2 );
+    }
+  }
+}
+
+/**
+ * Write one frame in a PNG file (8 bits with the palette of rars). The
+ * image data is not compressed (stored deflate blocks): no zlib needed.
+ *
+ * @param worker        (in) view and buffers of the thread
+ * @param iFrame        (in) number of the frame
+ * @return false after a write error
+ */
+bool TVideo::WritePng( TVideoWorker * worker, int iFrame )
+{
+  static const unsigned char aSignature[8] = { 137, 'P', 'N', 'G', 13, 10, 26, 10 };
+  unsigned char aHeader[13];
+  unsigned char aPalette[COLOR_MAX*3];
+  char sFileName[160];
+  int i, y;
+
+  // race.png -> race_000001.png
+  int len = (int)strlen( args.m_sVideoFile )-4;
+  sprintf( sFileName, "%.*s_%06d.png", min( len, 140 ), args.m_sVideoFile, iFrame+1 );
+
+  // Rows with the filter "none"
+  unsigned char * raw = worker->m_aPng;
+  const char * p = worker->m_pView->m_Bitmap;
+  for( y=0; y<m_iSizeY; y++ )
+  {
+    *raw++ = 0;
+    memcpy( raw, p, m_iSizeX );
+    raw += m_iSizeX;
+    p += m_iSizeX;
+  }
+
+  // zlib stream
+  long iRaw = (long)(m_iSizeX+1)*m_iSizeY;
+  unsigned char * out = worker->m_aBuffer;
+  unsigned int s1 = 1, s2 = 0;
+  *out++ = 0x78;
+  *out++ = 0x01;
+  raw = worker->m_aPng;
+  for( long pos=0; pos<iRaw; pos+=PNG_BLOCK )
+  {
+    long size = min( iRaw-pos, (long)PNG_BLOCK );
+    *out++ = ( pos+size==iRaw ) ? 1 : 0;
+    *out++ = (unsigned char)size;
+    *out++ = (unsigned char)(size>>8);
+    *out++ = (unsigned char)~size;
+    *out++ = (unsigned char)(~size>>8);
+    memcpy( out, raw+pos, size );
+    out += size;
+    for( long j=0; j<size; j++ )
+    {
+      s1 = ( s1+raw[pos+j] )%65521;
+      s2 = ( s2+s1 )%65521;
+    }
+  }
+  PutInt32( out, (s2<<16)|s1 );
+  out += 4;
+
+  PutInt32( aHeader, m_iSizeX );
+  PutInt32( aHeader+4, m_iSizeY );
+  aHeader[8] = 8;                 // bits per pixel
+  aHeader[9] = 3;                 // palette
+  aHeader[10] = aHeader[11] = aHeader[12] = 0;
+  for( i=0; i<COLOR_MAX; i++ )
+  {
+    aPalette[i*3] = m_aRGB[i][0];
+    aPalette[i*3+1] = m_aRGB[i][1];
+    aPalette[i*3+2] = m_aRGB[i][2];
+  }
+
+  FILE * f = fopen( sFileName, "wb" );
+  if( f==NULL )
+  {
+    return false;
+  }
+  bool bOk = fwrite( aSignature, 8, 1, f )==1
+          && PngChunk( f, "IHDR", aHeader, 13 )
+          && PngChunk( f, "PLTE", aPalette, COLOR_MAX*3 )
+          && PngChunk( f, "IDAT", worker->m_aBuffer, out-worker->m_aBuffer )
+          && PngChunk( f, "IEND", NULL, 0 );
+  if( fclose( f )!=0 )
+  {
+    bOk = false;
+  }
+  return bOk;
+}
@@ -0,0 +1,170 @@
+/**
+ * FILE: G_VIDEO.H (portable)
+ *
+ * Rendering of a replayed race in a video file, without display
+ *
+ * With -mp and -V, the movie is replayed without graphics. After each
+ * step, the positions of the cars are kept in memory (TVideo::Capture).
+ * At the end of the race, the frames are resampled at the rate of the
+ * video and drawn off-screen in the bitmaps of the classical 2D view
+ * (TViewVideo) by several threads. Each thread renders a range of
+ * consecutive frames; the ranges are written in order in the file.
+ *
+ * The format depends on the extension of the file:
+ *   .y4m : YUV4MPEG2 (4:2:0), read by ffmpeg, mplayer, ...
+ *   .png : one PNG image per frame (race_000001.png, ...)
+ *   other: raw RGB24 frames
+ *
+ * Usage:
+ *   rars -nd -mprace -Vrace.y4m -Vs640x480 -Vr25 -Vf -Vz4 4 10 oval2.trk
+ *
+ * History
+ *  ver. 0.1  Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __G_VIDEO_H
+#define __G_VIDEO_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#ifndef WIN32
+  #include <pthread.h>
+#endif
+#include <stdio.h>
+#include "g_view.h"
+#include "../globals.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_VIDEO_THREADS 8     // rendering threads
+#define VIDEO_CHUNK       8     // consecutive frames rendered by a thread
+
+#define VIDEO_RAW         0     // format of the file
+#define VIDEO_Y4M         1
+#define VIDEO_PNG         2
+
+#define VIDEO_WHOLE_TRACK -2    // Args::m_iVideoFollow
+#define VIDEO_LEADER      -1
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+class TVideo;
+
+/**
+ * Position of a car in one step of the race
+ */
+struct TVideoCar
+{
+  float x, y;
+  float ang;
+  bool  bCollision;
+};
+
+/**
+ * State of the race in one step
+ */
+struct TVideoStep
+{
+  float fTime;                  // race_data.m_fElapsedTime
+  int   iLeader;
+  int   iLap;                   // laps of the leader
+};
+
+/**
+ * Off-screen classical view. The whole track is drawn once; when a car
+ * is followed, the track is drawn again around it at each frame.
+ */
+class TViewVideo: public TViewClassical
+{
+  private:
+    char * m_aTrack;            // bitmap of the whole track
+    double m_fZoom;
+
+  public:
+    TViewVideo( int x, int y, double fZoom );
+    virtual ~TViewVideo();
+
+    void DrawBackground( double x, double y );
+    void DrawCar( TVideoCar * car, int nose_color, int tail_color );
+};
+
+/**
+ * Thread rendering frames
+ */
+struct TVideoWorker
+{
+  TVideo        * m_pVideo;
+  TViewVideo    * m_pView;
+  unsigned char * m_aBuffer;    // converted frames of one chunk
+  unsigned char * m_aPng;       // PNG: filtered rows
+#ifndef WIN32
+  pthread_t       m_oThread;
+#endif
+};
+
+/**
+ * Capture of a replayed race and rendering of the video
+ *
+ * Usage:
+ *   video.Init();              // RaceInit
+ *   video.Capture();           // after each step of the race
+ *   video.Render();            // RaceClose
+ */
+class TVideo
+{
+  private:
+    TVideoCar  * m_aCar;        // m_iNumCar cars per step
+    TVideoStep * m_aStep;
+    int          m_iNumStep;
+    int          m_iMaxStep;
+    int          m_iNumCar;
+    int          m_aNoseColor[MAX_CARS];
+    int          m_aTailColor[MAX_CARS];
+
+    int          m_iFormat;
+    int          m_iSizeX, m_iSizeY;
+    long         m_iFrameSize;  // bytes of one frame in the file
+    int          m_iNumFrame;
+    FILE       * m_pOut;
+    unsigned char m_aRGB[COLOR_MAX][3];
+    unsigned char m_aYUV[COLOR_MAX][3];
+
+    int          m_iNumChunk;
+    int          m_iNextChunk;  // next chunk to render
+    int          m_iNextWrite;  // next chunk to write (in order)
+    int          m_iNumDone;
+    bool         m_bError;
+
+#ifndef WIN32
+    pthread_mutex_t m_oMutex;
+    pthread_cond_t  m_oWritten; // a chunk is written
+
+    static void * WorkerThread( void * arg );
+#endif
+    void   Lock();
+    void   Unlock();
+    void   Work( TVideoWorker * worker );
+    void   RenderFrame( TViewVideo * view, int iFrame );
+    void   Convert( TViewVideo * view, unsigned char * out );
+    bool   WritePng( TVideoWorker * worker, int iFrame );
+    int    NumThread();
+
+  public:
+    TVideo();
+    ~TVideo();
+
+    void   Init();
+    void   Capture();
+    void   Render();
+};
+
+#endif // __G_VIDEO_H
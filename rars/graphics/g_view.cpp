@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "g_global.h"
 
 //--------------------------------------------------------------------------
@@ -33,12 +34,16 @@
  */
 TView::TView( int x, int  y, bool bVirtual ) : TLowGraphic( x, y, bVirtual )
 {
-  m_iFollowCar = g_ViewManager->GetFollowCar();
+  m_iFollowCar = g_ViewManager!=NULL ? g_ViewManager->GetFollowCar() : 0; // NULL without display (TViewVideo)
   m_OptionShowBoard = 1;
   m_TopX = 0;
   m_TopY = 0;
   m_SpeedX = 0;
   m_SpeedY = 0;
+  m_aLayer = NULL;
+  m_iLayerSize = 0;
+  m_bLayer = false;
+  m_iNumOverlay = 0;
 }
 
 /**
@@ -46,6 +51,7 @@ TView::TView( int x, int  y, bool bVirtual ) : TLowGraphic( x, y, bVirtual )
  */
 TView::~TView()
 {
+  delete[] m_aLayer;
 }
 
 /**
@@ -91,3 +97,88 @@ void TView::DrawBorder(Int2D v[])
   DrawLine(v[1], v[2], COLOR_WHITE);
 }
 
+
+/**
+ * Keep a copy of the bitmap (the track without the cars) in the layer.
+ * The cars drawn after are erased with RestoreOverlay.
+ */
+void TView::SaveLayer()
+{
+  long size = m_SizeX*m_SizeY;
+  if( m_iLayerSize!=size )
+  {
+    delete[] m_aLayer;
+    m_aLayer = new char[size];
+    m_iLayerSize = size;
+  }
+  memcpy( m_aLayer, m_Bitmap, size );
+  m_bLayer = true;
+  m_iNumOverlay = 0;
+}
+
+/**
+ * Copy back the layer on the rectangles drawn since the last frame
+ */
+void TView::RestoreOverlay()
+{
+  for( int i=0; i<m_iNumOverlay; i++ )
+  {
+    IntRect * r = &m_aOverlay[i];
+    long pos = r->y1*m_SizeX+r->x1;
+    int len = r->x2-r->x1+1;
+    for( int y=r->y1; y<=r->y2; y++ )
+    {
+      memcpy( m_Bitmap+pos, m_aLayer+pos, len );
+      pos += m_SizeX;
+    }
+    AddDirty( r->x1, r->y1, r->x2, r->y2 );
+  }
+  m_iNumOverlay = 0;
+}
+
+/**
+ * A rectangle is drawn over the layer: it is dirty in this frame and it
+ * will be restored in the next one.
+ *
+ * @param x1, y1        (in) top left corner
+ * @param x2, y2        (in) bottom right corner (included)
+ */
+void TView::AddOverlay( int x1, int y1, int x2, int y2 )
+{
+  if( x1<0 ) x1 = 0;
+  if( y1<0 ) y1 = 0;
+  if( x2>m_MaxX ) x2 = m_MaxX;
+  if( y2>m_MaxY ) y2 = m_MaxY;
+  if( x1>x2 || y1>y2 ) return;
+
+  AddDirty( x1, y1, x2, y2 );
+  if( m_iNumOverlay==MAX_OVERLAY )
+  {
+    // full: enlarge the last one
+    IntRect * r = &m_aOverlay[MAX_OVERLAY-1];
+    r->x1 = min( r->x1, x1 ); r->y1 = min( r->y1, y1 );
+    r->x2 = max( r->x2, x2 ); r->y2 = max( r->y2, y2 );
+    return;
+  }
+  IntRect * r = &m_aOverlay[m_iNumOverlay++];
+  r->x1 = x1; r->y1 = y1;
+  r->x2 = x2; r->y2 = y2;
+}
+
+/**
+ * Add the bounding box of a polygon in the overlay
+ *
+ * @param v             (in) vertices
+ * @param v_nb          (in) number of vertices
+ */
+void TView::AddOverlay( Int2D v[], int v_nb )
+{
+  int x1 = v[0].x, y1 = v[0].y;
+  int x2 = x1, y2 = y1;
+  for( int i=1; i<v_nb; i++ )
+  {
+    x1 = min( x1, v[i].x ); y1 = min( y1, v[i].y );
+    x2 = max( x2, v[i].x ); y2 = max( y2, v[i].y );
+  }
+  AddOverlay( x1-1, y1-1, x2+1, y2+1 );
+}
@@ -32,6 +32,9 @@
 //                           I N C L U D E
 //--------------------------------------------------------------------------
 
+#ifndef WIN32
+  #include <pthread.h>
+#endif
 #include "g_bitmap.h"
 #include "g_define.h"
 
@@ -63,6 +66,12 @@
 #define  TEXT_COLOR       COLOR_BLACK
 #define  FLASH_COLOR      COLOR_WHITE
 
+#define  DIRTY_TILE_SHIFT 5           // tiles of 32x32 pixels in the damage list
+#define  MAX_DIRTY_RECT   64          // rectangles returned by GetDirtyRects
+#define  MAX_OVERLAY      (2*MAX_CARS+16) // rectangles drawn over the track layer
+
+#define  RENDER_PERIOD    20          // ms between two frames of the render thread
+
 //--------------------------------------------------------------------------
 //                           F O R W A R D
 //--------------------------------------------------------------------------
@@ -87,6 +96,12 @@ typedef struct
 
 typedef Int2D Quad2D[4];
 
+typedef struct
+{
+  int x1, y1;                 // top left
+  int x2, y2;                 // bottom right (included)
+} IntRect;
+
 typedef struct
 {
   int r;                      // red
@@ -120,8 +135,8 @@ class TPalette
     TColor  m_Color[COLOR_MAX];
     // operations
     void Init();
-  private:
     void Load( const char * file_name );
+  private:
     void Set();
 };
 
@@ -129,6 +144,10 @@ class TLowGraphic
 {
   // attributes
     long m_ScreenSizeX;          // width of the screen (normally=size_x)
+    unsigned char * m_aDirty;    // damage list: one byte by tile, !=0 if the tile changed
+    int m_iTileX, m_iTileY;      // number of tiles
+    void FillPoly( Int2D v[], int v_nb, int c, TBitmap * t, double sine, double cosine );
+    void AllocDirty();
   public:
     long m_SizeX, m_SizeY;       // size of the bitmap
     int m_MaxX, m_MaxY;          // size_x-1, size_y-1
@@ -136,6 +155,7 @@ class TLowGraphic
     bool m_bVirtual;             // A virtual graphic is not associated with a control on the screen
     int m_ColorNb;
     TBitmap m_BitmapFont;
+    bool m_bDamage;              // the view adds its damage in the list (else all the bitmap is dirty)
 
   // constructor, destructor
     TLowGraphic( int x, int y, bool bVirtual=false );
@@ -159,6 +179,10 @@ class TLowGraphic
     void DrawStringOpaque( const char * text, int x, int y, int foreground=oBLACK, int background=oLIGHTGRAY );
     void FlipY();
     unsigned char * GetOneBitPerPixel( int color );
+  // damage list
+    void AddDirty( int x1, int y1, int x2, int y2 );
+    void SetAllDirty();
+    int GetDirtyRects( IntRect r[], int max );
 };
 
 class TView: public TLowGraphic 
@@ -171,8 +195,19 @@ class TView: public TLowGraphic
     double m_CenterX, m_CenterY, m_CenterZ;
     double m_SpeedX, m_SpeedY;
 
+    // track layer: the bitmap without the cars
+    char * m_aLayer;
+    long m_iLayerSize;
+    bool m_bLayer;                    // m_aLayer is the current track
+    IntRect m_aOverlay[MAX_OVERLAY];  // drawn over the layer since the last frame
+    int m_iNumOverlay;
+
     // Draws a border to a segment
     void DrawBorder(Int2D v[]);
+    void SaveLayer();
+    void RestoreOverlay();
+    void AddOverlay( int x1, int y1, int x2, int y2 );
+    void AddOverlay( Int2D v[], int v_nb );
 
   public:
     int m_OptionShowBoard;
@@ -289,6 +324,8 @@ class TView2D: public TView
     int m_dFollowCar;
     TBitmap m_BitmapGrass;
     double m_Zoom;
+    double m_fLastTopX, m_fLastTopY;  // camera of the last frame
+    double m_fLastScale;
 
   // operations
 
@@ -349,6 +386,7 @@ class TView3D: public TView
     void GL_DrawWheel3DS( TWheel3D * wheel, int i, float x, float y );
     void GL_DrawCarName( int i );
     void Load3DSWheel( TWheel3D * wheel, const char * filename );
+    bool Wheel3DSReady( TWheel3D * wheel );
     void GL_CreateList();
     void ExtractFrustum();
     float SphereInFrustum( float x, float y, float z, float radius );
@@ -382,6 +420,21 @@ class TViewManager
     int m_iLastViewMode;
     int m_iSizeOffX;
     int m_iSizeOffY;
+
+    // render thread
+#ifndef WIN32
+    pthread_t m_oRenderThread;
+    pthread_mutex_t m_oViewMutex;     // the views are being drawn or changed
+    static void * RenderThread( void * arg );
+#endif
+    bool m_bRenderThread;             // the render thread is running
+    volatile bool m_bStopRender;
+    double m_fPaceWallTime;           // realistic speed: start of the pace (ms)
+    long m_iPaceTick;                 //   and steps since the start
+    int m_iPaceSpeed;
+    void CountImage();
+    void DrawViews();
+    void Pace();
   public:
     int m_iFollowMode;                // Follow view mode
     double m_ZoomDelta;               //
@@ -413,6 +466,12 @@ class TViewManager
     // view <-> screen
     void Refresh();
     void CopyViewToScreen( int view_nr );
+    // render thread
+    void StartRender();
+    void StopRender();
+    bool IsRenderThread();
+    void Lock();
+    void Unlock();
     // option
     int GetFollowCar();
     void FollowCar( int car_nr );
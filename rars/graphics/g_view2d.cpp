@@ -50,6 +50,9 @@ TView2D::TView2D( int x, int y, int d_m_FollowCar ) : TView( x, y )
   m_dFollowCar = d_m_FollowCar;
   m_Zoom = 0.02;
   m_OptionShowBoard = 0;
+  m_fLastTopX = m_fLastTopY = 0.0;
+  m_fLastScale = 0.0;
+  m_bDamage = true;
 
   // load the bitmap of the grass
   m_BitmapGrass.PCX_Read( "bitmap/grass8x8.pcx" );
@@ -104,16 +107,16 @@ void TView2D::Refresh()
     // the user is changing 'm_FollowCar' ?
     if( m_FollowCarTime == 0 ) 
     {
-      m_CenterX = m_CenterX*0.3 + race_data.cars[m_iFollowCar]->x*0.7;
-      m_CenterY = m_CenterY*0.3 + race_data.cars[m_iFollowCar]->y*0.7;
+      m_CenterX = m_CenterX*0.3 + g_pSnapshot->cars[m_iFollowCar]->x*0.7;
+      m_CenterY = m_CenterY*0.3 + g_pSnapshot->cars[m_iFollowCar]->y*0.7;
     }
     else 
     {
       double aux = (1.0*(40-m_FollowCarTime)+0.95*m_FollowCarTime)/40.0;
       m_ScaleX = m_ScaleX * 0.98;
       aux = (0.3*(40-m_FollowCarTime)+0.95*m_FollowCarTime)/40.0;
-      m_CenterX = m_CenterX*aux + race_data.cars[m_iFollowCar]->x*(1.0-aux);
-      m_CenterY = m_CenterY*aux + race_data.cars[m_iFollowCar]->y*(1.0-aux);
+      m_CenterX = m_CenterX*aux + g_pSnapshot->cars[m_iFollowCar]->x*(1.0-aux);
+      m_CenterY = m_CenterY*aux + g_pSnapshot->cars[m_iFollowCar]->y*(1.0-aux);
       m_FollowCarTime--;
     }
   }
@@ -126,9 +129,44 @@ void TView2D::Refresh()
   m_TopX = m_CenterX - m_SizeX/(2*m_ScaleX);
   m_TopY = m_CenterY - m_SizeY/(2*m_ScaleY);
 
-  // refresh the bitmap
-  ClearBitmapTexture( m_TopX*m_ScaleX, m_TopY*m_ScaleY, 1/(m_ScaleX*40.0), &m_BitmapGrass );
-  DrawRoad();
+  // camera still (less than 1/20 pixel): keep the one of the last frame
+  bool bStill = m_fLastScale>0.0
+             && fabs( m_ScaleX-m_fLastScale )<m_fLastScale*1E-4
+             && fabs( m_TopX-m_fLastTopX )*m_ScaleX<0.05
+             && fabs( m_TopY-m_fLastTopY )*m_ScaleX<0.05;
+  if( bStill )
+  {
+    m_ScaleX = m_fLastScale;
+    m_ScaleY = - m_ScaleX;
+    m_TopX = m_fLastTopX;
+    m_TopY = m_fLastTopY;
+  }
+  else
+  {
+    m_fLastScale = m_ScaleX;
+    m_fLastTopX = m_TopX;
+    m_fLastTopY = m_TopY;
+    m_bLayer = false;
+  }
+
+  // refresh the bitmap: when the camera does not move, only erase
+  // the cars of the last frame with the track layer
+  if( m_bLayer )
+  {
+    RestoreOverlay();
+  }
+  else
+  {
+    ClearBitmapTexture( m_TopX*m_ScaleX, m_TopY*m_ScaleY, 1/(m_ScaleX*40.0), &m_BitmapGrass );
+    DrawRoad();
+    if( bStill )
+    {
+      // second frame at the same place: keep the track
+      SaveLayer();
+    }
+    m_iNumOverlay = 0;
+    SetAllDirty();
+  }
   DrawCars();
   if( g_ViewManager->m_ImageCpt!=1 && m_OptionShowBoard )
   {
@@ -153,6 +191,7 @@ void TView2D::Refresh()
   if( g_ViewManager->m_oInstantReplay->m_iMode!=INSTANT_RECORD )
   {
     DrawString( "R", m_SizeX-15, 10 );
+    AddOverlay( m_SizeX-15, 10, m_SizeX-8, 17 );
   }
 
 
@@ -289,10 +328,10 @@ void TView2D::DrawCars()
 
   for( i=0; i<args.m_iNumCar; i++ )           // for each car:
   {
-    x = (race_data.cars[i]->x-m_TopX)*m_ScaleX;
-    y = (race_data.cars[i]->y-m_TopY)*m_ScaleY;
+    x = (g_pSnapshot->cars[i]->x-m_TopX)*m_ScaleX;
+    y = (g_pSnapshot->cars[i]->y-m_TopY)*m_ScaleY;
     /* CHANGED 0.2: steering angle used to be shown in previous versions, like this:*/
-    ang = race_data.cars[i]->ang + race_data.cars[i]->alpha;  /* added alpha here! */
+    ang = g_pSnapshot->cars[i]->ang + g_pSnapshot->cars[i]->alpha;  /* added alpha here! */
     sine = sin(ang);    cosine = cos(ang);
     /* CHANGED 0.2: these two lines were added */
     double xx = sine*S_CARWID;  
@@ -309,7 +348,8 @@ void TView2D::DrawCars()
     /* CHANGED 0.2: again two lines below */
     v[1].x = (int)(x - xx);       v[1].y = (int)( y - yy);
     v[2].x = (int)( x + dx - xx); v[2].y = (int)( y+dy - yy);
-    if( race_data.cars[i]->collision_draw )
+    AddOverlay( v, 4 );
+    if( g_pSnapshot->cars[i]->collision_draw )
       DrawPoly( v, 4, FLASH_COLOR );
     else
       DrawPolyTexture( v, 4, -cosine/m_ScaleX, sine/m_ScaleX, &(g_ViewManager->m_aBitmapCar[i]) );
@@ -321,23 +361,24 @@ void TView2D::DrawCars()
     for( i=0; i<args.m_iNumCar; i++ )           // for each car:
     {
       // print only if the name will be visible on screen
-      y = (race_data.cars[i]->y-m_TopY)*m_ScaleY - 20.0;
+      y = (g_pSnapshot->cars[i]->y-m_TopY)*m_ScaleY - 20.0;
       if ( y>0 && y+10.0<m_SizeY )
       {
         double NameLen = 4.0*strlen(drivers[i]->getName());
-        x = (race_data.cars[i]->x-m_TopX)*m_ScaleX;
+        x = (g_pSnapshot->cars[i]->x-m_TopX)*m_ScaleX;
         if ( x-NameLen>0 && x+NameLen<m_SizeX )
         {
           int color;      // color of driver's name
           char s[10];
 
-          if( race_data.cars[i]->collision_draw )
+          if( g_pSnapshot->cars[i]->collision_draw )
             color = FLASH_COLOR;
           else
             color = drivers[i]->getTailColor();
 
           sprintf( s, "%s", drivers[i]->getName() );
           DrawString(s, (int)(x-NameLen), (int)y, color);
+          AddOverlay( (int)(x-NameLen), (int)y, (int)(x-NameLen)+8*(int)strlen(s)-1, (int)y+7 );
         }
       }
     }
@@ -360,6 +401,7 @@ void TView2D::DrawTrajectory( int car )
     int x_last = X_SCALE(ir->m_aData[start].x[car]);
     int y_last = Y_SCALE(ir->m_aData[start].y[car]);
     int x, y;
+    int x1 = x_last, y1 = y_last, x2 = x_last, y2 = y_last;  // bounding box
 
     for( int i=ir->m_iCurrentPos-2; i>=0; i-- )
     {
@@ -367,6 +409,8 @@ void TView2D::DrawTrajectory( int car )
       y = Y_SCALE(ir->m_aData[i].y[car]);
 
       DrawLine( x_last, y_last, x, y, color );
+      x1 = min( x1, x ); y1 = min( y1, y );
+      x2 = max( x2, x ); y2 = max( y2, y );
 
       x_last = x;
       y_last = y;
@@ -380,11 +424,14 @@ void TView2D::DrawTrajectory( int car )
         y = Y_SCALE(ir->m_aData[i].y[car]);
 
         DrawLine( x_last, y_last, x, y, color );
+        x1 = min( x1, x ); y1 = min( y1, y );
+        x2 = max( x2, x ); y2 = max( y2, y );
 
         x_last = x;
         y_last = y;
       }
     }
+    AddOverlay( x1, y1, x2, y2 );
   }
 }
 
@@ -400,25 +447,27 @@ void TView2D::DrawBoard()
 
   sprintf( s, "%ld", g_ViewManager->m_ImageCpt );
   DrawString( s, m_SizeX-48, 1 );
+  AddOverlay( m_SizeX-48, 1, m_SizeX-1, 8 );
 
   y = m_SizeY-40;
+  AddOverlay( 1, y, 3+8*max( (int)strlen(drivers[m_iFollowCar]->getName()), 16 )-1, y+5*8-1 );
 
   DrawString( drivers[m_iFollowCar]->getName(), 1, y );
   y += 8;
 
-  sprintf( s, "position %d", race_data.m_aPosOfCar[m_iFollowCar]+1 );
+  sprintf( s, "position %d", g_pSnapshot->m_aPosOfCar[m_iFollowCar]+1 );
   DrawString( s, 3, y );
   y += 8;
 
-  sprintf( s, "lap %ld/%ld", race_data.cars[m_iFollowCar]->laps, args.m_iNumLap );
+  sprintf( s, "lap %ld/%ld", g_pSnapshot->cars[m_iFollowCar]->laps, args.m_iNumLap );
   DrawString( s, 3, y );
   y += 8;
 
-  sprintf( s, "damage %ld", race_data.cars[m_iFollowCar]->damage );
+  sprintf( s, "damage %ld", g_pSnapshot->cars[m_iFollowCar]->damage );
   DrawString( s, 3, y );
   y += 8;
 
-  sprintf( s, "speed %6.2f", race_data.cars[m_iFollowCar]->speed_avg*MPH_FPS );
+  sprintf( s, "speed %6.2f", g_pSnapshot->cars[m_iFollowCar]->speed_avg*MPH_FPS );
   DrawStringOpaque( s, 3, y );
   y += 8;
 }
@@ -27,6 +27,7 @@
 
 #include "g_global.h"
 #include "../3ds/model_3ds.h"
+#include "../3ds/asset_loader.h"
 #include "g_track3d.h"
 
 #include "../misc.h"
@@ -176,6 +177,7 @@ void TView3D::Destroy()
   {
     track3D.Destroy();
   }
+  asset_loader.Reset();
   GLTexture::UnbindLoadedTexture();
   model_loader.Reset();
 }
@@ -229,8 +231,8 @@ void TView3D::DrawAll()
     // Creation des listes OpenGL
     GL_CreateList();
 
-    m_CamX = ( m_CenterX = race_data.cars[m_iFollowCar]->x ) + 200;
-    m_CamY =   m_CenterY = race_data.cars[m_iFollowCar]->y;
+    m_CamX = ( m_CenterX = g_pSnapshot->cars[m_iFollowCar]->x ) + 200;
+    m_CamY =   m_CenterY = g_pSnapshot->cars[m_iFollowCar]->y;
     m_CenterZ = 100;
 
     if( g_ViewManager->m_i3DS!=0 )
@@ -240,6 +242,9 @@ void TView3D::DrawAll()
     m_TrackBitmap = new TTrackBitmap( 160, 160 );
   } 
 
+  // Models read in the background
+  asset_loader.Upload();
+
   // the user is changing 'm_FollowCar' ?
   if( g_ViewManager->m_iFollowMode==FOLLOW_NOBODY )
   {
@@ -250,22 +255,22 @@ void TView3D::DrawAll()
     if( m_FollowCarTime == 0 ) 
     {  
       float frac = ( g_ViewManager->m_iRealSpeed==REAL_SPEED_FAST )?0.99f:0.7f;
-      m_CenterX = m_CenterX*(1-frac) + race_data.cars[m_iFollowCar]->x*frac;
-      m_CenterY = m_CenterY*(1-frac) + race_data.cars[m_iFollowCar]->y*frac;
+      m_CenterX = m_CenterX*(1-frac) + g_pSnapshot->cars[m_iFollowCar]->x*frac;
+      m_CenterY = m_CenterY*(1-frac) + g_pSnapshot->cars[m_iFollowCar]->y*frac;
       m_CenterZ = m_CenterZ*(1-frac) + track3D.CarHeight( m_iFollowCar, 0, banking )*frac;
     }
     else 
     {
       double aux = (0.05*(80-m_FollowCarTime)+0.95*m_FollowCarTime)/80.0;
-      m_CenterX = m_CenterX*aux + race_data.cars[m_iFollowCar]->x*(1.0-aux);
-      m_CenterY = m_CenterY*aux + race_data.cars[m_iFollowCar]->y*(1.0-aux);
+      m_CenterX = m_CenterX*aux + g_pSnapshot->cars[m_iFollowCar]->x*(1.0-aux);
+      m_CenterY = m_CenterY*aux + g_pSnapshot->cars[m_iFollowCar]->y*(1.0-aux);
       m_CenterZ = m_CenterZ*aux + track3D.CarHeight( m_iFollowCar, 0, banking )*(1.0-aux);
       m_FollowCarTime--;
     }
   }
 
   {
-    double a = race_data.cars[m_iFollowCar]->ang + race_data.cars[m_iFollowCar]->alpha*2;//JCer
+    double a = g_pSnapshot->cars[m_iFollowCar]->ang + g_pSnapshot->cars[m_iFollowCar]->alpha*2;//JCer
     double b = a+2*PI;
     if( fabs(m_Ang-a)>fabs(m_Ang-b) ) a = b;
     b = a-2*PI;
@@ -370,8 +375,8 @@ void TView3D::DrawAll()
           Height = 10+extra_height;
 
           // put camera in front of followed car
-          dx = -race_data.cars[m_iFollowCar]->xdot*10;
-          dy = -race_data.cars[m_iFollowCar]->ydot*10;
+          dx = -g_pSnapshot->cars[m_iFollowCar]->xdot*10;
+          dy = -g_pSnapshot->cars[m_iFollowCar]->ydot*10;
 
           // calculate radius on the xy plane
           r = sqrt( dx*dx + dy*dy );
@@ -385,8 +390,8 @@ void TView3D::DrawAll()
             dy *= factor;
           }
 
-          m_CenterX = race_data.cars[m_iFollowCar]->x;
-          m_CenterY = race_data.cars[m_iFollowCar]->y;
+          m_CenterX = g_pSnapshot->cars[m_iFollowCar]->x;
+          m_CenterY = g_pSnapshot->cars[m_iFollowCar]->y;
           m_CamX = m_CenterX-dx;
           m_CamY = m_CenterY-dy;
       }
@@ -407,8 +412,9 @@ void TView3D::DrawAll()
   }
   glTranslatef (-GLfloat(m_CenterX), -GLfloat(m_CenterY), -GLfloat(m_CenterZ) );
 
-  // Calculate the cone of view (Fustrum)
+  // Calculate the cone of view (Fustrum), shared with the track
   ExtractFrustum();
+  track3D.SetFrustum( m_aFrustum );
 
   glEnable(GL_TEXTURE_2D);
 
@@ -602,7 +608,7 @@ void TView3D::DrawCars()
  */
 void TView3D::DrawBoard()
 {
-  Car * car = race_data.cars[m_iFollowCar];
+  TCarSnapshot * car = g_pSnapshot->cars[m_iFollowCar];
   Driver * driver = drivers[m_iFollowCar];
 
   float aspect = float(m_SizeX)/m_SizeY;
@@ -614,12 +620,12 @@ void TView3D::DrawBoard()
 
   glTranslatef (-50*ux, 35*uy, -1 );
   glRasterPos2f(0, 0);
-  opengl.glPrint( opengl.m_iBigFont, "%d", race_data.m_aPosOfCar[m_iFollowCar]+1 );
+  opengl.glPrint( opengl.m_iBigFont, "%d", g_pSnapshot->m_aPosOfCar[m_iFollowCar]+1 );
   opengl.glPrint( opengl.m_iSmallFont, " th" );
   glTranslatef (85*ux, 0, 0 );
   glRasterPos2f(0, 0);
   opengl.glPrint( opengl.m_iSmallFont, "Lap " );
-  opengl.glPrint( opengl.m_iBigFont, " %d/%d", car->Laps, args.m_iNumLap );
+  opengl.glPrint( opengl.m_iBigFont, " %d/%d", car->laps, args.m_iNumLap );
   glTranslatef (0, -4.5f*uy, 0 );
   glRasterPos2f(0, 0);
   opengl.glPrint( opengl.m_iSmallFont, "Best" );
@@ -679,15 +685,17 @@ void TView3D::DrawBoard()
 void TView3D::GL_DrawCar3DS( int i )
 {
   double banking1, banking2;
-  float x = float(race_data.cars[i]->X),     // and not ->x (->X is the previous similation step coherent with seg_id and to_end)
-        y = float(race_data.cars[i]->Y),
+  float x = float(g_pSnapshot->cars[i]->X),     // and not ->x (->X is the previous similation step coherent with seg_id and to_end)
+        y = float(g_pSnapshot->cars[i]->Y),
         z_front = float( track3D.CarHeight(i, -CARLEN/2, banking1) ),
         z_back  = float( track3D.CarHeight(i, CARLEN/2, banking2) ),
         z = (z_front+z_back)/2,
-        ang = float(race_data.cars[i]->ang*180.0/PI);
+        ang = float(g_pSnapshot->cars[i]->ang*180.0/PI);
   double banking = ( banking1 + banking2 ) / 2;
 
-  // Store the z value to draw the trajectory
+  // Store the z value to draw the trajectory (InstantReplay records the
+  // live car: the OpenGL views are drawn by the simulation thread)
+  g_pSnapshot->cars[i]->Z = z; 
   race_data.cars[i]->Z = z; 
 
   double dist= SphereInFrustum( x, y, z, float(CARLEN+CARWID) );
@@ -696,15 +704,15 @@ void TView3D::GL_DrawCar3DS( int i )
     return;
   }
 
-  int color1 = race_data.cars[i]->nose_color;
-  int color2 = ( race_data.cars[i]->collision_draw
+  int color1 = g_pSnapshot->cars[i]->nose_color;
+  int color2 = ( g_pSnapshot->cars[i]->collision_draw
     ? FLASH_COLOR
-    :  race_data.cars[i]->tail_color
+    :  g_pSnapshot->cars[i]->tail_color
     );
 
-  float lin_acc = float(race_data.cars[i]->get_lin_acc()),
-        lat_acc = float(race_data.cars[i]->get_lat_acc()),
-        alpha   = float(race_data.cars[i]->get_alpha());
+  float lin_acc = float(g_pSnapshot->cars[i]->lin_acc),
+        lat_acc = float(g_pSnapshot->cars[i]->lat_acc),
+        alpha   = float(g_pSnapshot->cars[i]->alpha);
   
   #define H_CAR1 2.5f
   #define H_CAR2 4.5f
@@ -740,7 +748,7 @@ void TView3D::GL_DrawCar3DS( int i )
   static GLfloat high_shininess[] = { 20.0 };
   static GLfloat low_shininess[] = { 10.0 };
 
-  if( race_data.cars[i]->out == 0 )
+  if( g_pSnapshot->cars[i]->out == 0 )
   {
     ////
     //// draw acceleration Vector
@@ -766,7 +774,7 @@ void TView3D::GL_DrawCar3DS( int i )
   glMaterialfv( GL_FRONT_AND_BACK, GL_SPECULAR, mat_white);
   glMaterialfv( GL_FRONT_AND_BACK, GL_SHININESS, low_shininess);
 
-  if( m_aFrontWheel[i].m_pModel==NULL )
+  if( !Wheel3DSReady(&m_aFrontWheel[i]) || !Wheel3DSReady(&m_aBackWheel[i]) )
   {
     // FOR NEXT VERSION, replace that by a common wheel mechanism
     glDisable(GL_TEXTURE_2D);
@@ -816,8 +824,9 @@ void TView3D::GL_DrawCar3DS( int i )
   ////
   //// Draw the car
   ////
-  if( m_aModelBody[i]==NULL )
+  if( m_aModelBody[i]==NULL || !m_aModelBody[i]->IsReady() )
   {
+    // no custom model or not loaded yet
     glMaterialfv( GL_FRONT_AND_BACK, GL_SHININESS, low_shininess);
     glMaterialfv( GL_FRONT_AND_BACK, GL_DIFFUSE, mat_color2 );
     glMaterialfv( GL_FRONT_AND_BACK, GL_AMBIENT, mat_dark_color2 );
@@ -897,12 +906,14 @@ void TView3D::GL_DrawWheel3DS( TWheel3D * wheel, int i, float x, float y )
 void TView3D::GL_DrawCar( int i )
 {
   double banking;
-  float x = float(race_data.cars[i]->x),
-        y = float(race_data.cars[i]->y),
+  float x = float(g_pSnapshot->cars[i]->x),
+        y = float(g_pSnapshot->cars[i]->y),
         z = float( track3D.CarHeight(i, 0, banking) ),
-        ang = float(race_data.cars[i]->ang*180.0/PI);
+        ang = float(g_pSnapshot->cars[i]->ang*180.0/PI);
 
-  // Store the z value to draw the trajectory
+  // Store the z value to draw the trajectory (InstantReplay records the
+  // live car: the OpenGL views are drawn by the simulation thread)
+  g_pSnapshot->cars[i]->Z = z; 
   race_data.cars[i]->Z = z; 
 
   double dist= SphereInFrustum( x, y, z, float(CARLEN+CARWID) );
@@ -911,11 +922,11 @@ void TView3D::GL_DrawCar( int i )
     return;
   }
  
-  int   color1 =   race_data.cars[i]->nose_color,
-        color2 =   race_data.cars[i]->tail_color;
-  float lin_acc = float(race_data.cars[i]->get_lin_acc()),
-        lat_acc = float(race_data.cars[i]->get_lat_acc()),
-        alpha = float(race_data.cars[i]->get_alpha());
+  int   color1 =   g_pSnapshot->cars[i]->nose_color,
+        color2 =   g_pSnapshot->cars[i]->tail_color;
+  float lin_acc = float(g_pSnapshot->cars[i]->lin_acc),
+        lat_acc = float(g_pSnapshot->cars[i]->lat_acc),
+        alpha = float(g_pSnapshot->cars[i]->alpha);
 
   #define H_CAR1 2.5f
   #define H_CAR2 4.5f
@@ -937,7 +948,7 @@ void TView3D::GL_DrawCar( int i )
     GL_DrawCarName( i );
   }
 
-  if( race_data.cars[i]->out == 0 )
+  if( g_pSnapshot->cars[i]->out == 0 )
   {
     ////
     //// draw acceleration Vector
@@ -964,7 +975,7 @@ void TView3D::GL_DrawCar( int i )
   float px = GLfloat(CARWID/2)+0.5f;
 
   pColor = &Palette.m_Color[
-             race_data.cars[i]->collision_draw 
+             g_pSnapshot->cars[i]->collision_draw 
              ? FLASH_COLOR
              : oBLACK ];
   glColor4f ( pColor->fr, pColor->fg, pColor->fb, 1.0f);
@@ -1198,11 +1209,11 @@ void TView3D::GL_DrawCar( int i )
  */
 void TView3D::GL_DrawCarName( int i )
 {
-  // float NameLen=2.0f * (float)m_Zoom/0.01f * strlen(race_data.cars[i]->driver->getName());
+  // float NameLen=2.0f * (float)m_Zoom/0.01f * strlen(drivers[i]->getName());
   glPushMatrix ();  
   glTranslatef( 0.0f, 0.0f, 20.0f);
   glRasterPos2f(0.0f, 0.0f);
-  opengl.glPrint( opengl.m_iSmallFont, race_data.cars[i]->driver->getName());  // print GL text to the screen
+  opengl.glPrint( opengl.m_iSmallFont, drivers[i]->getName());  // print GL text to the screen
   glPopMatrix ();  
 }
 
@@ -1243,25 +1254,38 @@ void TView3D::DrawTrajectory( int car )
 }
 
 /**
- * Load a 3DS file and render it in an openGL list.
+ * Load a 3DS file of a wheel in the background (see Wheel3DSReady)
  *
- * @param list_id  : opengl id of the list
+ * @param wheel    : wheel of a car
  * @param filename : name of the 3ds file
  */
 void TView3D::Load3DSWheel( TWheel3D * wheel, const char * filename )
 {
-  bool bNew;
-  Model_3DS * model = model_loader.GetModel( bNew, filename, 0.1f, 90, true );
-  if( bNew )
+  wheel->m_pModel = model_loader.QueueModel( filename, 0.1f, 90, true, true );
+  wheel->m_fPerimeter = 0;
+}
+
+/**
+ * Check if the model of a wheel is loaded, take its size the first time
+ *
+ * @param wheel    : wheel of a car
+ * @return true if the wheel can be drawn with its model
+ */
+bool TView3D::Wheel3DSReady( TWheel3D * wheel )
+{
+  Model_3DS * model = wheel->m_pModel;
+  if( model==NULL || !model->IsReady() )
+  {
+    return false;
+  }
+  if( wheel->m_fPerimeter==0 )
   {
-    model->CalculateSphere();
-    model->Recenter();
+    wheel->m_fCenterX = -model->m_fCenterY;
+    wheel->m_fCenterY = model->m_fCenterX;
+    wheel->m_fCenterZ = model->m_fCenterZ;
+    wheel->m_fPerimeter = (float )((model->m_fMaxZ-model->m_fMinZ)*PI); // 2.0f/2.0f 
   }
-  wheel->m_fCenterX = -model->m_fCenterY;
-  wheel->m_fCenterY = model->m_fCenterX;
-  wheel->m_fCenterZ = model->m_fCenterZ;
-  wheel->m_fPerimeter = (float )((model->m_fMaxZ-model->m_fMinZ)*PI); // 2.0f/2.0f 
-  wheel->m_pModel = model;
+  return true;
 }
 
 /**
@@ -1284,7 +1308,7 @@ void TView3D::GL_CreateList()
   char s[256];
   for( int i=0; i<args.m_iNumCar; i++ )  // for each car:
   {       
-    const char * sModel = race_data.cars[i]->driver->getModel3D();
+    const char * sModel = drivers[i]->getModel3D();
     if( sModel==NULL )
     {
       m_aModelBody[i] = NULL;
@@ -1294,7 +1318,7 @@ void TView3D::GL_CreateList()
     else
     {
       sprintf( s, "3ds/%s/car_body.3ds", sModel );
-      m_aModelBody[i] = model_loader.GetModel( s, 0.1f, 90, true );;
+      m_aModelBody[i] = model_loader.QueueModel( s, 0.1f, 90, true );
       m_aModelBody[i]->SetEnvMap( true );
       
       sprintf( s, "3ds/%s/front_right_wheel.3ds", sModel );
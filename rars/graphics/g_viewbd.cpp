@@ -150,7 +150,7 @@ void TViewBoard::Refresh()
   x = 1; y = BOARD_Y;
 
   // set iFirstCarShown to see the follow car and min. (iShowCarsBehind) cars behind the car on ViewBoard
-  iFirstCarShown = race_data.m_aPosOfCar[m_iFollowCar]-(iMaxCarsShown-m_iShowCarsBehind-1);
+  iFirstCarShown = g_pSnapshot->m_aPosOfCar[m_iFollowCar]-(iMaxCarsShown-m_iShowCarsBehind-1);
   // iFirstCarShown stays same if viewing last (iShowCarsBehind+1) cars, to avoid empty lines when enough cars available
   if(iFirstCarShown > args.m_iNumCar-iMaxCarsShown)
     iFirstCarShown = args.m_iNumCar-iMaxCarsShown;
@@ -161,18 +161,18 @@ void TViewBoard::Refresh()
   iLastCarShown = min(iFirstCarShown+iMaxCarsShown-1,args.m_iNumCar-1);
   for( i=iFirstCarShown ; i<=iLastCarShown; i++ )
   {
-    pos = race_data.m_aCarInPos[i];
+    pos = g_pSnapshot->m_aCarInPos[i];
 
     int color;
-    if( race_data.cars[pos]->out == 1 ) 
+    if( g_pSnapshot->cars[pos]->out == 1 ) 
       color = oMAGENTA;
-    else if( race_data.cars[pos]->out == 2 ) 
+    else if( g_pSnapshot->cars[pos]->out == 2 ) 
       color = oGREEN;
-    else if( race_data.cars[pos]->offroad ) 
+    else if( g_pSnapshot->cars[pos]->offroad ) 
       color = oWHITE;
     else if( pos == m_iFollowCar )
       color = oYELLOW;
-    else if (race_data.cars[pos]->collision_draw) 
+    else if (g_pSnapshot->cars[pos]->collision_draw) 
       color = oRED;
     else
       color = oBLACK;
@@ -187,20 +187,20 @@ void TViewBoard::Refresh()
     strcat( s, tmp );
 
     // Time
-    if (race_data.cars[pos]->out == 1) {
+    if (g_pSnapshot->cars[pos]->out == 1) {
       sprintf( tmp, "   out    ");
-    } else if (race_data.cars[pos]->out == 2) {
+    } else if (g_pSnapshot->cars[pos]->out == 2) {
       sprintf( tmp, "   pit    ");
     } else if (i == 0) {
-      format_time(race_data.cars[pos]->last_crossing, tmp);
-    } else if (race_data.cars[pos]->laps < (race_data.cars[race_data.m_aCarInPos[0]]->laps - 1)) {
-      sprintf(tmp, "%2ld lap(s) ", race_data.cars[race_data.m_aCarInPos[0]]->laps - 1 - race_data.cars[pos]->laps);
-    } else if (race_data.cars[pos]->laps == race_data.cars[race_data.m_aCarInPos[0]]->laps) {
-      format_time(race_data.cars[pos]->last_crossing - race_data.cars[race_data.m_aCarInPos[0]]->last_crossing, tmp);
+      format_time(g_pSnapshot->cars[pos]->last_crossing, tmp);
+    } else if (g_pSnapshot->cars[pos]->laps < (g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->laps - 1)) {
+      sprintf(tmp, "%2ld lap(s) ", g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->laps - 1 - g_pSnapshot->cars[pos]->laps);
+    } else if (g_pSnapshot->cars[pos]->laps == g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->laps) {
+      format_time(g_pSnapshot->cars[pos]->last_crossing - g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->last_crossing, tmp);
     } else {
-      format_time(race_data.cars[pos]->last_crossing - 
-                  race_data.cars[race_data.m_aCarInPos[0]]->last_crossing +
-                  race_data.cars[race_data.m_aCarInPos[0]]->lap_time, tmp);
+      format_time(g_pSnapshot->cars[pos]->last_crossing - 
+                  g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->last_crossing +
+                  g_pSnapshot->cars[g_pSnapshot->m_aCarInPos[0]]->lap_time, tmp);
     }
 
     strcat(s, tmp);
@@ -209,40 +209,40 @@ void TViewBoard::Refresh()
     {
       sprintf( tmp, "%4d%7.2f%7.2f%4ld+%03ld%4ld%7.2f%7.2f%7.2f%7.2f%3d%4ld%7.2f%6lu%7.2f%5.2f%4ld%7.2f"
         , i+1
-        , race_data.cars[pos]->Behind_next
-        , race_data.cars[pos]->Ahead_next
-        , race_data.cars[pos]->Laps
-        , args.m_iNumLap-race_data.cars[pos]->Laps
-        , race_data.cars[pos]->Laps_lead
-        , SPD(race_data.cars[pos]->xdot, race_data.cars[pos]->ydot) * MPH_FPS
-        , race_data.cars[pos]->speed_avg * MPH_FPS
-        , race_data.cars[pos]->bestlap_speed * MPH_FPS
-        , race_data.cars[pos]->lastlap_speed * MPH_FPS
-        , race_data.cars[pos]->Pit_stops
-        , race_data.cars[pos]->Last_pit_visit
-        , race_data.cars[pos]->Total_pit_time
-        , race_data.cars[pos]->damage
-        , race_data.cars[pos]->fuel
-        , race_data.cars[pos]->fuel_mileage
-        , race_data.cars[pos]->projected_laps
-        , race_data.cars[pos]->RobotTime / race_data.m_fElapsedTime
+        , g_pSnapshot->cars[pos]->Behind_next
+        , g_pSnapshot->cars[pos]->Ahead_next
+        , g_pSnapshot->cars[pos]->laps
+        , args.m_iNumLap-g_pSnapshot->cars[pos]->laps
+        , g_pSnapshot->cars[pos]->laps_lead
+        , SPD(g_pSnapshot->cars[pos]->xdot, g_pSnapshot->cars[pos]->ydot) * MPH_FPS
+        , g_pSnapshot->cars[pos]->speed_avg * MPH_FPS
+        , g_pSnapshot->cars[pos]->bestlap_speed * MPH_FPS
+        , g_pSnapshot->cars[pos]->lastlap_speed * MPH_FPS
+        , g_pSnapshot->cars[pos]->pit_stops
+        , g_pSnapshot->cars[pos]->last_pit_visit
+        , g_pSnapshot->cars[pos]->Total_pit_time
+        , g_pSnapshot->cars[pos]->damage
+        , g_pSnapshot->cars[pos]->fuel
+        , g_pSnapshot->cars[pos]->fuel_mileage
+        , g_pSnapshot->cars[pos]->projected_laps
+        , g_pSnapshot->cars[pos]->RobotTime / g_pSnapshot->m_fElapsedTime
       );
     }
     else
     {
       sprintf( tmp, "%4d%7.2f%7.2f%4ld+%03ld%7.2f%7.2f%7.2f%3d%8lu%8.2f%7.2f"
         , i+1
-        , race_data.cars[pos]->Behind_next
-        , race_data.cars[pos]->Ahead_next
-        , race_data.cars[pos]->Laps
-        , args.m_iNumLap-race_data.cars[pos]->Laps
-        , SPD(race_data.cars[pos]->xdot, race_data.cars[pos]->ydot) * MPH_FPS
-        , race_data.cars[pos]->bestlap_speed * MPH_FPS
-        , race_data.cars[pos]->lastlap_speed * MPH_FPS
-        , race_data.cars[pos]->Pit_stops
-        , race_data.cars[pos]->damage
-        , race_data.cars[pos]->fuel
-        , race_data.cars[pos]->RobotTime / race_data.m_fElapsedTime
+        , g_pSnapshot->cars[pos]->Behind_next
+        , g_pSnapshot->cars[pos]->Ahead_next
+        , g_pSnapshot->cars[pos]->laps
+        , args.m_iNumLap-g_pSnapshot->cars[pos]->laps
+        , SPD(g_pSnapshot->cars[pos]->xdot, g_pSnapshot->cars[pos]->ydot) * MPH_FPS
+        , g_pSnapshot->cars[pos]->bestlap_speed * MPH_FPS
+        , g_pSnapshot->cars[pos]->lastlap_speed * MPH_FPS
+        , g_pSnapshot->cars[pos]->pit_stops
+        , g_pSnapshot->cars[pos]->damage
+        , g_pSnapshot->cars[pos]->fuel
+        , g_pSnapshot->cars[pos]->RobotTime / g_pSnapshot->m_fElapsedTime
       );
     }
 
@@ -257,17 +257,17 @@ void TViewBoard::Refresh()
     DrawPolyTexture( v, 4, -2.0, 0.0, &(g_ViewManager->m_aBitmapCar[pos]) );
     y += 8;
       
-    if( fBestLapSpeed<=race_data.cars[pos]->bestlap_speed)
+    if( fBestLapSpeed<=g_pSnapshot->cars[pos]->bestlap_speed)
     {
       iBestLapCar   = pos;
-      fBestLapSpeed = race_data.cars[pos]->bestlap_speed;
+      fBestLapSpeed = g_pSnapshot->cars[pos]->bestlap_speed;
     }
   }
 
   // fastest lap + BestView mode
   x=1; y=m_SizeY-8;
   char *mode[] = { "manual Update","any Overtaking", "for Position", "Nobody" };
-  sprintf( s, "%10s %6.2f mi/h    %-18s", drivers[iBestLapCar]->getName(), race_data.cars[iBestLapCar]->bestlap_speed * MPH_FPS, mode[g_ViewManager->m_iFollowMode] );
+  sprintf( s, "%10s %6.2f mi/h    %-18s", drivers[iBestLapCar]->getName(), g_pSnapshot->cars[iBestLapCar]->bestlap_speed * MPH_FPS, mode[g_ViewManager->m_iFollowMode] );
   DrawStringOpaque(s, x+190, y );
 
   // fps
@@ -40,6 +40,7 @@ TViewClassical::TViewClassical( int x, int y, bool bVirtual ) : TView( x, y, bVi
    FullScreenScale();
    m_OptionFlash = 1;
    m_OptionShowBoard = 0;
+   m_bDamage = true;
 
    m_BitmapGrass.PCX_Read( "bitmap/grass8x8.pcx" );
    ClearBitmapTexture( m_TopX*m_ScaleX, m_TopY*m_ScaleY, 1/(m_ScaleX*40.0), &m_BitmapGrass );
@@ -68,22 +69,32 @@ void TViewClassical::Resize( int x, int y )
    FullScreenScale();
    ClearBitmapTexture( m_TopX*m_ScaleX, m_TopY*m_ScaleY, 1/(m_ScaleX*40.0), &m_BitmapGrass );
    DrawRoad();
+   m_bLayer = false;
 }
 
 //__ TViewClassical::Refresh _______________________________________________
 //
-// Refresh the view
+// Refresh the view. The track is kept in the layer after the first
+// frame: the cars and the board of the last frame are erased with it.
 //__________________________________________________________________________
 
 void TViewClassical::Refresh()
 {
   int i;
 
-  DrawStart();
+  if( m_bLayer )
+  {
+     RestoreOverlay();
+  }
+  else
+  {
+     DrawStart();
+     SaveLayer();
+     SetAllDirty();
+  }
   if( m_OptionShowBoard )
      DrawBoard();
   for( i=0; i<args.m_iNumCar; i++ ) {
-     DrawCars( ERASE_CAR, i );
      DrawCars( DRAW_CAR, i );
    }
 }
@@ -213,13 +224,13 @@ void TViewClassical::DrawCars( int state, int car_nr )
 
    int i = car_nr;
    if( state==DRAW_CAR ) {
-      x = race_data.cars[i]->prex2 = race_data.cars[i]->x;
-      y = race_data.cars[i]->prey2 = race_data.cars[i]->y;
-      ang = race_data.cars[i]->prang2 = race_data.cars[i]->ang;
+      x = g_pSnapshot->cars[i]->prex2 = g_pSnapshot->cars[i]->x;
+      y = g_pSnapshot->cars[i]->prey2 = g_pSnapshot->cars[i]->y;
+      ang = g_pSnapshot->cars[i]->prang2 = g_pSnapshot->cars[i]->ang;
    } else {
-      x = race_data.cars[i]->prex2;
-      y = race_data.cars[i]->prey2;
-      ang = race_data.cars[i]->prang2;
+      x = g_pSnapshot->cars[i]->prex2;
+      y = g_pSnapshot->cars[i]->prey2;
+      ang = g_pSnapshot->cars[i]->prang2;
    }
    x = (x-m_TopX)*m_ScaleX;
    y = (y-m_TopY)*m_ScaleY;
@@ -235,17 +246,18 @@ void TViewClassical::DrawCars( int state, int car_nr )
    v[1].x = (int) xx; v[1].y = (int) yy;
    v[2].x = (int)( xx+dx ); v[2].y =(int)( yy+dy );
    if( state == DRAW_CAR ) {
-      if( race_data.cars[i]->collision_draw )
+      AddOverlay( v, 4 );
+      if( g_pSnapshot->cars[i]->collision_draw )
          DrawPoly( v, 4, FLASH_COLOR );
       else {
          if( m_OptionFlash && i==m_iFollowCar )
             DrawPoly( v, 4, g_ViewManager->m_ImageCpt&0x0f );
          else {
-            DrawPoly( v, 4, race_data.cars[i]->nose_color );
+            DrawPoly( v, 4, g_pSnapshot->cars[i]->nose_color );
             dx *=0.3; dy*=0.3;
             v[2].x = (int)( xx+dx ); v[2].y =(int)( yy+dy );
             v[3].x = (int)( x+dx ); v[3].y =(int)( y+dy );
-            DrawPoly( v, 4, race_data.cars[i]->tail_color );
+            DrawPoly( v, 4, g_pSnapshot->cars[i]->tail_color );
          }
       }
    } else {
@@ -270,28 +282,30 @@ void TViewClassical::DrawBoard()
 
    sprintf( s, "%ld", (long)g_ViewManager->m_ImageCpt );
    DrawStringOpaque( s, m_SizeX-48, 1 );
+   AddOverlay( m_SizeX-48, 1, m_SizeX-1, 8 );
 
    y = m_SizeY-40;
+   AddOverlay( 1, y, 3+8*12-1, y+5*8-1 );
 
    sprintf( s, "%s        ", drivers[m_iFollowCar]->getName() );
    s[8]='\0';
    DrawStringOpaque( s, 1, y );
    y += 8;
 
-   sprintf( s, "position %d ", race_data.m_aPosOfCar[m_iFollowCar]+1 );
+   sprintf( s, "position %d ", g_pSnapshot->m_aPosOfCar[m_iFollowCar]+1 );
    DrawStringOpaque( s, 3, y );
    y += 8;
 
-   sprintf( s, "lap %d/%d ", (int)race_data.cars[m_iFollowCar]->laps, (int)args.m_iNumLap );
+   sprintf( s, "lap %d/%d ", (int)g_pSnapshot->cars[m_iFollowCar]->laps, (int)args.m_iNumLap );
    DrawStringOpaque( s, 3, y );
    y += 8;
 
-   sprintf( s, "damage %ld    ", race_data.cars[m_iFollowCar]->damage );
+   sprintf( s, "damage %ld    ", g_pSnapshot->cars[m_iFollowCar]->damage );
    s[12]='\0';
    DrawStringOpaque( s, 3, y );
    y += 8;
 
-   sprintf( s, "speed %6.2f", race_data.cars[m_iFollowCar]->speed_avg*MPH_FPS );
+   sprintf( s, "speed %6.2f", g_pSnapshot->cars[m_iFollowCar]->speed_avg*MPH_FPS );
    DrawStringOpaque( s, 3, y );
    y += 8;
 }
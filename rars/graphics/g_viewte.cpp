@@ -33,6 +33,7 @@
 #include "g_global.h"
 #include "g_tracked.h"
 #include "g_track3d.h"
+#include "../3ds/asset_loader.h"
 
 #include "../misc.h"
 
@@ -80,6 +81,7 @@ void TViewTrackEditor::DrawAll()
     }
     m_bInit = false;
   }
+  asset_loader.Upload();
 
   MoveWithKeys();
 
@@ -98,8 +100,9 @@ void TViewTrackEditor::DrawAll()
   glRotatef ( float(m_fAngleZ),0.0f,0.0f,1.0f);
   glTranslatef (-GLfloat(m_CenterX), -GLfloat(m_CenterY), 0.0f );
 
-  // Calculate the cone of view (Fustrum)
+  // Calculate the cone of view (Fustrum), shared with the track
   ExtractFrustum();
+  track3D.SetFrustum( m_aFrustum );
 
   // Track
   if( currentTrack!=NULL )
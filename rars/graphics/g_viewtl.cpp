@@ -55,10 +55,10 @@ public:
   ChartData( int _car, int _nb )
   {
     car = _car;
-    color = race_data.cars[car]->tail_color;
+    color = g_pSnapshot->cars[car]->tail_color;
     if( color == oWHITE )
     {
-      color = race_data.cars[car]->nose_color;
+      color = g_pSnapshot->cars[car]->nose_color;
       if( color == oWHITE )
         color = oBLACK;
     }
@@ -78,7 +78,7 @@ public:
 
   void update()
   {
-    pos = (int) (race_data.cars[car]->distance / DIVIDER);
+    pos = (int) (g_pSnapshot->cars[car]->distance / DIVIDER);
     if( pos <0 ) pos = 0;
     if( pos>=nb_data) pos= nb_data-1;
     data[pos] = function();
@@ -86,12 +86,12 @@ public:
 
   double function()
   {
-//	double val = (race_data.cars[car]->vc -
-//		sqrt(race_data.cars[car]->xdot*race_data.cars[car]->xdot +
-//		     race_data.cars[car]->ydot*race_data.cars[car]->ydot)) * MPH_FPS;
+//	double val = (g_pSnapshot->cars[car]->vc -
+//		sqrt(g_pSnapshot->cars[car]->xdot*g_pSnapshot->cars[car]->xdot +
+//		     g_pSnapshot->cars[car]->ydot*g_pSnapshot->cars[car]->ydot)) * MPH_FPS;
     double val =
-		(sqrt(race_data.cars[car]->xdot*race_data.cars[car]->xdot +
-			  race_data.cars[car]->ydot*race_data.cars[car]->ydot)) * MPH_FPS;
+		(sqrt(g_pSnapshot->cars[car]->xdot*g_pSnapshot->cars[car]->xdot +
+			  g_pSnapshot->cars[car]->ydot*g_pSnapshot->cars[car]->ydot)) * MPH_FPS;
     return max( -200.0, min( 200.0, val ));
   }
 
@@ -103,10 +103,10 @@ public:
     delete data;
 
     car = car_nr;
-    color = race_data.cars[car]->tail_color;
+    color = g_pSnapshot->cars[car]->tail_color;
     if( color == oWHITE )
     {
-      color = race_data.cars[car]->nose_color;
+      color = g_pSnapshot->cars[car]->nose_color;
       if( color == oWHITE )
         color = oBLACK;
     }
@@ -133,8 +133,8 @@ void TViewTelemetry::MonitorInit()
   if( m_iChartDataNb==0 ) 
   {
     setTitle( "SPEED" );
-    // Monitor( 0, &(race_data.cars[0]->to_rgt) );
-    Monitor( race_data.m_aCarInPos[0] );
+    // Monitor( 0, &(g_pSnapshot->cars[0]->to_rgt) );
+    Monitor( g_pSnapshot->m_aCarInPos[0] );
     Monitor( m_iFollowCar );
   }
 }
@@ -247,9 +247,9 @@ void TViewTelemetry::FollowCar( int car_nr )
   if( m_iChartDataNb > 0 )
   {
     chartData[0]->FollowCar( car_nr );
-    int next = race_data.cars[car_nr]->s.position != 0 
-      ? race_data.m_aCarInPos[race_data.cars[car_nr]->s.position-1] 
-      : race_data.m_aCarInPos[1]; 
+    int next = g_pSnapshot->cars[car_nr]->position != 0 
+      ? g_pSnapshot->m_aCarInPos[g_pSnapshot->cars[car_nr]->position-1] 
+      : g_pSnapshot->m_aCarInPos[1]; 
     chartData[1]->FollowCar( next );
     m_iFollowCar = car_nr;
   }
@@ -340,6 +340,15 @@ void TViewTelemetry::Refresh()
     // Name
     int ipos = m_SizeX/2 + (v-(m_iChartDataNb/2))*100;
     DrawString( cd->name, ipos+12, m_SizeY-20, cd->color );
+
+    // Sectors and delta to the best lap
+    s[0] = 0;
+    for( i=0; i<g_pSnapshot->m_iNumSector; i++ )
+    {
+      sprintf( s+strlen(s), "S%d %6.2f  ", i+1, g_pSnapshot->m_aSector[cd->car][i] );
+    }
+    sprintf( s+strlen(s), "%+6.2f", g_pSnapshot->m_aDelta[cd->car] );
+    DrawString( s, ix_chart_pos+ix_chart_size-60*(g_pSnapshot->m_iNumSector+1), iy_chart_pos+5+v*15, cd->color );
   }
   
 
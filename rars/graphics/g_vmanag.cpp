@@ -23,7 +23,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#ifndef WIN32
+  #include <unistd.h>
+#endif
 #include "g_global.h"
+#include "g_snapshot.h"
 #include "../misc.h"
 
 //--------------------------------------------------------------------------
@@ -54,6 +58,12 @@ TViewManager::TViewManager( InstantReplay * ir )
   m_i3DS = g_oRarsIni.m_i3DS;
   m_bShowNames = (g_oRarsIni.m_iShowNames != 0);
   m_fFps = 0;
+  m_bRenderThread = false;
+  m_bStopRender = false;
+  m_iPaceSpeed = -1;
+#ifndef WIN32
+  pthread_mutex_init( &m_oViewMutex, NULL );
+#endif
 
   // init screen
   InitScreen();
@@ -77,6 +87,9 @@ TViewManager::TViewManager( InstantReplay * ir )
  */
 TViewManager::~TViewManager()
 {
+  // the render thread uses the views
+  StopRender();
+
   // close screen
   CloseScreen();
   m_Initialized = FALSE;
@@ -84,6 +97,9 @@ TViewManager::~TViewManager()
   // close all the views
   DeleteAllViews();
   free( m_Views );
+#ifndef WIN32
+  pthread_mutex_destroy( &m_oViewMutex );
+#endif
 }
 
 /**
@@ -134,17 +150,17 @@ double TViewManager::distance(int i,int j)
   default:
   case FOLLOW_FOR_POSITION:
     // for position
-    return fabs( race_data.cars[i]->Laps*len+race_data.cars[i]->Distance 
-               - race_data.cars[j]->Laps*len-race_data.cars[j]->Distance );
+    return fabs( g_pSnapshot->cars[i]->laps*len+g_pSnapshot->cars[i]->distance 
+               - g_pSnapshot->cars[j]->laps*len-g_pSnapshot->cars[j]->distance );
     break;
 
   case FOLLOW_ANY_OVERTAKING:
     // closest
-    return min( fabs( race_data.cars[i]->Distance 
-                    - race_data.cars[j]->Distance ),
+    return min( fabs( g_pSnapshot->cars[i]->distance 
+                    - g_pSnapshot->cars[j]->distance ),
                 len
-              - fabs( race_data.cars[i]->Distance 
-                    - race_data.cars[i]->Distance )
+              - fabs( g_pSnapshot->cars[i]->distance 
+                    - g_pSnapshot->cars[i]->distance )
               );
   }
 
@@ -156,17 +172,17 @@ double TViewManager::distance(int i,int j)
 
 int TViewManager::MostInterestingCar()
 {
-  int mi=race_data.m_aCarInPos[0];
+  int mi=g_pSnapshot->m_aCarInPos[0];
   double min_d=distance(0,1);
 
-  for( int n=0,i=mi; n<args.m_iNumCar; i=race_data.m_aCarInPos[++n])
+  for( int n=0,i=mi; n<args.m_iNumCar; i=g_pSnapshot->m_aCarInPos[++n])
   {
-    if( race_data.cars[i]->Out != 1  // not out of the race
-      && race_data.cars[i]->Out != 3  // did qualify
+    if( g_pSnapshot->cars[i]->out != 1  // not out of the race
+      && g_pSnapshot->cars[i]->out != 3  // did qualify
     )
     {
-      if( race_data.cars[i]->Offroad
-        && race_data.cars[i]->Out != 2 // do not follow the whole pit stop...
+      if( g_pSnapshot->cars[i]->offroad
+        && g_pSnapshot->cars[i]->out != 2 // do not follow the whole pit stop...
       )
       {
         return i; // ...only see how cars get into and out of pits
@@ -174,8 +190,8 @@ int TViewManager::MostInterestingCar()
       for( int j=0; j<args.m_iNumCar; j++)
       {
         if( i!=j  // not itself
-          && race_data.cars[j]->Out != 1 // not out of the race
-          && race_data.cars[i]->Bestlap_speed >= race_data.cars[j]->Bestlap_speed // follow the fastest
+          && g_pSnapshot->cars[j]->out != 1 // not out of the race
+          && g_pSnapshot->cars[i]->bestlap_speed >= g_pSnapshot->cars[j]->bestlap_speed // follow the fastest
           && min_d > distance(i,j) // is it the closest ?
         )
         {
@@ -189,19 +205,21 @@ int TViewManager::MostInterestingCar()
 }
 
 /**
- * Refresh the screen: calculate the views, copy them to the screen
+ * Called by the simulation after each step: publish the state of the
+ * race for the views. Without render thread, draw the views and copy
+ * them to the screen.
  */
 void TViewManager::Refresh()
 {
-  // image counter
-  m_ImageCpt ++;
-
-  // Follow chosen car
-  if( m_ImageCpt==1 && m_iFollowMode==FOLLOW_MANUAL && g_RaceStage!=QUALIF )
+  g_oSnapshot.Publish();
+  if( IsRenderThread() )
   {
-    FollowCar( find_name( g_oRarsIni.m_sFollowCar ) );
+    Pace();
+    return;
   }
 
+  CountImage();
+
   // super_fast_mode
   if( m_iRealSpeed==REAL_SPEED_FAST ) 
   {
@@ -218,6 +236,32 @@ void TViewManager::Refresh()
 #endif
   }
 
+  Lock();
+  g_pSnapshot = g_oSnapshot.Acquire();
+  DrawViews();
+  Unlock();
+}
+
+/**
+ * Count the images and follow the chosen car at the first one
+ */
+void TViewManager::CountImage()
+{
+  // image counter
+  m_ImageCpt ++;
+
+  // Follow chosen car
+  if( m_ImageCpt==1 && m_iFollowMode==FOLLOW_MANUAL && g_RaceStage!=QUALIF )
+  {
+    FollowCar( find_name( g_oRarsIni.m_sFollowCar ) );
+  }
+}
+
+/**
+ * Calculate the views from g_pSnapshot, copy them to the screen
+ */
+void TViewManager::DrawViews()
+{
   // zoom
   m_ZoomDelta = m_ZoomDelta*0.95+0.05;
 
@@ -236,6 +280,148 @@ void TViewManager::Refresh()
   }
 }
 
+/**
+ * Start the render thread: the views are drawn at RENDER_PERIOD from the
+ * snapshots, and the simulation does not wait for them. The 3D views
+ * stay drawn by the simulation (the OpenGL context is in its thread).
+ */
+void TViewManager::StartRender()
+{
+#ifndef WIN32
+  if( m_bRenderThread )
+  {
+    return;
+  }
+  m_bStopRender = false;
+  m_iPaceSpeed = -1;
+  // the thread tests m_bRenderThread under the lock: it is set first
+  Lock();
+  if( pthread_create( &m_oRenderThread, NULL, RenderThread, this )==0 )
+  {
+    m_bRenderThread = true;
+  }
+  Unlock();
+#endif
+}
+
+/**
+ * Stop the render thread (before the views are deleted)
+ */
+void TViewManager::StopRender()
+{
+#ifndef WIN32
+  if( !m_bRenderThread )
+  {
+    return;
+  }
+  m_bStopRender = true;
+  pthread_join( m_oRenderThread, NULL );
+  m_bRenderThread = false;
+#endif
+}
+
+/**
+ * The views of the current mode are drawn by the render thread
+ *
+ * @return              true if the render thread draws the views
+ */
+bool TViewManager::IsRenderThread()
+{
+  return m_bRenderThread && !IS_MODE_OPENGL( m_iViewMode );
+}
+
+/**
+ * Lock the views: they are drawn, resized or created by one thread at once
+ */
+void TViewManager::Lock()
+{
+#ifndef WIN32
+  pthread_mutex_lock( &m_oViewMutex );
+#endif
+}
+
+void TViewManager::Unlock()
+{
+#ifndef WIN32
+  pthread_mutex_unlock( &m_oViewMutex );
+#endif
+}
+
+#ifndef WIN32
+/**
+ * Main function of the render thread
+ *
+ * @param arg           (in) the TViewManager
+ */
+void * TViewManager::RenderThread( void * arg )
+{
+  TViewManager * vm = (TViewManager *)arg;
+  double next = g_oSnapshot.GetWallTime();
+
+  while( !vm->m_bStopRender )
+  {
+    // wait for the next frame (a late frame is not caught up)
+    next += RENDER_PERIOD;
+    double wait = next-g_oSnapshot.GetWallTime();
+    if( wait>0 )
+    {
+      usleep( (useconds_t)( wait*1000 ) );
+    }
+    else
+    {
+      next = g_oSnapshot.GetWallTime();
+    }
+
+    // the view mode is read under the lock, like the views themselves
+    vm->Lock();
+    if( vm->IsRenderThread() && !g_oSnapshot.IsEmpty() )
+    {
+      vm->CountImage();
+      g_pSnapshot = g_oSnapshot.Interpolate();
+      vm->DrawViews();
+    }
+    vm->Unlock();
+  }
+  return NULL;
+}
+#endif
+
+/**
+ * With the render thread, keep the realistic speed of the simulation:
+ * one step of delta_time in real time (REAL_SPEED_MEDIUM) or 4 times
+ * slower (REAL_SPEED_SLOW). REAL_SPEED_FAST runs at full speed.
+ */
+void TViewManager::Pace()
+{
+#ifndef WIN32
+  double now = g_oSnapshot.GetWallTime();
+  if( m_iPaceSpeed!=m_iRealSpeed )
+  {
+    m_iPaceSpeed = m_iRealSpeed;
+    m_fPaceWallTime = now;
+    m_iPaceTick = 0;
+  }
+  if( m_iRealSpeed==REAL_SPEED_FAST )
+  {
+    return;
+  }
+
+  m_iPaceTick++;
+  double step = delta_time*1000.0*( m_iRealSpeed==REAL_SPEED_SLOW ? 4.0 : 1.0 );
+  double wait = m_fPaceWallTime+m_iPaceTick*step-now;
+  if( wait>0 )
+  {
+    usleep( (useconds_t)( wait*1000 ) );
+  }
+  else if( wait<-500.0 )
+  {
+    // the simulation is slower than the time: do not catch up
+    m_fPaceWallTime = now;
+    m_iPaceTick = 0;
+  }
+#endif
+}
+
 /**
  * Change the car to follow in all the views
  *
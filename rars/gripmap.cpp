@@ -0,0 +1,138 @@
+/**
+ * GRIPMAP.CPP - grip of the track along and across each segment
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       gripmap.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "gripmap.h"
+#include "misc.h"
+#include "os.h"
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+GripMap::GripMap()
+{
+  m_iNumSeg = 0;
+  m_iRows = m_iLanes = 1;
+  m_aGrip = m_aTarget = NULL;
+  m_aRowScale = NULL;
+  m_fLaneScale = 0;
+  m_bEvolve = false;
+}
+
+/**
+ * Destructor
+ */
+GripMap::~GripMap()
+{
+  Free();
+}
+
+void GripMap::Free()
+{
+  delete [] m_aGrip;
+  delete [] m_aTarget;
+  delete [] m_aRowScale;
+  m_aGrip = m_aTarget = NULL;
+  m_aRowScale = NULL;
+}
+
+/**
+ * Build the map from the "grip" parameter of the segments of a track
+ *
+ * @param track         (in) track of the race
+ * @param evolve        (in) rubber the cells in when the cars pass
+ */
+void GripMap::Init( Track * track, bool evolve )
+{
+  int seg, i, n;
+  int cells;
+  double val[MAX_GRIP_CELLS];
+
+  Free();
+  m_bEvolve = evolve;
+  m_iNumSeg = track->NSEG;
+  m_iRows = track->m_iGripRows;
+  m_iLanes = track->m_iGripLanes;
+  cells = m_iRows*m_iLanes;
+  if( m_iRows<1 || m_iLanes<1 || cells>MAX_GRIP_CELLS )
+  {
+    exitOnError( "GripMap::Init: bad grip_rows (%d) or grip_lanes (%d)", m_iRows, m_iLanes );
+  }
+
+  m_aGrip = new float[m_iNumSeg*cells];
+  m_aRowScale = new double[m_iNumSeg];
+  m_fLaneScale = m_iLanes/track->width;
+
+  for( seg=0; seg<m_iNumSeg; seg++ )
+  {
+    m_aRowScale[seg] = m_iRows/track->rgtwall[seg].length;
+
+    // read the factors of the segment
+    const char * p = track->m_aSeg[seg].m_sGrip;
+    char * end;
+    for( n=0; n<MAX_GRIP_CELLS; n++ )
+    {
+      val[n] = strtod( p, &end );
+      if( end==p )
+      {
+        break;
+      }
+      p = end;
+    }
+
+    float * grip = &m_aGrip[seg*cells];
+    if( n==0 || n==1 )
+    {
+      for( i=0; i<cells; i++ )
+      {
+        grip[i] = n ? (float)val[0] : 1.0f;
+      }
+    }
+    else if( n==cells )
+    {
+      for( i=0; i<cells; i++ )
+      {
+        grip[i] = (float)val[i];
+      }
+    }
+    else
+    {
+      exitOnError( "GripMap::Init: segment %d has %d grip values (1 or %d expected)", seg, n, cells );
+    }
+  }
+
+  if( m_bEvolve )
+  {
+    m_aTarget = new float[m_iNumSeg*cells];
+    for( i=0; i<m_iNumSeg*cells; i++ )
+    {
+      m_aTarget[i] = m_aGrip[i]>RUBBER_GRIP ? m_aGrip[i] : (float)RUBBER_GRIP;
+    }
+  }
+}
+
+/**
+ * A car spends one time step in a cell (evolving mode): the cell is
+ * rubbered in a bit
+ *
+ * @param cell          (in) index of the cell (see Cell)
+ */
+void GripMap::Pass( int cell )
+{
+  m_aGrip[cell] += (float)(RUBBER_RATE*delta_time*(m_aTarget[cell]-m_aGrip[cell]));
+}
@@ -0,0 +1,96 @@
+/**
+ * gripmap.h - grip of the track along and across each segment
+ *
+ * Each segment of the track is cut in grip_rows cells along its length
+ * and grip_lanes cells across the width of the track (header of the
+ * .trx file). The "grip" parameter of a segment gives the factor applied
+ * to the friction force in each cell: the rows from the start of the
+ * segment, each row from the right side to the left side. A single
+ * value is used for the whole segment, no value means 1.
+ *   <header grip_rows="2" grip_lanes="3" ... />
+ *   <segment length="600" grip="1 1.02 .9  1 1.02 .7" />
+ *
+ * The factors are stored in one array [segment][row][lane], so the car
+ * model finds the cell of a car from seg_id, to_end and to_rgt in a few
+ * multiplications. In evolving mode (option -se), the cells where the
+ * cars drive are rubbered in: their grip goes up to RUBBER_GRIP (wet
+ * patches dry) a bit at each time step.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       gripmap.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_GRIPMAP_H
+#define __RARSCORE_GRIPMAP_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "track.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define RUBBER_GRIP  1.05  // grip of a cell completely rubbered in
+#define RUBBER_RATE  .02   // rubbering in of a cell, per second of car in the cell
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Grip map of the track (see RaceData::InitFriction)
+ */
+class GripMap
+{
+  private:
+    int      m_iNumSeg;
+    int      m_iRows;             // cells along a segment
+    int      m_iLanes;            // cells across the track
+    float  * m_aGrip;             // grip factor of the cells [seg][row][lane]
+    float  * m_aTarget;           // grip factor of the rubbered in cells
+    double * m_aRowScale;         // rows per unit of length of each segment (feet or radians)
+    double   m_fLaneScale;        // lanes per foot
+
+    void     Free();
+
+  public:
+    bool     m_bEvolve;           // Rubber the cells in when the cars pass
+
+    GripMap();
+    ~GripMap();
+    void     Init( Track * track, bool evolve );
+    void     Pass( int cell );
+
+    /**
+     * Cell of a car
+     *
+     * @param seg       (in) segment of the car (seg_id)
+     * @param to_end    (in) distance to the end of the segment (feet or radians)
+     * @param to_rgt    (in) distance to the right side of the track (feet)
+     * @return          index of the cell
+     */
+    int Cell( int seg, double to_end, double to_rgt )
+    {
+      int row = (int)(m_iRows - to_end*m_aRowScale[seg]);
+      int lane = (int)(to_rgt*m_fLaneScale);
+      if( row<0 ) row = 0; else if( row>=m_iRows ) row = m_iRows-1;
+      if( lane<0 ) lane = 0; else if( lane>=m_iLanes ) lane = m_iLanes-1;
+      return (seg*m_iRows + row)*m_iLanes + lane;
+    }
+
+    /**
+     * Grip factor of a cell
+     */
+    double Grip( int cell )
+    {
+      return m_aGrip[cell];
+    }
+};
+
+#endif
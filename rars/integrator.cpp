@@ -0,0 +1,166 @@
+/**
+ * INTEGRATOR.CPP - integration of the car model in time
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       integrator.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "integrator.h"
+#include "misc.h"
+#include "os.h"
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+Integrator::Integrator()
+{
+  m_aCar = NULL;
+  m_iNumCar = 0;
+  m_iMode = INTEGRATOR_REFERENCE;
+  m_iNumSubstep = 1;
+  m_fTolerance = INTEGRATOR_TOLERANCE;
+}
+
+/**
+ * Destructor
+ */
+Integrator::~Integrator()
+{
+  delete [] m_aCar;
+}
+
+/**
+ * Set the mode of the race and clear the statistics of the cars
+ *
+ * @param iMode         (in) INTEGRATOR_REFERENCE, INTEGRATOR_SUBSTEP or INTEGRATOR_ADAPTIVE
+ * @param iNumSubstep   (in) sub-steps of a tick (INTEGRATOR_SUBSTEP)
+ * @param fTolerance    (in) error of a tick above which it is cut (INTEGRATOR_ADAPTIVE)
+ * @param iNumCar       (in) cars of the race
+ */
+void Integrator::Init( int iMode, int iNumSubstep, double fTolerance, int iNumCar )
+{
+  m_iMode = iMode;
+  m_iNumSubstep = iNumSubstep<1 ? 1 : ( iNumSubstep>MAX_SUBSTEPS ? MAX_SUBSTEPS : iNumSubstep );
+  m_fTolerance = fTolerance>0.0 ? fTolerance : INTEGRATOR_TOLERANCE;
+
+  delete [] m_aCar;
+  m_iNumCar = iNumCar;
+  m_aCar = new IntegratorCar[iNumCar>0 ? iNumCar : 1];
+  for( int i=0; i<iNumCar; i++ )
+  {
+    Reset( i );
+    m_aCar[i].m_iNumTick = 0;
+    m_aCar[i].m_iNumStep = 0;
+    m_aCar[i].m_iMaxStep = 0;
+    m_aCar[i].m_oTickDiff.Clear();
+    m_aCar[i].m_oTickSpeedDiff.Clear();
+    m_aCar[i].m_fFuel = 0.0;
+    m_aCar[i].m_fRefFuel = 0.0;
+  }
+}
+
+/**
+ * Forget the history of a car (Car::PutCar)
+ *
+ * @param car           (in) index of the car in race_data.cars
+ */
+void Integrator::Reset( int car )
+{
+  if( car<0 || car>=m_iNumCar )
+  {
+    return;
+  }
+  IntegratorCar * c = m_aCar+car;
+  c->m_fPreStep = 0.0;
+  c->m_fTickXdot = c->m_fTickYdot = 0.0;
+  c->m_fTickXa = c->m_fTickYa = 0.0;
+  c->m_fTickXa2 = c->m_fTickYa2 = 0.0;
+  c->m_iNumHistory = 0;
+}
+
+/**
+ * Start of a tick, when the acceleration at the start of the tick is
+ * known: computes the reference step and the number of sub-steps.
+ *
+ * @param car           (in) index of the car in race_data.cars
+ * @param x, y          (in) position at the start of the tick
+ * @param xdot, ydot    (in) velocity
+ * @param x_a, y_a      (in) acceleration
+ * @return              sub-steps of the tick
+ */
+int Integrator::BeginTick( int car, double x, double y, double xdot, double ydot,
+                           double x_a, double y_a )
+{
+  IntegratorCar * c = m_aCar+car;
+  int n = 1;
+
+  c->m_fRefX = x + ( 1.5*xdot - .5*c->m_fTickXdot )*delta_time;
+  c->m_fRefY = y + ( 1.5*ydot - .5*c->m_fTickYdot )*delta_time;
+  c->m_fRefXdot = xdot + ( 1.5*x_a - .5*c->m_fTickXa )*delta_time;
+  c->m_fRefYdot = ydot + ( 1.5*y_a - .5*c->m_fTickYa )*delta_time;
+
+  if( m_iMode==INTEGRATOR_SUBSTEP )
+  {
+    n = m_iNumSubstep;
+  }
+  else if( c->m_iNumHistory>=2 )
+  {
+    double ex = x_a - 2.0*c->m_fTickXa + c->m_fTickXa2;
+    double ey = y_a - 2.0*c->m_fTickYa + c->m_fTickYa2;
+    double err = 5.0/12.0*delta_time*sqrt( ex*ex + ey*ey );
+    if( err>m_fTolerance )
+    {
+      n = (int)ceil( sqrt( err/m_fTolerance ) );
+      if( n>MAX_SUBSTEPS )
+      {
+        n = MAX_SUBSTEPS;
+      }
+    }
+  }
+
+  c->m_fTickXdot = xdot;
+  c->m_fTickYdot = ydot;
+  c->m_fTickXa2 = c->m_fTickXa;
+  c->m_fTickYa2 = c->m_fTickYa;
+  c->m_fTickXa = x_a;
+  c->m_fTickYa = y_a;
+  if( c->m_iNumHistory<2 )
+  {
+    c->m_iNumHistory++;
+  }
+
+  c->m_iNumTick++;
+  c->m_iNumStep += n;
+  if( n>c->m_iMaxStep )
+  {
+    c->m_iMaxStep = n;
+  }
+  return n;
+}
+
+/**
+ * End of a tick: difference of the sub-steps with the reference step
+ *
+ * @param car           (in) index of the car in race_data.cars
+ * @param x, y          (in) position at the end of the tick
+ * @param xdot, ydot    (in) velocity
+ */
+void Integrator::EndTick( int car, double x, double y, double xdot, double ydot )
+{
+  IntegratorCar * c = m_aCar+car;
+  c->m_oTickDiff.Add( vec_mag( x-c->m_fRefX, y-c->m_fRefY ) );
+  c->m_oTickSpeedDiff.Add( vec_mag( xdot-c->m_fRefXdot, ydot-c->m_fRefYdot ) );
+}
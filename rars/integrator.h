@@ -0,0 +1,120 @@
+/**
+ * integrator.h - integration of the car model (Car::MoveCarT) in time
+ *
+ * The robots drive at a fixed tick, delta_time (os.h). In the reference
+ * mode, the state of a car is advanced by one Adams-Bashforth step of a
+ * tick, as in the original model. The integrator can cut the tick in
+ * sub-steps, the controls of the robot (vc, alpha) being kept for the
+ * whole tick:
+ *  - INTEGRATOR_SUBSTEP (option -In): n sub-steps at each tick, n times
+ *    the cost of the physics;
+ *  - INTEGRATOR_ADAPTIVE (option -Ia): a tick is one step, as in the
+ *    reference mode, unless the local error estimated from the
+ *    accelerations of the last ticks (5/12 h |a(n) - 2 a(n-1) + a(n-2)|,
+ *    in fps) is above a tolerance: only then the tick is cut, in
+ *    sqrt(error/tolerance) sub-steps. It is more accurate than the
+ *    reference mode where the cars slide or crash, never faster: a step
+ *    is never longer than a tick.
+ * The sub-steps use the Adams-Bashforth formula for a variable step, so
+ * the step can change from a tick to the next one.
+ *
+ * In both modes, the reference step (one step of delta_time) is also
+ * computed from the state at the start of each tick, and the difference
+ * with the state at the end of the tick (tick difference) is kept for
+ * each car and written after the race (Report::WriteIntegrator). It is
+ * the local error of one tick, not the drift from a reference race: the
+ * two races part as soon as a robot reacts to the difference. The robots see the
+ * same tick and the same s.* in all modes. Each sub-step burns the fuel
+ * and takes the damage of its own length; the fuel the reference steps
+ * would burn is summed too, and the report warns when the two differ by
+ * more than INTEGRATOR_FUEL_ERROR.
+ *
+ * No mode steps over several ticks: a coarse fast-forward (the physics
+ * in steps longer than the tick of the robots, with its error checked
+ * against a reference race) is not done.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       integrator.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_INTEGRATOR_H
+#define __RARSCORE_INTEGRATOR_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "statistics.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define INTEGRATOR_REFERENCE  0      // one step of delta_time per tick
+#define INTEGRATOR_SUBSTEP    1      // a fixed number of sub-steps per tick
+#define INTEGRATOR_ADAPTIVE   2      // one step per tick, cut where the error is too large
+#define MAX_SUBSTEPS          32
+#define INTEGRATOR_TOLERANCE  0.02   // default tolerance of INTEGRATOR_ADAPTIVE (fps per tick)
+#define INTEGRATOR_FUEL_ERROR 0.02   // largest relative difference of the fuel burned with the reference steps
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Integrator state of a car
+ */
+struct IntegratorCar
+{
+  double m_fPreStep;            // last step (pre_xdot, pre_x_a of Car are one step back), 0 after PutCar
+  double m_fTickXdot, m_fTickYdot; // velocity at the start of the previous tick
+  double m_fTickXa, m_fTickYa;  // acceleration at the start of the previous tick
+  double m_fTickXa2, m_fTickYa2; // ... and of the tick before
+  int    m_iNumHistory;         // ticks since PutCar (0 to 2)
+  double m_fRefX, m_fRefY;      // reference step of the current tick
+  double m_fRefXdot, m_fRefYdot;
+  long   m_iNumTick;
+  long   m_iNumStep;
+  int    m_iMaxStep;            // most sub-steps of a tick
+  OnlineStat m_oTickDiff;       // distance to the reference step at the end of a tick (feet)
+  OnlineStat m_oTickSpeedDiff;  // same for the velocity (fps)
+  double m_fFuel;               // lb burned by the sub-steps (Car::MoveCarT)
+  double m_fRefFuel;            // lb burned by the reference steps (power at the start of each tick)
+};
+
+/**
+ * Integrator (used by Car::MoveCarT, see RaceData)
+ */
+class Integrator
+{
+  private:
+    IntegratorCar * m_aCar;
+    int      m_iNumCar;
+
+  public:
+    int      m_iMode;           // INTEGRATOR_REFERENCE, INTEGRATOR_SUBSTEP or INTEGRATOR_ADAPTIVE
+    int      m_iNumSubstep;     // INTEGRATOR_SUBSTEP
+    double   m_fTolerance;      // INTEGRATOR_ADAPTIVE
+
+    Integrator();
+    ~Integrator();
+    void     Init( int iMode, int iNumSubstep, double fTolerance, int iNumCar );
+    void     Reset( int car );
+    int      BeginTick( int car, double x, double y, double xdot, double ydot,
+                        double x_a, double y_a );
+    void     EndTick( int car, double x, double y, double xdot, double ydot );
+
+    /**
+     * @param car       (in) index of the car in race_data.cars
+     * @return          state of the car, NULL in the reference mode
+     */
+    IntegratorCar * State( int car )
+    {
+      return m_iMode==INTEGRATOR_REFERENCE ? (IntegratorCar *)0 : m_aCar+car;
+    }
+};
+
+#endif
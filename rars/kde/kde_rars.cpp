@@ -111,10 +111,33 @@ MyImage::MyImage( int image_id, QWidget * parent ):QWidget(parent)
   setBackgroundMode( NoBackground );
 }
 
-void MyImage::paintEvent(QPaintEvent *)
+/**
+ * Repaint only the parts of the image that changed (see TLowGraphic::GetDirtyRects)
+ */
+void MyImage::paintEvent(QPaintEvent * e)
 {
   QPainter paint(this);
-  paint.drawImage(0, 0, g_aImage[m_iImageId], 0, 0, g_aImage[m_iImageId].width(), g_aImage[m_iImageId].height());
+  QMemArray<QRect> rects = e->region().rects();
+  for( uint i=0; i<rects.size(); i++ )
+  {
+    const QRect & r = rects[i];
+    paint.drawImage(r.x(), r.y(), g_aImage[m_iImageId], r.x(), r.y(), r.width(), r.height());
+  }
+}
+
+/**
+ * Ask to repaint the damaged parts of a view
+ *
+ * @param view          (in) the view drawn in the image
+ */
+void MyImage::UpdateDirty( TLowGraphic * view )
+{
+  IntRect r[MAX_DIRTY_RECT];
+  int n = view->GetDirtyRects( r, MAX_DIRTY_RECT );
+  for( int i=0; i<n; i++ )
+  {
+    update( r[i].x1, r[i].y1, r[i].x2-r[i].x1+1, r[i].y2-r[i].y1+1 );
+  }
 }
 
 //--------------------------------------------------------------------------
@@ -524,20 +547,24 @@ void KdeRars::slotTimeOut()
     }
     else if( iViewMode==MODE_CLASSIC || iViewMode==MODE_TELEMETRY )
     {
-      image[0]->update();
+      g_ViewManager->Lock();
+      image[0]->UpdateDirty( g_ViewManager->m_Views[0] );
+      g_ViewManager->Unlock();
     }
     else
     {
+      g_ViewManager->Lock();
       if( iViewMode==MODE_OPENGL_WINDOW )
       {
         image_opengl->update();
       }
       else
       {
-        image[0]->update();
+        image[0]->UpdateDirty( g_ViewManager->m_Views[0] );
       }
-      image[1]->update();
-      image[2]->update();
+      image[1]->UpdateDirty( g_ViewManager->m_Views[1] );
+      image[2]->UpdateDirty( g_ViewManager->m_Views[2] );
+      g_ViewManager->Unlock();
     }
   }
   g_iCptMain++;
@@ -556,22 +583,27 @@ void KdeRars::resizeEvent ( QResizeEvent * )
   m_offy = max( 0, h-432 );  // and not 510 ??
   m_offx = m_offx-(m_offx%8);
 
+  // the render thread does not draw during the change
+  g_ViewManager->Lock();
   // <to_remove>
   g_ViewManager->DeleteAllViews();
   g_ViewManager->InitAllViews();
   // </to_remove>
 
   g_ViewManager->ResizeAllViews( m_offx, m_offy );
+  g_ViewManager->Unlock();
   SetImageGeometry();
 }
 
 void KdeRars::SetOpenGLMode( int mode )
 {
 //  timer->stop();
+  g_ViewManager->Lock();
   g_ViewManager->DeleteAllViews();
   g_ViewManager->m_iViewMode = mode;
   g_ViewManager->InitAllViews();
   g_ViewManager->ResizeAllViews( m_offx, m_offy );
+  g_ViewManager->Unlock();
   SetImageGeometry();
 //  timer->start( 50, false );
 }
@@ -18,6 +18,7 @@
 #include <qgl.h>
 
 class QLabel;
+class TLowGraphic;
 
 //--------------------------------------------------------------------------
 //                           G L O B A L S
@@ -41,6 +42,7 @@ class MyImage : public QWidget
 
 public:
   MyImage( int image_id, QWidget * parent);
+  void UpdateDirty( TLowGraphic * view );
 protected:
   void paintEvent(QPaintEvent *);
 };
@@ -0,0 +1,365 @@
+/**
+ * LAP_TIMING.CPP - Line crossing times, sectors and mini-sectors of the race
+ *
+ * History
+ *  ver. 0.90 Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <string.h>
+#include <math.h>
+#include "lap_timing.h"
+#include "track.h"
+#include "globals.h"
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+LapTiming::LapTiming()
+{
+  m_iNumCar = 0;
+  m_iNumLap = 0;
+  m_iNumSector = 1;
+  m_iNumMini = 1;
+  m_fLength = 1.0;
+  m_fMiniLength = 1.0;
+  m_aTime = NULL;
+  m_aSplit = NULL;
+  m_aCar = NULL;
+  m_aMemory = NULL;
+}
+
+/**
+ * Destructor
+ */
+LapTiming::~LapTiming()
+{
+  Close();
+}
+
+/**
+ * Allocate the times of a race (in one block) and clear them
+ *
+ * @param iNumCar       (in) number of cars
+ * @param iNumLap       (in) number of laps of the race
+ * @param track         (in) track of the race
+ */
+void LapTiming::Init( int iNumCar, int iNumLap, const Track * track )
+{
+  int i;
+
+  Close();
+  m_iNumCar = iNumCar;
+  m_iNumLap = iNumLap;
+  m_fLength = track->length;
+  InitSectors( track, args.m_iNumSector>0 ? args.m_iNumSector : track->m_iNumSector );
+  m_iNumMini = 1;
+  if( args.m_iMiniSector>0 )
+  {
+    m_iNumMini = (int)ceil( m_fLength/args.m_iMiniSector );
+  }
+  m_fMiniLength = m_fLength/m_iNumMini;
+
+  long iNumTime = (long)( iNumLap+1 )*iNumCar;
+  long iSize = iNumTime*sizeof(double)
+             + iNumCar*sizeof(LapTimingCar)
+             + iNumTime*m_iNumSector*sizeof(float)
+             + 3L*iNumCar*m_iNumMini*sizeof(float);
+  m_aMemory = new char[iSize];
+  memset( m_aMemory, 0, iSize );
+
+  m_aTime = (double *)m_aMemory;
+  m_aCar = (LapTimingCar *)( m_aTime+iNumTime );
+  m_aSplit = (float *)( m_aCar+iNumCar );
+  float * mini = m_aSplit+iNumTime*m_iNumSector;
+  for( i=0; i<iNumCar; i++ )
+  {
+    LapTimingCar * c = m_aCar+i;
+    c->m_iLastLap = -1;
+    c->m_aMini = mini;
+    c->m_aBestMini = mini+m_iNumMini;
+    c->m_aMiniBest = mini+2*m_iNumMini;
+    mini += 3*m_iNumMini;
+  }
+}
+
+/**
+ * Sectors ending at the ends of the segments the nearest to equal
+ * fractions of the lap (less sectors if the track has not enough segments)
+ *
+ * @param track         (in) track of the race
+ * @param iNumSector    (in) number of sectors wanted
+ */
+void LapTiming::InitSectors( const Track * track, int iNumSector )
+{
+  iNumSector = iNumSector<1 ? 1 : ( iNumSector>MAX_LAP_SECTORS ? MAX_LAP_SECTORS : iNumSector );
+  m_iNumSector = 0;
+  for( int k=1; k<iNumSector; k++ )
+  {
+    double target = k*m_fLength/iNumSector;
+    double prev = m_iNumSector>0 ? m_aSectorEnd[m_iNumSector-1] : 0.0;
+    double best = -1.0;
+    for( int i=0; i<track->NSEG; i++ )
+    {
+      double d = track->seg_dist[i];
+      if( d>prev && d<m_fLength && ( best<0.0 || fabs(d-target)<fabs(best-target) ) )
+      {
+        best = d;
+      }
+    }
+    if( best>0.0 )
+    {
+      m_aSectorEnd[m_iNumSector++] = best;
+    }
+  }
+  m_aSectorEnd[m_iNumSector++] = m_fLength;
+}
+
+/**
+ * Free the times of the race
+ */
+void LapTiming::Close()
+{
+  delete [] m_aMemory;
+  m_aMemory = NULL;
+  m_aTime = NULL;
+  m_aSplit = NULL;
+  m_aCar = NULL;
+}
+
+/**
+ * Distance of the next end of sector or of mini-sector of a car
+ *
+ * @param c             (in/out) timing of the car
+ */
+void LapTiming::NextEnd( LapTimingCar * c )
+{
+  double mini = ( c->m_iMini+1 )*m_fMiniLength;
+  double sector = m_aSectorEnd[c->m_iSector];
+  c->m_fNext = mini<sector ? mini : sector;
+}
+
+/**
+ * End of the current mini-sector of a car
+ *
+ * @param c             (in/out) timing of the car
+ * @param t             (in) time since the start of the lap
+ */
+void LapTiming::EndMini( LapTimingCar * c, float t )
+{
+  int j = c->m_iMini;
+  float d = t-( j>0 ? c->m_aMini[j-1] : 0.0f );
+
+  c->m_aMini[j] = t;
+  if( d>0.0f && ( c->m_aMiniBest[j]==0.0f || d<c->m_aMiniBest[j] ) )
+  {
+    c->m_aMiniBest[j] = d;
+  }
+  if( c->m_fBestLap>0.0 )
+  {
+    c->m_fDelta = t-c->m_aBestMini[j];
+  }
+  c->m_iMini++;
+}
+
+/**
+ * The car left one or more sectors or mini-sectors since the last step.
+ * The times are interpolated between the two steps.
+ *
+ * @param c             (in/out) timing of the car
+ * @param car           (in) index of the car
+ * @param distance      (in) distance from the line
+ * @param time          (in) time of the step
+ */
+void LapTiming::Cross( LapTimingCar * c, int car, double distance, double time )
+{
+  double start = m_aTime[Index(car,c->m_iLastLap)];
+  double a = ( time-c->m_fPrevTime )/( distance-c->m_fPrevDist );
+  double end;
+
+  float * split = m_aSplit+Index(car,c->m_iLastLap+1)*m_iNumSector;
+  while( c->m_iSector<m_iNumSector-1 && distance>=( end = m_aSectorEnd[c->m_iSector] ) )
+  {
+    split[c->m_iSector++] = (float)( c->m_fPrevTime+( end-c->m_fPrevDist )*a-start );
+  }
+  while( c->m_iMini<m_iNumMini-1 && distance>=( end = ( c->m_iMini+1 )*m_fMiniLength ) )
+  {
+    EndMini( c, (float)( c->m_fPrevTime+( end-c->m_fPrevDist )*a-start ) );
+  }
+  NextEnd( c );
+}
+
+/**
+ * The car crossed the line. The sectors and mini-sectors not noted
+ * during the lap end with it.
+ *
+ * @param car           (in) index of the car
+ * @param lap           (in) laps completed by the car (0 at the start)
+ * @param time          (in) time of the crossing
+ */
+void LapTiming::Lap( int car, int lap, double time )
+{
+  LapTimingCar * c = m_aCar+car;
+
+  if( lap<0 || lap>m_iNumLap )
+  {
+    return;
+  }
+  m_aTime[Index(car,lap)] = time;
+  if( lap>0 && c->m_iLastLap==lap-1 )
+  {
+    float lap_time = (float)( time-m_aTime[Index(car,lap-1)] );
+    float * split = m_aSplit+Index(car,lap)*m_iNumSector;
+    while( c->m_iSector<m_iNumSector )
+    {
+      split[c->m_iSector++] = lap_time;
+    }
+    while( c->m_iMini<m_iNumMini )
+    {
+      EndMini( c, lap_time );
+    }
+    if( c->m_fBestLap==0.0 || lap_time<c->m_fBestLap )
+    {
+      c->m_fBestLap = lap_time;
+      c->m_iBestLap = lap;
+      memcpy( c->m_aBestMini, c->m_aMini, m_iNumMini*sizeof(float) );
+    }
+  }
+  c->m_iLastLap = lap;
+  c->m_iSector = 0;
+  c->m_iMini = 0;
+  c->m_fPrevDist = 0.0;
+  c->m_fPrevTime = time;
+  NextEnd( c );
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param lap           (in) lap (1 to m_iNumLap)
+ * @return              time of the lap, 0 if not completed
+ */
+double LapTiming::LapTime( int car, int lap ) const
+{
+  if( lap<1 || lap>m_aCar[car].m_iLastLap )
+  {
+    return 0.0;
+  }
+  return m_aTime[Index(car,lap)]-m_aTime[Index(car,lap-1)];
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param lap           (in) lap (1 to m_iNumLap)
+ * @param sector        (in) sector (0 to NumSector()-1)
+ * @return              time since the start of the lap when the car left
+ *                      the sector, 0 if not done
+ */
+double LapTiming::Split( int car, int lap, int sector ) const
+{
+  if( lap<1 || lap>m_iNumLap )
+  {
+    return 0.0;
+  }
+  return m_aSplit[Index(car,lap)*m_iNumSector+sector];
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param lap           (in) lap (1 to m_iNumLap)
+ * @param sector        (in) sector (0 to NumSector()-1)
+ * @return              time spent in the sector, 0 if not done
+ */
+double LapTiming::SectorTime( int car, int lap, int sector ) const
+{
+  double split = Split( car, lap, sector );
+  if( split==0.0 || sector==0 )
+  {
+    return split;
+  }
+  return split-Split( car, lap, sector-1 );
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param lap           (out) lap of the best time (may be NULL)
+ * @return              best lap time of the car, 0 if no lap completed
+ */
+double LapTiming::BestLapTime( int car, int * lap ) const
+{
+  if( lap!=NULL )
+  {
+    *lap = m_aCar[car].m_iBestLap;
+  }
+  return m_aCar[car].m_fBestLap;
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param sector        (in) sector (0 to NumSector()-1)
+ * @return              best time of the car in the sector, 0 if not done
+ */
+double LapTiming::BestSectorTime( int car, int sector ) const
+{
+  double best = 0.0;
+  for( int i=1; i<=m_aCar[car].m_iLastLap; i++ )
+  {
+    double t = SectorTime( car, i, sector );
+    if( t>0.0 && ( best==0.0 || t<best ) )
+    {
+      best = t;
+    }
+  }
+  return best;
+}
+
+/**
+ * @param car           (in) index of the car
+ * @return              sum of the best times of the car in each
+ *                      mini-sector, 0 if no lap completed
+ */
+double LapTiming::TheoreticalBest( int car ) const
+{
+  const LapTimingCar * c = m_aCar+car;
+  double sum = 0.0;
+
+  if( c->m_fBestLap==0.0 )
+  {
+    return 0.0;
+  }
+  for( int j=0; j<m_iNumMini; j++ )
+  {
+    sum += c->m_aMiniBest[j];
+  }
+  return sum;
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param other         (in) index of the other car
+ * @param lap           (in) lap crossed by both cars
+ * @return              time between the crossings of the line by the cars
+ */
+double LapTiming::Gap( int car, int other, int lap ) const
+{
+  return Time( car, lap )-Time( other, lap );
+}
+
+/**
+ * @param car           (in) index of the car
+ * @param other         (in) index of the other car
+ * @return              laps crossed by the other car and not by this one
+ */
+int LapTiming::LapsDown( int car, int other ) const
+{
+  return m_aCar[other].m_iLastLap-m_aCar[car].m_iLastLap;
+}
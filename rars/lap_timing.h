@@ -0,0 +1,153 @@
+/**
+ * LAP_TIMING.H - Line crossing times, sectors and mini-sectors of the race
+ *
+ * The times of all the cars are kept in one matrix [lap][car], allocated
+ * once for the race. With the last lap completed by each car, the gaps
+ * between cars and the laps down are read without searching the laps.
+ *
+ * Sectors: the lap is divided in sectors ending at the ends of segments
+ * (seg_dist), near equal fractions of the lap. Their number is given by
+ * "sectors" in the header of the track or by the option -ts. The split of
+ * a sector is the time since the start of the lap when the car leaves it
+ * (the split of the last sector is the lap time). The splits of all the
+ * laps are kept.
+ *
+ * Mini-sectors: every args.m_iMiniSector feet (option -tm). Only the
+ * current lap is kept for each car, in a ring indexed by the mini-sector
+ * (before the car: lap in progress, after it: previous lap), with the same
+ * times of the best lap and the best time of each mini-sector. They give
+ * the delta to the best lap at each mini-sector and the theoretical best
+ * lap.
+ *
+ * The crossing times of the sectors and of the mini-sectors are
+ * interpolated between the steps.
+ *
+ * History
+ *  ver. 0.90 Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_LAP_TIMING_H
+#define __RARSCORE_LAP_TIMING_H
+
+//--------------------------------------------------------------------------
+//                          D E F I N E S
+//--------------------------------------------------------------------------
+
+#define MAX_LAP_SECTORS 8
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+class Track;
+
+/**
+ * Timing of one car
+ */
+struct LapTimingCar
+{
+  double  m_fPrevDist;          // distance and time of the last step (interpolation)
+  double  m_fPrevTime;
+  double  m_fNext;              // distance of the next end of sector or mini-sector
+  double  m_fBestLap;           // best lap time, 0 if none
+  int     m_iBestLap;           // lap of the best time
+  int     m_iLastLap;           // last lap crossed, -1 before the start
+  int     m_iSector;            // sector where the car is
+  int     m_iMini;              // mini-sector where the car is
+  float   m_fDelta;             // time to the best lap at the last mini-sector
+  float * m_aMini;              // [mini] time in the lap at the end of the mini-sectors (ring)
+  float * m_aBestMini;          // [mini] m_aMini of the best lap
+  float * m_aMiniBest;          // [mini] best time in each mini-sector
+};
+
+/**
+ * LapTiming (race_data.m_oLapTiming, used during the race)
+ *
+ * Usage:
+ *   m_oLapTiming.Init( args.m_iNumCar, args.m_iNumLap, currentTrack ); // RaceInit
+ *   m_oLapTiming.Sector( car, laps, distance, time );     // each step (Observe)
+ *   m_oLapTiming.Lap( car, laps, LineTime );              // line crossing
+ *   m_oLapTiming.Close();                                 // RaceClose
+ */
+class LapTiming
+{
+  private:
+    int      m_iNumCar;
+    int      m_iNumLap;
+    int      m_iNumSector;
+    int      m_iNumMini;
+    double   m_fLength;         // length of the track
+    double   m_fMiniLength;     // length of the mini-sectors
+    double   m_aSectorEnd[MAX_LAP_SECTORS]; // distance of the end of the sectors
+    double * m_aTime;           // [lap][car] time of the line crossing, 0 if not crossed
+    float  * m_aSplit;          // [lap][car][sector] split of the sectors, 0 if not done
+    LapTimingCar * m_aCar;      // [car]
+    char   * m_aMemory;         // one block for all the arrays
+
+    inline int Index( int car, int lap ) const { return lap*m_iNumCar+car; }
+
+    void   InitSectors( const Track * track, int iNumSector );
+    void   Cross( LapTimingCar * c, int car, double distance, double time );
+    void   EndMini( LapTimingCar * c, float t );
+    void   NextEnd( LapTimingCar * c );
+
+  public:
+    LapTiming();
+    ~LapTiming();
+
+    void   Init( int iNumCar, int iNumLap, const Track * track );
+    void   Close();
+    bool   IsOpen() const { return m_aMemory!=NULL; }
+
+    void   Lap( int car, int lap, double time );
+
+    /**
+     * Each step of a car: sectors and mini-sectors left since the last step
+     *
+     * @param car           (in) index of the car
+     * @param lap           (in) laps completed by the car
+     * @param distance      (in) distance from the line
+     * @param time          (in) time of the step
+     */
+    inline void Sector( int car, int lap, double distance, double time )
+    {
+      LapTimingCar * c = m_aCar+car;
+      if( lap!=c->m_iLastLap || lap<0 || lap>=m_iNumLap )
+      {
+        return;
+      }
+      if( distance>=c->m_fNext && distance>c->m_fPrevDist )
+      {
+        Cross( c, car, distance, time );
+      }
+      c->m_fPrevDist = distance;
+      c->m_fPrevTime = time;
+    }
+
+    /**
+     * @return time of the line crossing, 0 if not crossed
+     */
+    inline double Time( int car, int lap ) const
+    {
+      return (lap<0 || lap>m_iNumLap) ? 0.0 : m_aTime[Index(car,lap)];
+    }
+    inline int    LastLap( int car ) const { return m_aCar[car].m_iLastLap; }
+    inline int    NumSector() const { return m_iNumSector; }
+    inline int    NumMini() const { return m_iNumMini; }
+    inline double Delta( int car ) const { return m_aCar[car].m_fDelta; }
+
+    double LapTime( int car, int lap ) const;
+    double Split( int car, int lap, int sector ) const;
+    double SectorTime( int car, int lap, int sector ) const;
+    double BestLapTime( int car, int * lap ) const;
+    double BestSectorTime( int car, int sector ) const;
+    double TheoreticalBest( int car ) const;
+
+    double Gap( int car, int other, int lap ) const;
+    int    LapsDown( int car, int other ) const;
+};
+
+#endif
@@ -530,7 +530,7 @@ void qsortem()
   {
     if( args.m_iQualMode==QUAL_FASTEST_LAP )
     {
-      while(race_data.cars[race_data.m_aCarInPos[i+1]]->Q_bestlap > race_data.cars[race_data.m_aCarInPos[i]]->Q_bestlap)  
+      while(race_data.cars[race_data.m_aCarInPos[i+1]]->get_q_bestlap() > race_data.cars[race_data.m_aCarInPos[i]]->get_q_bestlap())  
       { 
         // When a car runs faster qualifying lap, we swap positions:
         temp = race_data.m_aCarInPos[i]; 
@@ -544,7 +544,7 @@ void qsortem()
     }
     else if( args.m_iQualMode==QUAL_AVERAGE_SPEED )
     {
-      while(race_data.cars[race_data.m_aCarInPos[i+1]]->Q_avgspeed > race_data.cars[race_data.m_aCarInPos[i]]->Q_avgspeed)  
+      while(race_data.cars[race_data.m_aCarInPos[i+1]]->get_q_avgspeed() > race_data.cars[race_data.m_aCarInPos[i]]->get_q_avgspeed())  
       {
         // When a car gets higher average speed, we swap positions:
         temp = race_data.m_aCarInPos[i];
@@ -560,9 +560,9 @@ void qsortem()
 
   for(i = 0; i < args.m_iNumCar-1; i++)
   {
-    if(race_data.cars[race_data.m_aCarInPos[i]]->Out == 3)
+    if(race_data.cars[race_data.m_aCarInPos[i]]->get_out() == 3)
     {
-      if(race_data.cars[race_data.m_aCarInPos[i+1]]->Out != 3) 
+      if(race_data.cars[race_data.m_aCarInPos[i+1]]->get_out() != 3) 
       { 
         temp = race_data.m_aCarInPos[i];
         race_data.m_aCarInPos[i] = race_data.m_aCarInPos[i+1];
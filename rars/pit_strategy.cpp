@@ -0,0 +1,413 @@
+/**
+ * PIT_STRATEGY.CPP - evaluation of pit plans
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       pit_strategy.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <math.h>
+#include "pit_strategy.h"
+#include "car.h"
+#include "track.h"
+#include "profiles.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define PIT_MASS_SHARE   0.3     // DefaultProfile: lap time ~ mass^0.3 (accelerations)
+#define PIT_DRAG_SHARE   0.1     // DefaultProfile: lap time ~ drag^0.1 (straights)
+#define PIT_TWO_PI       6.28318530717959
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+/**
+ * Fuel margins and shares of the damage repaired tried by Optimize
+ */
+static const double s_aMargin[] = { 0.01, 0.03, 0.06, 0.1, 0.15, 0.2, 0.3 };
+static const double s_aRepair[] = { 0.0, 0.25, 0.5, 0.75, 1.0 };
+static const int s_iNumMargin = sizeof(s_aMargin)/sizeof(s_aMargin[0]);
+static const int s_iNumRepair = sizeof(s_aRepair)/sizeof(s_aRepair[0]);
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+PitStrategy::PitStrategy()
+{
+  m_oProfile.m_fLapTime = 0.0;
+  m_oProfile.m_fLapTimeSd = 0.0;
+  m_oProfile.m_fFuelPerLap = 0.0;
+  m_oProfile.m_fFuelSd = 0.0;
+  m_oProfile.m_fDamagePerLap = 0.0;
+  m_oProfile.m_fDamageSd = 0.0;
+  m_oProfile.m_fFuelPenalty = 0.0;
+  m_oProfile.m_fDamagePenalty = 0.0;
+  m_oProfile.m_fPitLaneLoss = 0.0;
+  m_oProfile.m_fMaxFuel = MAX_FUEL;
+  m_iNumLap = 0;
+  m_fStartDamage = 0.0;
+  SetSeed( 1 );
+}
+
+/**
+ * @param profile       (in) what the robot does in a lap
+ * @param iNumLap       (in) laps of the plans (eg. the laps to go)
+ * @param fStartDamage  (in) damage at the start of the plans
+ */
+void PitStrategy::Init( const LapProfile * profile, int iNumLap, double fStartDamage )
+{
+  m_oProfile = *profile;
+  m_iNumLap = iNumLap;
+  m_fStartDamage = fStartDamage;
+}
+
+/**
+ * Seed of the generator of Simulate (the same seed gives the same scores)
+ *
+ * @param seed          (in) any value
+ */
+void PitStrategy::SetSeed( unsigned int seed )
+{
+  m_iRandom = seed ? seed : 1;
+  m_bGauss = false;
+}
+
+/**
+ * @return              a normal random value (mean 0, deviation 1)
+ */
+double PitStrategy::Gauss()
+{
+  if( m_bGauss )
+  {
+    m_bGauss = false;
+    return m_fGauss;
+  }
+  double u[2];
+  for( int i=0; i<2; i++ )
+  {
+    m_iRandom ^= m_iRandom<<13;
+    m_iRandom ^= m_iRandom>>17;
+    m_iRandom ^= m_iRandom<<5;
+    u[i] = ( (m_iRandom&0xFFFFFFFFU)+0.5 )/4294967296.0;
+  }
+  double r = sqrt( -2.0*log(u[0]) );
+  m_fGauss = r*sin( PIT_TWO_PI*u[1] );
+  m_bGauss = true;
+  return r*cos( PIT_TWO_PI*u[1] );
+}
+
+/**
+ * Time standing in the pits (see Car::MoveCar)
+ *
+ * @param fuel_amount   (in) fuel added, lb
+ * @param repair_amount (in) damage repaired
+ * @return              seconds
+ */
+double PitStrategy::StopTime( double fuel_amount, long repair_amount )
+{
+  double t = PIT_REPAIR_TIME*repair_amount;
+  if( t<PIT_REFUEL_TIME*fuel_amount )
+  {
+    t = PIT_REFUEL_TIME*fuel_amount;
+  }
+  return t;
+}
+
+/**
+ * A profile for the current track and physics, from the lap time and the
+ * fuel of a lap. The other values are estimates: the lap time varies by
+ * 1%, the fuel by 2%, there is no damage; the time lost per lb of fuel
+ * and per unit of damage come from the mass and the drag of the car; the
+ * pit lane is driven at m_fPitLaneSpeed instead of the average speed.
+ *
+ * @param p             (out) profile
+ * @param fLapTime      (in) lap time of the robot (s)
+ * @param fFuelPerLap   (in) fuel of a lap (lb), eg. length/(5280*s.fuel_mileage)
+ */
+void PitStrategy::DefaultProfile( LapProfile * p, double fLapTime, double fFuelPerLap )
+{
+  const PhysicsProfile * physics = race_data.m_pPhysics;
+  double max_fuel = physics!=NULL ? physics->m_fMaxFuel : MAX_FUEL;
+  double mass = physics!=NULL ? physics->m_fMass : M;
+
+  p->m_fLapTime = fLapTime;
+  p->m_fLapTimeSd = 0.01*fLapTime;
+  p->m_fFuelPerLap = fFuelPerLap;
+  p->m_fFuelSd = 0.02*fFuelPerLap;
+  p->m_fDamagePerLap = 0.0;
+  p->m_fDamageSd = 0.0;
+  // weight of the car with half a tank (lb), drag grows by 2/MAX_DAMAGE per unit
+  p->m_fFuelPenalty = PIT_MASS_SHARE*fLapTime/( mass*g+max_fuel/2 );
+  p->m_fDamagePenalty = PIT_DRAG_SHARE*fLapTime*2.0/MAX_DAMAGE;
+  p->m_fMaxFuel = max_fuel;
+
+  p->m_fPitLaneLoss = 0.0;
+  if( currentTrack!=NULL && currentTrack->m_fPitLaneSpeed>0.0 && fLapTime>0.0 )
+  {
+    double lane = currentTrack->m_fPitExit-currentTrack->m_fPitEntry;
+    if( lane<0.0 )
+    {
+      lane += currentTrack->length;
+    }
+    double speed = currentTrack->length/fLapTime;
+    if( speed>currentTrack->m_fPitLaneSpeed )
+    {
+      p->m_fPitLaneLoss = lane/currentTrack->m_fPitLaneSpeed-lane/speed;
+    }
+  }
+}
+
+/**
+ * Race time of a plan with the mean values of the profile. In a stint of
+ * k laps starting with the fuel F and the damage D, the lap i (0..k-1)
+ * carries F-(i+1/2)f and D+(i+1/2)d on average, so the time of the stint is
+ *   k*T + Pf*(k*F - f*k^2/2) + Pd*(k*D + d*k^2/2)
+ *
+ * @param plan          (in) the plan
+ * @return              race time, PIT_INFEASIBLE if the car runs out of
+ *                      fuel or has too much damage
+ */
+double PitStrategy::Evaluate( const PitPlan * plan ) const
+{
+  const LapProfile * p = &m_oProfile;
+  double fuel = plan->m_fStartFuel;
+  double damage = m_fStartDamage;
+  double time = 0.0;
+  int from = 0;
+
+  for( int i=0; i<=plan->m_iNumStop; i++ )
+  {
+    int to = i<plan->m_iNumStop ? plan->m_aLap[i] : m_iNumLap;
+    double k = to-from;
+    if( k<0.0 )
+    {
+      return PIT_INFEASIBLE;
+    }
+    time += k*p->m_fLapTime
+          + p->m_fFuelPenalty*( k*fuel-p->m_fFuelPerLap*k*k/2.0 )
+          + p->m_fDamagePenalty*( k*damage+p->m_fDamagePerLap*k*k/2.0 );
+    fuel -= k*p->m_fFuelPerLap;
+    damage += k*p->m_fDamagePerLap;
+    if( ( k>0.0 && fuel<=0.0 ) || damage>MAX_DAMAGE )
+    {
+      return PIT_INFEASIBLE;
+    }
+    if( i<plan->m_iNumStop )
+    {
+      double fuel_amount = plan->m_aFuel[i];
+      if( fuel_amount>p->m_fMaxFuel-fuel )
+      {
+        fuel_amount = p->m_fMaxFuel-fuel;
+      }
+      long repair_amount = plan->m_aRepair[i]<(long)damage ? plan->m_aRepair[i] : (long)damage;
+      time += p->m_fPitLaneLoss+StopTime( fuel_amount, repair_amount );
+      fuel += fuel_amount;
+      damage -= repair_amount;
+    }
+    from = to;
+  }
+  return time;
+}
+
+/**
+ * Monte-Carlo simulation of a plan: each run drives the laps one by one
+ * with a normal lap time, fuel and damage (not below 0) and does the stops
+ * of the plan with the same limits as the car.
+ *
+ * @param plan          (in) the plan
+ * @param iNumRun       (in) runs of the race
+ * @param score         (out) mean time, risk of not finishing
+ */
+void PitStrategy::Simulate( const PitPlan * plan, int iNumRun, PitScore * score )
+{
+  const LapProfile * p = &m_oProfile;
+  double sum = 0.0, sum2 = 0.0;
+  int run, lap, finished = 0;
+
+  for( run=0; run<iNumRun; run++ )
+  {
+    double fuel = plan->m_fStartFuel;
+    double damage = m_fStartDamage;
+    double time = 0.0;
+    int stop = 0;
+    for( lap=1; lap<=m_iNumLap; lap++ )
+    {
+      double t = p->m_fLapTime+p->m_fLapTimeSd*Gauss();
+      double f = p->m_fFuelPerLap+p->m_fFuelSd*Gauss();
+      double d = p->m_fDamagePerLap+p->m_fDamageSd*Gauss();
+      if( t<0.5*p->m_fLapTime ) t = 0.5*p->m_fLapTime;
+      if( f<0.0 ) f = 0.0;
+      if( d<0.0 ) d = 0.0;
+      time += t+p->m_fFuelPenalty*( fuel-f/2.0 )+p->m_fDamagePenalty*( damage+d/2.0 );
+      fuel -= f;
+      damage += d;
+      if( fuel<=0.0 || damage>MAX_DAMAGE )
+      {
+        break;
+      }
+      if( stop<plan->m_iNumStop && plan->m_aLap[stop]==lap )
+      {
+        double fuel_amount = plan->m_aFuel[stop];
+        if( fuel_amount>p->m_fMaxFuel-fuel )
+        {
+          fuel_amount = p->m_fMaxFuel-fuel;
+        }
+        long repair_amount = plan->m_aRepair[stop]<(long)damage ? plan->m_aRepair[stop] : (long)damage;
+        time += p->m_fPitLaneLoss+StopTime( fuel_amount, repair_amount );
+        fuel += fuel_amount;
+        damage -= repair_amount;
+        stop++;
+      }
+    }
+    if( lap>m_iNumLap )
+    {
+      finished++;
+      sum += time;
+      sum2 += time*time;
+    }
+  }
+
+  score->m_fTime = finished>0 ? sum/finished : 0.0;
+  score->m_fTimeSd = finished>1 ? sqrt( ( sum2-sum*sum/finished )/( finished-1 ) ) : 0.0;
+  score->m_fDnf = iNumRun>0 ? (double)( iNumRun-finished )/iNumRun : 0.0;
+  score->m_fScore = iNumRun>0 ? ( sum+( iNumRun-finished )*2.0*m_iNumLap*p->m_fLapTime )/iNumRun : 0.0;
+}
+
+/**
+ * Build a plan: the first stint has iFirst laps, the others share the rest
+ * of the race. The car takes the fuel of the next stint plus a margin, and
+ * repairs a share of the damage expected at the stop.
+ *
+ * @param plan          (out) the plan
+ * @param iNumStop      (in) stops
+ * @param iFirst        (in) laps of the first stint
+ * @param fMargin       (in) fuel taken in more than needed (eg. 0.1 for 10%)
+ * @param fRepair       (in) share of the damage repaired at the stops
+ * @param fStartFuel    (in) fuel at the start of the plan, 0 to choose it
+ */
+void PitStrategy::MakePlan( PitPlan * plan, int iNumStop, int iFirst, double fMargin,
+                            double fRepair, double fStartFuel )
+{
+  const LapProfile * p = &m_oProfile;
+  double need = p->m_fFuelPerLap*( 1.0+fMargin );
+  int lap = iFirst, len = iFirst, i;
+
+  if( fStartFuel<=0.0 )
+  {
+    // below 1 lb, the car would start with a full tank (Car::Control)
+    fStartFuel = len*need;
+    if( fStartFuel<1.0 ) fStartFuel = 1.0;
+    if( fStartFuel>p->m_fMaxFuel ) fStartFuel = p->m_fMaxFuel;
+  }
+  plan->m_fStartFuel = fStartFuel;
+  plan->m_iNumStop = iNumStop;
+
+  double fuel = fStartFuel;
+  double damage = m_fStartDamage;
+  int rest = m_iNumLap-iFirst;
+  for( i=0; i<iNumStop; i++ )
+  {
+    plan->m_aLap[i] = lap;
+    fuel -= len*p->m_fFuelPerLap;
+    damage += len*p->m_fDamagePerLap;
+    plan->m_aRepair[i] = (long)( fRepair*damage );
+    damage -= plan->m_aRepair[i];
+
+    len = rest/iNumStop+( i<rest%iNumStop ? 1 : 0 );
+    double fuel_amount = len*need-fuel;
+    if( fuel_amount>p->m_fMaxFuel-fuel ) fuel_amount = p->m_fMaxFuel-fuel;
+    if( fuel_amount<0.0 ) fuel_amount = 0.0;
+    plan->m_aFuel[i] = fuel_amount;
+    fuel += fuel_amount;
+    lap += len;
+  }
+}
+
+/**
+ * Find the best plan. For each number of stops (0..iMaxStop) and fuel
+ * margin, the best plan of Evaluate is kept among the lengths of the
+ * first stint and the shares of the damage repaired. The kept plans are
+ * simulated and the one with the best PitScore::m_fScore is chosen, so
+ * that the margins are paid only when the risk of running out is real.
+ *
+ * @param iMaxStop      (in) most stops of the plans
+ * @param iNumRun       (in) runs of Simulate for each kept plan
+ * @param best          (out) the best plan
+ * @param score         (out) its score
+ * @param fStartFuel    (in) fuel at the start, 0 to choose it (start of the race)
+ * @return              number of plans evaluated
+ */
+long PitStrategy::Optimize( int iMaxStop, int iNumRun, PitPlan * best, PitScore * score,
+                            double fStartFuel )
+{
+  PitPlan plan, kept;
+  PitScore s;
+  long iNumPlan = 0;
+  int n, first, m, r;
+
+  if( iMaxStop>MAX_PLAN_STOPS ) iMaxStop = MAX_PLAN_STOPS;
+  if( iMaxStop>m_iNumLap-1 ) iMaxStop = m_iNumLap-1;
+  if( iMaxStop<0 ) iMaxStop = 0;
+
+  score->m_fScore = -1.0;
+  for( n=0; n<=iMaxStop; n++ )
+  {
+    int base = m_iNumLap/( n+1 );
+    int shift = n==0 ? 0 : ( base/2<5 ? base/2 : 5 );
+    int last = m_iNumLap-n;        // the other stints have a lap at least
+    for( m=0; m<s_iNumMargin; m++ )
+    {
+      double kept_time = -1.0;
+      for( first=base-shift; first<=base+shift; first++ )
+      {
+        if( first<1 || first>last )
+        {
+          continue;
+        }
+        for( r=0; r<( n>0 ? s_iNumRepair : 1 ); r++ )
+        {
+          MakePlan( &plan, n, first, s_aMargin[m], s_aRepair[r], fStartFuel );
+          double t = Evaluate( &plan );
+          iNumPlan++;
+          if( t!=PIT_INFEASIBLE && ( kept_time<0.0 || t<kept_time ) )
+          {
+            kept_time = t;
+            kept = plan;
+          }
+        }
+      }
+      if( kept_time<0.0 )
+      {
+        continue;
+      }
+      Simulate( &kept, iNumRun, &s );
+      iNumPlan++;
+      if( score->m_fScore<0.0 || s.m_fScore<score->m_fScore )
+      {
+        *score = s;
+        *best = kept;
+      }
+    }
+  }
+  if( score->m_fScore<0.0 )        // all run out: the most stops, fuel and repairs
+  {
+    MakePlan( best, iMaxStop, m_iNumLap/( iMaxStop+1 ), s_aMargin[s_iNumMargin-1],
+              s_aRepair[s_iNumRepair-1], fStartFuel );
+    Simulate( best, iNumRun, score );
+    iNumPlan++;
+  }
+  return iNumPlan;
+}
@@ -0,0 +1,128 @@
+/**
+ * pit_strategy.h - evaluation of pit plans (when to stop, how much fuel
+ *                  to take, how much damage to repair)
+ *
+ * The model is the one of Car::MoveCar: a stop lasts the longest of the
+ * repair (PIT_REPAIR_TIME per unit of damage) and of the refuel
+ * (PIT_REFUEL_TIME per lb), the fuel can not exceed the tank, the repair
+ * can not exceed the damage, and the car is out of the race when it has
+ * no fuel or more than MAX_DAMAGE. The robot is described by a LapProfile:
+ * its lap time, the fuel and the damage of a lap, and the time lost for
+ * each lb of fuel carried and each unit of damage (drag).
+ *
+ * A plan is evaluated in two ways:
+ *  - Evaluate: the race time with the mean values, in closed form for each
+ *    stint (some nanoseconds per plan);
+ *  - Simulate: Monte-Carlo, lap by lap with random lap times, fuel and
+ *    damage. It gives the mean race time and the risk of not finishing.
+ * Optimize generates the plans with 0 to n stops (length of the first
+ * stint, fuel margin, share of the damage repaired). For each number of
+ * stops and fuel margin, the best plan of Evaluate is kept, then the
+ * kept plans are compared with Simulate.
+ *
+ * Usage (a robot, at the start of the race or to plan the rest of it):
+ *   LapProfile p;
+ *   PitStrategy::DefaultProfile( &p, lap_time, fuel_per_lap );
+ *   PitStrategy ps;
+ *   ps.Init( &p, s.laps_to_go, s.damage );
+ *   ps.Optimize( 4, 200, &plan, &score, s.fuel ); // plan.m_aLap[0] laps to go before the stop
+ *
+ * With -F, the best plan of each car is written after each race, from the
+ * profile measured during the race (Report::WritePitPlans).
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       pit_strategy.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_PIT_STRATEGY_H
+#define __RARSCORE_PIT_STRATEGY_H
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_PLAN_STOPS     8
+#define PIT_INFEASIBLE     -1.0      // Evaluate: out of fuel or damage
+#define PIT_PLAN_RUNS      200       // runs of Simulate for the plans of -F
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * What a robot does in a lap of the track (times in seconds)
+ */
+struct LapProfile
+{
+  double m_fLapTime;            // lap time with an empty tank and no damage
+  double m_fLapTimeSd;          // standard deviation of the lap time (traffic, mistakes)
+  double m_fFuelPerLap;         // lb
+  double m_fFuelSd;
+  double m_fDamagePerLap;
+  double m_fDamageSd;
+  double m_fFuelPenalty;        // time lost in a lap per lb of fuel carried
+  double m_fDamagePenalty;      // time lost in a lap per unit of damage
+  double m_fPitLaneLoss;        // time lost driving through the pit lane (without the stop)
+  double m_fMaxFuel;            // tank
+};
+
+/**
+ * A pit plan. The laps are counted from the start of the plan: the car
+ * stops at the end of lap m_aLap[i] (request_pit during this lap).
+ */
+struct PitPlan
+{
+  double m_fStartFuel;
+  int    m_iNumStop;
+  int    m_aLap[MAX_PLAN_STOPS];
+  double m_aFuel[MAX_PLAN_STOPS];       // fuel_amount of the stop
+  long   m_aRepair[MAX_PLAN_STOPS];     // repair_amount of the stop
+};
+
+/**
+ * Result of the Monte-Carlo simulation of a plan
+ */
+struct PitScore
+{
+  double m_fTime;               // mean race time of the runs that finished
+  double m_fTimeSd;
+  double m_fDnf;                // share of the runs out of fuel or damage
+  double m_fScore;              // mean time, a run that did not finish counting twice the race
+};
+
+/**
+ * PitStrategy
+ */
+class PitStrategy
+{
+  private:
+    LapProfile m_oProfile;
+    int        m_iNumLap;       // laps of the plans
+    double     m_fStartDamage;
+    unsigned int m_iRandom;     // own generator (xorshift), the race is not disturbed
+    double     m_fGauss;        // second value of Box-Muller
+    bool       m_bGauss;
+
+    double Gauss();
+    void   MakePlan( PitPlan * plan, int iNumStop, int iFirst, double fMargin,
+                     double fRepair, double fStartFuel );
+
+  public:
+    PitStrategy();
+
+    void   Init( const LapProfile * profile, int iNumLap, double fStartDamage = 0.0 );
+    void   SetSeed( unsigned int seed );
+
+    double Evaluate( const PitPlan * plan ) const;
+    void   Simulate( const PitPlan * plan, int iNumRun, PitScore * score );
+    long   Optimize( int iMaxStop, int iNumRun, PitPlan * best, PitScore * score,
+                     double fStartFuel = 0.0 );
+
+    static double StopTime( double fuel_amount, long repair_amount );
+    static void   DefaultProfile( LapProfile * p, double fLapTime, double fFuelPerLap );
+};
+
+#endif
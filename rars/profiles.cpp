@@ -0,0 +1,122 @@
+/**
+ * PROFILES.CPP - registries of the physics and scoring profiles
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       profiles.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <string.h>
+#include "profiles.h"
+
+//--------------------------------------------------------------------------
+//                           G L O B A L S
+//--------------------------------------------------------------------------
+
+double TableExp::s_aTable[TableExp::SIZE];
+
+/**
+ * Friction models of each physics profile, indexed by Surface
+ */
+#define FRICTION_MODELS(Physics, Exp) \
+  { loose_friction<Physics,Exp>, hard_friction<Physics,Exp>, skid_friction<Physics,Exp>, wet_friction<Physics,Exp> }
+
+static const FrictionModel s_aIndycarExact[NUM_SURFACE] = FRICTION_MODELS( IndycarPhysics, ExactExp );
+static const FrictionModel s_aIndycarFast[NUM_SURFACE]  = FRICTION_MODELS( IndycarPhysics, TableExp );
+static const FrictionModel s_aF1Exact[NUM_SURFACE]      = FRICTION_MODELS( F1Physics, ExactExp );
+static const FrictionModel s_aF1Fast[NUM_SURFACE]       = FRICTION_MODELS( F1Physics, TableExp );
+
+/**
+ * Car models of each physics profile, indexed by Surface (instantiated
+ * at the end of carz.cpp)
+ */
+#define MOVE_CAR_MODELS(Physics, Exp) \
+  { &Car::MoveCarT< Physics, loose_friction<Physics,Exp> >, &Car::MoveCarT< Physics, hard_friction<Physics,Exp> >, \
+    &Car::MoveCarT< Physics, skid_friction<Physics,Exp> >, &Car::MoveCarT< Physics, wet_friction<Physics,Exp> > }
+
+static const MoveCarProc s_aIndycarExactMove[NUM_SURFACE] = MOVE_CAR_MODELS( IndycarPhysics, ExactExp );
+static const MoveCarProc s_aIndycarFastMove[NUM_SURFACE]  = MOVE_CAR_MODELS( IndycarPhysics, TableExp );
+static const MoveCarProc s_aF1ExactMove[NUM_SURFACE]      = MOVE_CAR_MODELS( F1Physics, ExactExp );
+static const MoveCarProc s_aF1FastMove[NUM_SURFACE]       = MOVE_CAR_MODELS( F1Physics, TableExp );
+
+/**
+ * Physics profiles, the first one is the default
+ */
+const PhysicsProfile g_aPhysicsProfiles[] =
+{
+  { "INDYCAR", s_aIndycarExactMove, s_aIndycarFastMove, s_aIndycarExact, s_aIndycarFast, IndycarPhysics::MaxFuel(), IndycarPhysics::Mass() },
+  { "F1",      s_aF1ExactMove,      s_aF1FastMove,      s_aF1Exact,      s_aF1Fast,      F1Physics::MaxFuel(),      F1Physics::Mass() }
+};
+const int g_iNumPhysicsProfile = sizeof(g_aPhysicsProfiles)/sizeof(g_aPhysicsProfiles[0]);
+
+/**
+ * Scoring profiles, the first one is the default
+ */
+const ScoringProfile g_aScoringProfiles[] =
+{
+  { "INDYCAR", ScorePoints<IndycarScoring> },
+  { "F1",      ScorePoints<F1Scoring> },
+  { "NASCAR",  ScorePoints<NascarScoring> },
+  { "BTCC",    ScorePoints<BtccScoring> }
+};
+const int g_iNumScoringProfile = sizeof(g_aScoringProfiles)/sizeof(g_aScoringProfiles[0]);
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Fill the table of TableExp
+ */
+void TableExp::Init()
+{
+  int i;
+  for( i=0; i<SIZE; i++ )
+  {
+    s_aTable[i] = 1.0 - exp(-(double)i/STEPS);
+  }
+}
+
+/**
+ * Find a physics profile by name
+ *
+ * @param name      (in) name of the profile (ex: INDYCAR)
+ * @return          index in g_aPhysicsProfiles, -1 if unknown
+ */
+int FindPhysicsProfile( const char * name )
+{
+  int i;
+  for( i=0; i<g_iNumPhysicsProfile; i++ )
+  {
+    if( !strcmp(name, g_aPhysicsProfiles[i].m_sName) )
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Find a scoring profile by name
+ *
+ * @param name      (in) name of the profile (ex: NASCAR)
+ * @return          index in g_aScoringProfiles, -1 if unknown
+ */
+int FindScoringProfile( const char * name )
+{
+  int i;
+  for( i=0; i<g_iNumScoringProfile; i++ )
+  {
+    if( !strcmp(name, g_aScoringProfiles[i].m_sName) )
+    {
+      return i;
+    }
+  }
+  return -1;
+}
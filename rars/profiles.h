@@ -0,0 +1,298 @@
+/**
+ * profiles.h - physics and scoring profiles
+ *
+ * A profile is a small struct of static functions returning constants.
+ * The car model (Car::MoveCarT) and the scoring (ScorePoints) are
+ * templates on the profile, so each profile gets its own code with the
+ * constants folded in. The registries below list the instantiations;
+ * the ones used by a race are chosen at run time with -P and -C
+ * (see Args and RaceManager::CommonInit).
+ *
+ * To add a profile: write the struct, add it to the registry in
+ * profiles.cpp, and for a physics profile instantiate Car::MoveCarT
+ * at the end of carz.cpp (MOVE_CAR_INSTANCES).
+ *
+ * The friction models (one per surface type) are templates on the
+ * physics profile too, and Car::MoveCarT is a template on the friction
+ * model: one car model per profile and surface, with the friction
+ * inlined (in the sub-steps and in zbrent). The car model of each
+ * segment of the track is chosen once per race (see
+ * RaceData::InitFriction); Car::MoveCar calls the one of the segment of
+ * the car, once per tick. The robots get the friction of the track
+ * through a pointer (friction()).
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       profiles.cpp
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_PROFILES_H
+#define __RARSCORE_PROFILES_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <math.h>
+#include "car.h"
+
+//--------------------------------------------------------------------------
+//                     P H Y S I C S   P R O F I L E S
+//--------------------------------------------------------------------------
+
+/**
+ * Indycar physics: the default constants of car.h
+ */
+struct IndycarPhysics
+{
+  static double PowerMax() { return PM; }        // Power, Maximum, ft. lb. per sec.
+  static double Mass()     { return M; }         // mass without fuel, slugs
+  static double DragCon()  { return DRAG_CON; }  // air drag, lb. per (ft/sec)^2
+  static double MaxFuel()  { return MAX_FUEL; }  // full tank, lb.
+  static double Sfc()      { return SFC; }       // Fuel Consumption, lb.s/ft-lb.
+  static double MyuMax0()  { return MYU_MAX0; }  // maximum coef. of friction, surface 0
+  static double MyuMax1()  { return MYU_MAX1; }  // maximum coef. of friction, surface 1
+  static double MyuMax2()  { return MYU_MAX2; }  // maximum coef. of friction, surface 2
+  static double MyuMax3()  { return .7*MYU_MAX1; } // maximum coef. of friction, surface 3 (wet)
+};
+
+/**
+ * F1 physics: lighter and more powerful car, bigger tank
+ * (the values that were commented out in car.h)
+ */
+struct F1Physics : public IndycarPhysics
+{
+  static double PowerMax() { return 4e5; }       // ca 727 horsepowers
+  static double Mass()     { return 42; }        // about 610 kg without fuel
+  static double MaxFuel()  { return 440; }       // ca 200 kg
+  static double Sfc()      { return 1e-6; }
+};
+
+//--------------------------------------------------------------------------
+//                     F R I C T I O N   M O D E L S
+//--------------------------------------------------------------------------
+
+/**
+ * Surface types (-s option, "surface" of the track and of the segments)
+ */
+enum Surface
+{
+  SURFACE_LOOSE = 0,     // very loose surface
+  SURFACE_HARD,          // harder surface, ordinary cars
+  SURFACE_SKID,          // asphalt, F1 tyres, with skidding
+  SURFACE_WET,           // wet asphalt
+  NUM_SURFACE
+};
+
+/**
+ * The curve 1-exp(-x) of the friction models, computed with exp()
+ */
+struct ExactExp
+{
+  static double OneMinusExp( double x ) { return 1.0 - exp(-x); }
+};
+
+/**
+ * The curve 1-exp(-x) of the friction models, tabulated
+ *
+ * Cubic Hermite interpolation between the points of a table of step
+ * h = 1/STEPS on [0,MAX_X]. With f(x) = 1-exp(-x), f' = 1-f so only f is
+ * stored. The error is at most h^4/384 * max|f''''| = 2.6e-9 (h=1/32).
+ * Above MAX_X, 1 is returned (error exp(-32) = 1.3e-14). Below 0 and
+ * for a NaN (a slip ratio 0/0), x is taken as 0, so the index always
+ * stays in the table.
+ * The table must be filled by Init() before use.
+ */
+struct TableExp
+{
+  enum { STEPS = 32, MAX_X = 32, SIZE = STEPS*MAX_X+1 };
+  static double s_aTable[SIZE];
+
+  static void Init();
+  static double OneMinusExp( double x )
+  {
+    if( !(x>=0.0) )             // negative or NaN
+    {
+      return 0.0;
+    }
+    double t = x*STEPS;
+    if( t>=STEPS*MAX_X )
+    {
+      return 1.0;
+    }
+    int i = (int)t;
+    double u = t-i, u2 = u*u, u3 = u2*u;
+    double f0 = s_aTable[i], f1 = s_aTable[i+1];
+    return (2*u3-3*u2+1)*f0 + (3*u2-2*u3)*f1
+         + ((u3-2*u2+u)*(1.0-f0) + (u3-u2)*(1.0-f1))/STEPS;
+  }
+};
+
+/**
+ * Surface 0: force rising very rapidly with small slip speed, and then
+ * asymptotically approaching an upper limit (like tires on unpaved surfaces)
+ */
+template <class Physics, class Exp>
+double loose_friction( double slip, double slipping )
+{
+  return (Physics::MyuMax0() * slip)/(slipping + slip);
+}
+
+/**
+ * Surface 1: harder surface, ordinary cars
+ */
+template <class Physics, class Exp>
+double hard_friction( double slip, double slipping )
+{
+  return Physics::MyuMax1() * Exp::OneMinusExp(slip/slipping);
+}
+
+/**
+ * Surface 2: asphalt, F1 tyres, the grip drops when skidding
+ */
+template <class Physics, class Exp>
+double skid_friction( double slip, double slipping )
+{
+  if(slip > 20)
+  {
+    return Physics::MyuMax2() * Exp::OneMinusExp(slip/slipping) - .2; // skidding
+  }
+  else
+  {
+    return Physics::MyuMax2() * Exp::OneMinusExp(slip/slipping);
+  }
+}
+
+/**
+ * Surface 3: wet asphalt, less grip reached at a higher slip speed
+ */
+template <class Physics, class Exp>
+double wet_friction( double slip, double slipping )
+{
+  return Physics::MyuMax3() * Exp::OneMinusExp(slip/(1.5*slipping));
+}
+
+/**
+ * Entry of the physics registry
+ */
+struct PhysicsProfile
+{
+  const char * m_sName;
+  const MoveCarProc * m_aExactMoveCar;        // Car::MoveCarT of each surface, ExactExp
+  const MoveCarProc * m_aFastMoveCar;         // Car::MoveCarT of each surface, TableExp
+  const FrictionModel * m_aExactFriction;     // friction of each surface, ExactExp
+  const FrictionModel * m_aFastFriction;      // friction of each surface, TableExp
+  double m_fMaxFuel;
+  double m_fMass;                             // without fuel, slugs
+};
+
+//--------------------------------------------------------------------------
+//                     S C O R I N G   P R O F I L E S
+//--------------------------------------------------------------------------
+
+/**
+ * Indycar: 12 places, 1 point for the pole, 1 for the most laps lead
+ */
+struct IndycarScoring
+{
+  enum { NUM_POINTS = 12, POLE_BONUS = 1, LEAD_BONUS = 0, MOST_LEAD_BONUS = 1 };
+  static int Points( int pos )
+  {
+    static const int points[] = { 20, 16, 14, 12, 10, 8, 6, 5, 4, 3, 2, 1 };
+    return points[pos];
+  }
+};
+
+/**
+ * F1: 6 places
+ */
+struct F1Scoring
+{
+  enum { NUM_POINTS = 6, POLE_BONUS = 0, LEAD_BONUS = 0, MOST_LEAD_BONUS = 0 };
+  static int Points( int pos )
+  {
+    static const int points[] = { 10, 6, 4, 3, 2, 1 };
+    return points[pos];
+  }
+};
+
+/**
+ * NASCAR: 44 places, 5 points for leading a lap, 5 for the most laps lead
+ */
+struct NascarScoring
+{
+  enum { NUM_POINTS = 44, POLE_BONUS = 0, LEAD_BONUS = 5, MOST_LEAD_BONUS = 5 };
+  static int Points( int pos )
+  {
+    static const int points[] = { 175,170,165,160,155,150,146,142,138,134,130,
+      127,124,121,118,115,112,109,106,103,100,97,94,91,88,85,82,79,76,
+      73,70,67,64,61,58,55,52,49,46,43,40,37,34,31 };
+    return points[pos];
+  }
+};
+
+/**
+ * BTCC: 10 places, 1 point for the pole
+ */
+struct BtccScoring
+{
+  enum { NUM_POINTS = 10, POLE_BONUS = 1, LEAD_BONUS = 0, MOST_LEAD_BONUS = 0 };
+  static int Points( int pos )
+  {
+    static const int points[] = { 15, 12, 10, 8, 6, 5, 4, 3, 2, 1 };
+    return points[pos];
+  }
+};
+
+/**
+ * Points of a driver in a race
+ *
+ * @param pos        (in) finishing position (0 = winner)
+ * @param pole       (in) true if the driver started from the pole after qualifying
+ * @param laps_lead  (in) laps lead by the driver
+ * @param most_lead  (in) most laps lead by a driver of the race
+ * @return           the points
+ */
+template <class Scoring>
+int ScorePoints( int pos, bool pole, long laps_lead, long most_lead )
+{
+  int points = pos<Scoring::NUM_POINTS ? Scoring::Points(pos) : 0;
+  if( pole )
+  {
+    points += Scoring::POLE_BONUS;
+  }
+  if( laps_lead>0 )
+  {
+    points += Scoring::LEAD_BONUS;
+  }
+  if( laps_lead>=most_lead )
+  {
+    points += Scoring::MOST_LEAD_BONUS;
+  }
+  return points;
+}
+
+/**
+ * Entry of the scoring registry
+ */
+struct ScoringProfile
+{
+  const char * m_sName;
+  int (*m_pPoints)( int pos, bool pole, long laps_lead, long most_lead );
+};
+
+//--------------------------------------------------------------------------
+//                           E X T E R N S
+//--------------------------------------------------------------------------
+
+extern const PhysicsProfile g_aPhysicsProfiles[];
+extern const int g_iNumPhysicsProfile;
+extern const ScoringProfile g_aScoringProfiles[];
+extern const int g_iNumScoringProfile;
+
+int FindPhysicsProfile( const char * name );  // index in g_aPhysicsProfiles, -1 if unknown
+int FindScoringProfile( const char * name );  // index in g_aScoringProfiles, -1 if unknown
+
+#endif
@@ -16,6 +16,7 @@
 #include "car.h"
 #include "draw.h"
 #include "misc.h"
+#include "profiles.h"
 
 //--------------------------------------------------------------------------
 //                           F U N C T I O N S
@@ -27,6 +28,10 @@
 RaceData::RaceData()
 {
   cars = new Car*[MAX_CARS];
+  m_pPhysics = &g_aPhysicsProfiles[0];
+  m_pScoring = &g_aScoringProfiles[0];
+  m_pFriction = g_aPhysicsProfiles[0].m_aExactFriction[SURFACE_HARD];
+  m_aSegMoveCar = NULL;
 }
 
 /**
@@ -35,6 +40,54 @@ RaceData::RaceData()
 RaceData::~RaceData()
 {
   delete [] cars;
+  delete [] m_aSegMoveCar;
+}
+
+/**
+ * Resolve the friction models of the race, once for all the segments
+ * of the current track, from the physics profile and the surface types:
+ * each segment gets the car model compiled for its surface (so that the
+ * car model does not test the surface type, nor calls the friction
+ * through a pointer), and build the grip map of the track
+ */
+void RaceData::InitFriction()
+{
+  const FrictionModel * models;
+  const MoveCarProc * moves;
+  int i, surface;
+
+  if( args.m_bFastFriction )
+  {
+    TableExp::Init();
+    models = m_pPhysics->m_aFastFriction;
+    moves = m_pPhysics->m_aFastMoveCar;
+  }
+  else
+  {
+    models = m_pPhysics->m_aExactFriction;
+    moves = m_pPhysics->m_aExactMoveCar;
+  }
+
+  surface = currentTrack->Surface();
+  if( surface<0 || surface>=NUM_SURFACE )
+  {
+    exitOnError( "Unknown surface type %d", surface );
+  }
+  m_pFriction = models[surface];
+
+  delete [] m_aSegMoveCar;
+  m_aSegMoveCar = new MoveCarProc[currentTrack->m_iNumSegment];
+  for( i=0; i<currentTrack->m_iNumSegment; i++ )
+  {
+    surface = currentTrack->SegmentSurface( i );
+    if( surface<0 || surface>=NUM_SURFACE )
+    {
+      exitOnError( "Unknown surface type %d (segment %d)", surface, i );
+    }
+    m_aSegMoveCar[i] = moves[surface];
+  }
+
+  m_oGripMap.Init( currentTrack, args.m_bEvolvingGrip );
 }
 
 /**
@@ -50,7 +103,7 @@ void RaceData::QSortem()
   {
     if( args.m_iQualMode==QUAL_FASTEST_LAP )
     {
-      while(cars[m_aCarInPos[i+1]]->Q_bestlap > cars[m_aCarInPos[i]]->Q_bestlap)  
+      while(cars[m_aCarInPos[i+1]]->get_q_bestlap() > cars[m_aCarInPos[i]]->get_q_bestlap())  
       { 
         // When a car runs faster qualifying lap, we swap positions:
         temp = m_aCarInPos[i]; 
@@ -64,7 +117,7 @@ void RaceData::QSortem()
     }
     else if( args.m_iQualMode==QUAL_AVERAGE_SPEED )
     {
-      while(cars[m_aCarInPos[i+1]]->Q_avgspeed > cars[m_aCarInPos[i]]->Q_avgspeed)  
+      while(cars[m_aCarInPos[i+1]]->get_q_avgspeed() > cars[m_aCarInPos[i]]->get_q_avgspeed())  
       {
         // When a car gets higher average speed, we swap positions:
         temp = m_aCarInPos[i];
@@ -80,9 +133,9 @@ void RaceData::QSortem()
 
   for(i = 0; i < args.m_iNumCar-1; i++)
   {
-    if(cars[m_aCarInPos[i]]->Out == 3)
+    if(cars[m_aCarInPos[i]]->get_out() == 3)
     {
-      if(cars[m_aCarInPos[i+1]]->Out != 3) 
+      if(cars[m_aCarInPos[i+1]]->get_out() != 3) 
       { 
         temp = m_aCarInPos[i];
         m_aCarInPos[i] = m_aCarInPos[i+1];
@@ -24,6 +24,11 @@
 #include "movie.h"
 #include "os.h"
 #include "draw.h"
+#include "tournament.h"
+#include "aggregator.h"
+#include "profiles.h"
+#include "graphics/g_video.h"
+#include "race_server.h"
 
 //--------------------------------------------------------------------------
 //                           G L O B A L S
@@ -43,6 +48,8 @@ RaceData race_data;
  */
 RaceManager::~RaceManager()
 {
+  delete m_oServer;
+
   // Free the drivers array
   int i=0;
   while( drivers[i]!=NULL )
@@ -71,6 +78,39 @@ void RaceManager::ArgsInit( int argc, char* argv[] )
 {
   // Set the track, car_count, lap_count, and various options:
   args.GetArgs(argc, argv);
+
+  // Only generate a batch of random tracks
+  if( args.m_iNumRandomTrack>0 )
+  {
+    Track::generateRandomTracks( args.m_iNumRandomTrack, args.m_bRndmiz ? os.PickRandom() : args.m_iSeed );
+    exitNormally();
+  }
+
+  // Only check the collision tests
+  if( args.m_iCollisionCheck>0 )
+  {
+    if( CollisionSolver::Check( args.m_iCollisionCheck, args.m_bRndmiz ? os.PickRandom() : args.m_iSeed )>0 )
+    {
+      exitOnError( "Collision check: the separating axis test and Car::Overlap disagree" );
+    }
+    exitNormally();
+  }
+
+  // Only aggregate the results of other runs
+  if( args.m_iNumAggregate>0 )
+  {
+    Aggregator aggregator;
+    aggregator.Run( args.m_iNumAggregate, args.m_aAggregate );
+    exitNormally();
+  }
+
+  // Only run a tournament (the races are run by other rars processes)
+  if( args.m_sTournamentFile[0] )
+  {
+    Tournament tournament;
+    tournament.Run( args.m_sTournamentFile, argv[0] );
+    exitNormally();
+  }
   
   // Initialize the global currentTrack
   currentTrack = new Track(args.m_aTracks[args.m_iCurrentTrack]);
@@ -91,6 +131,16 @@ void RaceManager::ArgsInit( int argc, char* argv[] )
   
   // Write initial race data to report file:
   m_oReport.WriteBegin();
+
+  // Live stream of the races
+  if( args.m_sServer[0] )
+  {
+    m_oServer = new RaceServer();
+    if( !m_oServer->Start( args.m_sServer ) )
+    {
+      exitOnError( "Unable to start the race server on %s", args.m_sServer );
+    }
+  }
 }
 
 /**
@@ -100,6 +150,10 @@ void RaceManager::ArgsInit( int argc, char* argv[] )
 void RaceManager::ArgsClose()
 {
   m_oReport.WriteRam();
+  if( m_oServer!=NULL )
+  {
+    m_oServer->Stop();
+  }
 }
 
 /**
@@ -113,6 +167,11 @@ void RaceManager::AllInit()
   {
     exitOnError("Qualification mode is not allowed while replaying movie!\nDisable qualifying!");
   }
+  // The video is rendered from a movie:
+  if( args.m_sVideoFile[0] && args.m_iMovieMode!=MOVIE_PLAYBACK )
+  {
+    exitOnError("The video (-V) is rendered from a replayed movie!\nAdd -mp<movie>!");
+  }
   
   // Replace currentTrack with new
   delete currentTrack;
@@ -142,9 +201,6 @@ void RaceManager::AllInit()
  */
 void RaceManager::RaceInit(long rl)
 {
-  int i;
-  long j;
-  
   race_data.m_iNumCarFinished = 0;  // incremented by each car that finishes the race
   race_data.m_iNumCarOut = 0;   // incremented by each car that crashes
   race_data.m_fElapsedTime = 0.0;
@@ -184,25 +240,24 @@ void RaceManager::RaceInit(long rl)
 
   if( race_data.stage==RACING )
   {
-    // race_data.lapFinishingTimes stores lap finishing times for all cars and all laps
-    race_data.m_aLapFinishingTimes = new double *[args.m_iNumCar]; // setup the array:
-    for (i=0;i<args.m_iNumCar;i++)
-    {
-      race_data.m_aLapFinishingTimes[i] = new double[args.m_iNumLap+1];
-    }
-    
-    // Initialize race_data.lapFinishingTimes:
-    for (i=0;i<args.m_iNumCar;i++)
-    {
-      for (j=0;j<args.m_iNumLap+1;j++)
-      {
-        race_data.m_aLapFinishingTimes[i][j] = 0.0;
-      }
-    }
+    // race_data.m_oLapTiming stores lap finishing times for all cars and all laps
+    race_data.m_oLapTiming.Init( args.m_iNumCar, args.m_iNumLap, currentTrack );
   }
     
   // puts cars on starting grid, initialize their variables:
   ArrangeCars(); 
+
+  if( m_oServer!=NULL )
+  {
+    m_oServer->RaceStart();
+  }
+
+  // Positions of the cars kept for the video
+  if( args.m_sVideoFile[0] )
+  {
+    m_oVideo = new TVideo();
+    m_oVideo->Init();
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -266,6 +321,10 @@ int RaceManager::NormalRaceLoop()
   }
 
   //////// move_car, check collisions:
+  if( args.m_iMovieMode!=MOVIE_PLAYBACK )
+  {
+    race_data.m_oCollision.BeginStep();      // positions at the start of the step
+  }
   for(i=0; i<args.m_iNumCar; i++)             // for each car:
   {
     if( args.m_iMovieMode==MOVIE_PLAYBACK ) // imitate move_car()
@@ -275,10 +334,15 @@ int RaceManager::NormalRaceLoop()
   } 
   if( args.m_iMovieMode!=MOVIE_PLAYBACK )
   {
+    race_data.m_oCollision.ComputeBoxes();   // rectangles of the cars
     for(i=0; i<args.m_iNumCar; i++)           // for each car:
     {
       race_data.cars[i]->CheckCollisions();   // check for collisions
-      if( args.m_iMovieMode==MOVIE_RECORD )     // store some movie data
+    }
+    race_data.m_oCollision.Resolve();        // collisions during the step
+    if( args.m_iMovieMode==MOVIE_RECORD )     // store some movie data
+    {
+      for(i=0; i<args.m_iNumCar; i++)
         race_data.cars[i]->RecordMovie( m_oMovie );
     }
   }
@@ -299,6 +363,16 @@ int RaceManager::NormalRaceLoop()
 
   draw.UpdateLeaderboard();
 
+  if( m_oServer!=NULL )
+  {
+    m_oServer->Publish();           // never waits for the subscribers
+  }
+
+  if( m_oVideo!=NULL )
+  {
+    m_oVideo->Capture();
+  }
+
   // This section is required to update Instrument Panel:
   if(draw.m_bDisplay && draw.m_iCarShown >= 0)   // only if some driver is selected
   {
@@ -320,7 +394,7 @@ int RaceManager::NormalRaceLoop()
     return(0);
   }
   // also quit if lead car completes lap_count + 1 laps:
-  if(race_data.cars[race_data.m_aCarInPos[0]]->Laps >= (race_data.stage==PRACTICE ? args.m_iNumPracticeLap : args.m_iNumLap) + 1)
+  if(race_data.cars[race_data.m_aCarInPos[0]]->get_laps() >= (race_data.stage==PRACTICE ? args.m_iNumPracticeLap : args.m_iNumLap) + 1)
   {
     return(0);
   }
@@ -359,24 +433,44 @@ int RaceManager::NormalRaceLoop()
  */
 void RaceManager::RaceClose(long rl)
 {
+  if( m_oServer!=NULL )
+  {
+    m_oServer->RaceEnd();
+  }
   if( race_data.stage==RACING ) 
   {
-    m_oReport.WriteResults(rl+1, race_data.m_aCarInPos, race_data.cars);
-    for (int i=0;i<args.m_iNumCar;i++)
+    m_oResults.Fill(rl+1, race_data.m_aCarInPos, race_data.cars, &race_data.m_oLapTiming);
+    m_oReport.WriteResults(&m_oResults);
+    m_oReport.WriteLapTimes(race_data.m_aCarInPos, race_data.cars, &race_data.m_oLapTiming);
+    if( args.m_iPitPlanStops )
+    {
+      m_oReport.WritePitPlans(&m_oResults);
+    }
+    if( args.m_iIntegrator!=INTEGRATOR_REFERENCE )
     {
-      delete [] race_data.m_aLapFinishingTimes[i];
+      m_oReport.WriteIntegrator(&m_oResults);
     }
-    delete [] race_data.m_aLapFinishingTimes;
+    m_oReport.WriteResultStore(&m_oResults);
+    m_oReport.WriteStructured(&m_oResults);
+    race_data.m_oLapTiming.Close();
   }
   if( race_data.stage==PRACTICE )
   {
     args.m_bPractice = 0;
   }
-  else
+  else if( !args.m_sResultFile[0] ) // tournament races run at the same time: no records
   {
     currentTrack->writeTrackFastestLap(race_data.m_oLapRecord); // writes track record to file
   }
   
+  // video: all the frames are rendered at the end of the replay
+  if( m_oVideo!=NULL )
+  {
+    m_oVideo->Render();
+    delete m_oVideo;
+    m_oVideo = NULL;
+  }
+
   // movie
   if( args.m_iMovieMode!=MOVIE_NORMAL )
   {
@@ -390,7 +484,7 @@ void RaceManager::RaceClose(long rl)
  */
 void RaceManager::AllClose()
 {
-  m_oReport.WriteFinal();
+  m_oReport.WriteFinal(&m_oResults);
 
   // clean up, end graphics, back to normal
   int i=0;
@@ -533,11 +627,13 @@ void RaceManager::QualEvaluateResults()
       || (args.m_iQualMode==QUAL_AVERAGE_SPEED && (race_data.cars[i]->q_avgspeed <
       race_data.cars[race_data.m_aCarInPos[0]]->q_avgspeed/Q_CUTOFF)))
     {
-      race_data.cars[i]->Out = race_data.cars[i]->out = 3;  // did not qualify for race!
+      race_data.cars[i]->out = 3;  // did not qualify for race!
     }
   }
 
-  m_oReport.WriteQualResults(race_data.m_aCarInPos, race_data.cars);
+  m_oResults.FillQual(race_data.m_aCarInPos, race_data.cars);
+  m_oReport.WriteQualResults(&m_oResults);
+  m_oReport.WriteStructured(&m_oResults);
 
   for (i=0;i<args.m_iNumCar;i++)
   {
@@ -545,7 +641,7 @@ void RaceManager::QualEvaluateResults()
     {
       race_data.cars[i]->laps = -1;
       race_data.cars[i]->distance = -race_data.m_aPosOfCar[i]; // so they are not equal.
-      race_data.cars[i]->Speed_avg = race_data.cars[i]->Speed_max = 0; // to show on leaderboard
+      race_data.cars[i]->speed_avg = race_data.cars[i]->speed_max = 0; // to show on leaderboard
     }
   }
 }
@@ -642,7 +738,7 @@ void RaceManager::ArrangeCars()
     // Put cars on computed starting positions and initialize 
     // their variables. Save starting position
     // Mark cars that did not qualify for the race 
-    if (race_data.cars[race_data.m_aStartPos[i]]->Out != 3)
+    if (race_data.cars[race_data.m_aStartPos[i]]->get_out() != 3)
     {
       race_data.cars[race_data.m_aStartPos[i]]->PutCar(x,y,car_ang);
     }
@@ -650,7 +746,7 @@ void RaceManager::ArrangeCars()
     {
       ++race_data.m_iNumCarOut;
     }
-    race_data.cars[race_data.m_aStartPos[i]]->started = race_data.cars[race_data.m_aStartPos[i]]->Started = i;
+    race_data.cars[race_data.m_aStartPos[i]]->started = i;
   }
 }
 
@@ -669,7 +765,7 @@ void RaceManager::Sortem()
   
   for(i=0; i<args.m_iNumCar-1; i++)
   {
-    if(race_data.cars[race_data.m_aCarInPos[i]]->Out != 3 && !race_data.cars[race_data.m_aCarInPos[i]]->Done)
+    if(race_data.cars[race_data.m_aCarInPos[i]]->get_out() != 3 && !race_data.cars[race_data.m_aCarInPos[i]]->get_done())
     {
       // the while loop below does not usually repeat:
       while(race_data.cars[race_data.m_aCarInPos[i+1]]->Farther(race_data.cars[race_data.m_aCarInPos[i]]))
@@ -702,6 +798,11 @@ void RaceManager::Sortem()
 void RaceManager::CommonInit( Stage stage, int rl )
 {
   race_data.stage = stage;
+  race_data.m_pPhysics = &g_aPhysicsProfiles[args.m_iPhysics];
+  race_data.m_pScoring = &g_aScoringProfiles[args.m_iScoring];
+  race_data.InitFriction();
+  race_data.m_oIntegrator.Init( args.m_iIntegrator, args.m_iNumSubstep, args.m_fIntegratorTolerance, args.m_iNumCar );
+  race_data.m_oCollision.Init( args.m_bContinuousCollision, args.m_iNumCar );
 
   race_data.m_oLapRecord.speed = 0.0;
   
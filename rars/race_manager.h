@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include "report.h"
+#include "race_results.h"
 #include "movie.h"
 #include "instant_replay.h"
 #include "timer.h"
@@ -32,6 +33,9 @@
 //                             T Y P E S
 //--------------------------------------------------------------------------
 
+class TVideo;
+class RaceServer;
+
 /**
  * The Racemanager manage the play of a race 
  */
@@ -41,8 +45,11 @@ private:
   double        m_fPanelLastTime; // Last update of Instrument Panel
   int           m_iEndExtraTime;  // Number of loops after all cars are either finished or out
   Report        m_oReport;        // Report object used to write .out files
+  RaceResults   m_oResults;       // Results of the last session, and points of all the races
   Movie *       m_oMovie;         // Movie object used to read/write .xy .ang files
   InstantReplay m_oInstantReplay; // InstantReplay used to stop, rewind and replay the race
+  TVideo *      m_oVideo;         // Video rendered from the replayed movie (-V)
+  RaceServer *  m_oServer;        // Live stream of the race on a socket (-S)
   Timer         RobotTimer;    // Measures the time used by the robots
 
   void ArrangeCars();
@@ -55,6 +62,8 @@ public:
   RaceManager()
   {
     m_fPanelLastTime = 0.0;
+    m_oVideo = NULL;
+    m_oServer = NULL;
   }
   ~RaceManager();
 
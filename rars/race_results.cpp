@@ -0,0 +1,206 @@
+/**
+ * RACE_RESULTS.CPP - Results of a race or of a qualification
+ *
+ * History
+ *  ver. 0.90 Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <string.h>
+#include "race_results.h"
+#include "car.h"
+#include "track.h"
+#include "profiles.h"
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+RaceResults::RaceResults()
+{
+  m_aLapMemory = NULL;
+  m_iLapMemory = 0;
+  m_iStage = BEFORE;
+  m_iRace = 0;
+  m_sTrack = "";
+  m_sTrackName[0] = 0;
+  m_iSeed = 0;
+  m_iNumLap = 0;
+  m_fLength = 0.0;
+  m_fRecordSpeed = 0.0;
+  m_sRecordName[0] = 0;
+  m_iNumCar = 0;
+  memset( m_aCar, 0, sizeof(m_aCar) );
+  memset( m_aTotalPoints, 0, sizeof(m_aTotalPoints) );
+}
+
+/**
+ * Destructor
+ */
+RaceResults::~RaceResults()
+{
+  delete [] m_aLapMemory;
+}
+
+/**
+ * Copy the state of a car at the end of the session
+ *
+ * @param r             (out) result
+ * @param k             (in) index of the car
+ * @param car           (in) the car
+ */
+void RaceResults::FillCar( CarResult * r, int k, Car * car )
+{
+  r->m_iCar = k;
+  r->m_sName = drivers[k]->getName();
+  r->m_iStarted = car->started+1;
+  r->m_iOut = car->out;
+  r->m_iDone = car->done;
+  r->m_iLaps = car->laps;
+  r->m_iLapsLead = car->laps_lead;
+  r->m_fBehind = 0.0;
+  r->m_fBehindLeader = car->Behind_leader;
+  r->m_fBehindNext = car->Behind_next;
+  r->m_fAheadNext = car->Ahead_next;
+  r->m_fLastCrossing = car->last_crossing;
+  r->m_fDistance = car->distance;
+  r->m_fSpeedAvg = car->speed_avg*MPH_FPS;
+  r->m_fSpeedMax = car->speed_max*MPH_FPS;
+  r->m_fBestSpeed = car->bestlap_speed*MPH_FPS;
+  r->m_fLastSpeed = car->lastlap_speed*MPH_FPS;
+  r->m_bRecord = false;
+  r->m_fBestLap = 0.0;
+  r->m_iBestLap = 0;
+  r->m_fLapTime = car->lap_time;
+  r->m_aLapTime = NULL;
+  r->m_iNumLapTime = 0;
+  r->m_iDamage = car->damage;
+  r->m_fFuel = car->fuel;
+  r->m_fFuelPerLap = car->fuel_mileage>0.0 ? currentTrack->length/( car->fuel_mileage*5280.0 ) : 0.0;
+  r->m_iPitStops = car->pit_stops;
+  r->m_aPitLap = car->pit_log;
+  r->m_fPitTime = car->Total_pit_time;
+  r->m_iLastPitVisit = car->last_pit_visit;
+  r->m_fQualBestLap = car->q_bestlap;
+  r->m_fQualAvgSpeed = car->q_avgspeed;
+  r->m_fRobotTime = car->RobotTime;
+  r->m_iPoints = 0;
+  r->m_iTotalPoints = m_aTotalPoints[k];
+}
+
+/**
+ * Results of a race: the cars in finishing order (until the first car
+ * that did not qualify), their lap times and their points
+ *
+ * @param race          (in) number of the race (1..)
+ * @param order         (in) an array with the finishing order of the cars
+ * @param pcar          (in) an array with a pointer to all cars
+ * @param timing        (in) the times of the race
+ */
+void RaceResults::Fill( int race, int * order, Car ** pcar, const LapTiming * timing )
+{
+  int i, k, lap;
+  long most_lead = 0;
+
+  track_desc track = get_track_description();
+  m_iStage = RACING;
+  m_iRace = race+args.m_iCurrentTrack*args.m_iNumRace;
+  m_sTrack = currentTrack->m_sShortName;
+  strcpy( m_sTrackName, track.sName );
+  m_iSeed = race_data.m_iInitialSeed;
+  m_iNumLap = args.m_iNumLap;
+  m_fLength = track.length;
+  m_fRecordSpeed = track.record.speed*MPH_FPS;
+  strcpy( m_sRecordName, track.record.rob_name );
+
+  long iSize = (long)args.m_iNumCar*args.m_iNumLap;
+  if( iSize>m_iLapMemory )
+  {
+    delete [] m_aLapMemory;
+    m_aLapMemory = new float[iSize];
+    m_iLapMemory = iSize;
+  }
+
+  // The most laps lead (bonus points in some scorings)
+  for( i=0; i<args.m_iNumCar; i++ )
+  {
+    if( pcar[i]->laps_lead>most_lead )
+    {
+      most_lead = pcar[i]->laps_lead;
+    }
+  }
+
+  m_iNumCar = 0;
+  for( i=0; i<args.m_iNumCar; i++ )
+  {
+    k = order[i];
+    if( pcar[k]->out==3 )
+    {
+      break; // DNQ
+    }
+    CarResult * r = m_aCar+i;
+    FillCar( r, k, pcar[k] );
+    if( r->m_iLaps>=args.m_iNumLap && i>0 )
+    {
+      r->m_fBehind = pcar[order[0]]->last_crossing-pcar[k]->last_crossing;
+    }
+    r->m_bRecord = pcar[k]->bestlap_speed>track.record.speed;
+
+    r->m_aLapTime = m_aLapMemory+(long)i*args.m_iNumLap;
+    if( timing->IsOpen() )
+    {
+      r->m_fBestLap = timing->BestLapTime( k, &r->m_iBestLap );
+      r->m_iNumLapTime = timing->LastLap( k );
+      if( r->m_iNumLapTime>args.m_iNumLap )
+      {
+        r->m_iNumLapTime = args.m_iNumLap;
+      }
+      for( lap=1; lap<=r->m_iNumLapTime; lap++ )
+      {
+        r->m_aLapTime[lap-1] = (float)timing->LapTime( k, lap );
+      }
+    }
+
+    // Points of the scoring profile:
+    r->m_iPoints = race_data.m_pScoring->m_pPoints( i, args.m_bQual && !pcar[k]->started,
+                                                    pcar[k]->laps_lead, most_lead );
+    m_aTotalPoints[k] += r->m_iPoints;
+    r->m_iTotalPoints = m_aTotalPoints[k];
+    m_iNumCar++;
+  }
+}
+
+/**
+ * Results of the qualifications: all the cars in starting order
+ *
+ * @param order         (in) an array with the starting order of the cars
+ * @param pcar          (in) an array with a pointer to all cars
+ */
+void RaceResults::FillQual( int * order, Car ** pcar )
+{
+  track_desc track = get_track_description();
+  m_iStage = QUALIFYING;
+  m_iRace = 0;
+  m_sTrack = currentTrack->m_sShortName;
+  strcpy( m_sTrackName, track.sName );
+  m_iSeed = race_data.m_iInitialSeed;
+  m_iNumLap = args.m_iNumQualLap;
+  m_fLength = track.length;
+  m_fRecordSpeed = track.record.speed*MPH_FPS;
+  strcpy( m_sRecordName, track.record.rob_name );
+
+  m_iNumCar = args.m_iNumCar;
+  for( int i=0; i<args.m_iNumCar; i++ )
+  {
+    FillCar( m_aCar+i, order[i], pcar[order[i]] );
+  }
+}
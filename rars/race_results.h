@@ -0,0 +1,110 @@
+/**
+ * RACE_RESULTS.H - Results of a race or of a qualification
+ *
+ * The results are taken once from the cars at the end of the session
+ * (RaceResults::Fill) and all the reports are written from them: text and
+ * HTML (result_xxx.txt/html), result store of the tournaments (-R) and
+ * JSON lines or CSV (-O), one line per car.
+ *
+ * History
+ *  ver. 0.90 Creation
+ *
+ * @see:      C++ Coding Standard and CCDOC in help.htm
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_RACE_RESULTS_H
+#define __RARSCORE_RACE_RESULTS_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include "globals.h"
+#include "lap_timing.h"
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+class Car;
+
+/**
+ * Result of one car (speeds in mph, times in seconds)
+ */
+struct CarResult
+{
+  int      m_iCar;              // index in race_data.cars and drivers
+  const char * m_sName;         // name of the driver
+  int      m_iStarted;          // place on the grid (1..)
+  int      m_iOut;              // 1 out of the race, 3 did not qualify
+  int      m_iDone;             // completed the race
+  long     m_iLaps;
+  long     m_iLapsLead;
+  double   m_fBehind;           // seconds behind the winner (cars that finished)
+  double   m_fBehindLeader;     // at the last line crossing (Car::Behind_leader)
+  double   m_fBehindNext;
+  double   m_fAheadNext;
+  double   m_fLastCrossing;
+  double   m_fDistance;         // distance from the line
+  double   m_fSpeedAvg;
+  double   m_fSpeedMax;
+  double   m_fBestSpeed;
+  double   m_fLastSpeed;
+  bool     m_bRecord;           // best lap faster than the track record
+  double   m_fBestLap;          // best lap time (LapTiming)
+  int      m_iBestLap;          // lap of the best time
+  double   m_fLapTime;          // last lap time
+  float  * m_aLapTime;          // [lap-1] times of the laps completed
+  int      m_iNumLapTime;
+  long     m_iDamage;
+  double   m_fFuel;
+  double   m_fFuelPerLap;       // fuel of a lap (fuel mileage of the last laps), 0 if unknown
+  int      m_iPitStops;
+  const int * m_aPitLap;        // [stop] laps of the pit stops (Car::pit_log)
+  double   m_fPitTime;          // total time standing in the pits
+  long     m_iLastPitVisit;
+  double   m_fQualBestLap;      // qualification
+  double   m_fQualAvgSpeed;
+  double   m_fRobotTime;        // time used by the robot (ms)
+  int      m_iPoints;           // points of the race
+  int      m_iTotalPoints;      // points of all the races
+};
+
+/**
+ * RaceResults (RaceManager::m_oResults)
+ *
+ * Usage:
+ *   m_oResults.Fill( race, order, cars, &timing );   // RaceClose
+ *   m_oReport.WriteResults( &m_oResults );
+ */
+class RaceResults
+{
+  private:
+    float  * m_aLapMemory;      // times of the laps of all the cars
+    long     m_iLapMemory;
+
+    void   FillCar( CarResult * r, int k, Car * car );
+
+  public:
+    Stage      m_iStage;        // RACING or QUALIFYING
+    int        m_iRace;         // number of the race (1..)
+    const char * m_sTrack;      // short name of the track
+    char       m_sTrackName[32]; // name of the track (track_desc)
+    long       m_iSeed;         // initial seed of the random generator
+    long       m_iNumLap;       // laps of the race
+    double     m_fLength;       // length of the track (feet)
+    double     m_fRecordSpeed;  // track record before the race (mph)
+    char       m_sRecordName[33];
+    int        m_iNumCar;       // cars in m_aCar
+    CarResult  m_aCar[MAX_CARS];        // in finishing order (DNQ excluded from the races)
+    int        m_aTotalPoints[MAX_CARS]; // [car] points of all the races
+
+    RaceResults();
+    ~RaceResults();
+
+    void   Fill( int race, int * order, Car ** pcar, const LapTiming * timing );
+    void   FillQual( int * order, Car ** pcar );
+};
+
+#endif
@@ -0,0 +1,824 @@
+/**
+ * race_server.cpp - live stream of the race on a local socket
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       race_server.h for the messages
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "race_server.h"
+#include "car.h"
+#include "misc.h"
+#ifndef WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <errno.h>
+  #include <sys/types.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <sys/epoll.h>
+  #include <netinet/in.h>
+  #include <arpa/inet.h>
+#endif
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define SERVER_LINE   16384     // longest message
+#define TAG_LISTEN    -1        // epoll_event.data.u32 of the listening socket
+#define TAG_WAKE      -2        // and of the pipe
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+RaceServer::RaceServer()
+{
+  memset( m_aState, 0, sizeof(m_aState) );
+  m_iBack = 0;
+  m_iReady = 1;
+  m_iFront = 2;
+  m_bNewState = false;
+  m_bAsleep = false;
+  m_iEventWrite = m_iEventRead = m_iEventLost = 0;
+  m_iStep = 0;
+  m_sTrack[0] = 0;
+  m_iNumLap = 0;
+  m_iNumCar = 0;
+
+  m_iListen = -1;
+  m_iEpoll = -1;
+  m_aWake[0] = m_aWake[1] = -1;
+  for( int i=0; i<MAX_SERVER_CLIENTS; i++ )
+  {
+    m_aClient[i].m_iSocket = -1;
+    m_aClient[i].m_aBuffer = NULL;
+  }
+  m_sSocketPath[0] = 0;
+  m_aLine = NULL;
+  m_iSentNumLap = 0;
+  m_iSentNumCar = 0;
+  m_bStop = false;
+  m_bRunning = false;
+#ifndef WIN32
+  pthread_mutex_init( &m_oMutex, NULL );
+#endif
+}
+
+/**
+ * Destructor
+ */
+RaceServer::~RaceServer()
+{
+  Stop();
+#ifndef WIN32
+  pthread_mutex_destroy( &m_oMutex );
+#endif
+}
+
+void RaceServer::Lock()
+{
+#ifndef WIN32
+  pthread_mutex_lock( &m_oMutex );
+#endif
+}
+
+void RaceServer::Unlock()
+{
+#ifndef WIN32
+  pthread_mutex_unlock( &m_oMutex );
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Simulation side
+////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Wake up the socket thread (only if it sleeps, so that the simulation
+ * does not make a system call at each step)
+ *
+ * @param bWake         (in) result of the test of m_bAsleep under the lock
+ */
+void RaceServer::Wake( bool bWake )
+{
+#ifndef WIN32
+  if( bWake )
+  {
+    char c = 0;
+    if( write( m_aWake[1], &c, 1 )<0 )
+    {
+      // pipe full: the thread is awake anyway
+    }
+  }
+#endif
+}
+
+/**
+ * Add an event in the ring. If the socket thread is too late, the oldest
+ * event is lost.
+ *
+ * @param type          (in) SERVER_EVENT_xxx
+ * @param car           (in) index of the car (or -1)
+ * @param lap           (in) lap of the car
+ */
+void RaceServer::AddEvent( int type, int car, int lap )
+{
+  ServerEvent e;
+  e.m_iType = type;
+  e.m_fTime = race_data.m_fElapsedTime;
+  e.m_iCar = car;
+  e.m_iLap = lap;
+  e.m_fLapTime = 0.0f;
+  e.m_fDelta = 0.0f;
+  if( type==SERVER_EVENT_LAP )
+  {
+    const LapTiming & timing = race_data.m_oLapTiming;
+    if( timing.IsOpen() )
+    {
+      e.m_fLapTime = (float)timing.LapTime( car, lap );
+      e.m_fDelta = (float)timing.Delta( car );
+    }
+    else
+    {
+      e.m_fLapTime = (float)race_data.cars[car]->lap_time;
+    }
+  }
+
+  Lock();
+  if( m_iEventWrite-m_iEventRead>=SERVER_EVENTS )
+  {
+    m_iEventRead++;
+    m_iEventLost++;
+  }
+  m_aEvent[m_iEventWrite%SERVER_EVENTS] = e;
+  m_iEventWrite++;
+  bool bWake = m_bAsleep;
+  m_bAsleep = false;
+  Unlock();
+  Wake( bWake );
+}
+
+/**
+ * Copy the state of the race
+ *
+ * @param s             (out) state
+ */
+void RaceServer::CopyState( ServerState * s )
+{
+  int n = args.m_iNumCar<MAX_CARS ? args.m_iNumCar : MAX_CARS;
+
+  s->m_fTime = race_data.m_fElapsedTime;
+  s->m_iStep = m_iStep;
+  s->m_iNumCar = n;
+  memcpy( s->m_aCarInPos, race_data.m_aCarInPos, n*sizeof(int) );
+  for( int i=0; i<n; i++ )
+  {
+    Car * car = race_data.cars[i];
+    ServerCar * c = s->m_aCar+i;
+    c->x = (float)car->x;
+    c->y = (float)car->y;
+    c->speed = (float)sqrt( car->xdot*car->xdot+car->ydot*car->ydot );
+    c->distance = (float)car->distance;
+    c->fuel = (float)car->fuel;
+    c->damage = (long)car->damage;
+    c->laps = (int)car->laps;
+    c->pit_stops = car->pit_stops;
+    c->out = (char)car->out;
+    c->done = (char)car->done;
+    c->pitting = (char)car->pitting;
+  }
+}
+
+/**
+ * Make the back buffer the last published state
+ */
+void RaceServer::SwapState()
+{
+  Lock();
+  int tmp = m_iReady;
+  m_iReady = m_iBack;
+  m_iBack = tmp;
+  m_bNewState = true;
+  bool bWake = m_bAsleep;
+  m_bAsleep = false;
+  Unlock();
+  Wake( bWake );
+}
+
+/**
+ * Start of a race: names of the drivers and of the track
+ */
+void RaceServer::RaceStart()
+{
+  int i;
+
+  Lock();
+  strncpy( m_sTrack, currentTrack->m_sShortName, sizeof(m_sTrack)-1 );
+  m_sTrack[sizeof(m_sTrack)-1] = 0;
+  m_iNumLap = args.m_iNumLap;
+  m_iNumCar = args.m_iNumCar<MAX_CARS ? args.m_iNumCar : MAX_CARS;
+  for( i=0; i<m_iNumCar; i++ )
+  {
+    strncpy( m_aName[i], drivers[i]->getName(), sizeof(m_aName[i])-1 );
+    m_aName[i][sizeof(m_aName[i])-1] = 0;
+  }
+  Unlock();
+
+  for( i=0; i<MAX_CARS; i++ )
+  {
+    m_aLaps[i] = -1;
+    m_aPitting[i] = 0;
+  }
+  m_iStep = 0;
+  AddEvent( SERVER_EVENT_START, -1, 0 );
+}
+
+/**
+ * After each step of the race: events of the cars and, every
+ * args.m_iServerDecimate steps, state of the race
+ */
+void RaceServer::Publish()
+{
+  int n = args.m_iNumCar<MAX_CARS ? args.m_iNumCar : MAX_CARS;
+
+  for( int i=0; i<n; i++ )
+  {
+    Car * car = race_data.cars[i];
+    if( car->laps!=m_aLaps[i] )
+    {
+      if( car->laps>m_aLaps[i] && car->laps>0 )
+      {
+        AddEvent( SERVER_EVENT_LAP, i, (int)car->laps );
+      }
+      m_aLaps[i] = (int)car->laps;
+    }
+    if( car->pitting!=m_aPitting[i] )
+    {
+      AddEvent( car->pitting ? SERVER_EVENT_PIT_IN : SERVER_EVENT_PIT_OUT, i, (int)car->laps );
+      m_aPitting[i] = car->pitting;
+    }
+  }
+
+  if( m_iStep++%args.m_iServerDecimate==0 )
+  {
+    CopyState( &m_aState[m_iBack] );
+    SwapState();
+  }
+}
+
+/**
+ * End of a race: last state, then the end
+ */
+void RaceServer::RaceEnd()
+{
+  CopyState( &m_aState[m_iBack] );
+  SwapState();
+  AddEvent( SERVER_EVENT_END, -1, 0 );
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Socket side
+////////////////////////////////////////////////////////////////////////////
+
+#ifndef WIN32
+
+/**
+ * Open the socket and start its thread
+ *
+ * @param address       (in) TCP port of 127.0.0.1, or path of a Unix socket
+ * @return              false if the socket cannot be opened
+ */
+bool RaceServer::Start( const char * address )
+{
+  int i, one = 1;
+  const char * p;
+
+  for( p=address; isdigit(*p); p++ );
+  if( *p==0 )
+  {
+    struct sockaddr_in addr;
+    memset( &addr, 0, sizeof(addr) );
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons( atoi(address) );
+    addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    m_iListen = socket( AF_INET, SOCK_STREAM, 0 );
+    if( m_iListen>=0 )
+    {
+      setsockopt( m_iListen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one) );
+      if( bind( m_iListen, (struct sockaddr *)&addr, sizeof(addr) )<0 )
+      {
+        close( m_iListen );
+        m_iListen = -1;
+      }
+    }
+  }
+  else
+  {
+    struct sockaddr_un addr;
+    memset( &addr, 0, sizeof(addr) );
+    addr.sun_family = AF_UNIX;
+    strncpy( addr.sun_path, address, sizeof(addr.sun_path)-1 );
+    unlink( addr.sun_path );
+    m_iListen = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( m_iListen>=0 )
+    {
+      if( bind( m_iListen, (struct sockaddr *)&addr, sizeof(addr) )<0 )
+      {
+        close( m_iListen );
+        m_iListen = -1;
+      }
+      else
+      {
+        strcpy( m_sSocketPath, addr.sun_path );
+      }
+    }
+  }
+  if( m_iListen<0 || listen( m_iListen, MAX_SERVER_CLIENTS )<0 || pipe( m_aWake )<0 )
+  {
+    warning( "RaceServer: unable to listen on %s", address );
+    return false;
+  }
+  fcntl( m_iListen, F_SETFL, O_NONBLOCK );
+  fcntl( m_aWake[0], F_SETFL, O_NONBLOCK );
+  fcntl( m_aWake[1], F_SETFL, O_NONBLOCK );
+
+  m_iEpoll = epoll_create( MAX_SERVER_CLIENTS+2 );
+  if( m_iEpoll<0 )
+  {
+    warning( "RaceServer: epoll_create failed" );
+    return false;
+  }
+  struct epoll_event ev;
+  memset( &ev, 0, sizeof(ev) );
+  ev.events = EPOLLIN;
+  ev.data.u32 = (unsigned)TAG_LISTEN;
+  epoll_ctl( m_iEpoll, EPOLL_CTL_ADD, m_iListen, &ev );
+  ev.data.u32 = (unsigned)TAG_WAKE;
+  epoll_ctl( m_iEpoll, EPOLL_CTL_ADD, m_aWake[0], &ev );
+
+  m_aLine = new char[SERVER_LINE];
+  for( i=0; i<MAX_SERVER_CLIENTS; i++ )
+  {
+    m_aClient[i].m_aBuffer = new char[SERVER_BUFFER];
+  }
+  m_bStop = false;
+  if( pthread_create( &m_oThread, NULL, SocketThread, this )!=0 )
+  {
+    warning( "RaceServer: unable to start the thread" );
+    return false;
+  }
+  m_bRunning = true;
+  return true;
+}
+
+/**
+ * Stop the thread (after sending what it can without waiting) and close
+ * the sockets
+ */
+void RaceServer::Stop()
+{
+  int i;
+
+  if( m_bRunning )
+  {
+    m_bStop = true;
+    Wake( true );
+    pthread_join( m_oThread, NULL );
+    m_bRunning = false;
+  }
+  for( i=0; i<MAX_SERVER_CLIENTS; i++ )
+  {
+    if( m_aClient[i].m_iSocket>=0 )
+    {
+      Close( &m_aClient[i] );
+    }
+    delete [] m_aClient[i].m_aBuffer;
+    m_aClient[i].m_aBuffer = NULL;
+  }
+  if( m_iListen>=0 )
+  {
+    close( m_iListen );
+    m_iListen = -1;
+  }
+  if( m_sSocketPath[0] )
+  {
+    unlink( m_sSocketPath );
+    m_sSocketPath[0] = 0;
+  }
+  for( i=0; i<2; i++ )
+  {
+    if( m_aWake[i]>=0 )
+    {
+      close( m_aWake[i] );
+      m_aWake[i] = -1;
+    }
+  }
+  if( m_iEpoll>=0 )
+  {
+    close( m_iEpoll );
+    m_iEpoll = -1;
+  }
+  delete [] m_aLine;
+  m_aLine = NULL;
+}
+
+void * RaceServer::SocketThread( void * arg )
+{
+  ((RaceServer *)arg)->Run();
+  return NULL;
+}
+
+/**
+ * Loop of the socket thread
+ */
+void RaceServer::Run()
+{
+  struct epoll_event ev[MAX_SERVER_CLIENTS+2];
+  char buf[256];
+  int i, n;
+
+  while( !m_bStop )
+  {
+    n = epoll_wait( m_iEpoll, ev, MAX_SERVER_CLIENTS+2, 100 );
+    for( i=0; i<n; i++ )
+    {
+      int tag = (int)ev[i].data.u32;
+      if( tag==TAG_LISTEN )
+      {
+        Accept();
+      }
+      else if( tag==TAG_WAKE )
+      {
+        while( read( m_aWake[0], buf, sizeof(buf) )>0 );
+      }
+      else
+      {
+        ServerClient * c = &m_aClient[tag];
+        if( c->m_iSocket<0 )
+        {
+          continue;
+        }
+        if( ev[i].events & (EPOLLERR|EPOLLHUP) )
+        {
+          Close( c );
+          continue;
+        }
+        if( ev[i].events & EPOLLIN )
+        {
+          // the subscribers do not send anything: detect the end
+          int r = recv( c->m_iSocket, buf, sizeof(buf), MSG_DONTWAIT );
+          if( r==0 || ( r<0 && errno!=EAGAIN && errno!=EINTR ) )
+          {
+            Close( c );
+            continue;
+          }
+        }
+        if( ev[i].events & EPOLLOUT )
+        {
+          Flush( c );
+        }
+      }
+    }
+    SendPending();
+  }
+  SendPending();
+}
+
+/**
+ * New subscriber
+ */
+void RaceServer::Accept()
+{
+  int s;
+  while( (s = accept( m_iListen, NULL, NULL ))>=0 )
+  {
+    int i;
+    for( i=0; i<MAX_SERVER_CLIENTS && m_aClient[i].m_iSocket>=0; i++ );
+    if( i==MAX_SERVER_CLIENTS )
+    {
+      close( s );
+      continue;
+    }
+    fcntl( s, F_SETFL, O_NONBLOCK );
+    ServerClient * c = &m_aClient[i];
+    c->m_iSocket = s;
+    c->m_iBegin = c->m_iEnd = 0;
+    c->m_iSkipped = 0;
+    c->m_bWaitOut = false;
+
+    struct epoll_event ev;
+    memset( &ev, 0, sizeof(ev) );
+    ev.events = EPOLLIN;
+    ev.data.u32 = i;
+    epoll_ctl( m_iEpoll, EPOLL_CTL_ADD, s, &ev );
+
+    // it starts in the middle of the race: the names of the drivers
+    if( m_iSentNumCar>0 )
+    {
+      ServerEvent e;
+      memset( &e, 0, sizeof(e) );
+      e.m_iType = SERVER_EVENT_START;
+      e.m_iCar = -1;
+      int len = FormatEvent( &e );
+      memcpy( c->m_aBuffer, m_aLine, len );
+      c->m_iEnd = len;
+      Flush( c );
+    }
+  }
+}
+
+/**
+ * Disconnect a subscriber
+ *
+ * @param c             (in/out) subscriber
+ */
+void RaceServer::Close( ServerClient * c )
+{
+  epoll_ctl( m_iEpoll, EPOLL_CTL_DEL, c->m_iSocket, NULL );
+  close( c->m_iSocket );
+  c->m_iSocket = -1;
+}
+
+/**
+ * Send the buffer of a subscriber, without waiting. If the socket is
+ * full, the rest is sent when epoll says EPOLLOUT.
+ *
+ * @param c             (in/out) subscriber
+ */
+void RaceServer::Flush( ServerClient * c )
+{
+  while( c->m_iBegin<c->m_iEnd )
+  {
+    int r = send( c->m_iSocket, c->m_aBuffer+c->m_iBegin, c->m_iEnd-c->m_iBegin, MSG_DONTWAIT|MSG_NOSIGNAL );
+    if( r>0 )
+    {
+      c->m_iBegin += r;
+    }
+    else if( r<0 && errno==EINTR )
+    {
+      continue;
+    }
+    else if( r<0 && errno==EAGAIN )
+    {
+      break;
+    }
+    else
+    {
+      Close( c );
+      return;
+    }
+  }
+  bool bWaitOut = c->m_iBegin<c->m_iEnd;
+  if( !bWaitOut )
+  {
+    c->m_iBegin = c->m_iEnd = 0;
+  }
+  if( bWaitOut!=c->m_bWaitOut )
+  {
+    struct epoll_event ev;
+    memset( &ev, 0, sizeof(ev) );
+    ev.events = bWaitOut ? EPOLLIN|EPOLLOUT : EPOLLIN;
+    ev.data.u32 = c-m_aClient;
+    epoll_ctl( m_iEpoll, EPOLL_CTL_MOD, c->m_iSocket, &ev );
+    c->m_bWaitOut = bWaitOut;
+  }
+}
+
+/**
+ * Send a message to all the subscribers
+ *
+ * @param line          (in) message
+ * @param len           (in) length of the message
+ * @param bState        (in) state (skipped if the subscriber is late),
+ *                      else event (the subscriber is disconnected)
+ */
+void RaceServer::Send( const char * line, int len, bool bState )
+{
+  for( int i=0; i<MAX_SERVER_CLIENTS; i++ )
+  {
+    ServerClient * c = &m_aClient[i];
+    if( c->m_iSocket<0 )
+    {
+      continue;
+    }
+    if( c->m_iEnd+len>SERVER_BUFFER && c->m_iBegin>0 )
+    {
+      memmove( c->m_aBuffer, c->m_aBuffer+c->m_iBegin, c->m_iEnd-c->m_iBegin );
+      c->m_iEnd -= c->m_iBegin;
+      c->m_iBegin = 0;
+    }
+    if( c->m_iEnd+len>SERVER_BUFFER )
+    {
+      if( bState )
+      {
+        c->m_iSkipped++;
+      }
+      else
+      {
+        Close( c );
+      }
+      continue;
+    }
+    memcpy( c->m_aBuffer+c->m_iEnd, line, len );
+    c->m_iEnd += len;
+    Flush( c );
+  }
+}
+
+/**
+ * Take the events and the last state published by the simulation and
+ * send them
+ */
+void RaceServer::SendPending()
+{
+  static ServerEvent aEvent[SERVER_EVENTS];
+  const ServerState * s = NULL;
+  long i, n, lost;
+
+  Lock();
+  n = m_iEventWrite-m_iEventRead;
+  for( i=0; i<n; i++ )
+  {
+    aEvent[i] = m_aEvent[(m_iEventRead+i)%SERVER_EVENTS];
+  }
+  m_iEventRead = m_iEventWrite;
+  lost = m_iEventLost;
+  m_iEventLost = 0;
+  if( m_bNewState )
+  {
+    int tmp = m_iFront;
+    m_iFront = m_iReady;
+    m_iReady = tmp;
+    m_bNewState = false;
+    s = &m_aState[m_iFront];
+  }
+  if( n>0 )
+  {
+    memcpy( m_sSentTrack, m_sTrack, sizeof(m_sSentTrack) );
+    memcpy( m_aSentName, m_aName, sizeof(m_aSentName) );
+    m_iSentNumLap = m_iNumLap;
+    m_iSentNumCar = m_iNumCar;
+  }
+  m_bAsleep = ( n==0 && s==NULL );
+  Unlock();
+
+  if( lost>0 )
+  {
+    int len = sprintf( m_aLine, "{\"type\":\"lost\",\"events\":%ld}\n", lost );
+    Send( m_aLine, len, false );
+  }
+  for( i=0; i<n; i++ )
+  {
+    // the last state of the race goes before its end
+    if( aEvent[i].m_iType==SERVER_EVENT_END && s!=NULL )
+    {
+      Send( m_aLine, FormatState( s ), true );
+      s = NULL;
+    }
+    Send( m_aLine, FormatEvent( &aEvent[i] ), false );
+  }
+  if( s!=NULL )
+  {
+    Send( m_aLine, FormatState( s ), true );
+  }
+}
+
+#else // WIN32
+
+bool RaceServer::Start( const char * address )
+{
+  warning( "RaceServer: not available on this system" );
+  return false;
+}
+
+void RaceServer::Stop()
+{
+}
+
+#endif // WIN32
+
+/**
+ * Write s as a JSON string, quotes included. '"', '\\' and the control
+ * characters are escaped; the names are read as Latin-1, so the bytes
+ * above 127 are written as \u00XX and the message stays valid UTF-8.
+ *
+ * @param p             (out) buffer, 6 times the length of s + 3
+ * @param s             (in) string
+ * @return              length written
+ */
+static int JsonString( char * p, const char * s )
+{
+  char * start = p;
+
+  *p++ = '"';
+  for( ; *s; s++ )
+  {
+    unsigned char c = (unsigned char)*s;
+    switch( c )
+    {
+      case '"':  *p++ = '\\'; *p++ = '"';  break;
+      case '\\': *p++ = '\\'; *p++ = '\\'; break;
+      case '\n': *p++ = '\\'; *p++ = 'n';  break;
+      case '\r': *p++ = '\\'; *p++ = 'r';  break;
+      case '\t': *p++ = '\\'; *p++ = 't';  break;
+      default:
+        if( c<0x20 || c>0x7e )
+        {
+          p += sprintf( p, "\\u%04x", c );
+        }
+        else
+        {
+          *p++ = c;
+        }
+    }
+  }
+  *p++ = '"';
+  *p = 0;
+  return p-start;
+}
+
+/**
+ * Format the state of the race in m_aLine
+ *
+ * @param s             (in) state
+ * @return              length of the message
+ */
+int RaceServer::FormatState( const ServerState * s )
+{
+  char * p = m_aLine;
+  int i;
+
+  p += sprintf( p, "{\"type\":\"state\",\"time\":%.3f,\"step\":%ld,\"order\":[", s->m_fTime, s->m_iStep );
+  for( i=0; i<s->m_iNumCar; i++ )
+  {
+    p += sprintf( p, i ? ",%d" : "%d", s->m_aCarInPos[i] );
+  }
+  p += sprintf( p, "],\"cars\":[" );
+  for( i=0; i<s->m_iNumCar; i++ )
+  {
+    const ServerCar * c = s->m_aCar+i;
+    p += sprintf( p, "%s{\"car\":%d,\"lap\":%d,\"x\":%.2f,\"y\":%.2f,\"speed\":%.2f,\"distance\":%.1f,"
+                     "\"fuel\":%.2f,\"damage\":%ld,\"pits\":%d,\"pitting\":%d,\"out\":%d,\"done\":%d}",
+                  i ? "," : "", i, c->laps, c->x, c->y, c->speed, c->distance,
+                  c->fuel, c->damage, c->pit_stops, c->pitting, c->out, c->done );
+  }
+  p += sprintf( p, "]}\n" );
+  return p-m_aLine;
+}
+
+/**
+ * Format an event in m_aLine
+ *
+ * @param e             (in) event
+ * @return              length of the message
+ */
+int RaceServer::FormatEvent( const ServerEvent * e )
+{
+  char * p = m_aLine;
+  int i;
+
+  switch( e->m_iType )
+  {
+    case SERVER_EVENT_START:
+      p += sprintf( p, "{\"type\":\"start\",\"track\":" );
+      p += JsonString( p, m_sSentTrack );
+      p += sprintf( p, ",\"laps\":%d,\"cars\":[", m_iSentNumLap );
+      for( i=0; i<m_iSentNumCar; i++ )
+      {
+        p += sprintf( p, "%s{\"car\":%d,\"name\":", i ? "," : "", i );
+        p += JsonString( p, m_aSentName[i] );
+        p += sprintf( p, "}" );
+      }
+      p += sprintf( p, "]}\n" );
+      break;
+    case SERVER_EVENT_LAP:
+      p += sprintf( p, "{\"type\":\"lap\",\"time\":%.3f,\"car\":%d,\"lap\":%d,\"lap_time\":%.3f,\"delta\":%.3f}\n",
+                    e->m_fTime, e->m_iCar, e->m_iLap, e->m_fLapTime, e->m_fDelta );
+      break;
+    case SERVER_EVENT_PIT_IN:
+    case SERVER_EVENT_PIT_OUT:
+      p += sprintf( p, "{\"type\":\"pit\",\"time\":%.3f,\"car\":%d,\"lap\":%d,\"pit\":\"%s\"}\n",
+                    e->m_fTime, e->m_iCar, e->m_iLap, e->m_iType==SERVER_EVENT_PIT_IN ? "in" : "out" );
+      break;
+    case SERVER_EVENT_END:
+      p += sprintf( p, "{\"type\":\"end\",\"time\":%.3f}\n", e->m_fTime );
+      break;
+  }
+  return p-m_aLine;
+}
@@ -0,0 +1,194 @@
+/**
+ * race_server.h - live stream of the race on a local socket
+ *
+ * With -S, the state of the race is streamed to the programs connected
+ * on a local socket (eg. dashboards of races run without display):
+ *   -S7000           TCP port 7000 of 127.0.0.1
+ *   -S/tmp/rars.sock Unix domain socket
+ *   -Sd5             state of the cars sent every 5 steps (default 1)
+ *
+ * The messages are lines of JSON:
+ *   {"type":"start","track":"oval2","laps":10,"cars":[{"car":0,"name":"Tuto4"},...]}
+ *   {"type":"state","time":12.34,"order":[1,0],"cars":[{"car":0,"lap":3,"x":..},...]}
+ *   {"type":"lap","time":12.30,"car":1,"lap":3,"lap_time":29.12,"delta":-0.05}
+ *   {"type":"pit","time":40.10,"car":0,"lap":5,"pit":"in"}
+ *   {"type":"end","time":300.2}        (after the last state of the race)
+ *
+ * The simulation only copies the state of the cars in a triple buffer
+ * and the events in a ring (RaceServer::Publish), under a lock that is
+ * never held for more than a swap. The socket thread formats and sends
+ * the messages with epoll. A subscriber too slow to read skips states;
+ * it is disconnected if an event does not fit in its buffer. So the
+ * subscribers never stall the race.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       race_server.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_RACE_SERVER_H
+#define __RARSCORE_RACE_SERVER_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#ifndef WIN32
+  #include <pthread.h>
+#endif
+#include "globals.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_SERVER_CLIENTS  16
+#define SERVER_EVENTS       1024      // events waiting to be sent
+#define SERVER_BUFFER       65536     // bytes waiting to be sent to a client
+
+#define SERVER_EVENT_START  0
+#define SERVER_EVENT_LAP    1
+#define SERVER_EVENT_PIT_IN 2
+#define SERVER_EVENT_PIT_OUT 3
+#define SERVER_EVENT_END    4
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * State of a car in a step
+ */
+struct ServerCar
+{
+  float x, y;
+  float speed;
+  float distance;
+  float fuel;
+  long  damage;
+  int   laps;
+  int   pit_stops;
+  char  out;
+  char  done;
+  char  pitting;
+};
+
+/**
+ * State of the race in a step
+ */
+struct ServerState
+{
+  double    m_fTime;
+  long      m_iStep;
+  int       m_iNumCar;
+  int       m_aCarInPos[MAX_CARS];
+  ServerCar m_aCar[MAX_CARS];
+};
+
+/**
+ * Lap, pit, start or end of the race
+ */
+struct ServerEvent
+{
+  int    m_iType;               // SERVER_EVENT_xxx
+  double m_fTime;
+  int    m_iCar;
+  int    m_iLap;
+  float  m_fLapTime;
+  float  m_fDelta;
+};
+
+/**
+ * Subscriber
+ */
+struct ServerClient
+{
+  int    m_iSocket;             // -1 if free
+  char * m_aBuffer;             // bytes not sent yet
+  int    m_iBegin, m_iEnd;
+  long   m_iSkipped;            // states not sent (too slow)
+  bool   m_bWaitOut;            // waiting for EPOLLOUT
+};
+
+/**
+ * RaceServer (used by RaceManager with option -S)
+ *
+ * Usage:
+ *   server.Start( args.m_sServer );    // ArgsInit
+ *   server.RaceStart();                // RaceInit
+ *   server.Publish();                  // after each step of the race
+ *   server.RaceEnd();                  // RaceClose
+ *   server.Stop();                     // ArgsClose
+ */
+class RaceServer
+{
+  private:
+    // simulation side
+    ServerState   m_aState[3];          // triple buffer
+    int           m_iBack, m_iReady, m_iFront;
+    bool          m_bNewState;
+    bool          m_bAsleep;            // the socket thread waits for the pipe
+    ServerEvent   m_aEvent[SERVER_EVENTS];
+    long          m_iEventWrite;        // ring of events
+    long          m_iEventRead;
+    long          m_iEventLost;
+    int           m_aLaps[MAX_CARS];    // to find the events
+    int           m_aPitting[MAX_CARS];
+    long          m_iStep;
+    char          m_sTrack[32];
+    char          m_aName[MAX_CARS][32];
+    int           m_iNumLap;
+    int           m_iNumCar;
+
+    // socket side
+    int           m_iListen;
+    int           m_iEpoll;
+    int           m_aWake[2];           // pipe waking up the socket thread
+    ServerClient  m_aClient[MAX_SERVER_CLIENTS];
+    char          m_sSocketPath[108];   // Unix socket to unlink
+    char        * m_aLine;              // formatted message
+    char          m_sSentTrack[32];     // copies of the simulation side
+    char          m_aSentName[MAX_CARS][32];
+    int           m_iSentNumLap;
+    int           m_iSentNumCar;
+    volatile bool m_bStop;
+    bool          m_bRunning;
+
+#ifndef WIN32
+    pthread_t       m_oThread;
+    pthread_mutex_t m_oMutex;
+
+    static void * SocketThread( void * arg );
+#endif
+    void   Lock();
+    void   Unlock();
+    void   Wake( bool bWake );
+    void   AddEvent( int type, int car, int lap );
+    void   CopyState( ServerState * s );
+    void   SwapState();
+
+    void   Run();
+    void   Accept();
+    void   Close( ServerClient * c );
+    void   Flush( ServerClient * c );
+    void   Send( const char * line, int len, bool bState );
+    void   SendPending();
+    int    FormatState( const ServerState * s );
+    int    FormatEvent( const ServerEvent * e );
+
+  public:
+    RaceServer();
+    ~RaceServer();
+
+    bool   Start( const char * address );
+    void   Stop();
+    bool   IsRunning() { return m_bRunning; }
+
+    void   RaceStart();
+    void   Publish();
+    void   RaceEnd();
+};
+
+#endif
@@ -22,12 +22,15 @@
 //--------------------------------------------------------------------------
 
 #include <stdarg.h>
+#include <stdlib.h>
 #include <fstream.h>
 #include <string.h>
 #include <iomanip.h>
 #include "report.h"
 #include "os.h"
 #include "misc.h"
+#include "profiles.h"
+#include "pit_strategy.h"
 
 //--------------------------------------------------------------------------
 //                           F U N C T I O N S
@@ -95,7 +98,9 @@ void Report::WriteBegin()
   WriteHtml( "</span>" );
   WriteNewLine();
   WriteNewLine();
-  Write( "Track surface type %d", args.m_iSurface );
+  Write( "Track surface type %d", currentTrack->Surface() );
+  WriteNewLine();
+  Write( "Physics %s, scoring %s", g_aPhysicsProfiles[args.m_iPhysics].m_sName, g_aScoringProfiles[args.m_iScoring].m_sName );
   WriteNewLine();
   Write( "%d cars for ", args.m_iNumCar );
   if( args.m_iNumLap )
@@ -122,17 +127,17 @@ void Report::WriteBegin()
 /**
  * Outputs final qualifying results
  *
- * @param order      (in) an array with the srating order of the cars
- * @param pcar       (in) an array with a pointer to all cars
+ * @param results    (in) the cars in starting order
  */
-void Report::WriteQualResults(int* order, Car** pcar)
+void Report::WriteQualResults(const RaceResults * results)
 {
-  int i, k;
+  int i;
   double ratio= 0;
+  const CarResult * first = results->m_aCar;
  
   WriteHR( '-' );
   WriteHtml( "<span class=\"title\">" );
-  Write( "Qualifying results on %s", get_track_description().sName );
+  Write( "Qualifying results on %s", results->m_sTrackName );
   WriteHtml( "</span>" );
   WriteNewLine();
   WriteNewLine();
@@ -154,11 +159,11 @@ void Report::WriteQualResults(int* order, Car** pcar)
   Write( "Time to qualify = best time * %4.2f = ", Q_CUTOFF  );
   if(args.m_iQualMode == QUAL_AVERAGE_SPEED)
   {
-    Write( "%6.2f", MPH_FPS * pcar[order[0]]->q_avgspeed / Q_CUTOFF );
+    Write( "%6.2f", MPH_FPS * first->m_fQualAvgSpeed / Q_CUTOFF );
   }
   else if(args.m_iQualMode == QUAL_FASTEST_LAP)
   {
-    Write( "%6.2f", MPH_FPS * pcar[order[0]]->q_bestlap / Q_CUTOFF );
+    Write( "%6.2f", MPH_FPS * first->m_fQualBestLap / Q_CUTOFF );
   }
   Write( " mph." );
 
@@ -166,45 +171,45 @@ void Report::WriteQualResults(int* order, Car** pcar)
   WriteNewLine();
   WriteHtml( "<TABLE>" );
   WriteHtml( "<TR><TD class=\"tabTitle\">Position</TD><TD class=\"tabTitle\">Driver</TD><TD class=\"tabTitle\">Time</TD></TR>" );
-  for(i=0; i<args.m_iNumCar; i++) 
+  for(i=0; i<results->m_iNumCar; i++) 
   {
+    const CarResult * r = results->m_aCar+i;
     WriteHtml( "<TR><TD>" );
-    k = order[i];   
     Write( "%2d ", i+1 );
     WriteHtml( "</TD><TD>" );
-    Write( "%-9s ", drivers[k]->getName() );
+    Write( "%-9s ", r->m_sName );
     WriteHtml( "</TD><TD>" );
     if( args.m_iQualMode==QUAL_AVERAGE_SPEED )
     {
-      if(pcar[k]->q_avgspeed)
-        ratio = 100 * pcar[order[0]]->q_avgspeed / pcar[k]->q_avgspeed;
+      if(r->m_fQualAvgSpeed)
+        ratio = 100 * first->m_fQualAvgSpeed / r->m_fQualAvgSpeed;
       else ratio = 0;
-      Write( "%6.2f ", pcar[k]->q_avgspeed * MPH_FPS );
+      Write( "%6.2f ", r->m_fQualAvgSpeed * MPH_FPS );
     }
     else if(args.m_iQualMode==QUAL_FASTEST_LAP)
     {
-      if(pcar[k]->q_bestlap)
+      if(r->m_fQualBestLap)
       {
-        ratio = 100 * pcar[order[0]]->q_bestlap / pcar[k]->q_bestlap;
+        ratio = 100 * first->m_fQualBestLap / r->m_fQualBestLap;
       }
       else
       {
         ratio = 0;
       }
-      Write( "%6.2f mph", pcar[k]->q_bestlap * MPH_FPS );
+      Write( "%6.2f mph", r->m_fQualBestLap * MPH_FPS );
     }
 
-    if(pcar[k]->out==3)
+    if(r->m_iOut==3)
     {
       m_fout << "DNQ";
-      if(!pcar[k]-> q_avgspeed)
-        Write( "%6d laps",  pcar[k]->laps );
+      if(!r->m_fQualAvgSpeed)
+        Write( "%6d laps",  r->m_iLaps );
       else
         Write( "%6d %",  ratio );
     } 
-    else if(pcar[k]->damage)
+    else if(r->m_iDamage)
     {
-      Write( "%6d %", pcar[k]->damage );
+      Write( "%6d %", r->m_iDamage );
     }
     WriteHtml( "</TD></TR>" );
     m_fout << endl;
@@ -217,27 +222,22 @@ void Report::WriteQualResults(int* order, Car** pcar)
  * Outputs the race results, statistics about race
  * and the accumulated points
  *
- * @param race       (in) ?
- * @param order      (in) an array with the srating order of the cars
- * @param pcar       (in) an array with a pointer to all cars
+ * @param results    (in) the cars in finishing order
  */
-void Report::WriteResults(int race, int* order, Car** pcar)
+void Report::WriteResults(const RaceResults * results)
 {
-  int i, k;
-
-  track_desc track = get_track_description();
-  fastest_lap record = track.record;
-  double length = track.length;
+  int i;
+  double length = results->m_fLength;
 
   WriteHR( '-' );
   WriteHtml( "<span class=\"title\">" );
-  Write( "Race %d : Track %s", race + args.m_iCurrentTrack*args.m_iNumRace, track.sName );
+  Write( "Race %d : Track %s", results->m_iRace, results->m_sTrackName );
   WriteHtml( "</span><br>" );
   WriteNewLine();
   Write( "Race length was %.2f miles, ", args.m_iNumLap*length/5280.0 );
   Write( "%.2f kilometers.", args.m_iNumLap*length/3281.0 );
   WriteNewLine();
-  Write( "Track record was %.2f mph by %s", record.speed*MPH_FPS, record.rob_name );
+  Write( "Track record was %.2f mph by %s", results->m_fRecordSpeed, results->m_sRecordName );
   WriteNewLine();
   WriteNewLine();
 
@@ -255,88 +255,11 @@ void Report::WriteResults(int race, int* order, Car** pcar)
   WriteHtml( "  <td>\n" ); 
   WriteHtml( "<TABLE width=\"700\">\n" );
   WriteHtml( "<TR><TD class=\"tabTitle\">F</TD><TD class=\"tabTitle\">S</TD><TD class=\"tabTitle\">Driver</TD><TD class=\"tabTitle\">Laps</TD><TD class=\"tabTitle\">Lead</TD><TD class=\"tabTitle\">Speed</TD><TD class=\"tabTitle\">Best</TD><TD class=\"tabTitle\">Damage</TD><TD class=\"tabTitle\">Fuel</TD><TD class=\"tabTitle\">Pits</TD><TD class=\"tabTitle\">Time</TD><TD class=\"tabTitle\">Last</TD><TD class=\"tabTitle\">Pnts</TD></TR>" );
-   
-  // The places:   
-  for(i=0; i<args.m_iNumCar; i++)
-  {
-    k = order[i];   
-    if(pcar[k]->out == 3)
-    {
-      break;// Don't show DNQ cars in race results
-    }
 
-#ifdef F1
-    // F1 style scoring:
-    const int points[] = {10, 6, 4, 3, 2, 1 };   
-
-    if(i < 6)   // Points:
-    {
-      m_aPoints[k] += points[i];
-    }
-#endif
-#ifdef INDYCAR
-    // Indycar style scoring: 
-    const int points[] = { 20, 16, 14, 12, 10, 8, 6, 5, 4, 3, 2, 1 };   
-
-    if(i < 12)   // Points:
-    {
-      m_aPoints[k] += points[i];
-    }
-    if(args.m_bQual && !pcar[k]->started)
-    {
-      m_aPoints[k] += 1;
-    }
-    for(int j=0;j<args.m_iNumCar;j++)
-    {
-      if (pcar[k]->laps_lead < pcar[j]->laps_lead)
-      {
-        break;
-      }
-      if (j==args.m_iNumCar-1)
-      {
-        m_aPoints[k] += 1;
-      }
-    }
-#endif
-#ifdef NASCAR
-    // NASCAR style scoring: 
-    const int points[] = {175,170,165,160,155,150,146,142,138,134,130,
-    127,124,121,118,115,112,109,106,103,100,97,94,91,88,85,82,79,76,
-    73,70,67,64,61,58,55,52,49,46,43,40,37,34,31};   
-
-    if(i < 44)   // Points:
-    {
-      m_aPoints[k] += points[i];
-    }
-    if(pcar[k]->laps_lead)
-    {
-      m_aPoints[k] += 5;
-    }
-    for(int j=0;j<car_count;j++)
-    {
-      if (pcar[k]->laps_lead < pcar[j]->laps_lead)
-      {
-        break;
-      }
-      if (j==car_count-1)
-      {
-        m_aPoints[k] += 5;
-      }
-    }
-#endif      
-#ifdef BTCC
-    // BTCC style scoring: 
-    const int points[] = { 15, 12, 10, 8, 6, 5, 4, 3, 2, 1 };   
-
-    if(i < 10)   // Points:
-    {
-      m_aPoints[k] += points[i];
-    }
-    if(args.doQual && !pcar[k]->started)
-    {
-      m_aPoints[k] += 1;
-    }
-#endif
+  // The places (DNQ cars are not in the race results):
+  for(i=0; i<results->m_iNumCar; i++)
+  {
+    const CarResult * r = results->m_aCar+i;
 
     // Statistics:
     WriteHtml( "\n<TR>" );
@@ -344,7 +267,7 @@ void Report::WriteResults(int race, int* order, Car** pcar)
     WriteHtml( "<TD>" );
     Write( "%2d", i+1 );
     WriteHtml( "</TD><TD>" );
-    Write( "%3d", pcar[k]->started+1 );
+    Write( "%3d", r->m_iStarted );
     WriteHtml( "</TD>" );
     if( i==0 )
     {
@@ -355,10 +278,10 @@ void Report::WriteResults(int race, int* order, Car** pcar)
       WriteHtml( "<TD>" );
     }
     m_fout << "  ";
-    Write( "%-9s",  drivers[k]->getName() );
+    Write( "%-9s",  r->m_sName );
     WriteHtml( "</TD><TD>" );
     // output completed laps or seconds down from leader:
-    if( pcar[k]->laps>=args.m_iNumLap )
+    if( r->m_iLaps>=args.m_iNumLap )
     {
       if(!i)
       {
@@ -366,20 +289,20 @@ void Report::WriteResults(int race, int* order, Car** pcar)
       }
       else
       {
-        Write( "%7.2f", pcar[order[0]]->last_crossing-pcar[k]->last_crossing );
+        Write( "%7.2f", r->m_fBehind );
       }
     }
     else
     {
-      Write( "%7d", pcar[k]->laps );
+      Write( "%7d", r->m_iLaps );
     }
     WriteHtml( "</TD><TD>" );
-    Write( "%5d", pcar[k]->laps_lead );
+    Write( "%5d", r->m_iLapsLead );
     WriteHtml( "</TD><TD>" );
-    Write( "%7.2f",  pcar[k]->speed_avg * MPH_FPS );
+    Write( "%7.2f",  r->m_fSpeedAvg );
     WriteHtml( "</TD><TD>" );
-    Write( "%7.2f", pcar[k]->bestlap_speed * MPH_FPS );
-    if(pcar[k]->bestlap_speed > record.speed)
+    Write( "%7.2f", r->m_fBestSpeed );
+    if(r->m_bRecord)
     {
       Write( "!" );
     }
@@ -388,17 +311,17 @@ void Report::WriteResults(int race, int* order, Car** pcar)
       Write( " " );
     }
     WriteHtml( "</TD><TD>" );
-    Write( "%6d", pcar[k]->damage );
+    Write( "%6d", r->m_iDamage );
     WriteHtml( "</TD><TD>" );
-    Write( "%5d", int(pcar[k]->fuel) );
+    Write( "%5d", int(r->m_fFuel) );
     WriteHtml( "</TD><TD>" );
-    Write( "%4d", pcar[k]->pit_stops );// number of stops
+    Write( "%4d", r->m_iPitStops );// number of stops
     WriteHtml( "</TD><TD>" );
-    Write( "%6d", int(pcar[k]->Total_pit_time) );
+    Write( "%6d", int(r->m_fPitTime) );
     WriteHtml( "</TD><TD>" );
-    Write( "%5d", pcar[k]->last_pit_visit );
+    Write( "%5d", r->m_iLastPitVisit );
     WriteHtml( "</TD><TD>" );
-    Write( "%3d", m_aPoints[k] );
+    Write( "%3d", r->m_iTotalPoints );
     WriteHtml( "</TD>" );
     WriteHtml( "</TR>" );
     m_fout << endl;
@@ -414,6 +337,423 @@ void Report::WriteResults(int race, int* order, Car** pcar)
   WriteHtml( "</table>\n" );
 }
 
+/**
+ * Writes the lap times of the race in finishing order: best lap, best
+ * time of each car in each sector, theoretical best lap (best
+ * mini-sectors) and average lap
+ *
+ * @param order      (in) an array with the finishing order of the cars
+ * @param pcar       (in) an array with a pointer to all cars
+ * @param timing     (in) the times of the race
+ */
+void Report::WriteLapTimes(int* order, Car** pcar, const LapTiming * timing)
+{
+  int i, k, s, lap;
+  int n = timing->NumSector();
+
+  WriteNewLine();
+  m_fout << " F  Driver      Best  Lap";
+  for( s=0; s<n; s++ )
+  {
+    m_fout << "     S" << s+1;
+  }
+  m_fout << " Theor. Average" << endl;
+
+  WriteHtml( "<TABLE width=\"700\">\n" );
+  WriteHtml( "<TR><TD class=\"tabTitle\">F</TD><TD class=\"tabTitle\">Driver</TD><TD class=\"tabTitle\">Best</TD><TD class=\"tabTitle\">Lap</TD>" );
+  for( s=0; s<n; s++ )
+  {
+    WriteHtml( "<TD class=\"tabTitle\">S%d</TD>", s+1 );
+  }
+  WriteHtml( "<TD class=\"tabTitle\">Theor.</TD><TD class=\"tabTitle\">Average</TD></TR>" );
+
+  for(i=0; i<args.m_iNumCar; i++)
+  {
+    k = order[i];
+    if(pcar[k]->out == 3)
+    {
+      break;// DNQ
+    }
+    lap = 0;
+    double best = timing->BestLapTime( k, &lap );
+
+    WriteHtml( "\n<TR><TD>" );
+    Write( "%2d", i+1 );
+    WriteHtml( "</TD><TD>" );
+    m_fout << "  ";
+    Write( "%-9s", drivers[k]->getName() );
+    WriteHtml( "</TD><TD>" );
+    Write( "%7.2f", best );
+    WriteHtml( "</TD><TD>" );
+    Write( "%5d", lap );
+    for( s=0; s<n; s++ )
+    {
+      WriteHtml( "</TD><TD>" );
+      Write( "%7.2f", timing->BestSectorTime( k, s ) );
+    }
+    WriteHtml( "</TD><TD>" );
+    Write( "%7.2f", timing->TheoreticalBest( k ) );
+    WriteHtml( "</TD><TD>" );
+    lap = timing->LastLap( k );
+    Write( "%8.2f", lap>0 ? ( timing->Time(k,lap)-timing->Time(k,0) )/lap : 0.0 );
+    WriteHtml( "</TD></TR>" );
+    m_fout << endl;
+  }
+  WriteHtml( "</TABLE>" );
+}
+
+static int CompareFloat( const void * a, const void * b )
+{
+  float x = *(const float *)a, y = *(const float *)b;
+  return x<y ? -1 : ( x>y ? 1 : 0 );
+}
+
+/**
+ * Writes the best pit plan of each car that completed the race (-F),
+ * for the same number of laps. The profile of the car is measured in
+ * the race: median lap time (taken with half a tank and half the final
+ * damage) and its spread
+ * (interquartile range, the laps of the stops are outliers), fuel of a
+ * lap, damage since the last stop. The other values are the estimates
+ * of PitStrategy::DefaultProfile.
+ *
+ * @param results    (in) the cars in finishing order
+ */
+void Report::WritePitPlans(const RaceResults * results)
+{
+  int i, j;
+  char sStops[MAX_PLAN_STOPS*24+1];
+  float * aLap = new float[results->m_iNumLap>0 ? results->m_iNumLap : 1];
+
+  WriteNewLine();
+  m_fout << " F  Driver       Lap Fuel/l Dmg/l  Start Stops (lap:fuel/repair)             Plan   DNF%    Race" << endl;
+  WriteHtml( "<TABLE width=\"700\">\n" );
+  WriteHtml( "<TR><TD class=\"tabTitle\">F</TD><TD class=\"tabTitle\">Driver</TD><TD class=\"tabTitle\">Lap</TD><TD class=\"tabTitle\">Fuel/l</TD><TD class=\"tabTitle\">Dmg/l</TD><TD class=\"tabTitle\">Start</TD><TD class=\"tabTitle\">Stops</TD><TD class=\"tabTitle\">Plan</TD><TD class=\"tabTitle\">DNF</TD><TD class=\"tabTitle\">Race</TD></TR>" );
+
+  for( i=0; i<results->m_iNumCar; i++ )
+  {
+    const CarResult * r = results->m_aCar+i;
+    int n = r->m_iNumLapTime;
+    if( n<4 || r->m_fFuelPerLap<=0.0 )
+    {
+      continue;
+    }
+    double race = 0.0;
+    for( j=0; j<n; j++ )
+    {
+      aLap[j] = r->m_aLapTime[j];
+      race += r->m_aLapTime[j];
+    }
+    qsort( aLap, n, sizeof(float), CompareFloat );
+
+    LapProfile p;
+    PitStrategy::DefaultProfile( &p, aLap[n/2], r->m_fFuelPerLap );
+    p.m_fLapTime -= p.m_fFuelPenalty*p.m_fMaxFuel/2+p.m_fDamagePenalty*r->m_iDamage/2;
+    p.m_fLapTimeSd = ( aLap[3*n/4]-aLap[n/4] )/1.349;
+    long since = r->m_iLaps-r->m_iLastPitVisit;
+    p.m_fDamagePerLap = since>0 ? (double)r->m_iDamage/since : 0.0;
+    p.m_fDamageSd = p.m_fDamagePerLap;
+
+    PitStrategy ps;
+    PitPlan plan;
+    PitScore score;
+    ps.Init( &p, results->m_iNumLap );
+    ps.SetSeed( (unsigned int)results->m_iSeed+r->m_iCar );
+    ps.Optimize( args.m_iPitPlanStops, PIT_PLAN_RUNS, &plan, &score );
+
+    sStops[0] = 0;
+    for( j=0; j<plan.m_iNumStop; j++ )
+    {
+      sprintf( sStops+strlen(sStops), "%s%d:%.0f/%ld", j ? " " : "", plan.m_aLap[j], plan.m_aFuel[j], plan.m_aRepair[j] );
+    }
+
+    WriteHtml( "\n<TR><TD>" );
+    Write( "%2d", i+1 );
+    WriteHtml( "</TD><TD>" );
+    m_fout << "  ";
+    Write( "%-9s", r->m_sName );
+    WriteHtml( "</TD><TD>" );
+    Write( "%7.2f", aLap[n/2] );
+    WriteHtml( "</TD><TD>" );
+    Write( "%6.2f", r->m_fFuelPerLap );
+    WriteHtml( "</TD><TD>" );
+    Write( "%6.0f", p.m_fDamagePerLap );
+    WriteHtml( "</TD><TD>" );
+    Write( "%6.1f", plan.m_fStartFuel );
+    WriteHtml( "</TD><TD>" );
+    Write( " %-32s", plan.m_iNumStop ? sStops : "-" );
+    WriteHtml( "</TD><TD>" );
+    Write( "%8.1f", score.m_fTime );
+    WriteHtml( "</TD><TD>" );
+    Write( "%7.1f", 100.0*score.m_fDnf );
+    WriteHtml( "</TD><TD>" );
+    if( n>=results->m_iNumLap )
+    {
+      Write( "%8.1f", race );
+    }
+    else
+    {
+      Write( "%8s", "-" );
+    }
+    WriteHtml( "</TD></TR>" );
+    m_fout << endl;
+  }
+  WriteHtml( "</TABLE>" );
+  delete [] aLap;
+}
+
+/**
+ * Writes the sub-steps of the integrator (-I, -Ia) and the difference
+ * of each car with the reference step in a tick: distance between the state at
+ * the end of a tick and the one of one step of delta_time from the same
+ * start, mean and largest over the race. The fuel burned by the
+ * sub-steps must be the one of the reference steps, within
+ * INTEGRATOR_FUEL_ERROR: else a warning is given.
+ *
+ * @param results    (in) the cars in finishing order
+ */
+void Report::WriteIntegrator(const RaceResults * results)
+{
+  Integrator * integrator = &race_data.m_oIntegrator;
+
+  WriteNewLine();
+  if( integrator->m_iMode==INTEGRATOR_ADAPTIVE )
+  {
+    m_fout << " Integrator: adaptive sub-steps, tolerance " << integrator->m_fTolerance << " fps" << endl;
+  }
+  else
+  {
+    m_fout << " Integrator: " << integrator->m_iNumSubstep << " sub-steps" << endl;
+  }
+  m_fout << " I  Driver     Steps/tick  Max  TickDiff(ft)  Max(ft)   Diff(fps) Max(fps)  Fuel/ref" << endl;
+  WriteHtml( "<TABLE width=\"700\">\n" );
+  WriteHtml( "<TR><TD class=\"tabTitle\">I</TD><TD class=\"tabTitle\">Driver</TD><TD class=\"tabTitle\">Steps/tick</TD><TD class=\"tabTitle\">Max</TD><TD class=\"tabTitle\">TickDiff(ft)</TD><TD class=\"tabTitle\">Max(ft)</TD><TD class=\"tabTitle\">Diff(fps)</TD><TD class=\"tabTitle\">Max(fps)</TD><TD class=\"tabTitle\">Fuel/ref</TD></TR>" );
+
+  for( int i=0; i<results->m_iNumCar; i++ )
+  {
+    const CarResult * r = results->m_aCar+i;
+    const IntegratorCar * c = integrator->State( r->m_iCar );
+    if( c->m_iNumTick==0 )
+    {
+      continue;
+    }
+
+    WriteHtml( "\n<TR><TD>" );
+    Write( "%2d", i+1 );
+    WriteHtml( "</TD><TD>" );
+    m_fout << "  ";
+    Write( "%-9s", r->m_sName );
+    WriteHtml( "</TD><TD>" );
+    Write( "%11.3f", (double)c->m_iNumStep/c->m_iNumTick );
+    WriteHtml( "</TD><TD>" );
+    Write( "%5d", c->m_iMaxStep );
+    WriteHtml( "</TD><TD>" );
+    Write( "%12.2e", c->m_oTickDiff.Mean() );
+    WriteHtml( "</TD><TD>" );
+    Write( "%9.2e", c->m_oTickDiff.Max() );
+    WriteHtml( "</TD><TD>" );
+    Write( "%12.2e", c->m_oTickSpeedDiff.Mean() );
+    WriteHtml( "</TD><TD>" );
+    Write( "%9.2e", c->m_oTickSpeedDiff.Max() );
+    WriteHtml( "</TD><TD>" );
+    double fuel = c->m_fRefFuel>0.0 ? c->m_fFuel/c->m_fRefFuel : 1.0;
+    Write( "%10.4f", fuel );
+    WriteHtml( "</TD></TR>" );
+    m_fout << endl;
+    if( c->m_fRefFuel>1.0 && fabs( fuel-1.0 )>INTEGRATOR_FUEL_ERROR ) // 1 lb: the cars out at the start
+    {
+      warning( "Integrator: %s burned %.2f lb, %.2f lb with one step per tick",
+               r->m_sName, c->m_fFuel, c->m_fRefFuel );
+    }
+  }
+  WriteHtml( "</TABLE>" );
+}
+
+/**
+ * Appends the race results to the file given with -R, one line per car
+ * in finishing order, then END (see tournament.cpp):
+ * CAR pos driver start laps laps_lead avg_speed best_speed damage pits time
+ *
+ * @param results    (in) the cars in finishing order
+ */
+void Report::WriteResultStore(const RaceResults * results)
+{
+  FILE * f;
+  int i;
+
+  if( !args.m_sResultFile[0] )
+  {
+    return;
+  }
+  if( (f = fopen(args.m_sResultFile, "a"))==NULL )
+  {
+    warning( "Report.cpp: WriteResultStore: unable to write %s", args.m_sResultFile );
+    return;
+  }
+  for(i=0; i<results->m_iNumCar; i++)
+  {
+    const CarResult * r = results->m_aCar+i;
+    fprintf( f, "CAR\t%d\t%s\t%d\t%ld\t%ld\t%.3f\t%.3f\t%ld\t%d\t%.2f\n",
+             i+1, r->m_sName, r->m_iStarted, r->m_iLaps, r->m_iLapsLead,
+             r->m_fSpeedAvg, r->m_fBestSpeed, r->m_iDamage, r->m_iPitStops,
+             r->m_fLastCrossing );
+  }
+  fprintf( f, "END\n" );
+  fclose( f );
+}
+
+/**
+ * Appends the results to the file given with -O, one line per car in
+ * finishing order (starting order for the qualifications): CSV if the
+ * name of the file ends with .csv (with a header if the file is empty),
+ * else JSON lines. The lines of all the races have the same fields, so
+ * that a file of many races is read without parsing the text reports.
+ *
+ * @param results    (in) the results of a race or of the qualifications
+ */
+void Report::WriteStructured(const RaceResults * results)
+{
+  FILE * f;
+  int i;
+
+  if( !args.m_sStructuredFile[0] )
+  {
+    return;
+  }
+  const char * ext = strrchr( args.m_sStructuredFile, '.' );
+  int mode = ( ext!=NULL && strcmp(ext, ".csv")==0 ) ? STRUCT_CSV : STRUCT_JSON;
+  if( (f = fopen(args.m_sStructuredFile, "a"))==NULL )
+  {
+    warning( "Report.cpp: WriteStructured: unable to write %s", args.m_sStructuredFile );
+    return;
+  }
+  fseek( f, 0, SEEK_END );
+  if( mode==STRUCT_CSV && ftell(f)==0 && results->m_iNumCar>0 )
+  {
+    WriteCarFields( f, STRUCT_CSV_HEADER, results, 0 );
+  }
+  for( i=0; i<results->m_iNumCar; i++ )
+  {
+    WriteCarFields( f, mode, results, i );
+  }
+  fclose( f );
+}
+
+/**
+ * Writes the line of a car in a structured result file
+ *
+ * @param f          (in) the file
+ * @param mode       (in) STRUCT_JSON, STRUCT_CSV or STRUCT_CSV_HEADER (names only)
+ * @param results    (in) the results
+ * @param pos        (in) index of the car in results->m_aCar
+ */
+void Report::WriteCarFields(FILE * f, int mode, const RaceResults * results, int pos)
+{
+  const CarResult * r = results->m_aCar+pos;
+  int i;
+
+  m_iNumField = 0;
+  if( mode==STRUCT_JSON )
+  {
+    fputc( '{', f );
+  }
+  WriteField( f, mode, "session", "\"%s\"", results->m_iStage==QUALIFYING ? "qual" : "race" );
+  WriteField( f, mode, "race", "%d", results->m_iRace );
+  WriteField( f, mode, "track", "\"%s\"", results->m_sTrack );
+  WriteField( f, mode, "seed", "%ld", results->m_iSeed );
+  WriteField( f, mode, "race_laps", "%ld", results->m_iNumLap );
+  WriteField( f, mode, "pos", "%d", pos+1 );
+  WriteField( f, mode, "car", "%d", r->m_iCar );
+  WriteField( f, mode, "driver", "\"%s\"", r->m_sName );
+  WriteField( f, mode, "started", "%d", r->m_iStarted );
+  WriteField( f, mode, "out", "%d", r->m_iOut );
+  WriteField( f, mode, "done", "%d", r->m_iDone );
+  WriteField( f, mode, "laps", "%ld", r->m_iLaps );
+  WriteField( f, mode, "laps_lead", "%ld", r->m_iLapsLead );
+  WriteField( f, mode, "behind", "%.3f", r->m_fBehind );
+  WriteField( f, mode, "behind_leader", "%.3f", r->m_fBehindLeader );
+  WriteField( f, mode, "behind_next", "%.3f", r->m_fBehindNext );
+  WriteField( f, mode, "ahead_next", "%.3f", r->m_fAheadNext );
+  WriteField( f, mode, "last_crossing", "%.3f", r->m_fLastCrossing );
+  WriteField( f, mode, "distance", "%.1f", r->m_fDistance );
+  WriteField( f, mode, "speed_avg", "%.3f", r->m_fSpeedAvg );
+  WriteField( f, mode, "speed_max", "%.3f", r->m_fSpeedMax );
+  WriteField( f, mode, "bestlap_speed", "%.3f", r->m_fBestSpeed );
+  WriteField( f, mode, "lastlap_speed", "%.3f", r->m_fLastSpeed );
+  WriteField( f, mode, "record", "%d", r->m_bRecord ? 1 : 0 );
+  WriteField( f, mode, "best_lap", "%.3f", r->m_fBestLap );
+  WriteField( f, mode, "best_lap_num", "%d", r->m_iBestLap );
+  WriteField( f, mode, "lap_time", "%.3f", r->m_fLapTime );
+  WriteField( f, mode, "damage", "%ld", r->m_iDamage );
+  WriteField( f, mode, "fuel", "%.2f", r->m_fFuel );
+  WriteField( f, mode, "pit_stops", "%d", r->m_iPitStops );
+  WriteField( f, mode, "pit_time", "%.2f", r->m_fPitTime );
+  WriteField( f, mode, "last_pit_visit", "%ld", r->m_iLastPitVisit );
+  WriteField( f, mode, "q_bestlap", "%.3f", r->m_fQualBestLap );
+  WriteField( f, mode, "q_avgspeed", "%.3f", r->m_fQualAvgSpeed );
+  WriteField( f, mode, "robot_time", "%.1f", r->m_fRobotTime );
+  WriteField( f, mode, "points", "%d", r->m_iPoints );
+  WriteField( f, mode, "total_points", "%d", r->m_iTotalPoints );
+
+  // Lists: [a,b] in JSON, "a;b" in CSV
+  const char * open = mode==STRUCT_JSON ? "[" : "\"";
+  const char * close = mode==STRUCT_JSON ? "]" : "\"";
+  char sep = mode==STRUCT_JSON ? ',' : ';';
+  WriteField( f, mode, "pit_laps", "%s", open );
+  if( mode!=STRUCT_CSV_HEADER )
+  {
+    for( i=0; i<r->m_iPitStops; i++ )
+    {
+      if( i>0 )
+      {
+        fputc( sep, f );
+      }
+      fprintf( f, "%d", r->m_aPitLap[i] );
+    }
+    fputs( close, f );
+  }
+  WriteField( f, mode, "lap_times", "%s", open );
+  if( mode!=STRUCT_CSV_HEADER )
+  {
+    for( i=0; i<r->m_iNumLapTime; i++ )
+    {
+      if( i>0 )
+      {
+        fputc( sep, f );
+      }
+      fprintf( f, "%.3f", r->m_aLapTime[i] );
+    }
+    fputs( close, f );
+  }
+
+  fputs( mode==STRUCT_JSON ? "}\n" : "\n", f );
+}
+
+/**
+ * Writes a field of a line of a structured result file: "name":value in
+ * JSON, the value in CSV, the name in the header of a CSV file
+ */
+void Report::WriteField(FILE * f, int mode, const char * name, const char * format, ... )
+{
+  if( m_iNumField++>0 )
+  {
+    fputc( ',', f );
+  }
+  if( mode==STRUCT_CSV_HEADER )
+  {
+    fputs( name, f );
+    return;
+  }
+  if( mode==STRUCT_JSON )
+  {
+    fprintf( f, "\"%s\":", name );
+  }
+  va_list argList;
+  va_start(argList, format);
+  vfprintf(f, format, argList);
+  va_end(argList);
+}
+
 /**
  * Show remaining RAM
  */
@@ -427,17 +767,14 @@ void Report::WriteRam()
 /**
  * Write the final standing when rars has been started for several tracks.
  * This function is written by Oscar Gustfasson.
+ *
+ * @param results    (in) the points of all the races
  */
-void Report::WriteFinal()
+void Report::WriteFinal(const RaceResults * results)
 {
   int i, tmp, changed = 1, m = args.m_iNumCar;
   int place[MAX_CARS];
-
-  // check if a race was run at all
-  if( !m_aPoints )
-  {
-    return;
-  }
+  const int * points = results->m_aTotalPoints;
 
   for(i=0; i < m; i++)
   {
@@ -449,7 +786,7 @@ void Report::WriteFinal()
     changed = 0;
     for(i=0;i < m-1;i++)
     {
-      if( m_aPoints[place[i]]<m_aPoints[place[i+1]] )
+      if( points[place[i]]<points[place[i+1]] )
       {
         tmp = place[i];
         place[i] = place[i+1];
@@ -465,7 +802,7 @@ void Report::WriteFinal()
   
   for( i=0; i<m; i++ )
   {
-    if( i==0 || m_aPoints[place[i]]!=m_aPoints[place[i-1]] )
+    if( i==0 || points[place[i]]!=points[place[i-1]] )
     {
       // won't try the 2nd statement if i == 0
       Write( "Final place %3d ", i+1 );
@@ -474,7 +811,7 @@ void Report::WriteFinal()
     {
       Write( "                " );
     }
-    Write( "%10s  %2d points", drivers[place[i]]->getName(),m_aPoints[place[i]]  );
+    Write( "%10s  %2d points", drivers[place[i]]->getName(),points[place[i]]  );
     WriteNewLine();
   } 
   WriteNewLine();
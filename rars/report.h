@@ -18,8 +18,18 @@
 
 #include <stdio.h>
 #include "car.h"
+#include "lap_timing.h"
+#include "race_results.h"
 #include <iostream>
 
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define STRUCT_JSON         0   // modes of Report::WriteCarFields
+#define STRUCT_CSV          1
+#define STRUCT_CSV_HEADER   2
+
 //--------------------------------------------------------------------------
 //                             T Y P E S
 //--------------------------------------------------------------------------
@@ -32,21 +42,28 @@ class Report
   private:
     char m_buffer[512]; 
   
-    int m_aPoints[MAX_CARS]; // Accumulated points, initialized:
     std::ofstream m_fout;         // Output : .out file
     FILE *   m_fhtml;        // Output : .html file
+    int      m_iNumField;    // Fields written in the line (WriteField)
 
     void WriteHtml( const char * format, ... );
     void Write( const char * format, ... );
     void WriteNewLine();
     void WriteHR( char c );
+    void WriteCarFields( FILE * f, int mode, const RaceResults * results, int pos );
+    void WriteField( FILE * f, int mode, const char * name, const char * format, ... );
   
   public:
     void WriteBegin();
-    void WriteResults(int, int*, Car**);
-    void WriteQualResults(int*, Car**);
+    void WriteResults(const RaceResults*);
+    void WriteResultStore(const RaceResults*);
+    void WriteStructured(const RaceResults*);
+    void WriteLapTimes(int*, Car**, const LapTiming*);
+    void WritePitPlans(const RaceResults*);
+    void WriteIntegrator(const RaceResults*);
+    void WriteQualResults(const RaceResults*);
     void WriteRam();
-    void WriteFinal();
+    void WriteFinal(const RaceResults*);
 };
 
 #endif
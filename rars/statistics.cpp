@@ -0,0 +1,204 @@
+/**
+ * STATISTICS.CPP - streaming statistics of a series of values
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       statistics.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <math.h>
+#include "statistics.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define TDIGEST_CENTROIDS  (2*TDIGEST_COMPRESSION+10)   // bound of the merged centroids
+#define TDIGEST_PI         3.14159265358979
+
+//--------------------------------------------------------------------------
+//                           F U N C T I O N S
+//--------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////
+// OnlineStat
+////////////////////////////////////////////////////////////////////////////
+
+void OnlineStat::Clear()
+{
+  m_iCount = 0;
+  m_fMean = 0.0;
+  m_fM2 = 0.0;
+  m_fMin = 0.0;
+  m_fMax = 0.0;
+}
+
+/**
+ * @return          variance of the sample (0 for less than 2 values)
+ */
+double OnlineStat::Variance() const
+{
+  return m_iCount>1 ? m_fM2/( m_iCount-1 ) : 0.0;
+}
+
+double OnlineStat::StdDev() const
+{
+  return sqrt( Variance() );
+}
+
+////////////////////////////////////////////////////////////////////////////
+// TDigest
+////////////////////////////////////////////////////////////////////////////
+
+static int CompareDouble( const void * a, const void * b )
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return x<y ? -1 : ( x>y ? 1 : 0 );
+}
+
+/**
+ * Scale function: the centroids are limited to a width of 1 in k
+ *
+ * @param q         (in) quantile (0 to 1)
+ */
+static inline double TDigestScale( double q )
+{
+  return TDIGEST_COMPRESSION/( 2.0*TDIGEST_PI )*asin( 2.0*q-1.0 );
+}
+
+/**
+ * Constructor
+ */
+TDigest::TDigest()
+{
+  m_aMean = new double[2*TDIGEST_CENTROIDS+TDIGEST_BUFFER];
+  m_aWeight = m_aMean+TDIGEST_CENTROIDS;
+  m_aBuffer = m_aWeight+TDIGEST_CENTROIDS;
+  m_iNumCentroid = 0;
+  m_iNumBuffer = 0;
+  m_fTotal = 0.0;
+  m_fMin = 0.0;
+  m_fMax = 0.0;
+}
+
+/**
+ * Destructor
+ */
+TDigest::~TDigest()
+{
+  delete [] m_aMean;
+}
+
+/**
+ * @param x         (in) new value of the series
+ */
+void TDigest::Add( double x )
+{
+  if( Count()==0 || x<m_fMin ) m_fMin = x;
+  if( Count()==0 || x>m_fMax ) m_fMax = x;
+  if( m_iNumBuffer==TDIGEST_BUFFER )
+  {
+    Merge();
+  }
+  m_aBuffer[m_iNumBuffer++] = x;
+}
+
+/**
+ * Merge the buffered values with the centroids: both are sorted and
+ * merged, then the neighbours are grouped while the group stays within a
+ * width of 1 of the scale function.
+ */
+void TDigest::Merge()
+{
+  double aMean[TDIGEST_CENTROIDS+TDIGEST_BUFFER];
+  double aWeight[TDIGEST_CENTROIDS+TDIGEST_BUFFER];
+  int i, j, n;
+
+  if( m_iNumBuffer==0 )
+  {
+    return;
+  }
+  qsort( m_aBuffer, m_iNumBuffer, sizeof(double), CompareDouble );
+  for( i=0, j=0, n=0; i<m_iNumCentroid || j<m_iNumBuffer; n++ )
+  {
+    if( j==m_iNumBuffer || ( i<m_iNumCentroid && m_aMean[i]<=m_aBuffer[j] ) )
+    {
+      aMean[n] = m_aMean[i];
+      aWeight[n] = m_aWeight[i++];
+    }
+    else
+    {
+      aMean[n] = m_aBuffer[j++];
+      aWeight[n] = 1.0;
+    }
+  }
+  double total = m_fTotal+m_iNumBuffer;
+  m_iNumBuffer = 0;
+
+  double done = 0.0;            // weight of the centroids before the current one
+  double k_left = TDigestScale( 0.0 );
+  double mean = aMean[0], weight = aWeight[0];
+  m_iNumCentroid = 0;
+  for( i=1; i<n; i++ )
+  {
+    if( TDigestScale( ( done+weight+aWeight[i] )/total )-k_left<=1.0 )
+    {
+      weight += aWeight[i];
+      mean += ( aMean[i]-mean )*aWeight[i]/weight;
+    }
+    else
+    {
+      m_aMean[m_iNumCentroid] = mean;
+      m_aWeight[m_iNumCentroid++] = weight;
+      done += weight;
+      k_left = TDigestScale( done/total );
+      mean = aMean[i];
+      weight = aWeight[i];
+    }
+  }
+  m_aMean[m_iNumCentroid] = mean;
+  m_aWeight[m_iNumCentroid++] = weight;
+  m_fTotal = total;
+}
+
+/**
+ * @param q         (in) quantile (0 to 1, eg. 0.5 for the median)
+ * @return          value of the quantile, interpolated between the
+ *                  centres of the centroids (0 if there are no values)
+ */
+double TDigest::Quantile( double q )
+{
+  Merge();
+  if( m_iNumCentroid==0 )
+  {
+    return 0.0;
+  }
+  if( q<=0.0 ) return m_fMin;
+  if( q>=1.0 ) return m_fMax;
+
+  double t = q*m_fTotal;
+  double cum = 0.0;
+  for( int i=0; i<m_iNumCentroid; i++ )
+  {
+    double centre = cum+m_aWeight[i]/2.0;
+    if( t<centre )
+    {
+      if( i==0 )
+      {
+        return m_fMin+( m_aMean[0]-m_fMin )*t/centre;
+      }
+      double prev = cum-m_aWeight[i-1]/2.0;
+      return m_aMean[i-1]+( m_aMean[i]-m_aMean[i-1] )*( t-prev )/( centre-prev );
+    }
+    cum += m_aWeight[i];
+  }
+  double last = m_fTotal-m_aWeight[m_iNumCentroid-1]/2.0;
+  return m_aMean[m_iNumCentroid-1]+( m_fMax-m_aMean[m_iNumCentroid-1] )*( t-last )/( m_fTotal-last );
+}
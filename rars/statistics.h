@@ -0,0 +1,98 @@
+/**
+ * statistics.h - streaming statistics of a series of values
+ *
+ * OnlineStat: count, mean, variance (Welford), min and max, in constant
+ * memory and without loss of precision when the values are many.
+ *
+ * TDigest: approximate quantiles (median, percentiles) of any number of
+ * values in a fixed memory (merging t-digest of T. Dunning). The values
+ * are buffered, then sorted and merged with the centroids. The centroids
+ * are small near the ends of the distribution (q near 0 or 1) and large
+ * in the middle, so that the extreme quantiles stay precise.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       statistics.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_STATISTICS_H
+#define __RARSCORE_STATISTICS_H
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define TDIGEST_COMPRESSION  100     // about 2*compression centroids at most
+#define TDIGEST_BUFFER       500     // values added between two merges
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Count, mean, variance, min and max of a series
+ */
+class OnlineStat
+{
+  private:
+    long   m_iCount;
+    double m_fMean;
+    double m_fM2;               // sum of the squared differences to the mean
+    double m_fMin;
+    double m_fMax;
+
+  public:
+    OnlineStat() { Clear(); }
+    void   Clear();
+
+    /**
+     * @param x         (in) new value of the series
+     */
+    inline void Add( double x )
+    {
+      m_iCount++;
+      double d = x-m_fMean;
+      m_fMean += d/m_iCount;
+      m_fM2 += d*( x-m_fMean );
+      if( m_iCount==1 || x<m_fMin ) m_fMin = x;
+      if( m_iCount==1 || x>m_fMax ) m_fMax = x;
+    }
+
+    inline long   Count() const { return m_iCount; }
+    inline double Mean() const { return m_fMean; }
+    inline double Min() const { return m_fMin; }
+    inline double Max() const { return m_fMax; }
+    double Variance() const;
+    double StdDev() const;
+};
+
+/**
+ * Quantiles of a series (merging t-digest)
+ */
+class TDigest
+{
+  private:
+    double * m_aMean;           // centroids, sorted by mean
+    double * m_aWeight;
+    int      m_iNumCentroid;
+    double * m_aBuffer;         // values not merged yet
+    int      m_iNumBuffer;
+    double   m_fTotal;          // weight of the centroids
+    double   m_fMin;
+    double   m_fMax;
+
+    void   Merge();
+
+  public:
+    TDigest();
+    ~TDigest();
+
+    void   Add( double x );
+    double Quantile( double q );
+    double Count() const { return m_fTotal+m_iNumBuffer; }
+    int    NumCentroid() { Merge(); return m_iNumCentroid; }
+};
+
+#endif
@@ -0,0 +1,652 @@
+/**
+ * TOURNAMENT.CPP - evaluation of robots on many tracks and seeds
+ *
+ * The races are run by child processes: "rars track n laps -nd -ni
+ * -nr<seed> -R<file> -P<physics> -d drivers". With -R, the child writes the results
+ * of its race in <file> (see Report::WriteResultStore). When the child
+ * is finished, the results are appended to the store with a RACE line
+ * in front of them:
+ *
+ *   RACE  track  seed  lineup  physics
+ *   CAR   pos  driver  start  laps  laps_lead  avg_speed  best_speed  damage  pits  time
+ *   ...
+ *   END
+ *
+ * A race without END line (interrupted while writing) is ignored.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       tournament.h
+ * @version   0.90
+ */
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <iostream.h>
+#include <fstream.h>
+#include "tournament.h"
+#include "misc.h"
+#include "track.h"              // chdir()
+#include "profiles.h"
+#ifndef WIN32
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <dirent.h>
+  #include <sys/types.h>
+  #include <sys/wait.h>
+#endif
+
+//--------------------------------------------------------------------------
+//                          F U N C T I O N S
+//--------------------------------------------------------------------------
+
+/**
+ * Constructor
+ */
+Tournament::Tournament()
+{
+  m_iNumDriver = 0;
+  m_iNumTrack = 0;
+  m_iFirstSeed = 1;
+  m_iLastSeed = 10;
+  m_iNumLap = 10;
+  m_iNumJob = 0;
+  m_iPhysics = 0;
+  m_iScoring = 0;
+  strcpy( m_sStore, "tournament.res" );
+  strcpy( m_sReport, "result_tournament.txt" );
+  m_sLineup[0] = 0;
+  m_iNumCell = 0;
+  m_aDone = NULL;
+  m_iNumDone = 0;
+  memset( m_aStat, 0, sizeof(m_aStat) );
+}
+
+/**
+ * Destructor
+ */
+Tournament::~Tournament()
+{
+  int i;
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    delete[] m_aDrivers[i];
+  }
+  for( i=0; i<m_iNumTrack; i++ )
+  {
+    delete[] m_aTracks[i];
+  }
+  delete[] m_aDone;
+}
+
+/**
+ * Run the tournament: read the description, skip the races already
+ * in the store, run the others and write the rankings.
+ *
+ * @param file      (in) tournament file
+ * @param exe       (in) name of the rars executable (argv[0])
+ */
+void Tournament::Run( const char * file, const char * exe )
+{
+  FILE * f;
+  int i;
+
+  ReadDescription( file );
+
+  m_iNumCell = m_iNumTrack * (int)(m_iLastSeed-m_iFirstSeed+1);
+  m_aDone = new bool[m_iNumCell];
+  for( i=0; i<m_iNumCell; i++ )
+  {
+    m_aDone[i] = false;
+  }
+
+  // Resume: read the races already done
+  if( (f=fopen(m_sStore, "r"))!=NULL )
+  {
+    ParseRaces( f, -1 );
+    fclose( f );
+  }
+  cout << "Tournament: " << m_iNumDriver << " drivers, " << m_iNumTrack << " tracks, seeds "
+       << m_iFirstSeed << " to " << m_iLastSeed << ", " << m_iNumDone << "/" << m_iNumCell
+       << " races already in " << m_sStore << endl;
+
+  RunCells( exe );
+  WriteRanking();
+}
+
+/**
+ * Read the tournament file (see tournament.h for the format)
+ *
+ * @param file      (in) tournament file
+ */
+void Tournament::ReadDescription( const char * file )
+{
+  ifstream fin( file );
+  char word[128];
+  int i;
+
+  if( !fin )
+  {
+    exitOnError( "Tournament file %s is missing", file );
+  }
+  while( fin >> word )
+  {
+    if( !strcmp(word, "drivers") )
+    {
+      while( fin >> word && strcmp(word, "END") )
+      {
+        if( find_name(word)<0 )
+        {
+          exitOnError( "Tournament: driver %s was not found.", word );
+        }
+        if( m_iNumDriver<MAX_CARS )
+        {
+          m_aDrivers[m_iNumDriver] = new char[strlen(word)+1];
+          strcpy( m_aDrivers[m_iNumDriver++], word );
+        }
+      }
+    }
+    else if( !strcmp(word, "tracks") )
+    {
+      while( fin >> word && strcmp(word, "END") )
+      {
+        if( !strcmp(word, "ALL") )
+        {
+          ReadAllTracks();
+        }
+        else if( m_iNumTrack<MAX_TOURNAMENT_TRACKS )
+        {
+          m_aTracks[m_iNumTrack] = new char[strlen(word)+1];
+          strcpy( m_aTracks[m_iNumTrack++], word );
+        }
+      }
+    }
+    else if( !strcmp(word, "seeds") )
+    {
+      fin >> m_iFirstSeed >> m_iLastSeed;
+    }
+    else if( !strcmp(word, "laps") )
+    {
+      fin >> m_iNumLap;
+    }
+    else if( !strcmp(word, "jobs") )
+    {
+      fin >> m_iNumJob;
+    }
+    else if( !strcmp(word, "points") )
+    {
+      fin >> word;
+      if( (m_iScoring = FindScoringProfile(word))<0 )
+      {
+        exitOnError( "Tournament: unknown points system %s", word );
+      }
+    }
+    else if( !strcmp(word, "physics") )
+    {
+      fin >> word;
+      if( (m_iPhysics = FindPhysicsProfile(word))<0 )
+      {
+        exitOnError( "Tournament: unknown physics profile %s", word );
+      }
+    }
+    else if( !strcmp(word, "store") )
+    {
+      fin >> m_sStore;
+    }
+    else if( !strcmp(word, "report") )
+    {
+      fin >> m_sReport;
+    }
+    else
+    {
+      exitOnError( "Tournament: unknown keyword %s in %s", word, file );
+    }
+  }
+
+  if( m_iNumDriver<1 || m_iNumTrack<1 || m_iLastSeed<m_iFirstSeed || m_iNumLap<1 )
+  {
+    exitOnError( "Tournament: %s needs drivers, tracks, seeds and laps", file );
+  }
+  if( m_iNumJob<=0 )
+  {
+#ifndef WIN32
+    m_iNumJob = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if( m_iNumJob<=0 )
+    {
+      m_iNumJob = 1;
+    }
+  }
+  if( m_iNumJob>MAX_TOURNAMENT_JOBS )
+  {
+    m_iNumJob = MAX_TOURNAMENT_JOBS;
+  }
+
+  m_sLineup[0] = 0;
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    if( i>0 )
+    {
+      strcat( m_sLineup, "," );
+    }
+    strcat( m_sLineup, m_aDrivers[i] );
+  }
+}
+
+/**
+ * Add all the .trk files of the tracks directory, in alphabetical order.
+ * random.trk is skipped: it is a new track at each race.
+ */
+void Tournament::ReadAllTracks()
+{
+#ifndef WIN32
+  DIR * dir;
+  struct dirent * entry;
+  int first = m_iNumTrack, i, l;
+
+  chdir( "tracks" );
+  dir = opendir( "." );
+  chdir( ".." );
+  if( dir==NULL )
+  {
+    exitOnError( "Tournament: can not read the tracks directory" );
+  }
+  while( (entry=readdir(dir))!=NULL && m_iNumTrack<MAX_TOURNAMENT_TRACKS )
+  {
+    l = strlen( entry->d_name );
+    if( l<5 || strcmp(entry->d_name+l-4, ".trk") || !strcmp(entry->d_name, "random.trk") )
+    {
+      continue;
+    }
+    // insertion sort
+    for( i=m_iNumTrack; i>first && strcmp(m_aTracks[i-1], entry->d_name)>0; i-- )
+    {
+      m_aTracks[i] = m_aTracks[i-1];
+    }
+    m_aTracks[i] = new char[l+1];
+    strcpy( m_aTracks[i], entry->d_name );
+    m_iNumTrack++;
+  }
+  closedir( dir );
+#else
+  exitOnError( "Tournament: tracks ALL is not available on this platform" );
+#endif
+}
+
+/**
+ * Return the cell of a race, -1 if it is not part of this tournament.
+ *
+ * @param track     (in) track name
+ * @param seed      (in) seed of the race
+ */
+int Tournament::FindCell( const char * track, long seed )
+{
+  int i;
+  if( seed<m_iFirstSeed || seed>m_iLastSeed )
+  {
+    return -1;
+  }
+  for( i=0; i<m_iNumTrack; i++ )
+  {
+    if( !strcmp(track, m_aTracks[i]) )
+    {
+      return i*(int)(m_iLastSeed-m_iFirstSeed+1) + (int)(seed-m_iFirstSeed);
+    }
+  }
+  return -1;
+}
+
+/**
+ * Return the track and the seed of a cell
+ *
+ * @param cell      (in) the cell
+ * @param track     (out) track name
+ * @param seed      (out) seed of the race
+ */
+void Tournament::CellInfo( int cell, char ** track, long * seed )
+{
+  int nb_seed = (int)(m_iLastSeed-m_iFirstSeed+1);
+  *track = m_aTracks[cell/nb_seed];
+  *seed = m_iFirstSeed + cell%nb_seed;
+}
+
+/**
+ * Name of the file where the child writes the results of a cell
+ *
+ * @param cell      (in) the cell
+ * @param name      (out) file name
+ */
+void Tournament::TempName( int cell, char * name )
+{
+  sprintf( name, "%s.%d.tmp", m_sStore, cell );
+}
+
+/**
+ * Read races and add the complete ones to the statistics.
+ *
+ * @param f         (in) store file, or result file of a child
+ * @param cell      (in) -1 for the store, else the cell of the child
+ *                  (the child file has no RACE line)
+ * @return          the number of races added
+ */
+int Tournament::ParseRaces( FILE * f, int cell )
+{
+  char line[MAX_TOURNAMENT_LINE], name[128], track[128], lineup[MAX_TOURNAMENT_LINE];
+  TournamentRace race;
+  long seed, laps_lead;
+  int added = 0;
+
+  race.m_iNumCar = 0;
+  while( fgets(line, sizeof(line), f)!=NULL )
+  {
+    if( strchr(line, '\n')==NULL && !feof(f) )
+    {
+      // line too long: skip it and the race it belongs to
+      int c;
+      warning( "Tournament: line too long in the results, race ignored" );
+      while( (c=fgetc(f))!=EOF && c!='\n' );
+      cell = -1;
+      race.m_iNumCar = 0;
+      continue;
+    }
+    if( !strncmp(line, "RACE", 4) )
+    {
+      cell = -1;
+      race.m_iNumCar = 0;
+      if( sscanf(line+4, "%127s %ld %s %127s", track, &seed, lineup, name)==4
+       && !strcmp(lineup, m_sLineup) && !strcmp(name, g_aPhysicsProfiles[m_iPhysics].m_sName) )
+      {
+        cell = FindCell( track, seed );
+      }
+    }
+    else if( !strncmp(line, "CAR", 3) )
+    {
+      if( race.m_iNumCar<MAX_CARS
+       && sscanf(line+3, "%*d %127s %*d %*d %ld", name, &laps_lead)==2 )
+      {
+        strncpy( race.m_aName[race.m_iNumCar], name, 31 );
+        race.m_aName[race.m_iNumCar][31] = 0;
+        race.m_aLapsLead[race.m_iNumCar++] = laps_lead;
+      }
+    }
+    else if( !strncmp(line, "END", 3) )
+    {
+      if( cell>=0 && !m_aDone[cell] )
+      {
+        m_aDone[cell] = true;
+        m_iNumDone++;
+        AddRace( &race );
+        added++;
+      }
+      cell = -1;
+      race.m_iNumCar = 0;
+    }
+  }
+  return added;
+}
+
+/**
+ * Add the points of a race to the statistics of the drivers
+ *
+ * @param race      (in) the race
+ */
+void Tournament::AddRace( TournamentRace * race )
+{
+  const ScoringProfile * s = &g_aScoringProfiles[m_iScoring];
+  long most_lead = 0;
+  int i, k, points;
+
+  for( i=0; i<race->m_iNumCar; i++ )
+  {
+    if( race->m_aLapsLead[i]>most_lead )
+    {
+      most_lead = race->m_aLapsLead[i];
+    }
+  }
+  for( i=0; i<race->m_iNumCar; i++ )
+  {
+    for( k=0; k<m_iNumDriver; k++ )
+    {
+      if( !strcmp(race->m_aName[i], m_aDrivers[k]) )
+      {
+        break;
+      }
+    }
+    if( k==m_iNumDriver )
+    {
+      continue;
+    }
+    points = s->m_pPoints( i, false, race->m_aLapsLead[i], most_lead );
+    m_aStat[k].m_iNumRace++;
+    m_aStat[k].m_iNumWin += (i==0);
+    m_aStat[k].m_fSumPos += i+1;
+    m_aStat[k].m_fSumPoints += points;
+    m_aStat[k].m_fSumPoints2 += (double)points*points;
+  }
+}
+
+/**
+ * Run the races that are not in the store yet, m_iNumJob at a time.
+ *
+ * @param exe       (in) name of the rars executable
+ */
+void Tournament::RunCells( const char * exe )
+{
+  char sCar[16], sLap[16], sSeed[32], sResult[160], sPhysics[32];
+  const char * argv[MAX_CARS+16];
+  char * track;
+  long seed;
+  int cell, i, n;
+
+#ifndef WIN32
+  pid_t aPid[MAX_TOURNAMENT_JOBS];
+  int   aCell[MAX_TOURNAMENT_JOBS];
+  int   running = 0;
+  pid_t pid;
+#endif
+
+  sprintf( sCar, "%d", m_iNumDriver );
+  sprintf( sLap, "%ld", m_iNumLap );
+  sprintf( sPhysics, "-P%s", g_aPhysicsProfiles[m_iPhysics].m_sName );
+
+  cell = 0;
+  for(;;)
+  {
+#ifndef WIN32
+    // Start new races while there are free jobs
+    while( cell<m_iNumCell && running<m_iNumJob )
+    {
+      if( m_aDone[cell] )
+      {
+        cell++;
+        continue;
+      }
+#else
+    for( ; cell<m_iNumCell; cell++ )
+    {
+      if( m_aDone[cell] )
+      {
+        continue;
+      }
+#endif
+      CellInfo( cell, &track, &seed );
+      sprintf( sSeed, "-nr%ld", seed );
+      TempName( cell, sResult+2 );
+      sResult[0] = '-';
+      sResult[1] = 'R';
+      remove( sResult+2 );
+
+      n = 0;
+      argv[n++] = exe;
+      argv[n++] = track;
+      argv[n++] = sCar;
+      argv[n++] = sLap;
+      argv[n++] = "-nd";
+      argv[n++] = "-ni";
+      argv[n++] = sSeed;
+      argv[n++] = sResult;
+      argv[n++] = sPhysics;
+      argv[n++] = "-d";
+      for( i=0; i<m_iNumDriver; i++ )
+      {
+        argv[n++] = m_aDrivers[i];
+      }
+      argv[n] = NULL;
+
+#ifndef WIN32
+      pid = fork();
+      if( pid==0 )
+      {
+        // Child: the results go to the -R file only
+        int null = open( "/dev/null", O_WRONLY );
+        dup2( null, 1 );
+        dup2( null, 2 );
+        execvp( exe, (char * const *)argv );
+        _exit( 127 );
+      }
+      else if( pid<0 )
+      {
+        exitOnError( "Tournament: fork failed" );
+      }
+      aPid[running] = pid;
+      aCell[running] = cell;
+      running++;
+      cell++;
+    }
+
+    if( running==0 )
+    {
+      break;
+    }
+
+    // Wait for one race to finish
+    pid = wait( NULL );
+    for( i=0; i<running; i++ )
+    {
+      if( aPid[i]==pid )
+      {
+        FinishCell( aCell[i] );
+        running--;
+        aPid[i] = aPid[running];
+        aCell[i] = aCell[running];
+        break;
+      }
+    }
+#else
+      {
+        char command[1024];
+        command[0] = 0;
+        for( i=0; i<n; i++ )
+        {
+          strcat( command, argv[i] );
+          strcat( command, " " );
+        }
+        system( command );
+      }
+      FinishCell( cell );
+    }
+    break;
+#endif
+  }
+}
+
+/**
+ * A child is finished: move its results to the store.
+ *
+ * @param cell      (in) cell of the child
+ */
+void Tournament::FinishCell( int cell )
+{
+  char name[160], line[512];
+  char * track;
+  long seed;
+  FILE * f, * store;
+
+  CellInfo( cell, &track, &seed );
+  TempName( cell, name );
+  if( (f=fopen(name, "r"))==NULL || ParseRaces(f, cell)==0 )
+  {
+    warning( "Tournament: race on %s with seed %ld did not finish", track, seed );
+    if( f!=NULL )
+    {
+      fclose( f );
+    }
+    return;
+  }
+
+  // The store is only written by this process
+  if( (store=fopen(m_sStore, "a"))==NULL )
+  {
+    exitOnError( "Tournament: unable to write %s", m_sStore );
+  }
+  fprintf( store, "RACE\t%s\t%ld\t%s\t%s\n", track, seed, m_sLineup, g_aPhysicsProfiles[m_iPhysics].m_sName );
+  rewind( f );
+  while( fgets(line, sizeof(line), f)!=NULL )
+  {
+    fputs( line, store );
+  }
+  fclose( store );
+  fclose( f );
+  remove( name );
+
+  cout << m_iNumDone << "/" << m_iNumCell << "  " << track << "  seed " << seed << endl;
+}
+
+/**
+ * Write the rankings to the screen and to the report file:
+ * average points with a 95% confidence interval (normal approximation),
+ * average position and number of wins.
+ */
+void Tournament::WriteRanking()
+{
+  int order[MAX_CARS];
+  double mean[MAX_CARS], ci[MAX_CARS];
+  char line[256];
+  FILE * f;
+  int i, j, k, n;
+
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    n = m_aStat[i].m_iNumRace;
+    mean[i] = n ? m_aStat[i].m_fSumPoints/n : 0.0;
+    ci[i] = 0.0;
+    if( n>1 )
+    {
+      double var = (m_aStat[i].m_fSumPoints2 - n*mean[i]*mean[i])/(n-1);
+      ci[i] = 1.96*sqrt(var>0.0?var:0.0)/sqrt((double)n);
+    }
+    // insertion sort on the average points
+    for( j=i; j>0 && mean[order[j-1]]<mean[i]; j-- )
+    {
+      order[j] = order[j-1];
+    }
+    order[j] = i;
+  }
+
+  f = fopen( m_sReport, "w" );
+  // the lineup is too long for line
+  cout << endl << "Tournament " << m_sLineup << ": " << m_iNumDone << "/" << m_iNumCell
+       << " races, " << g_aScoringProfiles[m_iScoring].m_sName << " points" << endl;
+  if( f ) fprintf( f, "Tournament %s: %d/%d races, %s points\n",
+                   m_sLineup, m_iNumDone, m_iNumCell, g_aScoringProfiles[m_iScoring].m_sName );
+  sprintf( line, "%4s  %-12s %5s %5s %7s %8s %8s", "Rank", "Driver", "Races", "Wins", "AvgPos", "Points", "+/-95%" );
+  cout << line << endl;
+  if( f ) fprintf( f, "%s\n", line );
+  for( i=0; i<m_iNumDriver; i++ )
+  {
+    k = order[i];
+    n = m_aStat[k].m_iNumRace;
+    sprintf( line, "%4d  %-12s %5d %5d %7.2f %8.2f %8.2f", i+1, m_aDrivers[k], n,
+             m_aStat[k].m_iNumWin, n ? m_aStat[k].m_fSumPos/n : 0.0, mean[k], ci[k] );
+    cout << line << endl;
+    if( f ) fprintf( f, "%s\n", line );
+  }
+  if( f ) fclose( f );
+}
@@ -0,0 +1,114 @@
+/**
+ * tournament.h - evaluation of robots on many tracks and seeds
+ *
+ * A tournament runs the same lineup of drivers on a set of tracks, once
+ * for each seed of a range. Every (track, seed) race is run by a child
+ * RARS process without display, several at a time. The results of the
+ * finished races are appended to a store file, so an interrupted
+ * tournament continues where it stopped.
+ *
+ * History
+ *  ver. 0.90 created
+ *
+ * @see       tournament.cpp for method definitions
+ * @version   0.90
+ */
+
+#ifndef __RARSCORE_TOURNAMENT_H
+#define __RARSCORE_TOURNAMENT_H
+
+//--------------------------------------------------------------------------
+//                           I N C L U D E
+//--------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "globals.h"
+
+//--------------------------------------------------------------------------
+//                            D E F I N E
+//--------------------------------------------------------------------------
+
+#define MAX_TOURNAMENT_TRACKS 256  // tracks of one tournament
+#define MAX_TOURNAMENT_JOBS    64  // races run at the same time
+#define MAX_TOURNAMENT_LINE  (MAX_CARS*32+512) // line of the store (RACE line with the lineup)
+
+//--------------------------------------------------------------------------
+//                             T Y P E S
+//--------------------------------------------------------------------------
+
+/**
+ * Result of one race, in finishing order
+ */
+struct TournamentRace
+{
+  int  m_iNumCar;
+  char m_aName[MAX_CARS][32];      // driver names
+  long m_aLapsLead[MAX_CARS];      // laps lead by each driver
+};
+
+/**
+ * Accumulated results of one driver
+ */
+struct TournamentStat
+{
+  int    m_iNumRace;
+  int    m_iNumWin;
+  double m_fSumPos;       // sum of the finishing positions (1=winner)
+  double m_fSumPoints;    // sum of the points
+  double m_fSumPoints2;   // sum of the squared points
+};
+
+/**
+ * Tournament (used by RaceManager with option -T)
+ *
+ * The tournament file is made of keywords followed by values:
+ *   drivers Tuto4 Tuto4000 END    lineup
+ *   tracks  oval2 spa END         tracks (ALL = every .trk of tracks/)
+ *   seeds   1 20                  first and last seed
+ *   laps    10                    laps of each race
+ *   jobs    0                     races at the same time (0 = one per CPU)
+ *   points  INDYCAR               INDYCAR, F1, NASCAR or BTCC (see profiles.h)
+ *   physics INDYCAR               INDYCAR or F1
+ *   store   tournament.res        results of the finished races
+ *   report  result_tournament.txt rankings
+ */
+class Tournament
+{
+  private:
+    char * m_aDrivers[MAX_CARS];
+    int    m_iNumDriver;
+    char * m_aTracks[MAX_TOURNAMENT_TRACKS];
+    int    m_iNumTrack;
+    long   m_iFirstSeed;
+    long   m_iLastSeed;
+    long   m_iNumLap;
+    int    m_iNumJob;
+    int    m_iPhysics;            // index in g_aPhysicsProfiles
+    int    m_iScoring;            // index in g_aScoringProfiles
+    char   m_sStore[128];
+    char   m_sReport[128];
+    char   m_sLineup[MAX_CARS*32]; // driver names separated by ','
+
+    int    m_iNumCell;            // number of (track, seed) races
+    bool * m_aDone;               // m_aDone[cell] is true when the race is in the store
+    int    m_iNumDone;
+    TournamentStat m_aStat[MAX_CARS];
+
+    void   ReadDescription( const char * file );
+    void   ReadAllTracks();
+    int    FindCell( const char * track, long seed );
+    void   CellInfo( int cell, char ** track, long * seed );
+    void   TempName( int cell, char * name );
+    int    ParseRaces( FILE * f, int cell );
+    void   AddRace( TournamentRace * race );
+    void   RunCells( const char * exe );
+    void   FinishCell( int cell );
+    void   WriteRanking();
+
+  public:
+    Tournament();
+    ~Tournament();
+    void   Run( const char * file, const char * exe );
+};
+
+#endif
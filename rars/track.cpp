@@ -100,6 +100,10 @@ ReflectionProperty g_aTrackHeaderProp[] =
   { "start_x",            &(g_track.m_fRgtStartX),          &g_track,    T_DISTANCE, "Position X of the right side of the first segment" },
   { "start_y",            &(g_track.m_fRgtStartY),          &g_track,    T_DISTANCE, "Position Y of the right side of the first segment" },
   { "start_ang",          &(g_track.m_fStartAng),           &g_track,    T_ANGLE,    "Angle of the first segment" },
+  { "surface",            &(g_track.m_iSurface),            &g_track,    T_INT,      "Surface type (0 loose, 1 hard, 2 skidding, 3 wet) (-1 = option -s)" },
+  { "grip_rows",          &(g_track.m_iGripRows),           &g_track,    T_INT,      "Grip map: number of cells along a segment" },
+  { "grip_lanes",         &(g_track.m_iGripLanes),          &g_track,    T_INT,      "Grip map: number of cells across the track" },
+  { "sectors",            &(g_track.m_iNumSector),          &g_track,    T_INT,      "Number of timing sectors of the lap" },
   { NULL }
 };
 
@@ -140,6 +144,8 @@ ReflectionProperty g_aSegProp[] =
   { "type",               &(g_seg3D.m_sType),               &g_seg3D,    T_STRING     , "Type of the segment (default, y, yinv)" },
   { "section",            &(g_seg3D.m_sSection),            &g_seg3D,    T_STRING     , "Name of the section for segment with a type equal to y or yinv" },
   { "model",              &(g_seg3D.m_sModel),              &g_seg3D,    T_STRING     , "3DS Model for special segments where we do not want to use the 3D model\ngenerated automatically by Rars (3DS filename without .3ds extension)" },
+  { "surface",            &(g_seg3D.m_iSurface),            &g_seg3D,    T_INT        , "Surface type of the segment (-1 = surface of the track)" },
+  { "grip",               &(g_seg3D.m_sGrip),               &g_seg3D,    T_STRING     , "Grip factors of the cells: rows from the start of the segment,\neach from right to left (one value = whole segment)", sizeof(g_seg3D.m_sGrip) },
   { NULL }
 };
 
@@ -193,6 +199,10 @@ void Track::Init()
   m_fUnitDistanceScale = 1;
   m_fFinish = 0;
   m_iStartRows = 2;
+  m_iSurface = -1;
+  m_iGripRows = 1;
+  m_iGripLanes = 1;
+  m_iNumSector = 3;
   m_fRgtStartX = m_fRgtStartY = m_fStartAng = 0;
 
   m_iPitSide = 0;
@@ -252,7 +262,7 @@ Track::Track(char* file)
 
     if(!inf)                // If can't open file, & if filename had no extension,
     {        
-      for(i=0; i<8; i++)  // append .trk and see if that works
+      for(i=0; i<(int)sizeof(m_sFileName)-5; i++)  // append .trk and see if that works
       {
         if(m_sFileName[i] == '\0')
         {
@@ -1077,6 +1087,24 @@ void Track::RemoveSegment( int pos )
   }
 }
 
+/**
+ * Surface type of the track: given by the track file, else by option -s
+ */
+int Track::Surface()
+{
+  return m_iSurface>=0 ? m_iSurface : args.m_iSurface;
+}
+
+/**
+ * Surface type of a segment: given by the segment, else the surface of the track
+ *
+ * @param seg           (in) segment id
+ */
+int Track::SegmentSurface( int seg )
+{
+  return m_aSeg[seg].m_iSurface>=0 ? m_aSeg[seg].m_iSurface : Surface();
+}
+
 /**
  * Find a section id of a segment if not found
  */
@@ -1107,18 +1135,9 @@ void Track::readTrackFastestLap()
   int i; int found=0;
 
   // Try to read record from  the track record file:
-  if( args.m_iSurface==0 )
-  {
-    fin.open("records0.dat");  // Open the track record file
-  }  
-  else if( args.m_iSurface==1 )
-  {
-    fin.open("records1.dat");  // Open the track record file
-  }
-  else if( args.m_iSurface==2 )
-  {
-    fin.open("records2.dat");  // Open the track record file
-  }
+  char file[32];
+  sprintf( file, "records%d.dat", Surface() );
+  fin.open( file );            // Open the track record file
    
   if (fin) 
   {
@@ -1174,7 +1193,7 @@ void Track::writeTrackFastestLap(fastest_lap rfl)
 
   // Here is new track record confirmed:
   if( rfl.speed > m_oRecord.speed &&
-      strcmp(m_sFileName, "random.trk") ) 
+      strncmp(m_sFileName, "random", 6) ) 
   {
     m_oRecord.speed = rfl.speed * 3600.0/5280.0;
     // convert to MPH
@@ -1212,18 +1231,9 @@ void Track::writeTrackFastestLap(fastest_lap rfl)
 
     // Now print it all out again:
     //      fout.open("records.dat");
-    if( args.m_iSurface==0 )
-    {
-      fout.open("records0.dat");  // Open the track record file
-    }
-    else if( args.m_iSurface==1 )
-    {
-      fout.open("records1.dat");  // Open the track record file
-    }
-    else if( args.m_iSurface==2 )
-    {
-      fout.open("records2.dat");  // Open the track record file
-    }
+    char file[32];
+    sprintf( file, "records%d.dat", Surface() );
+    fout.open( file );         // Open the track record file
 
     fout << number_of_records << endl;
     for(i=0;i<number_of_records;i++)
@@ -1383,6 +1393,8 @@ Segment3D::Segment3D()
   strcpy( m_sType, "default" );
   strcpy( m_sSection, "" );
   strcpy( m_sModel, "" );
+  m_iSurface = -1;
+  strcpy( m_sGrip, "" );
 }
 
 /**
@@ -1561,7 +1573,16 @@ void ReflectionProperty::SetString( void * struct_base, const char * val )
     case T_STRING:
     {
       char * p = (char *)struct_data;
-      strcpy( p, val );
+      if( iSize>0 && (int)strlen(val)>=iSize )
+      {
+        warning( "Track: %s is too long, cut to %d characters", sXmlTag, iSize-1 );
+        strncpy( p, val, iSize-1 );
+        p[iSize-1] = 0;
+      }
+      else
+      {
+        strcpy( p, val );
+      }
       break;
     }
   }
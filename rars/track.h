@@ -33,6 +33,7 @@
 //--------------------------------------------------------------------------
 
 #define MAX_SEGMENT 100
+#define MAX_GRIP_CELLS 32      // grip_rows*grip_lanes (see gripmap.h)
 #define MAX_SECTION 10
 #define MAX_OBJECT3D 100
 
@@ -174,6 +175,8 @@ class Segment3D
     char m_sType[32];                  // Type of the segment
     char m_sSection[32];               // Section name for y a yinv type of segment
     char m_sModel[32];                 // 3DS Model for special segments where we do not want to use the 3D model generated automatically by Rars
+    int m_iSurface;                    // Surface type of the segment (-1 = surface of the track)
+    char m_sGrip[256];                 // Grip factors of the cells of the segment (see gripmap.h)
 
     // Calculated data
     int m_iPrvSeg;                     // This id allows to build the track easily. It is used mostly by the sections.
@@ -255,6 +258,7 @@ class ReflectionProperty
     void * base;               // Pointer to the reference structure containing the data 
     int    iType;              // Type of the data
     const char * sDescription; // Description of the data
+    int    iSize;              // Size of the buffer of a T_STRING (0 = not checked)
 
     void * GetDataPointer( void * struct_base );
     char * GetString( void * struct_base );
@@ -356,6 +360,10 @@ public:
   double m_fRgtStartY;         //    
   double m_fStartAng;          // Angle of first segment (radians)   
   int    m_iStartRows;         // How many rows of starting cars
+  int    m_iSurface;           // Surface type of the track (-1 = option -s)
+  int    m_iGripRows;          // Grip map: cells along a segment
+  int    m_iGripLanes;         // Grip map: cells across the track
+  int    m_iNumSector;         // Number of timing sectors (see LapTiming)
 
   // XWindow data
   double m_fXMax;              // Max coordinate in XWindow (feet) + see CalcMinMax
@@ -397,6 +405,8 @@ public:
   int SaveXml();                                // Save the track in Xml format
   void Rebuild();                               // Rebuild the lftwall from rgtwall
   void track_setup(double xstart, double ystart, double alfstart, segment *seg);
+  int Surface();                                // Surface type of the track
+  int SegmentSurface( int seg );                // Surface type of a segment
   void AddSegment( int pos, char * section );   // Add a segment to the rgtwall
   void RemoveSegment( int pos );                // Remove a segment to the rgtwall
   int GetSectionId( int iSeg );                 // Get the id of the section containing a segment 
@@ -406,6 +416,7 @@ public:
   void writeTrackFastestLap(fastest_lap);       // Write track record to file
 
   static void generateRandomTrack();            // Generate a random track and write it to file "random.trk"
+  static void generateRandomTracks( int count, long seed ); // Generate random000.trk, random001.trk, ...
   static void readTrackNamesFromFile();         // Read track files from season file
 
 
@@ -29,6 +29,10 @@
 #include "track.h"
 #include <iostream.h>
 #include <fstream.h>
+#ifndef WIN32
+  #include <unistd.h>             // sysconf()
+  #include <pthread.h>
+#endif
 
 //--------------------------------------------------------------------------
 //                            D E F I N E
@@ -42,6 +46,8 @@
 #define REPLACEMENT_TYPES 4
 #define LMIN 50.0               // minimum length of a straight
 #define MIN_RAD_QUOT 1.3        // min. quotient of radii of consecutive curves
+#define DOTS_PER_WIDTH 8        // overlap test: dots per track width along the track
+#define MAX_THREADS 16          // upper limit of candidate search threads
 
 //--------------------------------------------------------------------------
 //                              T Y P E
@@ -53,6 +59,71 @@ struct segm
   double length;   // length of curves in radians, of straights in feet
 };
 
+/**
+ * Random generator private to one track candidate.
+ *
+ * Same linear congruential generator as r_rand() in misc.cpp, but with
+ * its own seed, so that candidates can be generated in any order (or in
+ * several threads) and still give the same tracks for the same seed.
+ */
+class TrackRand
+{
+  public:
+    TrackRand( unsigned long seed ) { m_lSeed = seed; }
+    int Next()
+    {
+      m_lSeed = 0x015a4e35UL*m_lSeed + 1;
+      return (int)((m_lSeed>>16) & 0x7FFF);
+    }
+
+  private:
+    unsigned long m_lSeed;
+};
+
+/**
+ * Dots sampled on the middle of a candidate track, with a uniform grid
+ * spatial hash over them (cell size = track width).
+ *
+ * One OverlapGrid is kept by each search thread and reused for all the
+ * candidates it checks: the arrays only grow, so there is no allocation
+ * per candidate.
+ */
+struct OverlapGrid
+{
+  int      m_iSize;      // allocated number of dots
+  int      m_iNbDot;     // number of dots of the current candidate
+  double * m_aX;         // coordinates of the dots
+  double * m_aY;
+  int    * m_aSeg;       // segment of each dot
+  int    * m_aNext;      // next dot in the same bucket, -1 at the end
+  int    * m_aHead;      // first dot of each bucket, -1 if empty
+  int      m_iNbBucket;  // power of 2, at least twice m_iSize
+
+  OverlapGrid();
+  ~OverlapGrid();
+  void Reserve( int size );
+};
+
+/**
+ * State shared by the threads searching an acceptable candidate for one
+ * track. Candidates are numbered; a thread takes the next number under
+ * the mutex, generates and checks that candidate. The lowest accepted
+ * number wins, so the result does not depend on the number of threads.
+ */
+struct CandidateSearch
+{
+  unsigned long m_lSeed;  // seed of the track, candidate k uses mix_seed(m_lSeed,k)
+  int    m_iMaxSeg;
+  double m_dWidth;
+  double m_dLength;
+  double m_dMinRad;
+  int    m_iNext;         // next candidate to check
+  int    m_iFound;        // lowest accepted candidate, -1 if none yet
+#ifndef WIN32
+  pthread_mutex_t m_oMutex;
+#endif
+};
+
 //--------------------------------------------------------------------------
 //                          F U N C T I O N S
 //--------------------------------------------------------------------------
@@ -112,38 +183,39 @@ static void out_of_memory( void *p )
  * @param track    (??) an array of segm(s)
  * @param maxseg   (??) the maximum number of segments
  * @param RMIN     (??) 
+ * @param rnd      (in) random generator of this candidate
  */
-static void generate_track(int *NSEG, double width, double length, struct segm *track, int maxseg, double RMIN)
+static void generate_track(int *NSEG, double width, double length, struct segm *track, int maxseg, double RMIN, TrackRand &rnd)
 {
   int i=0,j,k;
   double h,l;
   
-  switch (r_rand() % BASIC_TRACKS) // select a basic track
+  switch (rnd.Next() % BASIC_TRACKS) // select a basic track
   {
   case 0: // choose a polygon shaped track as basic track
     do
     {
       do
       { 
-        *NSEG=2*(2+r_rand()%3); // the polygon has 2..4 edges (2=oval)
+        *NSEG=2*(2+rnd.Next()%3); // the polygon has 2..4 edges (2=oval)
       }
       while(*NSEG>maxseg);
 
       track[0].radius=0.0; // even segments are straights; odd curves
-      track[0].length=300.0+3*RMIN+r_rand()%(4000/ *NSEG);
-      track[1].radius=floor(RMIN+width+r_rand()%(2800/ *NSEG));
+      track[0].length=300.0+3*RMIN+rnd.Next()%(4000/ *NSEG);
+      track[1].radius=floor(RMIN+width+rnd.Next()%(2800/ *NSEG));
       // track[1].length=PI*4/ *NSEG;
       // for(i=2; i<*NSEG; i++)
       // {
       //   track[i].radius=track[i-2].radius;
       //   track[i].length=track[i-2].length;
       // }
-      track[1].length=PI/180*(30+r_rand()%120);
+      track[1].length=PI/180*(30+rnd.Next()%120);
       switch( *NSEG )
       {
         case 4: // oval
-          track[1].radius=floor(RMIN+r_rand()%(400/ *NSEG));
-          track[1].length=PI/180*(150+r_rand()%30);
+          track[1].radius=floor(RMIN+rnd.Next()%(400/ *NSEG));
+          track[1].length=PI/180*(150+rnd.Next()%30);
           track[2].radius=0.0;
           track[2].length=track[0].length;
           track[3].radius=( track[0].length
@@ -157,7 +229,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
           track[2].length=track[0].length;
           do
           {
-            track[3].radius=floor(RMIN+r_rand()%(2800/ *NSEG));
+            track[3].radius=floor(RMIN+rnd.Next()%(2800/ *NSEG));
             track[3].length=(2*PI-track[1].length)/2;
             track[4].radius=0.0;
             {
@@ -192,8 +264,8 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
       
         case 8: // square
           track[2].radius=0.0;
-          track[2].length=300.0+3*RMIN+r_rand()%(4000/ *NSEG);
-          track[3].radius=floor(RMIN+r_rand()%(2800/ *NSEG));
+          track[2].length=300.0+3*RMIN+rnd.Next()%(4000/ *NSEG);
+          track[3].radius=floor(RMIN+rnd.Next()%(2800/ *NSEG));
           track[3].length=PI-track[1].length;
           track[4].radius=0.0;
           track[4].length=track[0].length;
@@ -218,10 +290,10 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
     double r0=0,r1=0,r2=0,r3=0,r4=0; // radii of new segments
     double l0=0,l1=0,l2=0,l3=0,l4=0; // length of new segments
 
-    switch (r_rand() % REPLACEMENT_TYPES)  // replace this straight with what?
+    switch (rnd.Next() % REPLACEMENT_TYPES)  // replace this straight with what?
     {
       case 0:
-        while(track[i=1+r_rand()%((*NSEG*2)/3)].radius != 0);  // find a straight
+        while(track[i=1+rnd.Next()%((*NSEG*2)/3)].radius != 0);  // find a straight
 
         if( track[i].radius != 0.0 )
         {
@@ -240,12 +312,12 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
         {
           double x1,x2,y1,y2,m1,m2,b1,b2,A,B,C,d;
 
-          r0=-RMIN-r_rand()%(int)floor(1+h);
+          r0=-RMIN-rnd.Next()%(int)floor(1+h);
           r1=0;
           r3=0;
-          r4=-RMIN-r_rand()%(int)floor(1+h);
-          l0=PI/180*(30+r_rand()%120);
-          l1 = r_rand()%400+2*width+LMIN+RMIN*6;
+          r4=-RMIN-rnd.Next()%(int)floor(1+h);
+          l0=PI/180*(30+rnd.Next()%120);
+          l1 = rnd.Next()%400+2*width+LMIN+RMIN*6;
           l2=PI;
           l4=PI-l0;
 
@@ -273,7 +345,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
 
           l3 = l1 + d;
 
-          // r2=RMIN+r_rand()%(int)floor(1+(h-3*RMIN+r0)/2);
+          // r2=RMIN+rnd.Next()%(int)floor(1+(h-3*RMIN+r0)/2);
 
           m1 = 1/m1;
           b1 = y1 - m1*x1;
@@ -298,10 +370,10 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
           r2 -= width;
         }
       
-        // l1=-r4+r_rand()%800+2*width+LMIN+RMIN*6;
+        // l1=-r4+rnd.Next()%800+2*width+LMIN+RMIN*6;
         // l3=l1-r0+r4;
       
-        if( r_rand()%2 )
+        if( rnd.Next()%2 )
         {
           r0 = -r0;
           r2 = -r2;
@@ -328,7 +400,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
 
       case 1:
       case 2:
-        while(track[i=1+r_rand()%((*NSEG*2)/3)].radius != 0);  // find a straight
+        while(track[i=1+rnd.Next()%((*NSEG*2)/3)].radius != 0);  // find a straight
       
         if( track[i].radius != 0.0 )
         {
@@ -346,20 +418,20 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
         h=track[i].length/2;
         do
         {
-          l0=l4=PI/180*(30+r_rand()%70);
+          l0=l4=PI/180*(30+rnd.Next()%70);
         }
         while(fabs(l0-PI/2) < 0.07);
 
         l2=2*l0;
-        r0=r4=-RMIN-r_rand()%(int)floor(1-RMIN-width+h);
+        r0=r4=-RMIN-rnd.Next()%(int)floor(1-RMIN-width+h);
         h-=(width-r0)*sin(l0);
         if (l0 > PI/2)
         {
-          l1=l3=width+r_rand()%750+RMIN*6;
+          l1=l3=width+rnd.Next()%750+RMIN*6;
         }
         else
         {
-          l1=l3=LMIN+r_rand()%(int)floor(1+fabs((h-RMIN)/cos(l0)-LMIN));
+          l1=l3=LMIN+rnd.Next()%(int)floor(1+fabs((h-RMIN)/cos(l0)-LMIN));
         }
         r2=(h-l1*cos(l0))/sin(l2/2);
         h=r0/track[i-1].radius;
@@ -373,7 +445,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
           break;
         }
 
-        if( r_rand()%2 )
+        if( rnd.Next()%2 )
         {
           r0 = -r0;
           r2 = -r2;
@@ -386,7 +458,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
         break;
 
       case 3:
-        while(track[i=1+r_rand()%((*NSEG*2)/3)].radius == 0);  // find a curve
+        while(track[i=1+rnd.Next()%((*NSEG*2)/3)].radius == 0);  // find a curve
 
         if( track[i].radius == 0.0 )
         {
@@ -396,13 +468,13 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
         // Replace curve with S_curve/Straight/S_curve
         { double delta = fabs(track[i].radius)-RMIN;
 		    delta<1?delta=1:0;
-          r0 = r4 = +RMIN+r_rand()%(int)floor(delta);
-          r1 = r3 = +RMIN+r_rand()%(int)floor(delta);
+          r0 = r4 = +RMIN+rnd.Next()%(int)floor(delta);
+          r1 = r3 = +RMIN+rnd.Next()%(int)floor(delta);
         }
         r2 = 0.0;
       
         l0 = l4 = PI/180.*30.
-           + (r_rand()%100)/100.
+           + (rnd.Next()%100)/100.
            * (PI-PI/180.*30.-track[i].length/2.)
         ;
         l1 = l3 = l0
@@ -426,7 +498,7 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
 
         if( track[i].radius == 0.0 )
         {
-          r_rand()%2 == 0 ? r0 = -r0 : r0;
+          rnd.Next()%2 == 0 ? r0 = -r0 : r0;
         }
         else
         {
@@ -498,6 +570,67 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
 }
 
 
+/**
+ * Constructor
+ */
+OverlapGrid::OverlapGrid()
+{
+  m_iSize = m_iNbDot = m_iNbBucket = 0;
+  m_aX = m_aY = NULL;
+  m_aSeg = m_aNext = m_aHead = NULL;
+}
+
+/**
+ * Destructor
+ */
+OverlapGrid::~OverlapGrid()
+{
+  delete[] m_aX;
+  delete[] m_aY;
+  delete[] m_aSeg;
+  delete[] m_aNext;
+  delete[] m_aHead;
+}
+
+/**
+ * Make room for at least size dots. Nothing is kept.
+ *
+ * @param size     (in) number of dots needed
+ */
+void OverlapGrid::Reserve( int size )
+{
+  if( size<=m_iSize )
+  {
+    return;
+  }
+  delete[] m_aX;
+  delete[] m_aY;
+  delete[] m_aSeg;
+  delete[] m_aNext;
+  delete[] m_aHead;
+
+  m_iSize = size + size/2;
+  for( m_iNbBucket=64; m_iNbBucket<2*m_iSize; m_iNbBucket*=2 );
+  m_aX    = new double[m_iSize];
+  m_aY    = new double[m_iSize];
+  m_aSeg  = new int[m_iSize];
+  m_aNext = new int[m_iSize];
+  m_aHead = new int[m_iNbBucket];
+  out_of_memory(m_aHead);
+}
+
+/**
+ * Hash a grid cell to a bucket of the grid.
+ *
+ * @param cx       (in) cell column
+ * @param cy       (in) cell row
+ * @param mask     (in) number of buckets - 1
+ */
+static inline int grid_bucket( int cx, int cy, int mask )
+{
+  return (int)( ((unsigned)cx*73856093U ^ (unsigned)cy*19349663U) & (unsigned)mask );
+}
+
 /**
  * Check whether the track contains overlapping segments.
  *
@@ -506,54 +639,67 @@ static void generate_track(int *NSEG, double width, double length, struct segm *
  * If the distance is smaller than the track width, the 2 segments either
  * overlap or the segments are neighbors...
  *
- * @param NSEG     (??) the number of segments
- * @param width    (??) the width of the track
- * @param track    (??) an array of segm(s)
- * @param limit    (??) 
+ * The dots are put in a uniform grid with cells of one track width, so
+ * each dot is only compared with the dots of the 3x3 cells around it
+ * instead of all the dots of all the other segments.
+ *
+ * @param NSEG     (in) the number of segments
+ * @param width    (in) the width of the track
+ * @param track    (in) an array of segm(s)
+ * @param limit    (in) stop counting above this number of close dots
+ * @param grid     (in/out) work buffers of the calling thread
+ * @return         the number of pairs of close dots (at most limit+1)
  */
-static int overlaps(int NSEG, double width, struct segm *track, int limit )
+static int overlaps(int NSEG, double width, struct segm *track, int limit, OverlapGrid &grid )
 {
-  int    i, j, ii, jj;
-  int    *dots;         // dots[i] is the number of dots in segment i
-  double **X, **Y;      // X[i][j], Y[i][j] are coord. of j-th dot in segment i
+  int    i, j, n, dots;
   double x=0, y=width/2, w=0;
   double xx , yy;
+  double width2=width*width*1.02;
+  double cell=sqrt(width2);
+  int    mask;
   int    overlap=0;
 
-  dots = new int[NSEG];
-  X    = new double *[NSEG];
-  Y    = new double *[NSEG];
-  out_of_memory(Y);
+  // Count the dots first, to size the buffers once
+  n = 0;
+  for(i=0; i<NSEG; i++)
+  {
+    double r=fabs(track[i].radius);
+    double l=track[i].length;
+    dots = track[i].radius==0 
+         ? (int)ceil(l/width*DOTS_PER_WIDTH)
+         : (int)ceil((r+width/2)*l/width*DOTS_PER_WIDTH);
+    n += dots<=1 ? 2 : dots;
+  }
+  grid.Reserve(n);
+  grid.m_iNbDot = 0;
+  mask = grid.m_iNbBucket-1;
+  for(i=0; i<grid.m_iNbBucket; i++)
+  {
+    grid.m_aHead[i] = -1;
+  }
 
   for(i=0; i<NSEG; i++)        // put dots on segment i
   {
     double r=track[i].radius;
     double l=track[i].length;
+    double hx=0, hy=0, xm=0, ym=0, w0=0, hh=0;
     if (r==0)
     {
-      double hx, hy;
-      dots[i]=(int)ceil(l/width*8);
-      if (dots[i] <= 1)
+      dots=(int)ceil(l/width*DOTS_PER_WIDTH);
+      if (dots <= 1)
       {
-        dots[i]=2;
+        dots=2;
       }
-      X[i] = new double[ dots[i] ];
-      Y[i] = new double[ dots[i] ];
-      out_of_memory(Y[i]);
       xx=x; yy=y;
       x+=l*cos(w);
       y+=l*sin(w);
-      hx=(x-xx)/(dots[i]-1);
-      hy=(y-yy)/(dots[i]-1);
-      for(j=0; j<dots[i]; j++)
-      {
-        X[i][j]=xx+hx*j;
-        Y[i][j]=yy+hy*j;
-      }
+      hx=(x-xx)/(dots-1);
+      hy=(y-yy)/(dots-1);
     }
     else
     {
-      double xm, ym, w0, w1, PI_2, ll, hh;
+      double PI_2, ll;
       if (r>0)
       {
         PI_2=PI/2;
@@ -569,96 +715,88 @@ static int overlaps(int NSEG, double width, struct segm *track, int limit )
       xm=x+r*cos(w+PI_2);
       ym=y+r*sin(w+PI_2);
       w0=w-PI_2;
-      w1=w0+ll;
       w+=ll;
 
-      dots[i]=(int)ceil(r*l/width*8);
-      if (dots[i] <= 1)
+      dots=(int)ceil(r*l/width*DOTS_PER_WIDTH);
+      if (dots <= 1)
       {
-        dots[i]  = 2;
+        dots = 2;
       }
-      X[i] = new double[ dots[i] ];
-      Y[i] = new double[ dots[i] ];
-      out_of_memory(Y[i]);
-      hh=(w1-w0)/(dots[i]-1);
-      for(j=0; j<dots[i]; j++)
-      {  
-        double h=w0+hh*j;
-        X[i][j]=xm+r*cos(h);
-        Y[i][j]=ym+r*sin(h);
-      }
-      x=X[i][dots[i]-1];
-      y=Y[i][dots[i]-1];
+      hh=ll/(dots-1);
     }
-  }
 
-  // Now there are lots of dots on the middle of the track.
-  // Next we check whether dots in separate segments come too close.
-  for(i=0;   i<NSEG-3; i++)
-  {
-    for(j=i+3; j<NSEG  ; j++)
+    for(j=0; j<dots; j++)
     {
-      double width2=width*width*1.02;
-      double width8=8/width;
-      if (i<1 && j>=NSEG-3 && i<j-NSEG+3)
+      int    d = grid.m_iNbDot;
+      int    cx, cy, gx, gy, k;
+      double px, py;
+      if (track[i].radius==0)
       {
-         continue;  // segments i and j are near neighbors, dots may come close
+        px=xx+hx*j;
+        py=yy+hy*j;
+      }
+      else
+      {
+        px=xm+r*cos(w0+hh*j);
+        py=ym+r*sin(w0+hh*j);
       }
 
-      for(ii=dots[i]-1; ii>=0; ii--)
+      // Compare with the dots already in the 3x3 cells around
+      cx=(int)floor(px/cell);
+      cy=(int)floor(py/cell);
+      for(gx=cx-1; gx<=cx+1; gx++)
       {
-        int dmin=32767;
-        for(jj=dots[j]-1; jj>=0; jj--)
+        for(gy=cy-1; gy<=cy+1; gy++)
         {
-          double dx=X[i][ii]-X[j][jj];
-          double dy=Y[i][ii]-Y[j][jj];
-          double d2=dx*dx+dy*dy;
-          if (d2 >= width2)
+          for(k=grid.m_aHead[grid_bucket(gx,gy,mask)]; k>=0; k=grid.m_aNext[k])
           {
-            int d=(int)(sqrt(d2)*width8)-8;
-            if (d<dmin) dmin=d;
+            int    sd=i-grid.m_aSeg[k];   // segments i and sd are near neighbors,
+            double dx, dy;                 // dots may come close
+            if (sd<3 || NSEG-sd<3)
             {
-              jj-=d;
+              continue;
             }
-          }
-          else
-          {
-            ++overlap;//=1;  // segments i and j probably overlap
-            //  cout << '.';
-            if( overlap > limit )
+            dx=px-grid.m_aX[k];
+            dy=py-grid.m_aY[k];
+            if (dx*dx+dy*dy < width2)
             {
-              goto End;
+              ++overlap;   // segments i and seg[k] probably overlap
+              if( overlap > limit )
+              {
+                return overlap;
+              }
             }
           }
-        } 
-        ii-=dmin;
+        }
       }
-    }
-  }
 
-End:
-  cout << overlap << ' ';
-  for(i=0; i<NSEG; i++)
-  {
-    free(X[i]);
-    free(Y[i]);
+      grid.m_aX[d]=px;
+      grid.m_aY[d]=py;
+      grid.m_aSeg[d]=i;
+      k=grid_bucket(cx,cy,mask);
+      grid.m_aNext[d]=grid.m_aHead[k];
+      grid.m_aHead[k]=d;
+      grid.m_iNbDot++;
+    }
+    if (track[i].radius!=0)
+    {
+      x=grid.m_aX[grid.m_iNbDot-1];
+      y=grid.m_aY[grid.m_iNbDot-1];
+    }
   }
-  free(X);
-  free(Y);
-  free(dots);
 
   return overlap;
 }
 
-
 /**
- * Write the track in random.trk
+ * Write the track in a .trk file
  *
  * @param NSEG     (in) the number of segments
  * @param width    (in) the width of the track
  * @param track    (in) an array of segm(s)
+ * @param filename (in) name of the file (ex: random.trk)
  */
-static void write_track(int NSEG, double width, struct segm *track)
+static void write_track(int NSEG, double width, struct segm *track, const char * filename)
 {
   int i,j;
   double x=0, xmin=0, xmax=0, X_MAX, TRK_STRT_X,
@@ -733,10 +871,10 @@ static void write_track(int NSEG, double width, struct segm *track)
     h=0;
   } 
 
-  FILE * f = fopen(TRACKFILENAME,"w");
+  FILE * f = fopen(filename,"w");
   if( f==NULL )
   {
-    exitOnError("trackgen.cpp: write_track: unable to create file %s", TRACKFILENAME );
+    exitOnError("trackgen.cpp: write_track: unable to create file %s", filename );
   }
 
   fprintf(f,"%d\t\tNSEG - the number of track segments\n", NSEG);
@@ -779,35 +917,201 @@ static void write_track(int NSEG, double width, struct segm *track)
 }
 
 /**
- * Generate random track and write it to a file
+ * Seed of a candidate (or of a track of a batch), scrambled so that
+ * close numbers do not give close LCG sequences.
+ *
+ * @param seed     (in) seed of the track (or of the batch)
+ * @param k        (in) number of the candidate (or of the track)
  */
-void Track::generateRandomTrack()
+static unsigned long mix_seed( unsigned long seed, unsigned long k )
 {
-  int    NSEG;                            // number of track segments
-  int    maxseg=20+r_rand()%29;           // maximum number of track segments
-  double width=100;   //75.0+r_rand()%26; // track width in feet
-  double length=3000+r_rand()%18000;      // requested track length in feet (length<0: don't care)
-  double minrad=10;                       // minimum radius of curves (inner wall)
-  struct segm * track;
+  unsigned long h = (seed ^ 0x5bd1e995UL) * 2654435761UL + k;
+  h ^= h >> 15;
+  h *= 2246822519UL;
+  h ^= h >> 13;
+  return h & 0xFFFFFFFFUL;
+}
+
+/**
+ * Generate the candidate k of a search and check it.
+ *
+ * @param s        (in) the search
+ * @param k        (in) number of the candidate
+ * @param track    (out) the candidate (array of s->m_iMaxSeg segm)
+ * @param NSEG     (out) number of segments of the candidate
+ * @param grid     (in/out) work buffers of the calling thread
+ * @return         true if no segments overlap
+ */
+static bool check_candidate( CandidateSearch * s, int k, struct segm *track, int *NSEG, OverlapGrid &grid )
+{
+  TrackRand rnd( mix_seed(s->m_lSeed, k) );
   int o;
 
-  cout << length/5280. << ' '
-       << width  << ' '
-       << maxseg << ' ';
+  generate_track(NSEG, s->m_dWidth, s->m_dLength, track, s->m_iMaxSeg, s->m_dMinRad, rnd);
+  o = overlaps(*NSEG, s->m_dWidth, track, (int)(s->m_dLength*0.05), grid);
+  return o <= (s->m_dLength<20.0?0.0:s->m_dLength)*0.01;
+}
+
+/**
+ * Body of a search thread: check candidates until one with a lower
+ * number than the next free one has been accepted.
+ *
+ * @param param    (in) the CandidateSearch
+ */
+static void * search_thread( void * param )
+{
+  CandidateSearch * s = (CandidateSearch *)param;
+  struct segm * track = new segm[s->m_iMaxSeg];
+  OverlapGrid grid;
+  int NSEG, k;
 
-  track = new segm[maxseg];
   out_of_memory(track);
+  for(;;)
+  {
+#ifndef WIN32
+    pthread_mutex_lock( &s->m_oMutex );
+#endif
+    k = s->m_iNext;
+    if( s->m_iFound<0 || k<s->m_iFound )
+    {
+      s->m_iNext++;
+    }
+    else
+    {
+      k = -1;
+    }
+#ifndef WIN32
+    pthread_mutex_unlock( &s->m_oMutex );
+#endif
+    if( k<0 )
+    {
+      break;
+    }
+
+    if( check_candidate(s, k, track, &NSEG, grid) )
+    {
+#ifndef WIN32
+      pthread_mutex_lock( &s->m_oMutex );
+#endif
+      if( s->m_iFound<0 || k<s->m_iFound )
+      {
+        s->m_iFound = k;
+      }
+#ifndef WIN32
+      pthread_mutex_unlock( &s->m_oMutex );
+#endif
+    }
+  }
+  delete[] track;
+  return NULL;
+}
 
-  do
+/**
+ * Return the number of threads used to search the candidates.
+ */
+static int search_thread_count()
+{
+#ifndef WIN32
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if( n>MAX_THREADS )
   {
-    generate_track(&NSEG,width,length,track,maxseg,minrad); // generate track
+    n = MAX_THREADS;
   }
-  while((o=overlaps(NSEG, width, track, (int)(length*0.05) ))
-         >
-         (length<20.0?0.0:length)*0.01
-       );      // repeat until no segments overlap
+  return n<1 ? 1 : (int)n;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Generate one random track from a seed and write it to a file.
+ * The same seed always gives the same file.
+ *
+ * @param seed     (in) seed of the track
+ * @param filename (in) name of the .trk file
+ */
+static void generate_random_track( unsigned long seed, const char * filename )
+{
+  TrackRand rnd( seed );
+  CandidateSearch s;
+  int    NSEG;                              // number of track segments
+  struct segm * track;
+  OverlapGrid grid;
+
+  s.m_lSeed   = seed;
+  s.m_iMaxSeg = 20+rnd.Next()%29;           // maximum number of track segments
+  s.m_dWidth  = 100;   //75.0+rnd.Next()%26; // track width in feet
+  s.m_dLength = 3000+rnd.Next()%18000;      // requested track length in feet (length<0: don't care)
+  s.m_dMinRad = 10;                         // minimum radius of curves (inner wall)
+  s.m_iNext   = 0;
+  s.m_iFound  = -1;
+
+  cout << s.m_dLength/5280. << ' '
+       << s.m_dWidth  << ' '
+       << s.m_iMaxSeg << ' ';
+
+  // repeat until no segments overlap
+#ifndef WIN32
+  int nb_thread = search_thread_count(), i;
+  pthread_t threads[MAX_THREADS];
+
+  pthread_mutex_init( &s.m_oMutex, NULL );
+  for( i=1; i<nb_thread; i++ )
+  {
+    if( pthread_create(&threads[i], NULL, search_thread, &s) != 0 )
+    {
+      nb_thread = i;
+    }
+  }
+  search_thread( &s );
+  for( i=1; i<nb_thread; i++ )
+  {
+    pthread_join( threads[i], NULL );
+  }
+  pthread_mutex_destroy( &s.m_oMutex );
+#else
+  search_thread( &s );
+#endif
 
-  write_track(NSEG, width, track);     // write the track to file "random.trk"
+  // regenerate the winner
+  track = new segm[s.m_iMaxSeg];
+  out_of_memory(track);
+  check_candidate( &s, s.m_iFound, track, &NSEG, grid );
+  cout << s.m_iFound+1 << " candidate(s) -> " << filename << endl;
+
+  write_track(NSEG, s.m_dWidth, track, filename);
+  delete[] track;
 
   return;
 }
+
+/**
+ * Generate random track and write it to a file
+ */
+void Track::generateRandomTrack()
+{
+  unsigned long seed = ((unsigned long)r_rand()<<15) ^ r_rand();
+  generate_random_track( seed, TRACKFILENAME );   // write the track to file "random.trk"
+}
+
+/**
+ * Generate a batch of random tracks, random000.trk, random001.trk, ...
+ * in the tracks directory. Used to test the robots on many tracks.
+ * The same seed always gives the same batch.
+ *
+ * @param count    (in) number of tracks
+ * @param seed     (in) seed of the batch
+ */
+void Track::generateRandomTracks( int count, long seed )
+{
+  char filename[32];
+  int i;
+
+  // the path is built here: the current directory is never changed, and a
+  // missing tracks directory stops in write_track with the file name
+  for( i=0; i<count; i++ )
+  {
+    sprintf( filename, "tracks/random%03d.trk", i );
+    generate_random_track( mix_seed((unsigned long)seed, i), filename );
+  }
+}